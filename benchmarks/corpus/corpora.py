@@ -2,10 +2,15 @@
 Corpus tier registry — the single entry point the runner calls.
 
 Tiers:
-  smoke    deterministic synthetic set (no network, fast, CI-safe). Default.
-  silesia  the standard 12-file real-world corpus (fetched).
-  enwik8   100 MB Wikipedia text (fetched).
-  all      every tier above.
+  smoke       deterministic synthetic set (no network, fast, CI-safe). Default.
+  prod        production-shaped synthetic set: NDJSON logs, protobuf records,
+              HTML, source code, framed sub-4 KB messages (1.5 MB each).
+  prod-small  the prod shapes as single 512 B / 4 KiB payloads.
+  prod-large  the prod shapes at 64 MiB.
+  prod-1g     1 GiB logs and protobuf streams (generated on first use).
+  silesia     the standard 12-file real-world corpus (fetched).
+  enwik8      100 MB Wikipedia text (fetched).
+  all         every tier above.
 
 `resolve("smoke,silesia")` accepts a comma-separated list and merges, deduping
 by dataset id. Each returned dataset is {id, path, bytes, sha256, tier, ...}.
@@ -13,6 +18,7 @@ by dataset id. Each returned dataset is {id, path, bytes, sha256, tier, ...}.
 
 from __future__ import annotations
 
+import functools
 import sys
 from pathlib import Path
 
@@ -22,6 +28,10 @@ import generate as synthetic  # noqa: E402
 
 TIER_RESOLVERS = {
     "smoke": synthetic.resolve,
+    "prod": functools.partial(synthetic.resolve, "prod"),
+    "prod-small": functools.partial(synthetic.resolve, "prod-small"),
+    "prod-large": functools.partial(synthetic.resolve, "prod-large"),
+    "prod-1g": functools.partial(synthetic.resolve, "prod-1g"),
     "silesia": fetch.resolve_silesia,
     "silesia-mini": fetch.resolve_silesia_mini,
     "enwik8": fetch.resolve_enwik8,
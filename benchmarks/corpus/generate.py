@@ -8,19 +8,35 @@ results across machines and over time). Each dataset targets a distinct
 compressibility regime, because codec rankings flip wildly between, say,
 natural-language text and already-compressed bytes.
 
-`generate(force=False)` writes the data files plus a `manifest.json` recording
-each file's sha256. The runner verifies those hashes and regenerates on
-mismatch, so a corpus change is always explicit and visible in git.
+Two families of shapes:
+  smoke  text / json / binary / random — the four compressibility regimes.
+  prod   production-shaped data: NDJSON service logs, protobuf-style records,
+         HTML, source code, and a message-queue segment of sub-4 KB messages —
+         what "which codec/level for our traffic" should be answered on.
 
-Run directly to (re)generate:  python3 benchmarks/corpus/generate.py
+Every shape is an endless record stream seeded off SEED + the shape name, cut
+to the dataset's size; so a tier's datasets at different sizes are prefixes of
+one another (logs-4k is the first 4 KiB of logs), and adding a shape or a tier
+never perturbs the others. Tiers (see TIERS) pick shapes × sizes, from single
+sub-4 KB messages up to 1 GiB streams; nothing touches the network.
+
+`generate(tiers)` writes the tiers' data files and records each file's sha256
+in `manifest.json` under its tier. The runner verifies those hashes and
+regenerates on mismatch, so a corpus change is always explicit and visible in
+git.
+
+Run directly to (re)generate:  python3 benchmarks/corpus/generate.py [tier ...]
 """
 
 from __future__ import annotations
 
+import argparse
 import hashlib
 import json
 import random
 import struct
+import time
+import zlib
 from pathlib import Path
 
 CORPUS_DIR = Path(__file__).resolve().parent
@@ -30,6 +46,9 @@ MANIFEST = CORPUS_DIR / "manifest.json"
 SEED = 0xC0FFEE  # fixed; do not change without a baseline rebuild
 TARGET = 1_500_000  # ~1.5 MB per dataset: stable timing without making xz/bz2 L9 crawl
 
+_KiB, _MiB, _GiB = 1 << 10, 1 << 20, 1 << 30
+_CHUNK = 1 << 20  # write granularity
+
 # A small vocabulary produces realistic-ish, highly-compressible prose.
 _WORDS = (
     "the of and a to in is be that it for not on with as you do at this but his "
@@ -39,26 +58,21 @@ _WORDS = (
 ).split()
 
 
-def _text(n: int, rng: random.Random) -> bytes:
+# ---- smoke shapes --------------------------------------------------------
+
+def _text(rng: random.Random):
     """Natural-language-like prose. High redundancy; favors the strong coders."""
-    out = []
-    size = 0
-    while size < n:
+    while True:
         words = rng.choices(_WORDS, k=rng.randint(8, 16))
-        line = " ".join(words) + ".\n"
-        b = line.encode()
-        out.append(b)
-        size += len(b)
-    return b"".join(out)[:n]
+        yield (" ".join(words) + ".\n").encode()
 
 
-def _json(n: int, rng: random.Random) -> bytes:
+def _json(rng: random.Random):
     """Structured records. Repetitive keys, mixed value types — log/API shaped."""
-    out = [b"[\n"]
-    size = 2
+    yield b"[\n"
     i = 0
-    while size < n:
-        rec = (
+    while True:
+        yield (
             '  {"id": %d, "ts": %d, "level": %d, "name": "%s", '
             '"ok": %s, "ratio": %.3f},\n'
             % (
@@ -69,111 +83,412 @@ def _json(n: int, rng: random.Random) -> bytes:
                 "true" if rng.random() > 0.3 else "false",
                 rng.uniform(1.0, 8.0),
             )
-        )
-        b = rec.encode()
-        out.append(b)
-        size += len(b)
+        ).encode()
         i += 1
-    return b"".join(out)[:n]
 
 
-def _binary(n: int, rng: random.Random) -> bytes:
+def _binary(rng: random.Random):
     """Structured binary: columnar-ish records with smooth + noisy fields.
     Compressible but not trivially so — exercises the LZ + entropy stages."""
-    out = bytearray()
+    pos = 0
     counter = 0.0
-    while len(out) < n:
+    while True:
         counter += rng.uniform(-1.0, 1.0)
-        out += struct.pack(
+        yield struct.pack(
             "<IfHH",
-            len(out),  # monotonic — very predictable
+            pos,  # monotonic — very predictable
             counter,  # random walk — locally smooth
             rng.randint(0, 1023),  # bounded noise
             rng.randint(0, 65535),  # full noise
         )
-    return bytes(out[:n])
+        pos += 12
 
 
-def _random(n: int, rng: random.Random) -> bytes:
+def _random(rng: random.Random):
     """Incompressible bytes — proxy for already-compressed/encrypted data.
     The worst case: good codecs should detect it and barely expand."""
-    return rng.randbytes(n)
+    while True:
+        yield rng.randbytes(64 * _KiB)
+
+
+# ---- production shapes ---------------------------------------------------
+
+_SERVICES = ("api-gateway", "auth", "orders", "billing", "search", "inventory", "notifier")
+_ROUTES = (
+    ("GET", "/v1/users/%d"), ("GET", "/v1/users/%d/orders"), ("POST", "/v1/orders"),
+    ("GET", "/v1/orders/%d"), ("GET", "/v1/search"), ("PUT", "/v1/cart/%d/items"),
+    ("GET", "/v2/inventory/%d"), ("DELETE", "/v1/sessions/%d"), ("GET", "/healthz"),
+)
+_ROUTE_W = (20, 12, 8, 10, 15, 6, 9, 3, 17)
+_STATUS = (200, 201, 204, 304, 400, 401, 404, 429, 500, 503)
+_STATUS_W = (70, 6, 4, 5, 4, 2, 5, 1, 2, 1)
+_LOG_MSGS = ("request completed", "cache miss", "upstream call finished",
+             "retrying upstream", "slow query", "token refreshed")
+_LOG_MSG_W = (70, 10, 10, 4, 4, 2)
+
+
+def _zipf_id(rng: random.Random) -> int:
+    """Heavy-tailed ids: a few hot users/orders, a long tail of cold ones."""
+    return int(rng.paretovariate(1.1) * 1000)
+
+
+def _logs(rng: random.Random):
+    """NDJSON service logs: ISO-8601 timestamps advancing a few ms per line,
+    hex trace ids, Zipf-ish routes and ids, and the odd error with a stack."""
+    t_ms = 1_700_000_000_000
+    sec, stamp = -1, ""
+    while True:
+        t_ms += int(rng.expovariate(1 / 3.0))  # ~330 req/s with bursts
+        s, ms = divmod(t_ms, 1000)
+        if s != sec:
+            sec, stamp = s, time.strftime("%Y-%m-%dT%H:%M:%S", time.gmtime(s))
+        method, route = rng.choices(_ROUTES, _ROUTE_W)[0]
+        path = route % _zipf_id(rng) if "%d" in route else route
+        status = rng.choices(_STATUS, _STATUS_W)[0]
+        level = "error" if status >= 500 else "warn" if status >= 400 else "info"
+        svc = rng.choice(_SERVICES)
+        line = (
+            '{"ts":"%s.%03dZ","level":"%s","service":"%s","host":"%s-%02d",'
+            '"trace_id":"%032x","span_id":"%016x","method":"%s","path":"%s",'
+            '"status":%d,"latency_ms":%.2f,"bytes":%d,"msg":"%s"'
+            % (stamp, ms, level, svc, svc, rng.randint(1, 24),
+               rng.getrandbits(128), rng.getrandbits(64), method, path, status,
+               rng.lognormvariate(2.5, 1.0), int(rng.lognormvariate(7, 1.5)),
+               rng.choices(_LOG_MSGS, _LOG_MSG_W)[0])
+        )
+        if level == "error":
+            frames = "\\n".join(
+                "    at %s.%s (%s.go:%d)" % (rng.choice(_SERVICES), rng.choice(_WORDS),
+                                            rng.choice(_WORDS), rng.randint(10, 900))
+                for _ in range(rng.randint(3, 8)))
+            line += ',"error":"upstream %s: connection reset\\n%s"' % (svc, frames)
+        yield (line + "}\n").encode()
+
+
+def _varint(v: int) -> bytes:
+    out = bytearray()
+    while v >= 0x80:
+        out.append((v & 0x7F) | 0x80)
+        v >>= 7
+    out.append(v)
+    return bytes(out)
+
+
+def _pb_bytes(field: int, payload: bytes) -> bytes:
+    return _varint(field << 3 | 2) + _varint(len(payload)) + payload
+
+
+def _proto_record(rng: random.Random, rid: int, t_ns: int) -> bytes:
+    rec = bytearray()
+    rec += _varint(1 << 3) + _varint(rid)                                  # id
+    rec += _varint(2 << 3 | 1) + struct.pack("<Q", t_ns)                   # ts (fixed64)
+    rec += _pb_bytes(3, "_".join(rng.choices(_WORDS, k=rng.randint(1, 3))).encode())
+    rec += _varint(4 << 3) + _varint(rng.choices(range(6), (50, 20, 10, 10, 5, 5))[0])
+    tags = b"".join(_varint(int(rng.expovariate(0.05))) for _ in range(rng.randint(0, 8)))
+    if tags:
+        rec += _pb_bytes(5, tags)                                          # packed varints
+    rec += _varint(6 << 3 | 1) + struct.pack("<d", rng.gauss(100.0, 15.0))
+    for _ in range(rng.randint(0, 3)):                                     # attrs
+        rec += _pb_bytes(7, _pb_bytes(1, rng.choice(_WORDS).encode())
+                         + _varint(2 << 3) + _varint(rng.randint(0, 1 << 20)))
+    if rng.random() < 0.5:
+        rec += _pb_bytes(8, rng.randbytes(16))                             # digest
+    return bytes(rec)
+
+
+def _proto(rng: random.Random):
+    """Protobuf wire-format records, varint-length-delimited (writeDelimitedTo
+    style): varints, fixed64 timestamps, short strings, packed repeated
+    fields, nested messages and random digests."""
+    t_ns = 1_700_000_000 * 10**9
+    rid = 0
+    while True:
+        rid += 1
+        t_ns += int(rng.expovariate(1 / 2e6))
+        rec = _proto_record(rng, rid, t_ns)
+        yield _varint(len(rec)) + rec
+
+
+def _sentence(rng: random.Random, lo: int, hi: int) -> str:
+    return " ".join(rng.choices(_WORDS, k=rng.randint(lo, hi)))
+
+
+def _html(rng: random.Random):
+    """Rendered HTML pages: a shared head and nav, then article cards with
+    classes, attributes and links — markup-heavy with prose in between."""
+    page = 0
+    while True:
+        page += 1
+        yield (
+            '<!DOCTYPE html>\n<html lang="en">\n<head>\n<meta charset="utf-8">\n'
+            '<title>%s</title>\n<link rel="stylesheet" href="/static/css/site.%08x.css">\n'
+            '<script defer src="/static/js/app.%08x.js"></script>\n</head>\n<body>\n'
+            '<nav class="navbar navbar-expand-lg"><ul class="nav">\n'
+            % (_sentence(rng, 3, 6).title(), rng.getrandbits(32), rng.getrandbits(32))
+        ).encode()
+        yield "".join(
+            '  <li class="nav-item"><a class="nav-link" href="/%s">%s</a></li>\n'
+            % (w, w.title()) for w in rng.sample(_WORDS, 6)).encode()
+        yield b'</ul></nav>\n<main class="container">\n'
+        for _ in range(rng.randint(8, 30)):
+            item = _zipf_id(rng)
+            yield (
+                '<article class="card card-%s" data-id="%d">\n'
+                '  <h2 class="card-title"><a href="/items/%d">%s</a></h2>\n'
+                '  <p class="card-text">%s.</p>\n'
+                '  <span class="price">$%d.%02d</span> <a class="btn btn-primary" '
+                'href="/cart/add?id=%d">Add to cart</a>\n</article>\n'
+                % (rng.choice(("small", "wide", "featured")), item, item,
+                   _sentence(rng, 2, 6).title(), _sentence(rng, 12, 40),
+                   rng.randint(1, 500), rng.randint(0, 99), item)
+            ).encode()
+        yield ('</main>\n<footer class="footer">&copy; %d</footer>\n</body>\n</html>\n'
+               % (2000 + page % 25)).encode()
+
+
+_C_TYPES = ("int", "size_t", "uint8_t*", "const char*", "cu_status_t", "uint64_t")
 
 
-DATASETS = {
+def _ident(rng: random.Random) -> str:
+    return "_".join(rng.choices(_WORDS, k=rng.randint(1, 3)))
+
+
+def _source(rng: random.Random):
+    """C-like source files: license header, includes, then functions with
+    comments, declarations, branches and loops — indentation-heavy, with a
+    small identifier vocabulary reused everywhere."""
+    while True:
+        yield ("/*\n * %s.c — %s.\n *\n * SPDX-License-Identifier: MIT\n */\n\n"
+               % (_ident(rng), _sentence(rng, 4, 10))).encode()
+        yield "".join('#include "%s.h"\n' % _ident(rng) for _ in range(rng.randint(2, 5))).encode()
+        yield b"#include <stdint.h>\n#include <stdlib.h>\n#include <string.h>\n\n"
+        for _ in range(rng.randint(4, 16)):
+            name = "cu_" + _ident(rng)
+            args = ", ".join("%s %s" % (rng.choice(_C_TYPES), _ident(rng))
+                             for _ in range(rng.randint(1, 4)))
+            body = []
+            for _ in range(rng.randint(3, 14)):
+                v = _ident(rng)
+                r = rng.random()
+                if r < 0.3:
+                    body.append("    %s %s = %s(%s);" % (rng.choice(_C_TYPES), v,
+                                                         _ident(rng), _ident(rng)))
+                elif r < 0.5:
+                    body.append("    if (!%s) {\n        cu_set_last_error(\"%s\");\n"
+                                "        return CU_ERR_INVALID_ARG;\n    }"
+                                % (v, _sentence(rng, 2, 6)))
+                elif r < 0.65:
+                    body.append("    for (size_t i = 0; i < %s; i++) {\n"
+                                "        %s[i] = %s(%s[i]);\n    }"
+                                % (v, v, _ident(rng), _ident(rng)))
+                elif r < 0.8:
+                    body.append("    /* %s. */" % _sentence(rng, 4, 12).capitalize())
+                else:
+                    body.append("    %s += %d;" % (v, rng.randint(1, 4096)))
+            yield ("/* %s. */\nstatic cu_status_t %s(%s) {\n%s\n    return CU_OK;\n}\n\n"
+                   % (_sentence(rng, 4, 12).capitalize(), name, args,
+                      "\n".join(body))).encode()
+
+
+def _api_json(rng: random.Random, budget: int) -> bytes:
+    """An API response body with as many items as fit in ~budget bytes."""
+    head = '{"request_id":"%032x","status":"ok","items":[' % rng.getrandbits(128)
+    items = []
+    size = len(head) + 3
+    while True:
+        item = ('{"id":%d,"sku":"%s-%05d","qty":%d,"price":%.2f,"tags":["%s","%s"]}'
+                % (_zipf_id(rng), rng.choice(_WORDS).upper(), rng.randint(0, 99999),
+                   rng.randint(1, 9), rng.uniform(0.5, 300.0),
+                   rng.choice(_WORDS), rng.choice(_WORDS)))
+        if items and size + len(item) + 1 > budget:
+            break
+        items.append(item)
+        size += len(item) + 1
+    return (head + ",".join(items) + "]}").encode()
+
+
+def _messages(rng: random.Random):
+    """A message-queue segment: independent sub-4 KB messages (log-normal
+    sizes, median ~300 B), each framed as <u32 length><u8 kind>. Kinds mix a
+    log line, a protobuf record and an API JSON body. Pair with the runner's
+    msg mode to time per-message calls on realistic payloads."""
+    logs = _logs(random.Random(rng.getrandbits(64)))
+    rid, t_ns = 0, 1_700_000_000 * 10**9
+    while True:
+        kind = rng.choices((0, 1, 2), (50, 25, 25))[0]
+        if kind == 0:
+            body = next(logs)
+        elif kind == 1:
+            rid += 1
+            t_ns += int(rng.expovariate(1 / 2e6))
+            body = _proto_record(rng, rid, t_ns)
+        else:
+            body = _api_json(rng, min(4096 - 5, int(rng.lognormvariate(5.7, 0.9))))
+        body = body[:4096 - 5]
+        yield struct.pack("<IB", len(body), kind) + body
+
+
+SHAPES = {
     "text": (_text, "Natural-language-like prose (highly compressible)"),
     "json": (_json, "Structured JSON records (log/API shaped)"),
     "binary": (_binary, "Columnar binary: smooth + noisy numeric fields"),
     "random": (_random, "Incompressible random bytes (already-compressed proxy)"),
+    "logs": (_logs, "NDJSON service logs with timestamps and trace ids"),
+    "proto": (_proto, "Length-delimited protobuf wire-format records"),
+    "html": (_html, "Rendered HTML pages (markup-heavy)"),
+    "source": (_source, "C-like source code"),
+    "messages": (_messages, "Message-queue segment of framed sub-4 KB messages"),
 }
 
+_SMOKE = ("text", "json", "binary", "random")
+_PROD = ("logs", "proto", "html", "source", "messages")
 
-def generate(force: bool = False) -> dict:
-    DATA_DIR.mkdir(parents=True, exist_ok=True)
-    entries = []
-    for name, (fn, desc) in DATASETS.items():
-        path = DATA_DIR / f"{name}.bin"
-        # Each dataset gets its own deterministic stream seeded off the global
-        # seed + name, so adding a dataset doesn't perturb the others.
-        rng = random.Random(SEED ^ (hash(name) & 0xFFFFFFFF))
-        if force or not path.exists():
-            data = fn(TARGET, rng)
-            path.write_bytes(data)
-        digest = hashlib.sha256(path.read_bytes()).hexdigest()
-        entries.append(
-            {
-                "id": name,
-                "file": f"data/{name}.bin",
-                "bytes": path.stat().st_size,
-                "sha256": digest,
-                "description": desc,
-            }
-        )
-    manifest = {"seed": SEED, "target_bytes": TARGET, "datasets": entries}
-    MANIFEST.write_text(json.dumps(manifest, indent=2) + "\n")
-    return manifest
+# tier -> [(shape, bytes)]. Datasets at TARGET keep the bare shape name as
+# their id; other sizes get a suffix (logs-4k, logs-64m), so tiers merge.
+TIERS = {
+    "smoke": [(s, TARGET) for s in _SMOKE],
+    "prod": [(s, TARGET) for s in _PROD],
+    # single small payloads — one API body / log batch / page fragment per call
+    "prod-small": [(s, n) for n in (512, 4 * _KiB) for s in _PROD if s != "messages"],
+    "prod-large": [(s, 64 * _MiB) for s in _PROD],
+    # long streams for streaming-mode and window/memory behavior
+    "prod-1g": [(s, _GiB) for s in ("logs", "proto")],
+}
+
+
+def _size_tag(n: int) -> str:
+    for unit, tag in ((_GiB, "g"), (_MiB, "m"), (_KiB, "k")):
+        if n % unit == 0:
+            return f"{n // unit}{tag}"
+    return str(n)
+
+
+def dataset_id(shape: str, n: int) -> str:
+    return shape if n == TARGET else f"{shape}-{_size_tag(n)}"
+
+
+def _rng(shape: str) -> random.Random:
+    # Seeded off the global seed + shape name (crc32, not hash(): str hashing
+    # is salted per process), so adding a shape doesn't perturb the others.
+    return random.Random(SEED ^ zlib.crc32(shape.encode()))
+
+
+def _write(path: Path, shape: str, n: int) -> str:
+    """Stream the first n bytes of `shape` into path; returns the sha256."""
+    h = hashlib.sha256()
+    tmp = path.with_suffix(path.suffix + ".part")
+    left = n
+    buf: list[bytes] = []
+    pending = 0
+    with open(tmp, "wb") as f:
+        for rec in SHAPES[shape][0](_rng(shape)):
+            rec = rec[:left]
+            buf.append(rec)
+            pending += len(rec)
+            left -= len(rec)
+            if pending >= _CHUNK or not left:
+                b = b"".join(buf)
+                f.write(b)
+                h.update(b)
+                buf.clear()
+                pending = 0
+            if not left:
+                break
+    tmp.replace(path)
+    return h.hexdigest()
+
+
+def _sha256(path: Path) -> str:
+    h = hashlib.sha256()
+    with open(path, "rb") as f:
+        for chunk in iter(lambda: f.read(_CHUNK), b""):
+            h.update(chunk)
+    return h.hexdigest()
 
 
 def load_manifest() -> dict | None:
     if not MANIFEST.exists():
         return None
-    return json.loads(MANIFEST.read_text())
+    m = json.loads(MANIFEST.read_text())
+    return m if m.get("seed") == SEED and "tiers" in m else None
 
 
-def verify() -> bool:
-    """True if every manifest file exists with the recorded sha256."""
+def generate(tiers: list[str] | tuple[str, ...] = ("smoke",), force: bool = False) -> dict:
+    """(Re)generate the given tiers and record them in the manifest; other
+    tiers' manifest entries are kept as they are."""
+    DATA_DIR.mkdir(parents=True, exist_ok=True)
+    manifest = load_manifest() or {"seed": SEED, "tiers": {}}
+    for tier in tiers:
+        entries = []
+        for shape, n in TIERS[tier]:
+            ds = dataset_id(shape, n)
+            path = DATA_DIR / f"{ds}.bin"
+            if force or not path.exists() or path.stat().st_size != n:
+                print(f"[corpus] generating {ds} ({n:,} B)")
+                digest = _write(path, shape, n)
+            else:
+                digest = _sha256(path)
+            entries.append(
+                {
+                    "id": ds,
+                    "file": f"data/{ds}.bin",
+                    "bytes": n,
+                    "sha256": digest,
+                    "description": SHAPES[shape][1],
+                }
+            )
+        manifest["tiers"][tier] = {"datasets": entries}
+    MANIFEST.write_text(json.dumps(manifest, indent=2) + "\n")
+    return manifest
+
+
+def verify(tier: str = "smoke") -> bool:
+    """True if every file of the tier exists with the recorded sha256."""
     m = load_manifest()
-    if not m:
+    if not m or tier not in m["tiers"]:
+        return False
+    expected = [dataset_id(s, n) for s, n in TIERS[tier]]
+    if [d["id"] for d in m["tiers"][tier]["datasets"]] != expected:
         return False
-    for d in m["datasets"]:
+    for d in m["tiers"][tier]["datasets"]:
         p = CORPUS_DIR / d["file"]
-        if not p.exists():
+        if not p.exists() or p.stat().st_size != d["bytes"]:
             return False
-        if hashlib.sha256(p.read_bytes()).hexdigest() != d["sha256"]:
+        if _sha256(p) != d["sha256"]:
             return False
     return True
 
 
-def resolve() -> list[dict]:
-    """Ensure the synthetic 'smoke' tier exists and return its datasets in the
-    common shape used by the runner ({id, path, bytes, sha256, tier, ...})."""
-    if not verify():
-        generate(force=True)
+def resolve(tier: str = "smoke") -> list[dict]:
+    """Ensure a synthetic tier exists and return its datasets in the common
+    shape used by the runner ({id, path, bytes, sha256, tier, ...})."""
+    if not verify(tier):
+        generate([tier], force=True)
     out = []
-    for d in load_manifest()["datasets"]:
+    for d in load_manifest()["tiers"][tier]["datasets"]:
         out.append({
             "id": d["id"],
             "path": str((CORPUS_DIR / d["file"]).resolve()),
             "bytes": d["bytes"],
             "sha256": d["sha256"],
-            "tier": "smoke",
+            "tier": tier,
             "description": d["description"],
         })
     return out
 
 
 if __name__ == "__main__":
-    m = generate(force=True)
-    print(f"Generated {len(m['datasets'])} datasets into {DATA_DIR}")
-    for d in m["datasets"]:
-        print(f"  {d['id']:8} {d['bytes']:>9,} B  {d['sha256'][:12]}…")
+    ap = argparse.ArgumentParser(description="Regenerate synthetic corpus tiers.")
+    ap.add_argument("tiers", nargs="*", default=["smoke"],
+                    help=f"tiers to regenerate ({', '.join(TIERS)}, all); default smoke")
+    args = ap.parse_args()
+    tiers = list(TIERS) if "all" in args.tiers else args.tiers
+    for t in tiers:
+        if t not in TIERS:
+            raise SystemExit(f"unknown tier '{t}'. Known: {', '.join(TIERS)}, all")
+    m = generate(tiers, force=True)
+    for t in tiers:
+        ds = m["tiers"][t]["datasets"]
+        print(f"{t}: {len(ds)} datasets in {DATA_DIR}")
+        for d in ds:
+            print(f"  {d['id']:14} {d['bytes']:>13,} B  {d['sha256'][:12]}…")
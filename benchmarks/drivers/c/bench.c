@@ -1,12 +1,18 @@
 /*
  * compress-utils C benchmark driver.
  *
- * Thin adapter: wraps the public cu_* one-shot ABI as bench_codec_t entries
+ * Thin adapter: wraps the public cu_* one-shot, streaming and parallel ABI as
+ * bench_codec_t entries
  * and hands them to the shared harness (bench_harness.h), which owns timing,
  * statistics, round-trip verification, and NDJSON emission. The algorithm enum
  * rides in each codec's `native_id`.
  *
  * Protocol, env, and --info are documented in benchmarks/README.md.
+ *
+ * `bench --startup <cold|warm> <algo> <level> <path>` is the one exception to
+ * the job protocol: it times the first cu_compress of a fresh process (after
+ * cu_warmup for "warm") and the second one, prints one record and exits. The
+ * runner's startup mode spawns it once per sample.
  */
 
 #include "compress_utils.h"
@@ -36,13 +42,21 @@ static int cu_do_decompress(const bench_codec_t* c, const uint8_t* in, size_t in
  * emitting nor finishing (mirrors the JS dispatcher's DRAIN_MAX_ITERATIONS). */
 #define CU_DRAIN_MAX (1 << 20)
 
-/* Streaming compress: feed input in `chunk`-sized pieces through the cu_*
+/* Output space for the next stream call: the caller's window (the scratch a
+ * binding drains into), or everything left when no window is set. */
+static size_t cu_out_window(const bench_stream_t* io, size_t left) {
+    return io->out_chunk && io->out_chunk < left ? io->out_chunk : left;
+}
+
+/* Streaming compress: feed input in `io->chunk`-sized pieces through the cu_*
  * stream ABI, honoring the "fill buffer, BUF_TOO_SMALL, drain with (NULL,0)"
- * protocol. `out` is bound-sized so it always has room. */
+ * protocol. `out` is bound-sized so it always has room; with an output window
+ * each call sees at most `io->out_chunk` bytes of it, and every BUF_TOO_SMALL
+ * counts as a drain. */
 static int cu_do_compress_stream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                                 uint8_t* out, size_t* out_len, int level, size_t chunk,
+                                 uint8_t* out, size_t* out_len, int level, bench_stream_t* io,
                                  const char** err) {
-    if (chunk == 0) chunk = 64 * 1024;
+    size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     cu_compress_stream_t* s = NULL;
     cu_status_t st = cu_compress_stream_create((cu_algorithm_t)c->native_id, level, &s);
     if (st != CU_OK) { *err = cu_last_error(); return (int)st; }
@@ -50,18 +64,19 @@ static int cu_do_compress_stream(const bench_codec_t* c, const uint8_t* in, size
     size_t cap = *out_len, pos = 0;
     for (size_t off = 0; off < in_len; off += chunk) {
         size_t n = in_len - off < chunk ? in_len - off : chunk;
-        size_t ol = cap - pos;
+        size_t ol = cu_out_window(io, cap - pos);
         st = cu_compress_stream_write(s, in + off, n, out + pos, &ol);
         pos += ol;
         for (int guard = 0; st == CU_ERR_BUF_TOO_SMALL && guard < CU_DRAIN_MAX; guard++) {
-            ol = cap - pos;
+            io->drains++;
+            ol = cu_out_window(io, cap - pos);
             st = cu_compress_stream_write(s, NULL, 0, out + pos, &ol);
             pos += ol;
         }
         if (st != CU_OK) { *err = cu_last_error(); cu_compress_stream_destroy(s); return (int)st; }
     }
     for (int guard = 0; guard < CU_DRAIN_MAX; guard++) {
-        size_t ol = cap - pos;
+        size_t ol = cu_out_window(io, cap - pos);
         st = cu_compress_stream_finish(s, out + pos, &ol);
         pos += ol;
         if (st == CU_OK) break;
@@ -70,17 +85,19 @@ static int cu_do_compress_stream(const bench_codec_t* c, const uint8_t* in, size
             cu_compress_stream_destroy(s);
             return (int)st;
         }
+        io->drains++;
     }
     cu_compress_stream_destroy(s);
     *out_len = pos;
     return 0;
 }
 
-/* Streaming decompress: feed the compressed buffer in `chunk`-sized pieces. */
+/* Streaming decompress: feed the compressed buffer in `io->chunk`-sized
+ * pieces, same output window and drain counting as compress. */
 static int cu_do_decompress_stream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                                   uint8_t* out, size_t* out_len, size_t chunk,
+                                   uint8_t* out, size_t* out_len, bench_stream_t* io,
                                    const char** err) {
-    if (chunk == 0) chunk = 64 * 1024;
+    size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     cu_decompress_stream_t* s = NULL;
     cu_status_t st = cu_decompress_stream_create((cu_algorithm_t)c->native_id, &s);
     if (st != CU_OK) { *err = cu_last_error(); return (int)st; }
@@ -88,18 +105,19 @@ static int cu_do_decompress_stream(const bench_codec_t* c, const uint8_t* in, si
     size_t cap = *out_len, pos = 0;
     for (size_t off = 0; off < in_len; off += chunk) {
         size_t n = in_len - off < chunk ? in_len - off : chunk;
-        size_t ol = cap - pos;
+        size_t ol = cu_out_window(io, cap - pos);
         st = cu_decompress_stream_write(s, in + off, n, out + pos, &ol);
         pos += ol;
         for (int guard = 0; st == CU_ERR_BUF_TOO_SMALL && guard < CU_DRAIN_MAX; guard++) {
-            ol = cap - pos;
+            io->drains++;
+            ol = cu_out_window(io, cap - pos);
             st = cu_decompress_stream_write(s, NULL, 0, out + pos, &ol);
             pos += ol;
         }
         if (st != CU_OK) { *err = cu_last_error(); cu_decompress_stream_destroy(s); return (int)st; }
     }
     for (int guard = 0; guard < CU_DRAIN_MAX; guard++) {
-        size_t ol = cap - pos;
+        size_t ol = cu_out_window(io, cap - pos);
         st = cu_decompress_stream_finish(s, out + pos, &ol);
         pos += ol;
         if (st == CU_OK) break;
@@ -108,15 +126,37 @@ static int cu_do_decompress_stream(const bench_codec_t* c, const uint8_t* in, si
             cu_decompress_stream_destroy(s);
             return (int)st;
         }
+        io->drains++;
     }
     cu_decompress_stream_destroy(s);
     *out_len = pos;
     return 0;
 }
 
+/* cu_compress_parallel on `threads` workers at the codec's default chunk
+ * size; the multi-frame output decodes with plain cu_decompress. */
+static size_t cu_parallel_bound(const bench_codec_t* c, size_t in_len, unsigned threads) {
+    cu_parallel_opts_t opts = { threads, 0 };
+    return cu_compress_parallel_bound(in_len, (cu_algorithm_t)c->native_id, &opts);
+}
+
+static int cu_do_compress_parallel(const bench_codec_t* c, const uint8_t* in, size_t in_len,
+                                   uint8_t* out, size_t* out_len, int level, unsigned threads,
+                                   const char** err) {
+    cu_parallel_opts_t opts = { threads, 0 };
+    cu_status_t s = cu_compress_parallel((cu_algorithm_t)c->native_id, in, in_len, out,
+                                         out_len, level, &opts);
+    if (s != CU_OK) { *err = cu_last_error(); return (int)s; }
+    return 0;
+}
+
+/* No message sessions: the C API has no reusable contexts or dictionaries,
+ * so only "msg:fresh" jobs run here (one cu_compress per message). The stream
+ * functions honor an output window, so sweep jobs can shrink it. */
 #define CU_CODEC(NAME, ENUM)                                              \
     { NAME, "compress-utils", (ENUM), cu_bound, cu_do_compress,           \
-      cu_do_decompress, cu_do_compress_stream, cu_do_decompress_stream }
+      cu_do_decompress, cu_do_compress_stream, cu_do_decompress_stream,   \
+      cu_parallel_bound, cu_do_compress_parallel, NULL, NULL, NULL, NULL, 1 }
 
 static const bench_codec_t CODECS[] = {
     CU_CODEC("zstd", CU_ALGO_ZSTD),
@@ -130,9 +170,93 @@ static const bench_codec_t CODECS[] = {
 };
 static const size_t N_CODECS = sizeof(CODECS) / sizeof(CODECS[0]);
 
+/* One time-to-first-compress sample. The input is read before the clock
+ * starts; each timed call includes sizing and allocating its output, as a
+ * caller's first request would. BENCH_SPAWN_NS (CLOCK_MONOTONIC, set by the
+ * runner just before exec) adds the process-level figure: exec, dynamic
+ * loading and relocation up to the end of the first compress. */
+static int cu_startup(const char* variant, const char* algo, const char* level_s,
+                      const char* path) {
+    const bench_codec_t* codec = bench_find(CODECS, N_CODECS, algo);
+    int warm = !strcmp(variant, "warm");
+    if (!codec || (!warm && strcmp(variant, "cold"))) {
+        fprintf(stderr, "bench: bad --startup arguments\n");
+        return 1;
+    }
+    int level = (int)strtol(level_s, NULL, 10);
+    size_t in_len = 0;
+    uint8_t* in = bench_read_file(path, &in_len);
+    if (!in) {
+        fprintf(stderr, "bench: cannot read '%s'\n", path);
+        return 1;
+    }
+    cu_algorithm_t a = (cu_algorithm_t)codec->native_id;
+
+    uint64_t t0 = bench_now_ns();
+    cu_status_t s = warm ? cu_warmup(&a, 1, &level, 1) : CU_OK;
+    uint64_t warmup_ns = warm ? bench_now_ns() - t0 : 0;
+    uint64_t first_ns = 0, steady_ns = 0, first_end = 0;
+    size_t out_len = 0;
+    uint8_t* out = NULL;
+    for (int call = 0; call < 2 && s == CU_OK; call++) {
+        uint64_t c0 = bench_now_ns();
+        out_len = cu_compress_bound(in_len, a);
+        free(out);
+        out = (uint8_t*)malloc(out_len ? out_len : 1);
+        s = out ? cu_compress(a, in, in_len, out, &out_len, level) : CU_ERR_OOM;
+        uint64_t c1 = bench_now_ns();
+        if (call == 0) {
+            first_ns = c1 - c0;
+            first_end = c1;
+        } else {
+            steady_ns = c1 - c0;
+        }
+    }
+    if (s != CU_OK) {
+        fprintf(stderr, "bench: startup %s L%d failed: %s\n", algo, level, cu_last_error());
+        free(out);
+        free(in);
+        return 1;
+    }
+    uint8_t* back = (uint8_t*)malloc(in_len ? in_len : 1);
+    size_t back_len = in_len;
+    int verified = back && cu_decompress(a, out, out_len, back, &back_len) == CU_OK &&
+                   back_len == in_len && memcmp(back, in, in_len) == 0;
+    const char* spawn = getenv("BENCH_SPAWN_NS");
+    uint64_t spawn_ns = spawn ? strtoull(spawn, NULL, 10) : 0;
+
+    FILE* o = stdout;
+    fputs("{\"lang\":\"c\",\"impl\":\"compress-utils\",\"algo\":", o);
+    bench_emit_json_string(o, algo);
+    fprintf(o, ",\"level\":%d,\"mode\":\"startup\",\"startup\":\"%s\",", level, variant);
+    fputs("\"chunk_bytes\":0,\"threads\":1,\"callers\":1,\"input\":", o);
+    bench_emit_json_string(o, path);
+    fprintf(o, ",\"input_bytes\":%zu,\"output_bytes\":%zu,", in_len, out_len);
+    if (warm) fprintf(o, "\"warmup_ns\":%llu,", (unsigned long long)warmup_ns);
+    fprintf(o, "\"first_ns\":%llu,\"steady_ns\":%llu,", (unsigned long long)first_ns,
+            (unsigned long long)steady_ns);
+    if (spawn_ns && spawn_ns < first_end) {
+        fprintf(o, "\"process_ns\":%llu,", (unsigned long long)(first_end - spawn_ns));
+    }
+    fprintf(o, "\"verified\":%s}\n", verified ? "true" : "false");
+    free(back);
+    free(out);
+    free(in);
+    return 0;
+}
+
 int main(int argc, char** argv) {
     if (argc > 1 && !strcmp(argv[1], "--info")) {
-        return bench_info("c", cu_version(), "c");
+        return bench_info("c", cu_version(), "c", 1);
+    }
+    if (argc == 6 && !strcmp(argv[1], "--startup")) {
+        return cu_startup(argv[2], argv[3], argv[4], argv[5]);
     }
-    return bench_run("c", CODECS, N_CODECS);
+#ifdef BENCH_ALLOC_TRACKING
+    /* With CU_HUGE_PAGES on, cu_codec_alloc mmaps the large codec tables
+     * instead of calling malloc, so the heap counts would miss them. */
+    const char* hp = getenv("CU_HUGE_PAGES");
+    bench_heap_untracked = hp && strtoull(hp, NULL, 10) != 0;
+#endif
+    return bench_run("c", CODECS, N_CODECS, bench_threads(argc, argv));
 }
@@ -0,0 +1,206 @@
+/*
+ * bench_alloc.h — heap and copy accounting for the C benchmark drivers.
+ *
+ * The drivers interpose the allocator: this header defines malloc, free and
+ * friends in the driver binary, forwarding to glibc's __libc_* entry points
+ * and counting usable bytes. Allocations from the library, the statically
+ * linked codecs and libstdc++'s operator new all go through it. compress-utils
+ * routes codec contexts through cu_codec_alloc (src/alloc.c), which is plain
+ * malloc unless huge pages are on. Then blocks at or above the threshold are
+ * mmapped and never seen here, so bench.c drops the heap fields for those runs
+ * (bench_heap_untracked).
+ *
+ * Counting costs every allocation and copy a few atomics, so only the
+ * memory-pass builds (bench_mem, bench_baseline_mem) include it; the runner
+ * compiles the timing binaries with -DBENCH_NO_ALLOC_TRACKING. The harness
+ * brackets one untimed call with bench_alloc_begin / bench_alloc_end to get
+ * that call's peak heap, bytes allocated and allocation count.
+ *
+ * memcpy / memmove are interposed the same way, so the measured call also
+ * reports the bytes copied through them — the streaming backends' pending /
+ * stash copies among them. Copies the compiler inlines (small fixed sizes)
+ * aren't seen; only the measured call pays the counting.
+ *
+ * RSS high-water comes from /proc: clear_refs "5" resets VmHWM (Linux 4.0+),
+ * after malloc_trim has handed free heap pages back.
+ *
+ * glibc-only; elsewhere (or with -DBENCH_NO_ALLOC_TRACKING) the driver just
+ * omits the memory fields. Include from exactly one translation unit.
+ */
+
+#ifndef BENCH_ALLOC_H
+#define BENCH_ALLOC_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GLIBC__) && !defined(BENCH_NO_ALLOC_TRACKING)
+#define BENCH_ALLOC_TRACKING 1
+
+#include <errno.h>
+#include <malloc.h>
+
+extern void* __libc_malloc(size_t n);
+extern void* __libc_calloc(size_t n, size_t size);
+extern void* __libc_realloc(void* p, size_t n);
+extern void* __libc_memalign(size_t align, size_t n);
+extern void __libc_free(void* p);
+extern void* __memcpy_chk(void* dst, const void* src, size_t n, size_t dst_len);
+extern void* __memmove_chk(void* dst, const void* src, size_t n, size_t dst_len);
+
+static size_t bench_heap_live;   /* usable bytes currently allocated */
+static size_t bench_heap_peak;   /* high-water of bench_heap_live */
+static size_t bench_heap_bytes;  /* requested bytes since the last reset */
+static size_t bench_heap_count;  /* allocations since the last reset */
+static size_t bench_copy_bytes;  /* memcpy / memmove bytes while armed */
+static int bench_copy_armed;
+
+static void bench_heap_add(void* p, size_t requested) {
+    if (!p) return;
+    size_t live = __atomic_add_fetch(&bench_heap_live, malloc_usable_size(p), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bench_heap_bytes, requested, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bench_heap_count, 1, __ATOMIC_RELAXED);
+    size_t peak = __atomic_load_n(&bench_heap_peak, __ATOMIC_RELAXED);
+    while (live > peak && !__atomic_compare_exchange_n(&bench_heap_peak, &peak, live, 1,
+                                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static void bench_heap_sub(void* p) {
+    if (p) __atomic_sub_fetch(&bench_heap_live, malloc_usable_size(p), __ATOMIC_RELAXED);
+}
+
+void* malloc(size_t n) {
+    void* p = __libc_malloc(n);
+    bench_heap_add(p, n);
+    return p;
+}
+
+void* calloc(size_t n, size_t size) {
+    void* p = __libc_calloc(n, size);
+    bench_heap_add(p, n * size);  /* overflow returns NULL, so no count */
+    return p;
+}
+
+void* realloc(void* p, size_t n) {
+    size_t old = p ? malloc_usable_size(p) : 0;
+    void* q = __libc_realloc(p, n);
+    if (q || n == 0) {  /* realloc(p, 0) frees p */
+        if (p) __atomic_sub_fetch(&bench_heap_live, old, __ATOMIC_RELAXED);
+        bench_heap_add(q, n);
+    }
+    return q;
+}
+
+void* reallocarray(void* p, size_t n, size_t size) {
+    if (size && n > SIZE_MAX / size) { errno = ENOMEM; return NULL; }
+    return realloc(p, n * size);
+}
+
+void free(void* p) {
+    bench_heap_sub(p);
+    __libc_free(p);
+}
+
+void* memalign(size_t align, size_t n) {
+    void* p = __libc_memalign(align, n);
+    bench_heap_add(p, n);
+    return p;
+}
+
+void* aligned_alloc(size_t align, size_t n) { return memalign(align, n); }
+
+int posix_memalign(void** out, size_t align, size_t n) {
+    if (align < sizeof(void*) || (align & (align - 1))) return EINVAL;
+    void* p = memalign(align, n);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+void* valloc(size_t n) { return memalign(4096, n); }
+
+/* The _chk entry points forward to glibc's implementations; calling them
+ * through volatile pointers keeps the compiler from folding them back into
+ * memcpy / memmove (i.e. into these wrappers). */
+static void* (*volatile bench_real_memcpy)(void*, const void*, size_t, size_t) = __memcpy_chk;
+static void* (*volatile bench_real_memmove)(void*, const void*, size_t, size_t) = __memmove_chk;
+
+void* memcpy(void* dst, const void* src, size_t n) {
+    if (bench_copy_armed) __atomic_add_fetch(&bench_copy_bytes, n, __ATOMIC_RELAXED);
+    return bench_real_memcpy(dst, src, n, (size_t)-1);
+}
+
+void* memmove(void* dst, const void* src, size_t n) {
+    if (bench_copy_armed) __atomic_add_fetch(&bench_copy_bytes, n, __ATOMIC_RELAXED);
+    return bench_real_memmove(dst, src, n, (size_t)-1);
+}
+
+typedef struct {
+    size_t peak;        /* peak heap above the live bytes at bench_alloc_begin */
+    size_t bytes;       /* bytes requested */
+    size_t count;       /* allocation calls */
+    size_t copy_bytes;  /* bytes through memcpy / memmove */
+} bench_alloc_stats_t;
+
+static size_t bench_heap_base;
+
+static void bench_alloc_begin(void) {
+    bench_heap_base = __atomic_load_n(&bench_heap_live, __ATOMIC_RELAXED);
+    __atomic_store_n(&bench_heap_peak, bench_heap_base, __ATOMIC_RELAXED);
+    __atomic_store_n(&bench_heap_bytes, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&bench_heap_count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&bench_copy_bytes, 0, __ATOMIC_RELAXED);
+    bench_copy_armed = 1;
+}
+
+static void bench_alloc_end(bench_alloc_stats_t* st) {
+    bench_copy_armed = 0;
+    st->copy_bytes = __atomic_load_n(&bench_copy_bytes, __ATOMIC_RELAXED);
+    size_t peak = __atomic_load_n(&bench_heap_peak, __ATOMIC_RELAXED);
+    st->peak = peak > bench_heap_base ? peak - bench_heap_base : 0;
+    st->bytes = __atomic_load_n(&bench_heap_bytes, __ATOMIC_RELAXED);
+    st->count = __atomic_load_n(&bench_heap_count, __ATOMIC_RELAXED);
+}
+
+/* VmHWM / VmRSS from /proc/self/status in bytes, 0 if unavailable. */
+static size_t bench_proc_status_bytes(const char* key) {
+    FILE* f = fopen("/proc/self/status", "r");
+    if (!f) return 0;
+    char line[256];
+    size_t kb = 0, klen = strlen(key);
+    while (fgets(line, sizeof(line), f)) {
+        if (!strncmp(line, key, klen) && line[klen] == ':') {
+            kb = (size_t)strtoull(line + klen + 1, NULL, 10);
+            break;
+        }
+    }
+    fclose(f);
+    return kb * 1024;
+}
+
+/* Reset the RSS high-water mark; returns the current RSS, or 0 if the kernel
+ * can't reset it (the caller then reports nothing). Free heap pages go back to
+ * the kernel first, so memory left over from earlier calls doesn't hide the
+ * next call's working set. */
+static size_t bench_rss_begin(void) {
+    malloc_trim(0);
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (!f) return 0;
+    int ok = fputs("5", f) >= 0;
+    ok = fclose(f) == 0 && ok;
+    return ok ? bench_proc_status_bytes("VmRSS") : 0;
+}
+
+/* RSS growth since bench_rss_begin at its high-water mark. */
+static size_t bench_rss_end(size_t base) {
+    if (!base) return 0;
+    size_t hwm = bench_proc_status_bytes("VmHWM");
+    return hwm > base ? hwm - base : 0;
+}
+
+#endif /* __GLIBC__ && !BENCH_NO_ALLOC_TRACKING */
+
+#endif /* BENCH_ALLOC_H */
@@ -17,6 +17,9 @@
  *   bz2    clamp 1..9             BZ2_bzBuffToBuff{Compress,Decompress}, wf=0
  *   lz4    fast/HC split          LZ4F frame, contentSize + checksum + linked
  *   xz     clamp(user-1,0..9)     lzma_easy_buffer_encode, CRC64
+ *
+ * zstd, zlib and lz4 also implement message sessions (reusable contexts and
+ * raw-content dictionaries) for the "msg:reuse" / "msg:dict" jobs.
  */
 
 #include <stdint.h>
@@ -242,17 +245,19 @@ static int xz_decompress(const bench_codec_t* c, const uint8_t* in, size_t in_le
 }
 
 /* ---- streaming --------------------------------------------------------------
- * Feed input in `chunk`-sized pieces through each library's native streaming
- * API, writing all output into the (bound-sized) `out` buffer. Mirrors the
- * cu_*_stream_* paths so a cu-vs-native stream comparison is apples-to-apples.
- * Streaming doesn't know the total size up front, so frames omit content size
- * (which can make the stream ratio differ slightly from one-shot — expected).
+ * Feed input in `io->chunk`-sized pieces through each library's native
+ * streaming API, writing all output into the (bound-sized) `out` buffer.
+ * Mirrors the cu_*_stream_* paths so a cu-vs-native stream comparison is
+ * apples-to-apples. Streaming doesn't know the total size up front, so frames
+ * omit content size (which can make the stream ratio differ slightly from
+ * one-shot — expected). The output window isn't honored here (the codecs leave
+ * stream_out_window 0), so sweeps with one skip these drivers' rows.
  */
 
 /* zstd */
 static int z_cstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                     uint8_t* out, size_t* out_len, int level, size_t chunk, const char** err) {
-    (void)c; if (chunk == 0) chunk = 64 * 1024;
+                     uint8_t* out, size_t* out_len, int level, bench_stream_t* io, const char** err) {
+    (void)c; size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     ZSTD_CCtx* z = ZSTD_createCCtx();
     if (!z) { *err = "ZSTD_createCCtx"; return 1; }
     ZSTD_CCtx_setParameter(z, ZSTD_c_compressionLevel, zstd_level(level));
@@ -280,8 +285,8 @@ static int z_cstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
 }
 
 static int z_dstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                     uint8_t* out, size_t* out_len, size_t chunk, const char** err) {
-    (void)c; if (chunk == 0) chunk = 64 * 1024;
+                     uint8_t* out, size_t* out_len, bench_stream_t* io, const char** err) {
+    (void)c; size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     ZSTD_DCtx* z = ZSTD_createDCtx();
     if (!z) { *err = "ZSTD_createDCtx"; return 1; }
     ZSTD_outBuffer ob = {out, *out_len, 0};
@@ -301,8 +306,8 @@ static int z_dstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
 
 /* brotli */
 static int br_cstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                      uint8_t* out, size_t* out_len, int level, size_t chunk, const char** err) {
-    (void)c; if (chunk == 0) chunk = 64 * 1024;
+                      uint8_t* out, size_t* out_len, int level, bench_stream_t* io, const char** err) {
+    (void)c; size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     BrotliEncoderState* e = BrotliEncoderCreateInstance(NULL, NULL, NULL);
     if (!e) { *err = "BrotliEncoderCreateInstance"; return 1; }
     BrotliEncoderSetParameter(e, BROTLI_PARAM_QUALITY, brotli_level(level));
@@ -336,8 +341,8 @@ static int br_cstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
 }
 
 static int br_dstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                      uint8_t* out, size_t* out_len, size_t chunk, const char** err) {
-    (void)c; if (chunk == 0) chunk = 64 * 1024;
+                      uint8_t* out, size_t* out_len, bench_stream_t* io, const char** err) {
+    (void)c; size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     BrotliDecoderState* dec = BrotliDecoderCreateInstance(NULL, NULL, NULL);
     if (!dec) { *err = "BrotliDecoderCreateInstance"; return 1; }
     size_t cap = *out_len, avail_out = cap;
@@ -361,8 +366,8 @@ static int br_dstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
 
 /* zlib */
 static int zl_cstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                      uint8_t* out, size_t* out_len, int level, size_t chunk, const char** err) {
-    (void)c; if (chunk == 0) chunk = 64 * 1024;
+                      uint8_t* out, size_t* out_len, int level, bench_stream_t* io, const char** err) {
+    (void)c; size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     z_stream s; memset(&s, 0, sizeof(s));
     if (deflateInit(&s, clamp_level(level, 1, 9)) != Z_OK) { *err = "deflateInit"; return 1; }
     size_t cap = *out_len;
@@ -386,8 +391,8 @@ static int zl_cstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
 }
 
 static int zl_dstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                      uint8_t* out, size_t* out_len, size_t chunk, const char** err) {
-    (void)c; if (chunk == 0) chunk = 64 * 1024;
+                      uint8_t* out, size_t* out_len, bench_stream_t* io, const char** err) {
+    (void)c; size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     z_stream s; memset(&s, 0, sizeof(s));
     if (inflateInit(&s) != Z_OK) { *err = "inflateInit"; return 1; }
     size_t cap = *out_len;
@@ -409,8 +414,8 @@ static int zl_dstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
 
 /* bz2 */
 static int bz_cstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                      uint8_t* out, size_t* out_len, int level, size_t chunk, const char** err) {
-    (void)c; if (chunk == 0) chunk = 64 * 1024;
+                      uint8_t* out, size_t* out_len, int level, bench_stream_t* io, const char** err) {
+    (void)c; size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     bz_stream s; memset(&s, 0, sizeof(s));
     if (BZ2_bzCompressInit(&s, clamp_level(level, 1, 9), 0, 0) != BZ_OK) {
         *err = "bzCompressInit"; return 1;
@@ -436,8 +441,8 @@ static int bz_cstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
 }
 
 static int bz_dstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                      uint8_t* out, size_t* out_len, size_t chunk, const char** err) {
-    (void)c; if (chunk == 0) chunk = 64 * 1024;
+                      uint8_t* out, size_t* out_len, bench_stream_t* io, const char** err) {
+    (void)c; size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     bz_stream s; memset(&s, 0, sizeof(s));
     if (BZ2_bzDecompressInit(&s, 0, 0) != BZ_OK) { *err = "bzDecompressInit"; return 1; }
     size_t cap = *out_len;
@@ -459,8 +464,8 @@ static int bz_dstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
 
 /* lz4 (frame) */
 static int l4_cstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                      uint8_t* out, size_t* out_len, int level, size_t chunk, const char** err) {
-    (void)c; if (chunk == 0) chunk = 64 * 1024;
+                      uint8_t* out, size_t* out_len, int level, bench_stream_t* io, const char** err) {
+    (void)c; size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     LZ4F_cctx* cc = NULL;
     if (LZ4F_isError(LZ4F_createCompressionContext(&cc, LZ4F_VERSION))) {
         *err = "lz4 cctx"; return 1;
@@ -487,8 +492,8 @@ static int l4_cstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
 }
 
 static int l4_dstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                      uint8_t* out, size_t* out_len, size_t chunk, const char** err) {
-    (void)c; if (chunk == 0) chunk = 64 * 1024;
+                      uint8_t* out, size_t* out_len, bench_stream_t* io, const char** err) {
+    (void)c; size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     LZ4F_dctx* d = NULL;
     if (LZ4F_isError(LZ4F_createDecompressionContext(&d, LZ4F_VERSION))) {
         *err = "lz4 dctx"; return 1;
@@ -511,8 +516,8 @@ static int l4_dstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
 
 /* xz */
 static int xz_cstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                      uint8_t* out, size_t* out_len, int level, size_t chunk, const char** err) {
-    (void)c; if (chunk == 0) chunk = 64 * 1024;
+                      uint8_t* out, size_t* out_len, int level, bench_stream_t* io, const char** err) {
+    (void)c; size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     lzma_stream s = LZMA_STREAM_INIT;
     if (lzma_easy_encoder(&s, (uint32_t)clamp_level(level - 1, 0, 9), LZMA_CHECK_CRC64) != LZMA_OK) {
         *err = "lzma encoder"; return 1;
@@ -538,8 +543,8 @@ static int xz_cstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
 }
 
 static int xz_dstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
-                      uint8_t* out, size_t* out_len, size_t chunk, const char** err) {
-    (void)c; if (chunk == 0) chunk = 64 * 1024;
+                      uint8_t* out, size_t* out_len, bench_stream_t* io, const char** err) {
+    (void)c; size_t chunk = io->chunk ? io->chunk : 64 * 1024;
     lzma_stream s = LZMA_STREAM_INIT;
     if (lzma_stream_decoder(&s, UINT64_MAX, 0) != LZMA_OK) { *err = "lzma decoder"; return 1; }
     size_t cap = *out_len;
@@ -559,21 +564,230 @@ static int xz_dstream(const bench_codec_t* c, const uint8_t* in, size_t in_len,
     return rc;
 }
 
+/* ---- message sessions (reuse / dict) ------------------------------------- */
+/* Contexts live for a whole msg job; each message is still its own frame with
+ * the same settings as the one-shot path. Dictionaries are raw content (no
+ * trained dictionary format); the harness keeps `dict` alive until
+ * session_close. */
+
+typedef struct {
+    ZSTD_CCtx* cctx;
+    ZSTD_DCtx* dctx;
+    ZSTD_DDict* ddict;
+} z_session_t;
+
+static void z_session_close(void* p) {
+    z_session_t* s = (z_session_t*)p;
+    ZSTD_freeCCtx(s->cctx);
+    ZSTD_freeDCtx(s->dctx);
+    ZSTD_freeDDict(s->ddict);
+    free(s);
+}
+
+static void* z_session_open(const bench_codec_t* c, int variant, int level,
+                            const uint8_t* dict, size_t dict_len, const char** err) {
+    (void)c;
+    z_session_t* s = (z_session_t*)calloc(1, sizeof(*s));
+    if (!s) { *err = "out of memory"; return NULL; }
+    s->cctx = ZSTD_createCCtx();
+    s->dctx = ZSTD_createDCtx();
+    if (!s->cctx || !s->dctx) { z_session_close(s); *err = "ZSTD_createCCtx failed"; return NULL; }
+    ZSTD_CCtx_setParameter(s->cctx, ZSTD_c_compressionLevel, zstd_level(level));
+    if (variant == BENCH_MSG_DICT) {
+        /* Sticky on the CCtx (digested once, reused by every frame), and a
+         * DDict for the decoder. */
+        size_t r = ZSTD_CCtx_loadDictionary(s->cctx, dict, dict_len);
+        s->ddict = ZSTD_createDDict(dict, dict_len);
+        if (ZSTD_isError(r) || !s->ddict) {
+            z_session_close(s);
+            *err = "zstd dictionary load failed";
+            return NULL;
+        }
+    }
+    return s;
+}
+
+static int z_session_compress(void* p, const uint8_t* in, size_t in_len, uint8_t* out,
+                              size_t* out_len, const char** err) {
+    z_session_t* s = (z_session_t*)p;
+    ZSTD_CCtx_setPledgedSrcSize(s->cctx, in_len);
+    size_t r = ZSTD_compress2(s->cctx, out, *out_len, in, in_len);
+    if (ZSTD_isError(r)) { *err = ZSTD_getErrorName(r); return 1; }
+    *out_len = r;
+    return 0;
+}
+
+static int z_session_decompress(void* p, const uint8_t* in, size_t in_len, uint8_t* out,
+                                size_t* out_len, const char** err) {
+    z_session_t* s = (z_session_t*)p;
+    size_t r = s->ddict ? ZSTD_decompress_usingDDict(s->dctx, out, *out_len, in, in_len, s->ddict)
+                        : ZSTD_decompressDCtx(s->dctx, out, *out_len, in, in_len);
+    if (ZSTD_isError(r)) { *err = ZSTD_getErrorName(r); return 1; }
+    *out_len = r;
+    return 0;
+}
+
+typedef struct {
+    z_stream c;
+    z_stream d;
+    int c_init, d_init;
+    const uint8_t* dict;
+    size_t dict_len;
+} zl_session_t;
+
+static void zl_session_close(void* p) {
+    zl_session_t* s = (zl_session_t*)p;
+    if (s->c_init) deflateEnd(&s->c);
+    if (s->d_init) inflateEnd(&s->d);
+    free(s);
+}
+
+static void* zl_session_open(const bench_codec_t* c, int variant, int level,
+                             const uint8_t* dict, size_t dict_len, const char** err) {
+    (void)c;
+    zl_session_t* s = (zl_session_t*)calloc(1, sizeof(*s));
+    if (!s) { *err = "out of memory"; return NULL; }
+    s->c_init = deflateInit(&s->c, clamp_level(level, 1, 9)) == Z_OK;
+    s->d_init = inflateInit(&s->d) == Z_OK;
+    if (!s->c_init || !s->d_init) { zl_session_close(s); *err = "zlib init failed"; return NULL; }
+    if (variant == BENCH_MSG_DICT) {
+        s->dict = dict;
+        s->dict_len = dict_len;
+    }
+    return s;
+}
+
+/* deflateReset drops the dictionary, so it's set again per message (zlib
+ * hashes it into the window each time; there's no pre-digested form). */
+static int zl_session_compress(void* p, const uint8_t* in, size_t in_len, uint8_t* out,
+                               size_t* out_len, const char** err) {
+    zl_session_t* s = (zl_session_t*)p;
+    deflateReset(&s->c);
+    if (s->dict && deflateSetDictionary(&s->c, s->dict, (uInt)s->dict_len) != Z_OK) {
+        *err = "deflateSetDictionary failed";
+        return 1;
+    }
+    s->c.next_in = (Bytef*)in;
+    s->c.avail_in = (uInt)in_len;
+    s->c.next_out = out;
+    s->c.avail_out = (uInt)*out_len;
+    if (deflate(&s->c, Z_FINISH) != Z_STREAM_END) { *err = "deflate failed"; return 1; }
+    *out_len = (size_t)(s->c.next_out - out);
+    return 0;
+}
+
+static int zl_session_decompress(void* p, const uint8_t* in, size_t in_len, uint8_t* out,
+                                 size_t* out_len, const char** err) {
+    zl_session_t* s = (zl_session_t*)p;
+    inflateReset(&s->d);
+    s->d.next_in = (Bytef*)in;
+    s->d.avail_in = (uInt)in_len;
+    s->d.next_out = out;
+    s->d.avail_out = (uInt)*out_len;
+    int r = inflate(&s->d, Z_FINISH);
+    if (r == Z_NEED_DICT && s->dict) {
+        if (inflateSetDictionary(&s->d, s->dict, (uInt)s->dict_len) != Z_OK) {
+            *err = "inflateSetDictionary failed";
+            return 1;
+        }
+        r = inflate(&s->d, Z_FINISH);
+    }
+    if (r != Z_STREAM_END) { *err = "inflate failed"; return 1; }
+    *out_len = (size_t)(s->d.next_out - out);
+    return 0;
+}
+
+typedef struct {
+    LZ4F_cctx* cctx;
+    LZ4F_dctx* dctx;
+    LZ4F_CDict* cdict;
+    const uint8_t* dict;
+    size_t dict_len;
+    int level;
+} l4_session_t;
+
+static void l4_session_close(void* p) {
+    l4_session_t* s = (l4_session_t*)p;
+    LZ4F_freeCompressionContext(s->cctx);
+    LZ4F_freeDecompressionContext(s->dctx);
+    LZ4F_freeCDict(s->cdict);
+    free(s);
+}
+
+static void* l4_session_open(const bench_codec_t* c, int variant, int level,
+                             const uint8_t* dict, size_t dict_len, const char** err) {
+    (void)c;
+    l4_session_t* s = (l4_session_t*)calloc(1, sizeof(*s));
+    if (!s) { *err = "out of memory"; return NULL; }
+    s->level = level;
+    if (LZ4F_isError(LZ4F_createCompressionContext(&s->cctx, LZ4F_VERSION)) ||
+        LZ4F_isError(LZ4F_createDecompressionContext(&s->dctx, LZ4F_VERSION))) {
+        l4_session_close(s);
+        *err = "LZ4F context creation failed";
+        return NULL;
+    }
+    if (variant == BENCH_MSG_DICT) {
+        s->cdict = LZ4F_createCDict(dict, dict_len);
+        if (!s->cdict) { l4_session_close(s); *err = "LZ4F_createCDict failed"; return NULL; }
+        s->dict = dict;
+        s->dict_len = dict_len;
+    }
+    return s;
+}
+
+static int l4_session_compress(void* p, const uint8_t* in, size_t in_len, uint8_t* out,
+                               size_t* out_len, const char** err) {
+    l4_session_t* s = (l4_session_t*)p;
+    LZ4F_preferences_t prefs;
+    lz4_prefs(&prefs, s->level, in_len);
+    size_t r = LZ4F_compressFrame_usingCDict(s->cctx, out, *out_len, in, in_len, s->cdict,
+                                             &prefs);
+    if (LZ4F_isError(r)) { *err = LZ4F_getErrorName(r); return 1; }
+    *out_len = r;
+    return 0;
+}
+
+static int l4_session_decompress(void* p, const uint8_t* in, size_t in_len, uint8_t* out,
+                                 size_t* out_len, const char** err) {
+    l4_session_t* s = (l4_session_t*)p;
+    size_t out_cap = *out_len, out_pos = 0, in_pos = 0;
+    while (in_pos < in_len) {
+        size_t dst = out_cap - out_pos;
+        size_t src = in_len - in_pos;
+        size_t hint = LZ4F_decompress_usingDict(s->dctx, out + out_pos, &dst, in + in_pos, &src,
+                                                s->dict, s->dict_len, NULL);
+        if (LZ4F_isError(hint)) {
+            LZ4F_resetDecompressionContext(s->dctx);
+            *err = LZ4F_getErrorName(hint);
+            return 1;
+        }
+        out_pos += dst;
+        in_pos += src;
+        if (hint == 0) break;  /* frame complete; dctx is ready for the next */
+        if (dst == 0 && src == 0) { *err = "LZ4F stalled"; return 1; }
+    }
+    *out_len = out_pos;
+    return 0;
+}
+
 /* ---- registry ------------------------------------------------------------ */
 
 static const bench_codec_t CODECS[] = {
-    {"zstd", "libzstd", 0, z_bound, z_compress, z_decompress, z_cstream, z_dstream},
+    {"zstd", "libzstd", 0, z_bound, z_compress, z_decompress, z_cstream, z_dstream, NULL, NULL,
+     z_session_open, z_session_compress, z_session_decompress, z_session_close},
     {"brotli", "libbrotli", 0, br_bound, br_compress, br_decompress, br_cstream, br_dstream},
-    {"zlib", "zlib", 0, zl_bound, zl_compress, zl_decompress, zl_cstream, zl_dstream},
+    {"zlib", "zlib", 0, zl_bound, zl_compress, zl_decompress, zl_cstream, zl_dstream, NULL, NULL,
+     zl_session_open, zl_session_compress, zl_session_decompress, zl_session_close},
     {"bz2", "libbz2", 0, bz_bound, bz_compress, bz_decompress, bz_cstream, bz_dstream},
-    {"lz4", "liblz4", 0, l4_bound, l4_compress, l4_decompress, l4_cstream, l4_dstream},
+    {"lz4", "liblz4", 0, l4_bound, l4_compress, l4_decompress, l4_cstream, l4_dstream, NULL, NULL,
+     l4_session_open, l4_session_compress, l4_session_decompress, l4_session_close},
     {"xz", "liblzma", 0, xz_bound, xz_compress, xz_decompress, xz_cstream, xz_dstream},
 };
 static const size_t N_CODECS = sizeof(CODECS) / sizeof(CODECS[0]);
 
 int main(int argc, char** argv) {
     if (argc > 1 && !strcmp(argv[1], "--info")) {
-        return bench_info("c", "baseline", "c-baseline");
+        return bench_info("c", "baseline", "c-baseline", 0);
     }
-    return bench_run("c", CODECS, N_CODECS);
+    return bench_run("c", CODECS, N_CODECS, bench_threads(argc, argv));
 }
@@ -12,9 +12,36 @@
  * every result record, so the report tooling can overlay our binding against
  * the native baseline for the same (lang, algo).
  *
- * Modes: each job runs in one-shot or streaming mode. A codec may leave its
- * *_stream pointers NULL; stream-mode jobs for such codecs are skipped (a skip
- * marker keeps the runner's line-synchronous protocol in step), not failed.
+ * Modes: each job runs in one-shot, streaming or parallel mode. A codec may
+ * leave its *_stream or *_parallel pointers NULL; jobs in those modes are then
+ * skipped (a skip marker keeps the runner's line-synchronous protocol in step),
+ * not failed. Streaming jobs may also cap the output space offered per call
+ * (the scratch buffer a binding drains into) and then count drain calls.
+ *
+ * Threads (--threads N or BENCH_THREADS): one-shot and streaming jobs run on N
+ * caller threads at once, each with its own buffers, and every sample starts
+ * from a barrier so the calls really overlap. Per-call times then measure
+ * latency under contention; the wall time of each sample (first start to last
+ * finish) gives aggregate throughput. Parallel-mode jobs instead make one call
+ * that uses N of the library's own workers.
+ *
+ * Messages: "msg" jobs slice the input into many small messages and time every
+ * call on its own, reporting tail percentiles from an HDR-style histogram. See
+ * bench_run_msg_job.
+ *
+ * Call overhead: "ffi:<bytes>" jobs time a tight loop of one-shot calls on a
+ * tiny payload (0 B, 64 B, 1 KB, …) and report ns per call. This driver is the
+ * raw C call; the other languages' drivers run the same job through their
+ * binding, so the difference is the wrapper's own cost. See bench_run_ffi_job.
+ *
+ * Counters: where bench_perf.h can open perf events (Linux with a PMU), every
+ * timed one-shot / streaming call is also bracketed by cycle, instruction,
+ * cache-miss and branch-miss counters, reported as per-call medians with
+ * cycles/byte and IPC.
+ *
+ * Memory: where bench_alloc.h can interpose the allocator (glibc), each job
+ * makes one extra untimed round trip to record per-call peak heap, bytes
+ * allocated and allocation count, plus RSS high-water for streaming jobs.
  *
  * Header-only: each driver is a single translation unit that includes this and
  * provides main(). Timing wraps only the compress / decompress calls.
@@ -23,21 +50,34 @@
 #ifndef BENCH_HARNESS_H
 #define BENCH_HARNESS_H
 
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
+#include "bench_alloc.h"
+#include "bench_perf.h"
+
 /* ---- codec interface ----------------------------------------------------- */
 
 struct bench_codec;
 
+/* Streaming knobs for one call, plus what the call observed. */
+typedef struct {
+    size_t chunk;      /* input bytes per write call */
+    size_t out_chunk;  /* output space offered per call; 0 = everything left */
+    size_t drains;     /* out: calls that came back "output full, call again" */
+} bench_stream_t;
+
 /* compress/decompress return 0 on success (with *out_len set to bytes
  * written) and non-zero on failure, optionally setting *err to a static
- * message. The *_stream variants take a chunk size (the input is fed in
- * chunk-sized pieces, exercising the streaming drain protocol) and may be
- * NULL if the driver doesn't implement streaming for that codec yet.
+ * message. The *_stream variants feed the input in io->chunk pieces,
+ * exercising the streaming drain protocol, and may be NULL if the driver
+ * doesn't implement streaming for that codec yet. A codec that sets
+ * stream_out_window also honors io->out_chunk and counts io->drains; others
+ * only run stream jobs with an unbounded output window.
  * native_id is impl-private scratch (the compress-utils driver stashes its
  * algorithm enum there; the native driver ignores it). */
 typedef struct bench_codec {
@@ -50,10 +90,32 @@ typedef struct bench_codec {
     int (*decompress)(const struct bench_codec*, const uint8_t* in, size_t in_len,
                       uint8_t* out, size_t* out_len, const char** err);
     int (*compress_stream)(const struct bench_codec*, const uint8_t* in, size_t in_len,
-                           uint8_t* out, size_t* out_len, int level, size_t chunk,
+                           uint8_t* out, size_t* out_len, int level, bench_stream_t* io,
                            const char** err);
     int (*decompress_stream)(const struct bench_codec*, const uint8_t* in, size_t in_len,
-                             uint8_t* out, size_t* out_len, size_t chunk, const char** err);
+                             uint8_t* out, size_t* out_len, bench_stream_t* io,
+                             const char** err);
+    /* Optional: the library's own multi-threaded compressor on `threads`
+     * workers. parallel_bound returns 0 when the codec has no parallel mode.
+     * The output must decode with `decompress`. */
+    size_t (*parallel_bound)(const struct bench_codec*, size_t in_len, unsigned threads);
+    int (*compress_parallel)(const struct bench_codec*, const uint8_t* in, size_t in_len,
+                             uint8_t* out, size_t* out_len, int level, unsigned threads,
+                             const char** err);
+    /* Optional small-message sessions (see "msg" jobs below). session_open
+     * returns state reused by every call of a job: variant BENCH_MSG_REUSE
+     * keeps codec contexts alive across messages, BENCH_MSG_DICT also primes
+     * them with `dict`. It returns NULL with *err unset when the codec can't
+     * do that variant (the job is skipped). The "fresh" variant needs none of
+     * these; it calls compress/decompress per message. */
+    void* (*session_open)(const struct bench_codec*, int variant, int level,
+                          const uint8_t* dict, size_t dict_len, const char** err);
+    int (*session_compress)(void* s, const uint8_t* in, size_t in_len, uint8_t* out,
+                            size_t* out_len, const char** err);
+    int (*session_decompress)(void* s, const uint8_t* in, size_t in_len, uint8_t* out,
+                              size_t* out_len, const char** err);
+    void (*session_close)(void* s);
+    int stream_out_window;  /* *_stream honor bench_stream_t.out_chunk */
 } bench_codec_t;
 
 /* ---- timing -------------------------------------------------------------- */
@@ -130,14 +192,310 @@ static const bench_codec_t* bench_find(const bench_codec_t* codecs, size_t n,
     return NULL;
 }
 
+/* ---- barrier ----------------------------------------------------------- */
+
+/* pthread_barrier_t is optional in POSIX (macOS lacks it). */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    size_t n;
+    size_t waiting;
+    unsigned long gen;
+} bench_barrier_t;
+
+static void bench_barrier_init(bench_barrier_t* b, size_t n) {
+    pthread_mutex_init(&b->lock, NULL);
+    pthread_cond_init(&b->cond, NULL);
+    b->n = n;
+    b->waiting = 0;
+    b->gen = 0;
+}
+
+static void bench_barrier_destroy(bench_barrier_t* b) {
+    pthread_mutex_destroy(&b->lock);
+    pthread_cond_destroy(&b->cond);
+}
+
+static void bench_barrier_wait(bench_barrier_t* b) {
+    pthread_mutex_lock(&b->lock);
+    unsigned long gen = b->gen;
+    if (++b->waiting == b->n) {
+        b->waiting = 0;
+        b->gen++;
+        pthread_cond_broadcast(&b->cond);
+    } else {
+        while (gen == b->gen) pthread_cond_wait(&b->cond, &b->lock);
+    }
+    pthread_mutex_unlock(&b->lock);
+}
+
 /* ---- one job ------------------------------------------------------------- */
 
-/* Returns 1 = result emitted, 0 = failure, -1 = skipped (stream mode requested
- * but this codec has no streaming functions). */
+typedef enum { BENCH_ONESHOT, BENCH_STREAM, BENCH_PARALLEL } bench_mode_t;
+
+static const char* const BENCH_MODE_NAMES[] = { "oneshot", "stream", "parallel" };
+
+/* What every caller thread of a job shares (read-only). */
+typedef struct {
+    const bench_codec_t* codec;
+    int level;
+    bench_mode_t mode;
+    size_t chunk;
+    size_t out_chunk;  /* stream mode: output window per call, 0 = unbounded */
+    unsigned workers;  /* parallel mode: the library's worker threads */
+    int perf;          /* count perf events around each call */
+    const uint8_t* in;
+    size_t in_len;
+    size_t bound;
+} bench_job_t;
+
+/* `drains` receives the stream drain count (0 outside stream mode). */
+static int bench_compress_once(const bench_job_t* j, uint8_t* out, size_t* out_len,
+                               size_t* drains, const char** err) {
+    const bench_codec_t* c = j->codec;
+    bench_stream_t io = { j->chunk, j->out_chunk, 0 };
+    int r;
+    *out_len = j->bound;
+    *drains = 0;
+    switch (j->mode) {
+    case BENCH_STREAM:
+        r = c->compress_stream(c, j->in, j->in_len, out, out_len, j->level, &io, err);
+        *drains = io.drains;
+        return r;
+    case BENCH_PARALLEL:
+        return c->compress_parallel(c, j->in, j->in_len, out, out_len, j->level, j->workers,
+                                    err);
+    default:
+        return c->compress(c, j->in, j->in_len, out, out_len, j->level, err);
+    }
+}
+
+static int bench_decompress_once(const bench_job_t* j, const uint8_t* in, size_t in_len,
+                                 uint8_t* out, size_t* out_len, size_t* drains,
+                                 const char** err) {
+    const bench_codec_t* c = j->codec;
+    bench_stream_t io = { j->chunk, j->out_chunk, 0 };
+    *out_len = j->in_len;
+    *drains = 0;
+    if (j->mode != BENCH_STREAM) return c->decompress(c, in, in_len, out, out_len, err);
+    int r = c->decompress_stream(c, in, in_len, out, out_len, &io, err);
+    *drains = io.drains;
+    return r;
+}
+
+/* One caller thread: its own output buffers and per-sample start/end stamps. */
+typedef struct {
+    const bench_job_t* job;
+    bench_barrier_t* barrier;  /* NULL with a single caller */
+    size_t samples;
+    size_t warmup;
+    uint8_t* comp;
+    size_t comp_len;
+    uint8_t* dec;
+    size_t dec_len;
+    uint64_t* c_t0;
+    uint64_t* c_t1;
+    uint64_t* d_t0;
+    uint64_t* d_t1;
+    bench_perf_sample_t* c_perf;
+    bench_perf_sample_t* d_perf;
+    size_t c_drains;  /* drain calls of the last compress / decompress */
+    size_t d_drains;
+    const char* err;
+    int failed;  /* 1 = compress failed, 2 = decompress failed */
+    pthread_t tid;
+} bench_caller_t;
+
+static void* bench_caller_main(void* arg) {
+    bench_caller_t* c = (bench_caller_t*)arg;
+    const bench_job_t* j = c->job;
+    /* Counters are per thread, so each caller opens its own group. */
+    bench_perf_t perf;
+    bench_perf_sample_t scratch;
+    if (j->perf) bench_perf_open(&perf); else perf.leader = -1;
+    /* A failed caller keeps meeting the barrier so its peers don't hang. */
+    for (size_t i = 0; i < c->warmup + c->samples; i++) {
+        if (c->barrier) bench_barrier_wait(c->barrier);
+        if (c->failed) continue;
+        bench_perf_start(&perf);
+        uint64_t t0 = bench_now_ns();
+        if (bench_compress_once(j, c->comp, &c->comp_len, &c->c_drains, &c->err)) {
+            c->failed = 1;
+        }
+        uint64_t t1 = bench_now_ns();
+        bench_perf_stop(&perf, i >= c->warmup ? &c->c_perf[i - c->warmup] : &scratch);
+        if (i >= c->warmup) {
+            c->c_t0[i - c->warmup] = t0;
+            c->c_t1[i - c->warmup] = t1;
+        }
+    }
+    for (size_t i = 0; i < c->warmup + c->samples; i++) {
+        if (c->barrier) bench_barrier_wait(c->barrier);
+        if (c->failed) continue;
+        bench_perf_start(&perf);
+        uint64_t t0 = bench_now_ns();
+        if (bench_decompress_once(j, c->comp, c->comp_len, c->dec, &c->dec_len, &c->d_drains,
+                                  &c->err)) {
+            c->failed = 2;
+        }
+        uint64_t t1 = bench_now_ns();
+        bench_perf_stop(&perf, i >= c->warmup ? &c->d_perf[i - c->warmup] : &scratch);
+        if (i >= c->warmup) {
+            c->d_t0[i - c->warmup] = t0;
+            c->d_t1[i - c->warmup] = t1;
+        }
+    }
+    bench_perf_close(&perf);
+    return NULL;
+}
+
+typedef struct {
+    uint64_t median, mad, min, wall_median;
+} bench_stats_t;
+
+/* Per-call latency over every caller's samples, plus the median wall time of
+ * a sample (earliest start to latest finish across callers). */
+static int bench_stats(const bench_caller_t* callers, size_t n, size_t samples, int decomp,
+                       bench_stats_t* st) {
+    size_t total = n * samples;
+    uint64_t* lat = (uint64_t*)malloc((total ? total : 1) * sizeof(uint64_t));
+    uint64_t* wall = (uint64_t*)malloc((samples ? samples : 1) * sizeof(uint64_t));
+    if (!lat || !wall) { free(lat); free(wall); return 0; }
+    for (size_t s = 0; s < samples; s++) {
+        uint64_t first = UINT64_MAX, last = 0;
+        for (size_t k = 0; k < n; k++) {
+            uint64_t t0 = decomp ? callers[k].d_t0[s] : callers[k].c_t0[s];
+            uint64_t t1 = decomp ? callers[k].d_t1[s] : callers[k].c_t1[s];
+            lat[k * samples + s] = t1 - t0;
+            if (t0 < first) first = t0;
+            if (t1 > last) last = t1;
+        }
+        wall[s] = last - first;
+    }
+    qsort(lat, total, sizeof(uint64_t), bench_cmp_u64);
+    qsort(wall, samples, sizeof(uint64_t), bench_cmp_u64);
+    st->median = bench_median_sorted(lat, total);
+    st->mad = bench_mad(lat, total, st->median);
+    st->min = total ? lat[0] : 0;
+    st->wall_median = bench_median_sorted(wall, samples);
+    free(lat);
+    free(wall);
+    return 1;
+}
+
+/* Per-call median of each perf event over every caller's samples; returns the
+ * mask of events with at least one valid sample. */
+static unsigned bench_perf_stats(const bench_caller_t* callers, size_t n, size_t samples,
+                                 int decomp, uint64_t med[BENCH_PERF_N]) {
+    size_t total = n * samples;
+    uint64_t* v = (uint64_t*)malloc((total ? total : 1) * sizeof(uint64_t));
+    if (!v) return 0;
+    unsigned mask = 0;
+    for (int e = 0; e < BENCH_PERF_N; e++) {
+        size_t got = 0;
+        for (size_t k = 0; k < n; k++) {
+            const bench_perf_sample_t* ps = decomp ? callers[k].d_perf : callers[k].c_perf;
+            for (size_t s = 0; s < samples; s++) {
+                if (ps[s].mask & (1u << e)) v[got++] = ps[s].v[e];
+            }
+        }
+        if (!got) continue;
+        qsort(v, got, sizeof(uint64_t), bench_cmp_u64);
+        med[e] = bench_median_sorted(v, got);
+        mask |= 1u << e;
+    }
+    free(v);
+    return mask;
+}
+
+/* "<dir>_<event>" medians, plus cycles/byte (of input) and IPC. */
+static void bench_emit_perf(FILE* o, const char* dir, const uint64_t med[BENCH_PERF_N],
+                            unsigned mask, size_t in_len) {
+    for (int e = 0; e < BENCH_PERF_N; e++) {
+        if (mask & (1u << e)) {
+            fprintf(o, "\"%s_%s\":%llu,", dir, BENCH_PERF_NAMES[e],
+                    (unsigned long long)med[e]);
+        }
+    }
+    if ((mask & (1u << BENCH_PERF_CYCLES)) && in_len) {
+        fprintf(o, "\"%s_cycles_per_byte\":%.4f,", dir,
+                (double)med[BENCH_PERF_CYCLES] / (double)in_len);
+    }
+    if ((mask & (1u << BENCH_PERF_CYCLES)) && (mask & (1u << BENCH_PERF_INSTRUCTIONS)) &&
+        med[BENCH_PERF_CYCLES]) {
+        fprintf(o, "\"%s_ipc\":%.4f,", dir,
+                (double)med[BENCH_PERF_INSTRUCTIONS] / (double)med[BENCH_PERF_CYCLES]);
+    }
+}
+
+static void bench_free_callers(bench_caller_t* callers, size_t n) {
+    if (!callers) return;
+    for (size_t k = 0; k < n; k++) {
+        free(callers[k].comp); free(callers[k].dec);
+        free(callers[k].c_t0); free(callers[k].c_t1);
+        free(callers[k].d_t0); free(callers[k].d_t1);
+        free(callers[k].c_perf); free(callers[k].d_perf);
+    }
+    free(callers);
+}
+
+#ifdef BENCH_ALLOC_TRACKING
+/* Set by a driver whose library maps some blocks itself, out of the
+ * interposer's sight: the heap fields would undercount, so they are left out.
+ * Copies and RSS growth are still reported. */
+static int bench_heap_untracked;
+
+typedef struct {
+    bench_alloc_stats_t c, d;
+    size_t c_rss, d_rss;  /* RSS high-water growth ... */
+    int has_rss;          /* ... measured (streaming jobs, resettable HWM) */
+} bench_mem_t;
+
+/* One untimed compress + decompress on the calling thread (after every caller
+ * has finished, so nothing else is allocating), each bracketed for heap
+ * accounting. The buffers were touched by the timed passes, so RSS growth is
+ * the codec's own working set. */
+static void bench_measure_memory(const bench_job_t* j, bench_caller_t* c, bench_mem_t* m) {
+    const char* err = NULL;
+    size_t drains;
+    int rss = j->mode == BENCH_STREAM;
+    size_t base = rss ? bench_rss_begin() : 0;
+    m->has_rss = base != 0;
+    bench_alloc_begin();
+    bench_compress_once(j, c->comp, &c->comp_len, &drains, &err);
+    bench_alloc_end(&m->c);
+    m->c_rss = bench_rss_end(base);
+
+    base = rss ? bench_rss_begin() : 0;
+    m->has_rss = m->has_rss && base != 0;
+    bench_alloc_begin();
+    bench_decompress_once(j, c->comp, c->comp_len, c->dec, &c->dec_len, &drains, &err);
+    bench_alloc_end(&m->d);
+    m->d_rss = bench_rss_end(base);
+}
+
+static void bench_emit_mem(FILE* o, const char* dir, const bench_alloc_stats_t* st,
+                           size_t rss, int with_rss) {
+    if (!bench_heap_untracked) {
+        fprintf(o, "\"%s_heap_peak_bytes\":%zu,", dir, st->peak);
+        fprintf(o, "\"%s_alloc_bytes\":%zu,", dir, st->bytes);
+        fprintf(o, "\"%s_allocs\":%zu,", dir, st->count);
+    }
+    fprintf(o, "\"%s_memcpy_bytes\":%zu,", dir, st->copy_bytes);
+    if (with_rss) fprintf(o, "\"%s_rss_hwm_bytes\":%zu,", dir, rss);
+}
+#endif
+
+/* Returns 1 = result emitted, 0 = failure, -1 = skipped (the codec has no
+ * implementation of the requested mode). */
 static int bench_run_job(const char* lang, const bench_codec_t* codec, int level,
-                         int is_stream, size_t chunk, const char* path,
-                         size_t samples, size_t warmup) {
-    if (is_stream && (!codec->compress_stream || !codec->decompress_stream)) {
+                         bench_mode_t mode, size_t chunk, size_t out_chunk, unsigned threads,
+                         int perf, const char* path, size_t samples, size_t warmup) {
+    if (mode == BENCH_STREAM && (!codec->compress_stream || !codec->decompress_stream)) {
+        return -1;
+    }
+    if (mode == BENCH_STREAM && out_chunk && !codec->stream_out_window) return -1;
+    if (mode == BENCH_PARALLEL && (!codec->compress_parallel || !codec->parallel_bound)) {
         return -1;
     }
 
@@ -148,76 +506,573 @@ static int bench_run_job(const char* lang, const bench_codec_t* codec, int level
         return 0;
     }
 
-    size_t bound = codec->bound(codec, in_len);
-    uint8_t* comp = (uint8_t*)malloc(bound ? bound : 1);
-    uint8_t* dec = (uint8_t*)malloc(in_len ? in_len : 1);
-    uint64_t* c_t = (uint64_t*)malloc((samples ? samples : 1) * sizeof(uint64_t));
-    uint64_t* d_t = (uint64_t*)malloc((samples ? samples : 1) * sizeof(uint64_t));
-    if (!comp || !dec || !c_t || !d_t) {
+    /* Counters follow the calling thread only, which would miss the library's
+     * workers in parallel mode. */
+    bench_job_t job = { codec, level, mode, chunk, out_chunk, threads,
+                        perf && mode != BENCH_PARALLEL, in, in_len, 0 };
+    job.bound = mode == BENCH_PARALLEL ? codec->parallel_bound(codec, in_len, threads)
+                                       : codec->bound(codec, in_len);
+    if (mode == BENCH_PARALLEL && job.bound == 0) {
+        free(in);
+        return -1;  /* no parallel mode for this algorithm */
+    }
+
+    /* Parallel mode is one caller driving `threads` library workers. */
+    size_t n = mode == BENCH_PARALLEL ? 1 : threads;
+    size_t ts = (samples ? samples : 1) * sizeof(uint64_t);
+    size_t ps = (samples ? samples : 1) * sizeof(bench_perf_sample_t);
+    bench_caller_t* callers = (bench_caller_t*)calloc(n, sizeof(bench_caller_t));
+    int oom = !callers;
+    for (size_t k = 0; k < n && !oom; k++) {
+        bench_caller_t* c = &callers[k];
+        c->job = &job;
+        c->samples = samples;
+        c->warmup = warmup;
+        c->comp = (uint8_t*)malloc(job.bound ? job.bound : 1);
+        c->dec = (uint8_t*)malloc(in_len ? in_len : 1);
+        c->c_t0 = (uint64_t*)malloc(ts);
+        c->c_t1 = (uint64_t*)malloc(ts);
+        c->d_t0 = (uint64_t*)malloc(ts);
+        c->d_t1 = (uint64_t*)malloc(ts);
+        c->c_perf = (bench_perf_sample_t*)calloc(1, ps);
+        c->d_perf = (bench_perf_sample_t*)calloc(1, ps);
+        oom = !c->comp || !c->dec || !c->c_t0 || !c->c_t1 || !c->d_t0 || !c->d_t1 ||
+              !c->c_perf || !c->d_perf;
+    }
+    if (oom) {
         fprintf(stderr, "bench: OOM sizing '%s'\n", path);
-        free(in); free(comp); free(dec); free(c_t); free(d_t);
+        bench_free_callers(callers, n);
+        free(in);
+        return 0;
+    }
+
+    if (n == 1) {
+        bench_caller_main(&callers[0]);
+    } else {
+        bench_barrier_t barrier;
+        bench_barrier_init(&barrier, n);
+        size_t started = 0;
+        for (; started < n; started++) {
+            callers[started].barrier = &barrier;
+            if (pthread_create(&callers[started].tid, NULL, bench_caller_main,
+                               &callers[started]) != 0) {
+                break;
+            }
+        }
+        if (started < n) {
+            /* Can't run at the requested concurrency. The threads already
+             * started are parked at the barrier: mark them failed so they
+             * skip the work, and let them meet among themselves. */
+            pthread_mutex_lock(&barrier.lock);
+            for (size_t k = 0; k < started; k++) callers[k].failed = 1;
+            barrier.n = started;
+            if (started && barrier.waiting == started) {
+                barrier.waiting = 0;
+                barrier.gen++;
+                pthread_cond_broadcast(&barrier.cond);
+            }
+            pthread_mutex_unlock(&barrier.lock);
+        }
+        for (size_t k = 0; k < started; k++) pthread_join(callers[k].tid, NULL);
+        bench_barrier_destroy(&barrier);
+        if (started < n) {
+            fprintf(stderr, "bench: cannot start %u threads\n", threads);
+            bench_free_callers(callers, n);
+            free(in);
+            return 0;
+        }
+    }
+
+    for (size_t k = 0; k < n; k++) {
+        if (!callers[k].failed) continue;
+        fprintf(stderr, "bench: %s(%s/%s L%d %s) failed: %s\n",
+                callers[k].failed == 1 ? "compress" : "decompress",
+                codec->name, codec->impl, level, BENCH_MODE_NAMES[mode],
+                callers[k].err ? callers[k].err : "?");
+        bench_free_callers(callers, n);
+        free(in);
+        return 0;
+    }
+
+    int verified = 1;
+    for (size_t k = 0; k < n; k++) {
+        verified = verified && callers[k].dec_len == in_len &&
+                   (in_len == 0 || memcmp(in, callers[k].dec, in_len) == 0);
+    }
+
+    bench_stats_t c_st, d_st;
+    if (!bench_stats(callers, n, samples, 0, &c_st) ||
+        !bench_stats(callers, n, samples, 1, &d_st)) {
+        fprintf(stderr, "bench: OOM summarizing '%s'\n", path);
+        bench_free_callers(callers, n);
+        free(in);
+        return 0;
+    }
+    uint64_t c_pm[BENCH_PERF_N], d_pm[BENCH_PERF_N];
+    unsigned c_pmask = job.perf ? bench_perf_stats(callers, n, samples, 0, c_pm) : 0;
+    unsigned d_pmask = job.perf ? bench_perf_stats(callers, n, samples, 1, d_pm) : 0;
+
+#ifdef BENCH_ALLOC_TRACKING
+    bench_mem_t mem;
+    bench_measure_memory(&job, &callers[0], &mem);
+#endif
+
+    FILE* o = stdout;
+    fputs("{", o);
+    fputs("\"lang\":", o); bench_emit_json_string(o, lang); fputs(",", o);
+    fputs("\"impl\":", o); bench_emit_json_string(o, codec->impl); fputs(",", o);
+    fputs("\"algo\":", o); bench_emit_json_string(o, codec->name); fputs(",", o);
+    fprintf(o, "\"level\":%d,", level);
+    fputs("\"mode\":", o); bench_emit_json_string(o, BENCH_MODE_NAMES[mode]);
+    fputs(",", o);
+    fprintf(o, "\"chunk_bytes\":%zu,", mode == BENCH_STREAM ? chunk : (size_t)0);
+    if (mode == BENCH_STREAM) {
+        fprintf(o, "\"out_chunk_bytes\":%zu,", out_chunk);
+        if (codec->stream_out_window) {
+            fprintf(o, "\"compress_drains\":%zu,", callers[0].c_drains);
+            fprintf(o, "\"decompress_drains\":%zu,", callers[0].d_drains);
+        }
+    }
+    fprintf(o, "\"threads\":%u,", threads);
+    fprintf(o, "\"callers\":%zu,", n);
+    fputs("\"input\":", o); bench_emit_json_string(o, path); fputs(",", o);
+    fprintf(o, "\"input_bytes\":%zu,", in_len);
+    fprintf(o, "\"output_bytes\":%zu,", callers[0].comp_len);
+    fprintf(o, "\"compress_ns_median\":%llu,", (unsigned long long)c_st.median);
+    fprintf(o, "\"compress_ns_mad\":%llu,", (unsigned long long)c_st.mad);
+    fprintf(o, "\"compress_ns_min\":%llu,", (unsigned long long)c_st.min);
+    fprintf(o, "\"compress_wall_ns_median\":%llu,", (unsigned long long)c_st.wall_median);
+    bench_emit_perf(o, "compress", c_pm, c_pmask, in_len);
+    fprintf(o, "\"decompress_ns_median\":%llu,", (unsigned long long)d_st.median);
+    fprintf(o, "\"decompress_ns_mad\":%llu,", (unsigned long long)d_st.mad);
+    fprintf(o, "\"decompress_ns_min\":%llu,", (unsigned long long)d_st.min);
+    fprintf(o, "\"decompress_wall_ns_median\":%llu,", (unsigned long long)d_st.wall_median);
+    bench_emit_perf(o, "decompress", d_pm, d_pmask, in_len);
+#ifdef BENCH_ALLOC_TRACKING
+    bench_emit_mem(o, "compress", &mem.c, mem.c_rss, mem.has_rss);
+    bench_emit_mem(o, "decompress", &mem.d, mem.d_rss, mem.has_rss);
+#endif
+    fprintf(o, "\"samples\":%zu,", samples);
+    fprintf(o, "\"warmup\":%zu,", warmup);
+    fprintf(o, "\"verified\":%s", verified ? "true" : "false");
+    fputs("}\n", o);
+    fflush(o);
+
+    bench_free_callers(callers, n);
+    free(in);
+    return 1;
+}
+
+/* ---- small-message jobs -------------------------------------------------- */
+
+/* Job line: "<algo> <level> msg:<variant>:<sizes> <path>". The input is sliced
+ * into BENCH_MESSAGES messages at pseudo-random offsets (fixed seed, so every
+ * driver sees the same set); `sizes` is a fixed size "N" or a log-uniform
+ * range "LO-HI" (uniform octave, then uniform within it). Each message is
+ * compressed and decompressed as its own call, and every call is timed:
+ *
+ *   fresh  the plain one-shot entry points, i.e. new codec state per call;
+ *   reuse  one session whose contexts are reset between messages;
+ *   dict   reuse, plus a raw-content dictionary cut from other slices of the
+ *          same input (a stand-in for a trained dictionary).
+ *
+ * Sample times (compress_ns_median …) are whole passes over the message set,
+ * so input_bytes / compress_ns stays a throughput. Per-call latencies of every
+ * sampled pass go into a log-linear histogram for the percentiles. */
+
+typedef enum { BENCH_MSG_FRESH, BENCH_MSG_REUSE, BENCH_MSG_DICT } bench_msg_variant_t;
+
+static const char* const BENCH_MSG_VARIANT_NAMES[] = { "fresh", "reuse", "dict" };
+
+#define BENCH_MSG_DICT_BYTES (32 * 1024) /* zlib's window; fine for zstd/lz4 */
+#define BENCH_MSG_SEED 0x9E3779B97F4A7C15ull
+
+static uint64_t bench_rand(uint64_t* st) {
+    /* xorshift64* */
+    uint64_t x = *st;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *st = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+static size_t bench_rand_below(uint64_t* st, size_t n) {
+    return n ? (size_t)(bench_rand(st) % n) : 0;
+}
+
+static size_t bench_msg_size(uint64_t* st, size_t lo, size_t hi) {
+    if (lo >= hi) return lo;
+    unsigned e_lo = 0, e_hi = 0;
+    while (((size_t)2 << e_lo) <= lo) e_lo++;
+    while (((size_t)2 << e_hi) <= hi) e_hi++;
+    for (;;) {
+        unsigned e = e_lo + (unsigned)bench_rand_below(st, e_hi - e_lo + 1);
+        size_t v = ((size_t)1 << e) + bench_rand_below(st, (size_t)1 << e);
+        if (v >= lo && v <= hi) return v;
+    }
+}
+
+/* "N" or "LO-HI"; 0 on a malformed spec. */
+static int bench_parse_sizes(const char* s, size_t* lo, size_t* hi) {
+    char* end;
+    long a = strtol(s, &end, 10);
+    long b = a;
+    if (*end == '-') b = strtol(end + 1, &end, 10);
+    if (*end || a <= 0 || b < a) return 0;
+    *lo = (size_t)a;
+    *hi = (size_t)b;
+    return 1;
+}
+
+/* Log-linear latency histogram (HDR-style): values below 2^BENCH_HIST_SUB_BITS
+ * are exact, above that each power of two is split into 2^BENCH_HIST_SUB_BITS
+ * buckets, i.e. <1% relative error over the full 64-bit range. */
+#define BENCH_HIST_SUB_BITS 7
+#define BENCH_HIST_SUB (1u << BENCH_HIST_SUB_BITS)
+#define BENCH_HIST_BUCKETS ((64 - BENCH_HIST_SUB_BITS + 1) * BENCH_HIST_SUB)
+
+typedef struct {
+    uint64_t* counts;
+    uint64_t total;
+    uint64_t max;
+} bench_hist_t;
+
+static int bench_hist_init(bench_hist_t* h) {
+    h->counts = (uint64_t*)calloc(BENCH_HIST_BUCKETS, sizeof(uint64_t));
+    h->total = 0;
+    h->max = 0;
+    return h->counts != NULL;
+}
+
+static size_t bench_hist_index(uint64_t v) {
+    if (v < BENCH_HIST_SUB) return (size_t)v;
+    unsigned msb = 63;
+    while (!(v >> msb)) msb--;
+    unsigned shift = msb - BENCH_HIST_SUB_BITS;
+    return ((size_t)(shift + 1) << BENCH_HIST_SUB_BITS) + (size_t)((v >> shift) & (BENCH_HIST_SUB - 1));
+}
+
+/* Highest value that lands in bucket `i`. */
+static uint64_t bench_hist_upper(size_t i) {
+    if (i < BENCH_HIST_SUB) return (uint64_t)i;
+    unsigned shift = (unsigned)(i >> BENCH_HIST_SUB_BITS) - 1;
+    uint64_t sub = (uint64_t)(i & (BENCH_HIST_SUB - 1)) | BENCH_HIST_SUB;
+    return ((sub + 1) << shift) - 1;
+}
+
+static void bench_hist_record(bench_hist_t* h, uint64_t v) {
+    h->counts[bench_hist_index(v)]++;
+    h->total++;
+    if (v > h->max) h->max = v;
+}
+
+/* Value at quantile q (0..1): the upper edge of the bucket holding the
+ * ceil(q * total)-th sample, clamped to the recorded maximum. */
+static uint64_t bench_hist_quantile(const bench_hist_t* h, double q) {
+    if (h->total == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)h->total + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > h->total) rank = h->total;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BENCH_HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            uint64_t v = bench_hist_upper(i);
+            return v < h->max ? v : h->max;
+        }
+    }
+    return h->max;
+}
+
+/* Quantiles emitted as each record's CDF ("*_cdf": [[ns, q], …]). */
+static const double BENCH_CDF_Q[] = {
+    0.0, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 0.95, 0.99, 0.995, 0.999, 0.9999, 1.0
+};
+
+static void bench_emit_hist(FILE* o, const char* dir, const bench_hist_t* h) {
+    fprintf(o, "\"%s_ns_p50\":%llu,", dir, (unsigned long long)bench_hist_quantile(h, 0.5));
+    fprintf(o, "\"%s_ns_p90\":%llu,", dir, (unsigned long long)bench_hist_quantile(h, 0.9));
+    fprintf(o, "\"%s_ns_p99\":%llu,", dir, (unsigned long long)bench_hist_quantile(h, 0.99));
+    fprintf(o, "\"%s_ns_p999\":%llu,", dir, (unsigned long long)bench_hist_quantile(h, 0.999));
+    fprintf(o, "\"%s_ns_max\":%llu,", dir, (unsigned long long)h->max);
+    fprintf(o, "\"%s_cdf\":[", dir);
+    for (size_t i = 0; i < sizeof(BENCH_CDF_Q) / sizeof(BENCH_CDF_Q[0]); i++) {
+        uint64_t v = BENCH_CDF_Q[i] == 0.0 ? bench_hist_quantile(h, 1.0 / (double)h->total)
+                                           : bench_hist_quantile(h, BENCH_CDF_Q[i]);
+        fprintf(o, "%s[%llu,%g]", i ? "," : "", (unsigned long long)v, BENCH_CDF_Q[i]);
+    }
+    fputs("],", o);
+}
+
+typedef struct {
+    const bench_codec_t* codec;
+    int level;
+    void* session;  /* NULL for the fresh variant */
+} bench_msg_ctx_t;
+
+static int bench_msg_compress(const bench_msg_ctx_t* m, const uint8_t* in, size_t in_len,
+                              uint8_t* out, size_t* out_len, const char** err) {
+    if (m->session) return m->codec->session_compress(m->session, in, in_len, out, out_len, err);
+    return m->codec->compress(m->codec, in, in_len, out, out_len, m->level, err);
+}
+
+static int bench_msg_decompress(const bench_msg_ctx_t* m, const uint8_t* in, size_t in_len,
+                                uint8_t* out, size_t* out_len, const char** err) {
+    if (m->session) return m->codec->session_decompress(m->session, in, in_len, out, out_len, err);
+    return m->codec->decompress(m->codec, in, in_len, out, out_len, err);
+}
+
+/* Same return convention as bench_run_job. */
+static int bench_run_msg_job(const char* lang, const bench_codec_t* codec, int level,
+                             bench_msg_variant_t variant, const char* sizes, size_t messages,
+                             const char* path, size_t samples, size_t warmup) {
+    if (variant != BENCH_MSG_FRESH &&
+        (!codec->session_open || !codec->session_compress || !codec->session_decompress ||
+         !codec->session_close)) {
+        return -1;
+    }
+    size_t lo, hi;
+    if (!bench_parse_sizes(sizes, &lo, &hi)) {
+        fprintf(stderr, "bench: bad message sizes '%s'\n", sizes);
+        return 0;
+    }
+
+    size_t in_len = 0;
+    uint8_t* in = bench_read_file(path, &in_len);
+    if (!in) {
+        fprintf(stderr, "bench: cannot read '%s'\n", path);
         return 0;
     }
 
+    /* The message set: offsets and lengths, plus per-message output slots. */
+    size_t* off = (size_t*)malloc(messages * sizeof(size_t));
+    size_t* len = (size_t*)malloc(messages * sizeof(size_t));
+    size_t* c_off = (size_t*)malloc(messages * sizeof(size_t));
+    size_t* c_len = (size_t*)malloc(messages * sizeof(size_t));
+    uint64_t* c_pass = (uint64_t*)malloc((samples ? samples : 1) * sizeof(uint64_t));
+    uint64_t* d_pass = (uint64_t*)malloc((samples ? samples : 1) * sizeof(uint64_t));
+    uint8_t* comp = NULL;
+    uint8_t* dec = NULL;
+    uint8_t* dict = NULL;
+    size_t dict_len = 0;
+    bench_hist_t c_hist = { NULL, 0, 0 }, d_hist = { NULL, 0, 0 };
+    bench_msg_ctx_t m = { codec, level, NULL };
     const char* err = NULL;
-    size_t comp_len = 0;
-    int failed = 0;
+    const char* failed = NULL;
+    int rc = 0;
 
-    for (size_t i = 0; i < warmup && !failed; i++) {
-        comp_len = bound;
-        failed = is_stream
-            ? codec->compress_stream(codec, in, in_len, comp, &comp_len, level, chunk, &err)
-            : codec->compress(codec, in, in_len, comp, &comp_len, level, &err);
+    int ok = off && len && c_off && c_len && c_pass && d_pass &&
+             bench_hist_init(&c_hist) && bench_hist_init(&d_hist);
+    size_t total = 0, comp_cap = 0, max_len = 1;
+    uint64_t st = BENCH_MSG_SEED;
+    for (size_t i = 0; ok && i < messages; i++) {
+        size_t n = bench_msg_size(&st, lo, hi);
+        if (n > in_len) n = in_len;
+        off[i] = bench_rand_below(&st, in_len - n + 1);
+        len[i] = n;
+        c_off[i] = comp_cap;
+        comp_cap += codec->bound(codec, n);
+        total += n;
+        if (n > max_len) max_len = n;
     }
-    for (size_t i = 0; i < samples && !failed; i++) {
-        comp_len = bound;
-        uint64_t t0 = bench_now_ns();
-        failed = is_stream
-            ? codec->compress_stream(codec, in, in_len, comp, &comp_len, level, chunk, &err)
-            : codec->compress(codec, in, in_len, comp, &comp_len, level, &err);
-        uint64_t t1 = bench_now_ns();
-        c_t[i] = t1 - t0;
+    if (ok) {
+        comp = (uint8_t*)malloc(comp_cap ? comp_cap : 1);
+        dec = (uint8_t*)malloc(max_len);
+        ok = comp && dec;
+    }
+    if (ok && variant == BENCH_MSG_DICT) {
+        /* Dictionary: 1 KiB slices drawn with a different seed. */
+        dict_len = in_len < BENCH_MSG_DICT_BYTES ? in_len : BENCH_MSG_DICT_BYTES;
+        dict = (uint8_t*)malloc(dict_len ? dict_len : 1);
+        ok = dict != NULL;
+        uint64_t dst = ~BENCH_MSG_SEED;
+        for (size_t pos = 0; ok && pos < dict_len;) {
+            size_t n = dict_len - pos < 1024 ? dict_len - pos : 1024;
+            memcpy(dict + pos, in + bench_rand_below(&dst, in_len - n + 1), n);
+            pos += n;
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "bench: OOM sizing '%s'\n", path);
+        goto done;
+    }
+    if (variant != BENCH_MSG_FRESH) {
+        m.session = codec->session_open(codec, (int)variant, level, dict, dict_len, &err);
+        if (!m.session) {
+            if (!err) { rc = -1; goto done; }
+            failed = "session";
+        }
+    }
+
+    for (size_t p = 0; !failed && p < warmup + samples; p++) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < messages; i++) {
+            c_len[i] = codec->bound(codec, len[i]);
+            uint64_t t0 = bench_now_ns();
+            int r = bench_msg_compress(&m, in + off[i], len[i], comp + c_off[i], &c_len[i], &err);
+            uint64_t t1 = bench_now_ns();
+            if (r) { failed = "compress"; break; }
+            sum += t1 - t0;
+            if (p >= warmup) bench_hist_record(&c_hist, t1 - t0);
+        }
+        if (p >= warmup) c_pass[p - warmup] = sum;
+    }
+
+    int verified = 1;
+    size_t out_total = 0;
+    for (size_t p = 0; !failed && p < warmup + samples; p++) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < messages; i++) {
+            size_t dl = max_len;
+            uint64_t t0 = bench_now_ns();
+            int r = bench_msg_decompress(&m, comp + c_off[i], c_len[i], dec, &dl, &err);
+            uint64_t t1 = bench_now_ns();
+            if (r) { failed = "decompress"; break; }
+            sum += t1 - t0;
+            if (p >= warmup) bench_hist_record(&d_hist, t1 - t0);
+            if (p + 1 == warmup + samples) {
+                verified = verified && dl == len[i] &&
+                           (dl == 0 || memcmp(dec, in + off[i], dl) == 0);
+            }
+        }
+        if (p >= warmup) d_pass[p - warmup] = sum;
     }
     if (failed) {
-        fprintf(stderr, "bench: compress(%s/%s L%d %s) failed: %s\n",
-                codec->name, codec->impl, level, is_stream ? "stream" : "oneshot",
-                err ? err : "?");
-        free(in); free(comp); free(dec); free(c_t); free(d_t);
+        fprintf(stderr, "bench: %s(%s/%s L%d msg:%s:%s) failed: %s\n", failed, codec->name,
+                codec->impl, level, BENCH_MSG_VARIANT_NAMES[variant], sizes, err ? err : "?");
+        goto done;
+    }
+    for (size_t i = 0; i < messages; i++) out_total += c_len[i];
+
+    qsort(c_pass, samples, sizeof(uint64_t), bench_cmp_u64);
+    qsort(d_pass, samples, sizeof(uint64_t), bench_cmp_u64);
+    uint64_t c_med = bench_median_sorted(c_pass, samples);
+    uint64_t d_med = bench_median_sorted(d_pass, samples);
+
+    FILE* o = stdout;
+    fputs("{", o);
+    fputs("\"lang\":", o); bench_emit_json_string(o, lang); fputs(",", o);
+    fputs("\"impl\":", o); bench_emit_json_string(o, codec->impl); fputs(",", o);
+    fputs("\"algo\":", o); bench_emit_json_string(o, codec->name); fputs(",", o);
+    fprintf(o, "\"level\":%d,", level);
+    fputs("\"mode\":\"msg\",", o);
+    fputs("\"msg_variant\":", o);
+    bench_emit_json_string(o, BENCH_MSG_VARIANT_NAMES[variant]);
+    fputs(",", o);
+    fputs("\"msg_sizes\":", o); bench_emit_json_string(o, sizes); fputs(",", o);
+    fprintf(o, "\"messages\":%zu,", messages);
+    fprintf(o, "\"dict_bytes\":%zu,", dict_len);
+    fputs("\"chunk_bytes\":0,\"threads\":1,\"callers\":1,", o);
+    fputs("\"input\":", o); bench_emit_json_string(o, path); fputs(",", o);
+    fprintf(o, "\"input_bytes\":%zu,", total);
+    fprintf(o, "\"output_bytes\":%zu,", out_total);
+    fprintf(o, "\"compress_ns_median\":%llu,", (unsigned long long)c_med);
+    fprintf(o, "\"compress_ns_mad\":%llu,", (unsigned long long)bench_mad(c_pass, samples, c_med));
+    fprintf(o, "\"compress_ns_min\":%llu,", (unsigned long long)(samples ? c_pass[0] : 0));
+    bench_emit_hist(o, "compress", &c_hist);
+    fprintf(o, "\"decompress_ns_median\":%llu,", (unsigned long long)d_med);
+    fprintf(o, "\"decompress_ns_mad\":%llu,",
+            (unsigned long long)bench_mad(d_pass, samples, d_med));
+    fprintf(o, "\"decompress_ns_min\":%llu,", (unsigned long long)(samples ? d_pass[0] : 0));
+    bench_emit_hist(o, "decompress", &d_hist);
+    fprintf(o, "\"samples\":%zu,", samples);
+    fprintf(o, "\"warmup\":%zu,", warmup);
+    fprintf(o, "\"verified\":%s", verified ? "true" : "false");
+    fputs("}\n", o);
+    fflush(o);
+    rc = 1;
+
+done:
+    if (m.session) codec->session_close(m.session);
+    free(c_hist.counts); free(d_hist.counts);
+    free(dict); free(comp); free(dec);
+    free(off); free(len); free(c_off); free(c_len);
+    free(c_pass); free(d_pass);
+    free(in);
+    return rc;
+}
+
+/* ---- call-overhead jobs --------------------------------------------------- */
+
+/* The ffi reference is this raw C call, so it has to run without
+ * bench_alloc.h's interposer: counting every malloc and memcpy would inflate
+ * it and hide part of each binding's cost. A tracking build skips ffi jobs
+ * and reports "ffi":false. */
+#ifdef BENCH_ALLOC_TRACKING
+#define BENCH_FFI 0
+#else
+#define BENCH_FFI 1
+#endif
+
+/* Job line: "<algo> <level> ffi:<bytes> <path>". The payload is the first
+ * <bytes> of the file; every sample is `calls` back-to-back compress calls
+ * (then as many decompress calls of the result) timed as one loop, so the
+ * clock read doesn't dominate a sub-microsecond call. *_ns_* fields are per
+ * call. Same return convention as bench_run_job. */
+static int bench_run_ffi_job(const char* lang, const bench_codec_t* codec, int level,
+                             size_t payload, size_t calls, const char* path, size_t samples,
+                             size_t warmup) {
+    size_t in_len = 0;
+    uint8_t* in = bench_read_file(path, &in_len);
+    if (!in) {
+        fprintf(stderr, "bench: cannot read '%s'\n", path);
         return 0;
     }
+    if (payload > in_len) {
+        fprintf(stderr, "bench: '%s' is shorter than the %zu-byte payload\n", path, payload);
+        free(in);
+        return 0;
+    }
+    size_t bound = codec->bound(codec, payload);
+    uint8_t* comp = (uint8_t*)malloc(bound ? bound : 1);
+    uint8_t* dec = (uint8_t*)malloc(payload ? payload : 1);
+    uint64_t* c_t = (uint64_t*)malloc((samples ? samples : 1) * sizeof(uint64_t));
+    uint64_t* d_t = (uint64_t*)malloc((samples ? samples : 1) * sizeof(uint64_t));
+    const char* err = NULL;
+    const char* failed = NULL;
+    size_t comp_len = 0, dec_len = 0;
+    int rc = 0;
+    if (!comp || !dec || !c_t || !d_t) {
+        fprintf(stderr, "bench: OOM sizing '%s'\n", path);
+        goto done;
+    }
 
-    size_t dec_len = 0;
-    for (size_t i = 0; i < warmup && !failed; i++) {
-        dec_len = in_len;
-        failed = is_stream
-            ? codec->decompress_stream(codec, comp, comp_len, dec, &dec_len, chunk, &err)
-            : codec->decompress(codec, comp, comp_len, dec, &dec_len, &err);
+    for (size_t p = 0; !failed && p < warmup + samples; p++) {
+        uint64_t t0 = bench_now_ns();
+        for (size_t i = 0; i < calls; i++) {
+            comp_len = bound;
+            if (codec->compress(codec, in, payload, comp, &comp_len, level, &err)) {
+                failed = "compress";
+                break;
+            }
+        }
+        uint64_t t1 = bench_now_ns();
+        if (p >= warmup) c_t[p - warmup] = (t1 - t0) / calls;
     }
-    for (size_t i = 0; i < samples && !failed; i++) {
-        dec_len = in_len;
+    for (size_t p = 0; !failed && p < warmup + samples; p++) {
         uint64_t t0 = bench_now_ns();
-        failed = is_stream
-            ? codec->decompress_stream(codec, comp, comp_len, dec, &dec_len, chunk, &err)
-            : codec->decompress(codec, comp, comp_len, dec, &dec_len, &err);
+        for (size_t i = 0; i < calls; i++) {
+            dec_len = payload;
+            if (codec->decompress(codec, comp, comp_len, dec, &dec_len, &err)) {
+                failed = "decompress";
+                break;
+            }
+        }
         uint64_t t1 = bench_now_ns();
-        d_t[i] = t1 - t0;
+        if (p >= warmup) d_t[p - warmup] = (t1 - t0) / calls;
     }
     if (failed) {
-        fprintf(stderr, "bench: decompress(%s/%s L%d %s) failed: %s\n",
-                codec->name, codec->impl, level, is_stream ? "stream" : "oneshot",
-                err ? err : "?");
-        free(in); free(comp); free(dec); free(c_t); free(d_t);
-        return 0;
+        fprintf(stderr, "bench: %s(%s/%s L%d ffi:%zu) failed: %s\n", failed, codec->name,
+                codec->impl, level, payload, err ? err : "?");
+        goto done;
     }
-
-    int verified = (dec_len == in_len) && (in_len == 0 || memcmp(in, dec, in_len) == 0);
+    int verified = dec_len == payload && (payload == 0 || memcmp(dec, in, payload) == 0);
 
     qsort(c_t, samples, sizeof(uint64_t), bench_cmp_u64);
     qsort(d_t, samples, sizeof(uint64_t), bench_cmp_u64);
     uint64_t c_med = bench_median_sorted(c_t, samples);
     uint64_t d_med = bench_median_sorted(d_t, samples);
-    uint64_t c_mad = bench_mad(c_t, samples, c_med);
-    uint64_t d_mad = bench_mad(d_t, samples, d_med);
 
     FILE* o = stdout;
     fputs("{", o);
@@ -225,26 +1080,30 @@ static int bench_run_job(const char* lang, const bench_codec_t* codec, int level
     fputs("\"impl\":", o); bench_emit_json_string(o, codec->impl); fputs(",", o);
     fputs("\"algo\":", o); bench_emit_json_string(o, codec->name); fputs(",", o);
     fprintf(o, "\"level\":%d,", level);
-    fputs("\"mode\":", o); bench_emit_json_string(o, is_stream ? "stream" : "oneshot");
-    fputs(",", o);
-    fprintf(o, "\"chunk_bytes\":%zu,", is_stream ? chunk : (size_t)0);
+    fputs("\"mode\":\"ffi\",", o);
+    fprintf(o, "\"payload_bytes\":%zu,", payload);
+    fprintf(o, "\"calls\":%zu,", calls);
+    fputs("\"chunk_bytes\":0,\"threads\":1,\"callers\":1,", o);
     fputs("\"input\":", o); bench_emit_json_string(o, path); fputs(",", o);
-    fprintf(o, "\"input_bytes\":%zu,", in_len);
+    fprintf(o, "\"input_bytes\":%zu,", payload);
     fprintf(o, "\"output_bytes\":%zu,", comp_len);
     fprintf(o, "\"compress_ns_median\":%llu,", (unsigned long long)c_med);
-    fprintf(o, "\"compress_ns_mad\":%llu,", (unsigned long long)c_mad);
-    fprintf(o, "\"compress_ns_min\":%llu,", (unsigned long long)c_t[0]);
+    fprintf(o, "\"compress_ns_mad\":%llu,", (unsigned long long)bench_mad(c_t, samples, c_med));
+    fprintf(o, "\"compress_ns_min\":%llu,", (unsigned long long)(samples ? c_t[0] : 0));
     fprintf(o, "\"decompress_ns_median\":%llu,", (unsigned long long)d_med);
-    fprintf(o, "\"decompress_ns_mad\":%llu,", (unsigned long long)d_mad);
-    fprintf(o, "\"decompress_ns_min\":%llu,", (unsigned long long)d_t[0]);
+    fprintf(o, "\"decompress_ns_mad\":%llu,", (unsigned long long)bench_mad(d_t, samples, d_med));
+    fprintf(o, "\"decompress_ns_min\":%llu,", (unsigned long long)(samples ? d_t[0] : 0));
     fprintf(o, "\"samples\":%zu,", samples);
     fprintf(o, "\"warmup\":%zu,", warmup);
     fprintf(o, "\"verified\":%s", verified ? "true" : "false");
     fputs("}\n", o);
     fflush(o);
+    rc = 1;
 
-    free(in); free(comp); free(dec); free(c_t); free(d_t);
-    return 1;
+done:
+    free(comp); free(dec); free(c_t); free(d_t);
+    free(in);
+    return rc;
 }
 
 /* ---- driver entry points ------------------------------------------------- */
@@ -264,24 +1123,60 @@ static void bench_emit_marker(const char* key) {
     fflush(stdout);
 }
 
-/* Print {"lang","version","driver"} and return 0. `driver` is the runner's
- * registry key for this binary (e.g. "c" or "c-baseline"); the runner uses it
- * to name the results file so distinct drivers don't collide. */
-static int bench_info(const char* lang, const char* version, const char* driver) {
-    printf("{\"lang\":\"%s\",\"version\":\"%s\",\"driver\":\"%s\"}\n",
-           lang, version, driver);
+/* Print {"lang","version","driver","threads","messages","sweep","ffi","alloc"}
+ * and return 0.
+ * `driver` is the runner's registry key for this binary (e.g. "c" or
+ * "c-baseline"); the runner uses it to name the results file so distinct
+ * drivers don't collide.
+ * "threads":true tells the runner this driver honors BENCH_THREADS and
+ * understands parallel-mode jobs; "messages":true that it understands msg jobs;
+ * "sweep":true that it parses "stream:<chunk>:<out_chunk>"; "ffi" whether it
+ * runs call-overhead jobs (not in a tracking build); "startup" (the `startup` argument) that it takes
+ * one-shot `--startup` invocations; "alloc" whether records carry the heap /
+ * RSS fields. */
+static int bench_info(const char* lang, const char* version, const char* driver,
+                      int startup) {
+#ifdef BENCH_ALLOC_TRACKING
+    const char* alloc = "true";
+#else
+    const char* alloc = "false";
+#endif
+    printf("{\"lang\":\"%s\",\"version\":\"%s\",\"driver\":\"%s\",\"threads\":true,"
+           "\"messages\":true,\"sweep\":true,\"ffi\":%s,\"startup\":%s,\"alloc\":%s}\n",
+           lang, version, driver, BENCH_FFI ? "true" : "false", startup ? "true" : "false",
+           alloc);
     return 0;
 }
 
+/* Caller threads: `--threads N` on the command line, else BENCH_THREADS,
+ * else 1. */
+static unsigned bench_threads(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (!strcmp(argv[i], "--threads")) {
+            long n = strtol(argv[i + 1], NULL, 10);
+            if (n > 0) return (unsigned)n;
+        }
+    }
+    return (unsigned)bench_env_size("BENCH_THREADS", 1);
+}
+
 /* Read jobs from stdin, run each, emit NDJSON. Returns process exit code.
  *
- * Job line: "<algo> <level> [<mode>] <path>". `mode` is "oneshot" or "stream";
- * it's optional for backward compatibility — a 3-field line is treated as
- * one-shot. `path` may contain spaces. */
-static int bench_run(const char* lang, const bench_codec_t* codecs, size_t n_codecs) {
+ * Job line: "<algo> <level> [<mode>] <path>". `mode` is "oneshot", "stream",
+ * "stream:<chunk>:<out_chunk>" (explicit input chunk and output window, for
+ * sweeps), "parallel", "msg:<variant>:<sizes>" or "ffi:<bytes>"; it's optional
+ * for backward compatibility — a 3-field line is treated as one-shot. `path`
+ * may contain spaces. `threads` is the number of concurrent callers (library
+ * workers in parallel mode). */
+static int bench_run(const char* lang, const bench_codec_t* codecs, size_t n_codecs,
+                     unsigned threads) {
     size_t samples = bench_env_size("BENCH_SAMPLES", 5);
     size_t warmup = bench_env_size("BENCH_WARMUP", 1);
     size_t chunk = bench_env_size("BENCH_CHUNK", 64 * 1024);
+    size_t messages = bench_env_size("BENCH_MESSAGES", 2000);
+    size_t calls = bench_env_size("BENCH_CALLS", 20000);
+    const char* perf_env = getenv("BENCH_PERF");
+    int perf = !(perf_env && !strcmp(perf_env, "0"));
 
     char line[8192];
     int failures = 0;
@@ -306,11 +1201,38 @@ static int bench_run(const char* lang, const bench_codec_t* codecs, size_t n_cod
         /* Remainder is "[mode ]path". Detect an optional leading mode token. */
         char* rest = sp2 + 1;
         while (*rest == ' ') rest++;
-        int is_stream = 0;
+        bench_mode_t mode = BENCH_ONESHOT;
         char* path = rest;
-        if (!strncmp(rest, "stream ", 7)) {
-            is_stream = 1;
+        char* msg = NULL;
+        char* ffi = NULL;
+        size_t job_chunk = chunk, out_chunk = 0;
+        if (!strncmp(rest, "stream:", 7)) {
+            char* end;
+            mode = BENCH_STREAM;
+            job_chunk = (size_t)strtoull(rest + 7, &end, 10);
+            if (*end == ':') out_chunk = (size_t)strtoull(end + 1, &end, 10);
+            if (*end != ' ' || job_chunk == 0) {
+                fprintf(stderr, "bench: bad job line: %s\n", line);
+                failures++;
+                continue;
+            }
+            path = end + 1;
+        } else if (!strncmp(rest, "ffi:", 4)) {
+            ffi = rest + 4;
+            path = strchr(ffi, ' ');
+            if (!path) { fprintf(stderr, "bench: bad job line: %s\n", line); failures++; continue; }
+            *path++ = '\0';
+        } else if (!strncmp(rest, "msg:", 4)) {
+            msg = rest + 4;
+            path = strchr(msg, ' ');
+            if (!path) { fprintf(stderr, "bench: bad job line: %s\n", line); failures++; continue; }
+            *path++ = '\0';
+        } else if (!strncmp(rest, "stream ", 7)) {
+            mode = BENCH_STREAM;
             path = rest + 7;
+        } else if (!strncmp(rest, "parallel ", 9)) {
+            mode = BENCH_PARALLEL;
+            path = rest + 9;
         } else if (!strncmp(rest, "oneshot ", 8)) {
             path = rest + 8;
         }
@@ -322,11 +1244,41 @@ static int bench_run(const char* lang, const bench_codec_t* codecs, size_t n_cod
             continue;
         }
 
-        int r = bench_run_job(lang, codec, level, is_stream, chunk, path, samples, warmup);
+        int r;
+        if (ffi) {
+            /* Single-caller like msg jobs: skipped under --threads > 1, and
+             * in a tracking build (see BENCH_FFI). */
+            size_t payload = (size_t)strtoull(ffi, NULL, 10);
+            r = !BENCH_FFI || threads != 1 ? -1
+                             : bench_run_ffi_job(lang, codec, level, payload, calls, path,
+                                                 samples, warmup);
+        } else if (msg) {
+            /* "<variant>:<sizes>", sizes defaulting to 256-16384. Messages
+             * are single-caller latency runs: skipped under --threads > 1. */
+            char* sizes = strchr(msg, ':');
+            if (sizes) *sizes++ = '\0';
+            int variant = -1;
+            for (int v = 0; v < 3; v++) {
+                if (!strcmp(msg, BENCH_MSG_VARIANT_NAMES[v])) variant = v;
+            }
+            if (variant < 0) {
+                fprintf(stderr, "bench: unknown message variant '%s'\n", msg);
+                r = 0;
+            } else if (threads != 1) {
+                r = -1;
+            } else {
+                r = bench_run_msg_job(lang, codec, level, (bench_msg_variant_t)variant,
+                                      sizes && *sizes ? sizes : "256-16384", messages, path,
+                                      samples, warmup);
+            }
+        } else {
+            r = bench_run_job(lang, codec, level, mode, job_chunk, out_chunk, threads, perf, path,
+                              samples, warmup);
+        }
         if (r == 1) {
             /* result line already emitted by bench_run_job */
         } else if (r == -1) {
-            bench_emit_marker("skipped");  /* stream unsupported for this codec */
+            bench_emit_marker("skipped");  /* mode unsupported for this codec */
         } else {
             failures++;
             bench_emit_marker("error");  /* detail already on stderr */
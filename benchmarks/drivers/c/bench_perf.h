@@ -0,0 +1,140 @@
+/*
+ * bench_perf.h — hardware performance counters for the C benchmark drivers.
+ *
+ * Each caller thread opens one perf_event_open group for itself (user space
+ * only, so perf_event_paranoid <= 2 is enough) and reads it right before and
+ * after every timed call. Events: cycles (the group leader), instructions,
+ * L1D read misses, LLC misses and branch misses. A sibling the PMU doesn't
+ * offer is dropped; if cycles can't be opened at all — no PMU in a VM, a
+ * locked-down container, a non-Linux host — the thread simply counts nothing
+ * and the record omits the fields. BENCH_PERF=0 turns counting off.
+ *
+ * Counts are scaled by time_enabled / time_running when the kernel had to
+ * multiplex the group; a call during which the group never ran is dropped.
+ *
+ * Include from exactly one translation unit (bench_harness.h does).
+ */
+
+#ifndef BENCH_PERF_H
+#define BENCH_PERF_H
+
+#include <stdint.h>
+#include <string.h>
+
+enum {
+    BENCH_PERF_CYCLES,
+    BENCH_PERF_INSTRUCTIONS,
+    BENCH_PERF_L1D_MISSES,
+    BENCH_PERF_LLC_MISSES,
+    BENCH_PERF_BRANCH_MISSES,
+    BENCH_PERF_N
+};
+
+static const char* const BENCH_PERF_NAMES[BENCH_PERF_N] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"
+};
+
+/* One call's counter deltas; mask has bit i set when event i was counted. */
+typedef struct {
+    uint64_t v[BENCH_PERF_N];
+    unsigned mask;
+} bench_perf_sample_t;
+
+#if defined(__linux__) && !defined(BENCH_NO_PERF)
+#define BENCH_PERF 1
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* unistd.h only declares syscall() for _DEFAULT_SOURCE; the drivers build as
+ * plain -std=c11. */
+long syscall(long number, ...);
+
+typedef struct {
+    int leader;              /* -1 when counting is unavailable */
+    int fd[BENCH_PERF_N];
+    int slot[BENCH_PERF_N];  /* index in the group read, -1 = not counted */
+    int n;                   /* events in the group */
+    uint64_t raw[3 + BENCH_PERF_N];  /* last read: nr, enabled, running, values */
+} bench_perf_t;
+
+static const struct { uint32_t type; uint64_t config; } BENCH_PERF_EVENTS[BENCH_PERF_N] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+static void bench_perf_open(bench_perf_t* p) {
+    p->leader = -1;
+    p->n = 0;
+    for (int i = 0; i < BENCH_PERF_N; i++) { p->fd[i] = -1; p->slot[i] = -1; }
+    for (int i = 0; i < BENCH_PERF_N; i++) {
+        struct perf_event_attr a;
+        memset(&a, 0, sizeof(a));
+        a.size = sizeof(a);
+        a.type = BENCH_PERF_EVENTS[i].type;
+        a.config = BENCH_PERF_EVENTS[i].config;
+        a.exclude_kernel = 1;
+        a.exclude_hv = 1;
+        a.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                        PERF_FORMAT_TOTAL_TIME_RUNNING;
+        /* pid 0, cpu -1: this thread, wherever it runs. */
+        int fd = (int)syscall(SYS_perf_event_open, &a, 0, -1, p->leader, 0);
+        if (fd < 0) {
+            if (i == BENCH_PERF_CYCLES) return;  /* no leader: nothing to count */
+            continue;
+        }
+        if (i == BENCH_PERF_CYCLES) p->leader = fd;
+        p->fd[i] = fd;
+        p->slot[i] = p->n++;
+    }
+}
+
+static void bench_perf_close(bench_perf_t* p) {
+    for (int i = 0; i < BENCH_PERF_N; i++) {
+        if (p->fd[i] >= 0) close(p->fd[i]);
+        p->fd[i] = -1;
+    }
+    p->leader = -1;
+}
+
+/* Snapshot the group before a call. */
+static void bench_perf_start(bench_perf_t* p) {
+    if (p->leader < 0) return;
+    if (read(p->leader, p->raw, sizeof(p->raw)) < (ssize_t)(3 * sizeof(uint64_t))) {
+        p->raw[0] = 0;
+    }
+}
+
+/* Deltas since bench_perf_start, scaled for multiplexing. */
+static void bench_perf_stop(bench_perf_t* p, bench_perf_sample_t* s) {
+    s->mask = 0;
+    if (p->leader < 0 || p->raw[0] != (uint64_t)p->n) return;
+    uint64_t now[3 + BENCH_PERF_N];
+    if (read(p->leader, now, sizeof(now)) < (ssize_t)((3 + p->n) * sizeof(uint64_t))) return;
+    uint64_t enabled = now[1] - p->raw[1], running = now[2] - p->raw[2];
+    if (running == 0) return;
+    for (int i = 0; i < BENCH_PERF_N; i++) {
+        if (p->slot[i] < 0) continue;
+        uint64_t d = now[3 + p->slot[i]] - p->raw[3 + p->slot[i]];
+        s->v[i] = enabled == running ? d : (uint64_t)((double)d * enabled / running);
+        s->mask |= 1u << i;
+    }
+}
+
+#else /* no perf_event_open */
+
+typedef struct { int leader; } bench_perf_t;
+
+static void bench_perf_open(bench_perf_t* p) { p->leader = -1; }
+static void bench_perf_close(bench_perf_t* p) { (void)p; }
+static void bench_perf_start(bench_perf_t* p) { (void)p; }
+static void bench_perf_stop(bench_perf_t* p, bench_perf_sample_t* s) { (void)p; s->mask = 0; }
+
+#endif
+
+#endif /* BENCH_PERF_H */
@@ -3,10 +3,12 @@
 // Speaks the shared benchmark driver protocol (see benchmarks/README.md): reads
 // "<algo> <level> [<mode>] <path>" job lines from stdin, emits one NDJSON result
 // (or skip/error marker) per line, honours BENCH_SAMPLES / BENCH_WARMUP /
-// BENCH_CHUNK, and answers `--info`.
+// BENCH_CHUNK / BENCH_CALLS, and answers `--info`.
 //
 // Drives the compress-utils Go binding (bindings/go) the way a consumer would:
-// Compress/Decompress for one-shot, NewWriter/NewReader for streaming. The
+// Compress/Decompress for one-shot, NewWriter/NewReader for streaming;
+// "ffi:<bytes>" jobs loop Compress/Decompress on a tiny payload to time the
+// cgo crossing and wrapper per call. The
 // binding compiles the C core from source via cgo, so this is the same codec
 // code the other drivers measure — only the language wrapper differs.
 package main
@@ -50,6 +52,7 @@ var (
 	samples = envInt("BENCH_SAMPLES", 5)
 	warmup  = envInt("BENCH_WARMUP", 1)
 	chunk   = envInt("BENCH_CHUNK", 64*1024)
+	calls   = envInt("BENCH_CALLS", 20000)
 )
 
 type stats struct{ median, mad, min int64 }
@@ -184,6 +187,74 @@ func runJob(algoName string, level int, isStream bool, path string) (map[string]
 	}, nil
 }
 
+// runFFIJob times `calls` back-to-back calls per sample on the file's first
+// `payload` bytes; *_ns_* are per call (see bench_run_ffi_job in the C harness).
+func runFFIJob(algoName string, level, payload int, path string) (map[string]any, error) {
+	algo := algos[algoName]
+	f, err := os.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	data := make([]byte, payload)
+	_, err = io.ReadFull(f, data)
+	f.Close()
+	if err != nil {
+		return nil, fmt.Errorf("%s is shorter than the %d-byte payload", path, payload)
+	}
+
+	var comp []byte
+	cT := make([]int64, 0, samples)
+	for i := 0; i < warmup+samples; i++ {
+		t0 := time.Now()
+		for n := 0; n < calls; n++ {
+			if comp, err = cu.Compress(algo, data, level); err != nil {
+				return nil, err
+			}
+		}
+		if i >= warmup {
+			cT = append(cT, time.Since(t0).Nanoseconds()/int64(calls))
+		}
+	}
+
+	var dec []byte
+	dT := make([]int64, 0, samples)
+	for i := 0; i < warmup+samples; i++ {
+		t0 := time.Now()
+		for n := 0; n < calls; n++ {
+			if dec, err = cu.Decompress(algo, comp); err != nil {
+				return nil, err
+			}
+		}
+		if i >= warmup {
+			dT = append(dT, time.Since(t0).Nanoseconds()/int64(calls))
+		}
+	}
+
+	c, d := computeStats(cT), computeStats(dT)
+	return map[string]any{
+		"lang":                 "go",
+		"impl":                 "compress-utils",
+		"algo":                 algoName,
+		"level":                level,
+		"mode":                 "ffi",
+		"payload_bytes":        payload,
+		"calls":                calls,
+		"chunk_bytes":          0,
+		"input":                path,
+		"input_bytes":          payload,
+		"output_bytes":         len(comp),
+		"compress_ns_median":   c.median,
+		"compress_ns_mad":      c.mad,
+		"compress_ns_min":      c.min,
+		"decompress_ns_median": d.median,
+		"decompress_ns_mad":    d.mad,
+		"decompress_ns_min":    d.min,
+		"samples":              samples,
+		"warmup":               warmup,
+		"verified":             bytes.Equal(dec, data),
+	}, nil
+}
+
 func emit(obj map[string]any) {
 	b, _ := json.Marshal(obj)
 	fmt.Println(string(b))
@@ -191,7 +262,7 @@ func emit(obj map[string]any) {
 
 func main() {
 	if len(os.Args) > 1 && os.Args[1] == "--info" {
-		emit(map[string]any{"lang": "go", "version": cu.Version(), "driver": "go"})
+		emit(map[string]any{"lang": "go", "version": cu.Version(), "driver": "go", "ffi": true})
 		return
 	}
 
@@ -210,7 +281,16 @@ func main() {
 		}
 		algoName, levelS, rest := f[0], f[1], f[2]
 		isStream := false
+		ffi := -1
 		switch {
+		case strings.HasPrefix(rest, "ffi:"):
+			f := strings.SplitN(rest[len("ffi:"):], " ", 2)
+			n, err := strconv.Atoi(f[0])
+			if err != nil || n < 0 || len(f) < 2 {
+				emit(map[string]any{"error": true})
+				continue
+			}
+			ffi, rest = n, f[1]
 		case strings.HasPrefix(rest, "stream "):
 			isStream, rest = true, rest[len("stream "):]
 		case strings.HasPrefix(rest, "oneshot "):
@@ -227,11 +307,18 @@ func main() {
 			emit(map[string]any{"error": true})
 			continue
 		}
-		rec, err := runJob(algoName, level, isStream, path)
+		var rec map[string]any
+		if ffi >= 0 {
+			rec, err = runFFIJob(algoName, level, ffi, path)
+		} else {
+			rec, err = runJob(algoName, level, isStream, path)
+		}
 		if err != nil {
 			mode := "oneshot"
 			if isStream {
 				mode = "stream"
+			} else if ffi >= 0 {
+				mode = fmt.Sprintf("ffi:%d", ffi)
 			}
 			fmt.Fprintf(os.Stderr, "bench-go: %s L%d %s failed: %v\n", algoName, level, mode, err)
 			emit(map[string]any{"error": true})
@@ -5,11 +5,12 @@ Python benchmark driver.
 Speaks the shared benchmark driver protocol (see benchmarks/README.md): reads
 "<algo> <level> [<mode>] <path>" job lines from stdin, emits one NDJSON result
 (or skip/error marker) per line, honours BENCH_SAMPLES / BENCH_WARMUP /
-BENCH_CHUNK, and answers `--info`.
+BENCH_CHUNK / BENCH_CALLS, and answers `--info`.
 
 Drives the compress-utils Python binding (bindings/python) the way a consumer
 would: compress/decompress for one-shot, CompressStream/DecompressStream for
-streaming.
+streaming. "ffi:<bytes>" jobs loop compress/decompress on a tiny payload to
+time the binding's per-call cost.
 """
 
 from __future__ import annotations
@@ -29,6 +30,7 @@ ALGOS = {"zstd", "brotli", "zlib", "bz2", "lz4", "xz", "snappy", "gzip"}
 SAMPLES = int(os.environ.get("BENCH_SAMPLES") or 5)
 WARMUP = int(os.environ.get("BENCH_WARMUP") or 1)
 CHUNK = int(os.environ.get("BENCH_CHUNK") or 64 * 1024)
+CALLS = int(os.environ.get("BENCH_CALLS") or 20000)
 
 
 def _stats(samples: list[int]) -> dict:
@@ -105,6 +107,55 @@ def _run_job(algo_name: str, level: int, is_stream: bool, path: str) -> dict:
     }
 
 
+def _run_ffi_job(algo_name: str, level: int, payload: int, path: str) -> dict:
+    """CALLS back-to-back calls per sample on the file's first `payload` bytes;
+    *_ns_* are per call (see bench_run_ffi_job in the C harness)."""
+    algo = getattr(cu.Algorithm, algo_name)
+    with open(path, "rb") as f:
+        data = f.read(payload)
+    if len(data) != payload:
+        raise ValueError(f"{path} is shorter than the {payload}-byte payload")
+    compress, decompress = cu.compress, cu.decompress
+
+    comp = b""
+    c_t = []
+    for i in range(WARMUP + SAMPLES):
+        t0 = time.perf_counter_ns()
+        for _ in range(CALLS):
+            comp = compress(data, algo, level)
+        if i >= WARMUP:
+            c_t.append((time.perf_counter_ns() - t0) // CALLS)
+
+    dec = b""
+    d_t = []
+    for i in range(WARMUP + SAMPLES):
+        t0 = time.perf_counter_ns()
+        for _ in range(CALLS):
+            dec = decompress(comp, algo)
+        if i >= WARMUP:
+            d_t.append((time.perf_counter_ns() - t0) // CALLS)
+
+    c, d = _stats(c_t), _stats(d_t)
+    return {
+        "lang": "python",
+        "impl": "compress-utils",
+        "algo": algo_name,
+        "level": level,
+        "mode": "ffi",
+        "payload_bytes": payload,
+        "calls": CALLS,
+        "chunk_bytes": 0,
+        "input": path,
+        "input_bytes": payload,
+        "output_bytes": len(comp),
+        "compress_ns_median": c["median"], "compress_ns_mad": c["mad"], "compress_ns_min": c["min"],
+        "decompress_ns_median": d["median"], "decompress_ns_mad": d["mad"], "decompress_ns_min": d["min"],
+        "samples": SAMPLES,
+        "warmup": WARMUP,
+        "verified": dec == data,
+    }
+
+
 def _emit(obj: dict) -> None:
     sys.stdout.write(json.dumps(obj) + "\n")
     sys.stdout.flush()
@@ -115,7 +166,7 @@ JOB_RE = re.compile(r"^(\S+)\s+(\S+)\s+(.*)$")
 
 def main() -> None:
     if len(sys.argv) > 1 and sys.argv[1] == "--info":
-        _emit({"lang": "python", "version": cu.version(), "driver": "python"})
+        _emit({"lang": "python", "version": cu.version(), "driver": "python", "ffi": True})
         return
 
     # readline loop (not `for line in sys.stdin`) to avoid read-ahead buffering
@@ -130,7 +181,14 @@ def main() -> None:
             continue
         algo, level_s, rest = m.group(1), m.group(2), m.group(3)
         is_stream = False
-        if rest.startswith("stream "):
+        ffi = None
+        if rest.startswith("ffi:"):
+            ffi_s, _, rest = rest[4:].partition(" ")
+            if not ffi_s.isdigit():
+                _emit({"error": True})
+                continue
+            ffi = int(ffi_s)
+        elif rest.startswith("stream "):
             is_stream, rest = True, rest[7:]
         elif rest.startswith("oneshot "):
             rest = rest[8:]
@@ -140,10 +198,13 @@ def main() -> None:
             _emit({"skipped": True})
             continue
         try:
+            if ffi is not None:
+                _emit(_run_ffi_job(algo, int(level_s), ffi, path))
+                continue
             _emit(_run_job(algo, int(level_s), is_stream, path))
         except Exception as e:  # noqa: BLE001
-            sys.stderr.write(f"bench-py: {algo} L{level_s} "
-                             f"{'stream' if is_stream else 'oneshot'} failed: {e}\n")
+            mode = f"ffi:{ffi}" if ffi is not None else "stream" if is_stream else "oneshot"
+            sys.stderr.write(f"bench-py: {algo} L{level_s} {mode} failed: {e}\n")
             _emit({"error": True})
 
 
@@ -4,13 +4,16 @@
  * Speaks the same benchmark driver protocol as the C drivers (see
  * benchmarks/README.md): reads "<algo> <level> [<mode>] <path>" job lines from
  * stdin, emits one NDJSON result (or skip/error marker) per line, honours
- * BENCH_SAMPLES / BENCH_WARMUP / BENCH_CHUNK, and answers `--info`.
+ * BENCH_SAMPLES / BENCH_WARMUP / BENCH_CHUNK / BENCH_CALLS, and answers
+ * `--info`.
  *
  * It drives the built compress-utils WASM package (bindings/wasm/dist) the same
  * way a real consumer would: `import('compress-utils/<algo>')` →
  * compress/decompress + createCompressStream/createDecompressStream. Each
  * record also carries `wasm_size_bytes` (the module's on-disk size) — the
- * primary metric for the WASM size-reduction work.
+ * primary metric for the WASM size-reduction work. "ffi:<bytes>" jobs loop
+ * `await compress`/`await decompress` on a tiny payload to time the JS↔WASM
+ * crossing, arena copies and promise per call.
  *
  * Run: node bench_wasm.mjs        (or `--info`)
  */
@@ -29,6 +32,7 @@ const ALGOS = new Set(["zstd", "brotli", "zlib", "bz2", "lz4", "xz", "snappy", "
 const SAMPLES = Number(process.env.BENCH_SAMPLES) || 5;
 const WARMUP = Number(process.env.BENCH_WARMUP) || 1;
 const CHUNK = Number(process.env.BENCH_CHUNK) || 64 * 1024;
+const CALLS = Number(process.env.BENCH_CALLS) || 20000;
 
 const modCache = new Map();
 function loadModule(algo) {
@@ -153,6 +157,57 @@ async function runJob(algo, level, isStream, path) {
     };
 }
 
+// CALLS back-to-back calls per sample on the file's first `payload` bytes;
+// *_ns_* are per call (see bench_run_ffi_job in the C harness).
+async function runFfiJob(algo, level, payload, path) {
+    const mod = await loadModule(algo);
+    const input = readFileSync(path).subarray(0, payload);
+    if (input.length !== payload) {
+        throw new Error(`${path} is shorter than the ${payload}-byte payload`);
+    }
+
+    let comp;
+    const cT = [];
+    for (let i = 0; i < WARMUP + SAMPLES; i++) {
+        const t0 = now();
+        for (let n = 0; n < CALLS; n++) comp = await mod.compress(input, { level });
+        if (i >= WARMUP) cT.push(Math.floor(Number(now() - t0) / CALLS));
+    }
+
+    let dec;
+    const dT = [];
+    for (let i = 0; i < WARMUP + SAMPLES; i++) {
+        const t0 = now();
+        for (let n = 0; n < CALLS; n++) dec = await mod.decompress(comp);
+        if (i >= WARMUP) dT.push(Math.floor(Number(now() - t0) / CALLS));
+    }
+
+    const c = stats(cT);
+    const d = stats(dT);
+    return {
+        lang: "wasm",
+        impl: "compress-utils",
+        algo,
+        level,
+        mode: "ffi",
+        payload_bytes: payload,
+        calls: CALLS,
+        chunk_bytes: 0,
+        input: path,
+        input_bytes: payload,
+        output_bytes: comp.length,
+        compress_ns_median: c.median,
+        compress_ns_mad: c.mad,
+        compress_ns_min: c.min,
+        decompress_ns_median: d.median,
+        decompress_ns_mad: d.mad,
+        decompress_ns_min: d.min,
+        samples: SAMPLES,
+        warmup: WARMUP,
+        verified: bytesEqual(input, dec),
+    };
+}
+
 function emit(obj) {
     process.stdout.write(JSON.stringify(obj) + "\n");
 }
@@ -162,7 +217,7 @@ async function main() {
         const pkg = JSON.parse(
             readFileSync(resolve(REPO, "bindings/wasm/package.json"), "utf8"),
         );
-        emit({ lang: "wasm", version: pkg.version, driver: "wasm" });
+        emit({ lang: "wasm", version: pkg.version, driver: "wasm", ffi: true });
         return;
     }
 
@@ -177,15 +232,21 @@ async function main() {
         const level = parseInt(m[2], 10);
         let rest = m[3];
         let isStream = false;
-        if (rest.startsWith("stream ")) { isStream = true; rest = rest.slice(7); }
+        let ffi = -1;
+        const fm = rest.match(/^ffi:(\d+) (.*)$/);
+        if (fm) { ffi = parseInt(fm[1], 10); rest = fm[2]; }
+        else if (rest.startsWith("ffi:")) { emit({ error: true }); continue; }
+        else if (rest.startsWith("stream ")) { isStream = true; rest = rest.slice(7); }
         else if (rest.startsWith("oneshot ")) { rest = rest.slice(8); }
         const path = rest.trim();
 
         if (!ALGOS.has(algo)) { emit({ skipped: true }); continue; }
+        const mode = ffi >= 0 ? `ffi:${ffi}` : isStream ? "stream" : "oneshot";
         try {
-            emit(await runJob(algo, level, isStream, path));
+            emit(ffi >= 0 ? await runFfiJob(algo, level, ffi, path)
+                          : await runJob(algo, level, isStream, path));
         } catch (e) {
-            process.stderr.write(`bench-wasm: ${algo} L${level} ${isStream ? "stream" : "oneshot"} failed: ${e?.message || e}\n`);
+            process.stderr.write(`bench-wasm: ${algo} L${level} ${mode} failed: ${e?.message || e}\n`);
             emit({ error: true });
         }
     }
@@ -100,6 +100,11 @@ class RunMeta:
     chunk: int = 64 * 1024
     samples: int = 5
     warmup: int = 1
+    threads: list = field(default_factory=lambda: [1])
+    numa: list = field(default_factory=list)  # --numa placements; empty = not set
+    huge_pages: list = field(default_factory=list)  # --huge-pages settings; empty = not set
+    messages: int = 0  # small-message jobs: messages per job (0 = none run)
+    calls: int = 0  # call-overhead jobs: calls per sample (0 = none run)
     machine: dict = field(default_factory=machine_fingerprint)
 
 
@@ -127,6 +132,13 @@ def decompress_mbps(rec: dict) -> float:
     return (rec["input_bytes"] / MB) / (ns / 1e9) if ns else 0.0
 
 
+def aggregate_mbps(rec: dict, direction: str) -> float:
+    """Throughput of all concurrent callers together: callers × input bytes ÷
+    the median wall time of a sample. Equals *_mbps for a single caller."""
+    ns = rec.get(f"{direction}_wall_ns_median") or rec[f"{direction}_ns_median"]
+    return (rec.get("callers", 1) * rec["input_bytes"] / MB) / (ns / 1e9) if ns else 0.0
+
+
 def enrich(rec: dict) -> dict:
     """Attach derived fields to a raw driver record (non-destructive).
 
@@ -137,9 +149,15 @@ def enrich(rec: dict) -> dict:
     r = dict(rec)
     r.setdefault("impl", "compress-utils")
     r.setdefault("mode", "oneshot")
+    r.setdefault("threads", 1)
+    r.setdefault("callers", 1)
     r["ratio"] = ratio(rec)
+    if r["mode"] == "startup":  # single timed calls, no throughput
+        return r
     r["compress_mbps"] = compress_mbps(rec)
     r["decompress_mbps"] = decompress_mbps(rec)
+    r["compress_mbps_aggregate"] = aggregate_mbps(r, "compress")
+    r["decompress_mbps_aggregate"] = aggregate_mbps(r, "decompress")
     return r
 
 
@@ -50,7 +50,8 @@ def main() -> None:
 
     def med(lang, algo, field):
         vals = [r[field] for r in recs if r["lang"] == lang and r["algo"] == algo
-                and r["level"] == args.level and r["mode"] == args.mode]
+                and r["level"] == args.level and r["mode"] == args.mode
+                and r.get("threads", 1) == 1]
         return statistics.median(vals) if vals else 0.0
 
     # Only plot languages actually present, so bar groups center correctly
@@ -6,7 +6,13 @@ Report + regression tool for benchmark results.
     python3 benchmarks/report.py new.json --baseline old.json   # regression diff
 
 Default (no path) reads results/latest.json. Plots land in results/plots/ and
-need matplotlib; the table and regression diff are stdlib-only.
+need matplotlib; the table and regression diff are stdlib-only. A run with
+several thread counts (runner.py --threads 1,2,4,…) also gets a scaling table
+and throughput-vs-threads plots; drivers that read hardware counters or track
+allocations add counter and memory tables; small-message runs (--modes msg) get a
+per-call latency table and latency-CDF plots; streaming sweeps (--modes sweep) get
+a best-buffer table and chunk × output-buffer throughput heatmaps; call-overhead
+runs (--modes ffi) get a per-binding ns/call table and wrapper-overhead plots.
 """
 
 from __future__ import annotations
@@ -31,15 +37,58 @@ SPEED_DROP_PCT = 8.0
 # --------------------------------------------------------------------------- #
 
 
+def is_msg(r: dict) -> bool:
+    return r.get("mode") == "msg"
+
+
+def is_sweep(r: dict) -> bool:
+    """A streaming record with an explicit output window (a --modes sweep cell);
+    plain stream jobs offer the whole output buffer."""
+    return r.get("mode") == "stream" and bool(r.get("out_chunk_bytes"))
+
+
+def is_ffi(r: dict) -> bool:
+    return r.get("mode") == "ffi"
+
+
+def is_startup(r: dict) -> bool:
+    return r.get("mode") == "startup"
+
+
+def is_matrix(r: dict) -> bool:
+    """Records the main table, plots and scaling cover."""
+    return not is_msg(r) and not is_sweep(r) and not is_ffi(r) and not is_startup(r)
+
+
+def mode_of(r: dict) -> str:
+    """The job's mode token: "msg:<variant>:<sizes>" for small-message records
+    and "stream:<chunk>:<out_chunk>" for sweep cells, so they don't collide with
+    each other."""
+    if is_msg(r):
+        return f"msg:{r.get('msg_variant', 'fresh')}:{r.get('msg_sizes', '')}"
+    if is_sweep(r):
+        return f"stream:{r['chunk_bytes']}:{r['out_chunk_bytes']}"
+    if is_ffi(r):
+        return f"ffi:{r['payload_bytes']}"
+    # runner.py --numa / --huge-pages tag every record with their setting.
+    mode = r.get("mode", "oneshot")
+    if r.get("numa"):
+        mode += f"@{r['numa']}"
+    if r.get("huge_pages"):
+        mode += f"+hp-{r['huge_pages']}"
+    return mode
+
+
 def print_table(data: dict) -> None:
     meta = data["meta"]
     recs = sorted(
-        data["records"],
-        key=lambda r: (r["input_id"], r["algo"], r.get("impl", ""), r.get("mode", ""),
-                       r["level"]),
+        (r for r in data["records"] if is_matrix(r)),
+        key=lambda r: (r["input_id"], r["algo"], r.get("impl", ""), mode_of(r),
+                       r["level"], r.get("threads", 1)),
     )
     multi_impl = len({r.get("impl", "compress-utils") for r in recs}) > 1
-    multi_mode = len({r.get("mode", "oneshot") for r in recs}) > 1
+    multi_mode = len({mode_of(r) for r in recs}) > 1
+    multi_threads = len({r.get("threads", 1) for r in recs}) > 1
     drivers = ", ".join(f"{d['key']} v{d['version']}" for d in meta.get("drivers", []))
     print(f"\n  {drivers}  "
           f"@ {meta['git_sha']}{'*' if meta.get('git_dirty') else ''}  "
@@ -49,8 +98,9 @@ def print_table(data: dict) -> None:
           f"{meta['samples']} samples + {meta['warmup']} warmup\n")
 
     impl_col = f"{'impl':16} " if multi_impl else ""
-    mode_col = f"{'mode':8} " if multi_mode else ""
-    hdr = (f"  {'input':8} {'algo':7} {impl_col}{mode_col}{'lvl':>3} "
+    mode_col = f"{'mode':14} " if multi_mode else ""
+    thr_col = f"{'thr':>3} " if multi_threads else ""
+    hdr = (f"  {'input':8} {'algo':7} {impl_col}{mode_col}{'lvl':>3} {thr_col}"
            f"{'ratio':>7} {'c MB/s':>9} {'d MB/s':>9}  {'ok':>2}")
     print(hdr)
     print("  " + "-" * (len(hdr) - 2))
@@ -62,14 +112,346 @@ def print_table(data: dict) -> None:
             cur = r["input_id"]
         ok = "✓" if r.get("verified") else "✗"
         impl_cell = f"{r.get('impl', 'compress-utils'):16} " if multi_impl else ""
-        mode_cell = f"{r.get('mode', 'oneshot'):8} " if multi_mode else ""
+        mode_cell = f"{mode_of(r):14} " if multi_mode else ""
+        thr_cell = f"{r.get('threads', 1):>3} " if multi_threads else ""
         print(
-            f"  {r['input_id']:8} {r['algo']:7} {impl_cell}{mode_cell}{r['level']:>3} "
+            f"  {r['input_id']:8} {r['algo']:7} {impl_cell}{mode_cell}{r['level']:>3} {thr_cell}"
             f"{r['ratio']:>7.3f} {r['compress_mbps']:>9.1f} {r['decompress_mbps']:>9.1f}  {ok:>2}"
         )
     print()
 
 
+# --------------------------------------------------------------------------- #
+# Memory
+# --------------------------------------------------------------------------- #
+
+
+def print_memory(data: dict) -> None:
+    """Per-call heap peak / allocation count, memcpy volume (and RSS growth for
+    streaming) from drivers that track allocations; one thread count, matrix
+    records only."""
+    recs = [r for r in data["records"]
+            if "compress_heap_peak_bytes" in r and is_matrix(r)]
+    if not recs:
+        return
+    min_threads = min(r.get("threads", 1) for r in recs)
+    recs = sorted((r for r in recs if r.get("threads", 1) == min_threads),
+                  key=lambda r: (r["input_id"], r["algo"], r.get("impl", ""),
+                                 mode_of(r), r["level"]))
+    kib = lambda n: f"{n / 1024:>9.0f}" if n is not None else f"{'-':>9}"  # noqa: E731
+    print("  memory per call: heap peak KiB, allocations, memcpy KiB, "
+          "RSS growth KiB (streaming)\n")
+    hdr = (f"  {'input':8} {'algo':7} {'impl':16} {'mode':8} {'lvl':>3} "
+           f"{'c heap':>9} {'c allocs':>8} {'c copy':>9} {'c rss':>9} "
+           f"{'d heap':>9} {'d allocs':>8} {'d copy':>9} {'d rss':>9}")
+    print(hdr)
+    print("  " + "-" * (len(hdr) - 2))
+    cur = None
+    for r in recs:
+        if r["input_id"] != cur:
+            if cur is not None:
+                print()
+            cur = r["input_id"]
+        print(
+            f"  {r['input_id']:8} {r['algo']:7} {r.get('impl', 'compress-utils'):16} "
+            f"{mode_of(r):8} {r['level']:>3} "
+            f"{kib(r['compress_heap_peak_bytes'])} {r['compress_allocs']:>8} "
+            f"{kib(r.get('compress_memcpy_bytes'))} {kib(r.get('compress_rss_hwm_bytes'))} "
+            f"{kib(r['decompress_heap_peak_bytes'])} {r['decompress_allocs']:>8} "
+            f"{kib(r.get('decompress_memcpy_bytes'))} {kib(r.get('decompress_rss_hwm_bytes'))}"
+        )
+    print()
+
+
+# --------------------------------------------------------------------------- #
+# Hardware counters
+# --------------------------------------------------------------------------- #
+
+COUNTER_EVENTS = [("l1d_misses", "L1D"), ("llc_misses", "LLC"), ("branch_misses", "br")]
+
+
+def print_counters(data: dict) -> None:
+    """Cycles/byte, IPC and misses per KB of input from drivers that could open
+    perf events. A "-" is an event the host's PMU didn't offer."""
+    recs = sorted((r for r in data["records"] if "compress_cycles" in r and is_matrix(r)),
+                  key=lambda r: (r["input_id"], r["algo"], r.get("impl", ""),
+                                 mode_of(r), r["level"], r.get("threads", 1)))
+    if not recs:
+        return
+    multi_threads = len({r.get("threads", 1) for r in recs}) > 1
+    thr_col = f"{'thr':>3} " if multi_threads else ""
+
+    def cells(r: dict, direction: str) -> str:
+        kb = r["input_bytes"] / 1000 or 1
+        out = [f"{r.get(f'{direction}_cycles_per_byte', 0):>7.2f}"]
+        ipc = r.get(f"{direction}_ipc")
+        out.append(f"{ipc:>5.2f}" if ipc is not None else f"{'-':>5}")
+        for ev, _ in COUNTER_EVENTS:
+            v = r.get(f"{direction}_{ev}")
+            out.append(f"{v / kb:>7.2f}" if v is not None else f"{'-':>7}")
+        return " ".join(out)
+
+    print("  hardware counters per call: cycles/byte, IPC, misses per KB of input\n")
+    ev_hdr = lambda d: (f"{d + ' cyc/B':>7} {d + ' IPC':>5} "  # noqa: E731
+                        + " ".join(f"{d + ' ' + short:>7}" for _, short in COUNTER_EVENTS))
+    hdr = (f"  {'input':8} {'algo':7} {'impl':16} {'mode':8} {'lvl':>3} {thr_col}"
+           f"{ev_hdr('c')}  {ev_hdr('d')}")
+    print(hdr)
+    print("  " + "-" * (len(hdr) - 2))
+    cur = None
+    for r in recs:
+        if r["input_id"] != cur:
+            if cur is not None:
+                print()
+            cur = r["input_id"]
+        thr_cell = f"{r.get('threads', 1):>3} " if multi_threads else ""
+        print(f"  {r['input_id']:8} {r['algo']:7} {r.get('impl', 'compress-utils'):16} "
+              f"{mode_of(r):8} {r['level']:>3} {thr_cell}"
+              f"{cells(r, 'compress')}  {cells(r, 'decompress')}")
+    print()
+
+
+# --------------------------------------------------------------------------- #
+# Small-message latency
+# --------------------------------------------------------------------------- #
+
+
+def msg_key(r: dict) -> tuple:
+    return (r["input_id"], r["algo"], r.get("msg_sizes", ""), r["level"],
+            r.get("impl", "compress-utils"), r.get("msg_variant", "fresh"))
+
+
+def print_latency(data: dict) -> None:
+    recs = sorted((r for r in data["records"] if is_msg(r)), key=msg_key)
+    if not recs:
+        return
+    print(f"  small messages: per-call latency in µs over {recs[0].get('messages', '?')} "
+          f"messages × samples\n")
+    hdr = (f"  {'input':8} {'algo':7} {'sizes':11} {'lvl':>3} {'impl':16} {'var':5} "
+           f"{'ratio':>6} {'c p50':>8} {'c p99':>8} {'c p99.9':>8} "
+           f"{'d p50':>8} {'d p99':>8} {'d p99.9':>8}  {'ok':>2}")
+    print(hdr)
+    print("  " + "-" * (len(hdr) - 2))
+    cur = None
+    for r in recs:
+        group = msg_key(r)[:4]
+        if group != cur:
+            if cur is not None:
+                print()
+            cur = group
+        us = [r.get(f"{d}_ns_{p}", 0) / 1000 for d in ("compress", "decompress")
+              for p in ("p50", "p99", "p999")]
+        ok = "✓" if r.get("verified") else "✗"
+        print(
+            f"  {r['input_id']:8} {r['algo']:7} {r.get('msg_sizes', ''):11} {r['level']:>3} "
+            f"{r.get('impl', 'compress-utils'):16} {r.get('msg_variant', 'fresh'):5} "
+            f"{r['ratio']:>6.3f} " + " ".join(f"{v:>8.1f}" for v in us) + f"  {ok:>2}"
+        )
+    print()
+
+
+# --------------------------------------------------------------------------- #
+# Streaming sweep
+# --------------------------------------------------------------------------- #
+
+# The bindings' stream scratch (Go, Rust, WASM, C++): 64 KiB in, 64 KiB out.
+BINDING_CHUNK = BINDING_OUT = 64 * 1024
+
+
+def sweep_groups(recs: list[dict]) -> dict:
+    groups: dict = {}
+    for r in recs:
+        if is_sweep(r):
+            groups.setdefault((r["input_id"], r["algo"], r.get("impl", "compress-utils"),
+                               r["level"]), []).append(r)
+    return groups
+
+
+def size_label(n: int) -> str:
+    for unit, shift in (("M", 20), ("K", 10)):
+        if n >= 1 << shift and n % (1 << shift) == 0:
+            return f"{n >> shift}{unit}"
+    return str(n)
+
+
+def print_sweep(data: dict) -> None:
+    """Per codec: the fastest (input chunk, output buffer) cell for each
+    direction, and how the bindings' 64K/64K default compares with it."""
+    groups = sweep_groups(data["records"])
+    if not groups:
+        return
+    print("  streaming sweep: best input chunk / output buffer per direction vs the "
+          "bindings' 64K/64K\n")
+    hdr = (f"  {'input':8} {'algo':7} {'impl':16} {'lvl':>3} "
+           f"{'best c':>11} {'MB/s':>8} {'64K %':>6} {'drains':>7} "
+           f"{'best d':>11} {'MB/s':>8} {'64K %':>6} {'drains':>7}")
+    print(hdr)
+    print("  " + "-" * (len(hdr) - 2))
+    for k in sorted(groups):
+        rs = groups[k]
+        default = next((r for r in rs if r["chunk_bytes"] == BINDING_CHUNK
+                        and r["out_chunk_bytes"] == BINDING_OUT), None)
+        cells = []
+        for d in ("compress", "decompress"):
+            best = max(rs, key=lambda r: r[f"{d}_mbps"])
+            cell = f"{size_label(best['chunk_bytes'])}/{size_label(best['out_chunk_bytes'])}"
+            pct = (f"{default[f'{d}_mbps'] / best[f'{d}_mbps'] * 100:>6.0f}"
+                   if default and best[f"{d}_mbps"] else f"{'-':>6}")
+            drains = f"{default[f'{d}_drains']:>7}" if default else f"{'-':>7}"
+            cells.append(f"{cell:>11} {best[f'{d}_mbps']:>8.1f} {pct} {drains}")
+        inp, algo, impl, lvl = k
+        print(f"  {inp:8} {algo:7} {impl:16} {lvl:>3} {cells[0]} {cells[1]}")
+    print()
+
+
+# --------------------------------------------------------------------------- #
+# Call overhead
+# --------------------------------------------------------------------------- #
+
+
+def ffi_label(r: dict) -> str:
+    """"<lang>" for compress-utils bindings, "<lang>/<impl>" for baselines."""
+    impl = r.get("impl", "compress-utils")
+    return r["lang"] if impl == "compress-utils" else f"{r['lang']}/{impl}"
+
+
+def ffi_groups(recs: list[dict]) -> dict:
+    """ffi records by (input, level, algo, payload), each with its raw C call
+    (the C driver's compress-utils record) as the reference, or None."""
+    groups: dict = {}
+    for r in recs:
+        if is_ffi(r):
+            groups.setdefault((r["input_id"], r["level"], r["algo"], r["payload_bytes"]),
+                              []).append(r)
+    out = {}
+    for k, rs in groups.items():
+        ref = next((r for r in rs if r["lang"] == "c"
+                    and r.get("impl", "compress-utils") == "compress-utils"), None)
+        out[k] = (sorted(rs, key=ffi_label), ref)
+    return out
+
+
+def print_ffi(data: dict) -> None:
+    """ns per call and the wrapper's share of it: each binding minus the raw C
+    call on the same payload."""
+    groups = ffi_groups(data["records"])
+    if not groups:
+        return
+    print("  call overhead: ns/call, and wrapper = binding − raw C call\n")
+    hdr = (f"  {'input':8} {'algo':7} {'lvl':>3} {'bytes':>6} {'driver':18} "
+           f"{'c ns':>9} {'wrapper':>9} {'d ns':>9} {'wrapper':>9}  {'ok':>2}")
+    print(hdr)
+    print("  " + "-" * (len(hdr) - 2))
+    cur = None
+    for k in sorted(groups):
+        rs, ref = groups[k]
+        if k[:3] != cur:
+            if cur is not None:
+                print()
+            cur = k[:3]
+        inp, lvl, algo, payload = k
+        for r in rs:
+            cells = []
+            for d in ("compress", "decompress"):
+                ns = r[f"{d}_ns_median"]
+                over = (f"{ns - ref[f'{d}_ns_median']:>+9}" if ref and r is not ref
+                        else f"{'-':>9}")
+                cells.append(f"{ns:>9} {over}")
+            ok = "✓" if r.get("verified") else "✗"
+            print(f"  {inp:8} {algo:7} {lvl:>3} {payload:>6} {ffi_label(r):18} "
+                  f"{cells[0]} {cells[1]}  {ok:>2}")
+    print()
+
+
+# --------------------------------------------------------------------------- #
+# Startup
+# --------------------------------------------------------------------------- #
+
+
+def print_startup(data: dict) -> None:
+    """Time to first compress in a fresh process, cold and after cu_warmup,
+    against the same process's second call."""
+    recs = sorted((r for r in data["records"] if is_startup(r)),
+                  key=lambda r: (r["input_id"], r["algo"], r["level"], mode_of(r),
+                                 r["startup"] != "cold"))
+    if not recs:
+        return
+
+    def us(r, f):
+        ns = r.get(f"{f}_ns_median")
+        return f"{ns / 1e3:>9.1f}" if ns is not None else f"{'-':>9}"
+
+    print("  startup: µs, median of fresh processes; first = first compress call, "
+          "process = spawn → end of first call\n")
+    hdr = (f"  {'input':8} {'algo':7} {'lvl':>3} {'variant':16} "
+           f"{'first':>9} {'steady':>9} {'warmup':>9} {'process':>9}  {'ok':>2}")
+    print(hdr)
+    print("  " + "-" * (len(hdr) - 2))
+    for r in recs:
+        ok = "✓" if r.get("verified") else "✗"
+        # The variant plus any --numa / --huge-pages tag mode_of appends.
+        variant = r["startup"] + mode_of(r)[len("startup"):]
+        print(f"  {r['input_id']:8} {r['algo']:7} {r['level']:>3} {variant:16} "
+              f"{us(r, 'first')} {us(r, 'steady')} {us(r, 'warmup')} "
+              f"{us(r, 'process')}  {ok:>2}")
+    print()
+
+
+# --------------------------------------------------------------------------- #
+# Thread scaling
+# --------------------------------------------------------------------------- #
+
+
+def scaling_key(r: dict) -> tuple:
+    return (r["input_id"], r["algo"], r.get("impl", "compress-utils"),
+            mode_of(r), r["level"])
+
+
+def scaling_groups(recs: list[dict]) -> dict:
+    """Records measured at more than one thread count, grouped by spec and
+    sorted by threads."""
+    groups: dict = {}
+    for r in recs:
+        if not is_matrix(r):
+            continue
+        groups.setdefault(scaling_key(r), []).append(r)
+    return {k: sorted(v, key=lambda r: r.get("threads", 1))
+            for k, v in groups.items() if len({r.get("threads", 1) for r in v}) > 1}
+
+
+def efficiency(r: dict, base: dict, direction: str) -> float:
+    """Aggregate throughput at N threads ÷ (N/N0 × aggregate at the lowest
+    count N0, normally 1). 1.0 is linear scaling."""
+    t, t0 = r.get("threads", 1), base.get("threads", 1)
+    agg, agg0 = r[f"{direction}_mbps_aggregate"], base[f"{direction}_mbps_aggregate"]
+    return agg / (agg0 * t / t0) if agg0 else 0.0
+
+
+def print_scaling(data: dict) -> None:
+    groups = scaling_groups(data["records"])
+    if not groups:
+        return
+    print("  thread scaling: aggregate MB/s, per-thread MB/s, efficiency vs the "
+          "lowest thread count\n")
+    hdr = (f"  {'input':8} {'algo':7} {'mode':14} {'lvl':>3} {'thr':>3} "
+           f"{'c agg':>9} {'c/thr':>8} {'c eff':>6} {'d agg':>9} {'d/thr':>8} {'d eff':>6}")
+    print(hdr)
+    print("  " + "-" * (len(hdr) - 2))
+    for k in sorted(groups):
+        rs = groups[k]
+        base = rs[0]
+        for r in rs:
+            print(
+                f"  {r['input_id']:8} {r['algo']:7} {mode_of(r):14} "
+                f"{r['level']:>3} {r.get('threads', 1):>3} "
+                f"{r['compress_mbps_aggregate']:>9.1f} {r['compress_mbps']:>8.1f} "
+                f"{efficiency(r, base, 'compress'):>6.2f} "
+                f"{r['decompress_mbps_aggregate']:>9.1f} {r['decompress_mbps']:>8.1f} "
+                f"{efficiency(r, base, 'decompress'):>6.2f}"
+            )
+        print()
+
+
 # --------------------------------------------------------------------------- #
 # Plots
 # --------------------------------------------------------------------------- #
@@ -86,15 +468,27 @@ def make_plots(data: dict) -> None:
         return
 
     PLOTS_DIR.mkdir(parents=True, exist_ok=True)
-    recs = data["records"]
+    msg_recs = [r for r in data["records"] if is_msg(r)]
+    sweep = sweep_groups(data["records"])
+    ffi = ffi_groups(data["records"])
+    all_recs = [r for r in data["records"] if is_matrix(r)]
+    # The Pareto and bar charts compare codecs at one concurrency: the lowest
+    # thread count measured. Scaling gets its own plots below.
+    min_threads = min((r.get("threads", 1) for r in all_recs), default=1)
+    recs = [r for r in all_recs if r.get("threads", 1) == min_threads]
     inputs = sorted({r["input_id"] for r in recs})
     algos = sorted({r["algo"] for r in recs})
+    if not recs:
+        make_latency_plots(plt, msg_recs)
+        make_sweep_plots(plt, sweep)
+        make_ffi_plots(plt, ffi)
+        return
     cmap = {a: c for a, c in zip(algos, plt.cm.tab10.colors)}
     # Color encodes algorithm; line style encodes the (impl, mode) series, so a
     # native baseline or a streaming variant overlays its counterpart in the
     # same hue.
     def series_of(r: dict) -> tuple:
-        return (r.get("impl", "compress-utils"), r.get("mode", "oneshot"))
+        return (r.get("impl", "compress-utils"), mode_of(r))
 
     series = sorted({series_of(r) for r in recs})
     styles = ["-o", "--s", ":^", "-.D", "--o", ":s"]
@@ -173,6 +567,169 @@ def make_plots(data: dict) -> None:
         plt.close(fig)
         print(f"[report] wrote {out}")
 
+    # 3) Scaling per (input, impl, mode): aggregate throughput vs threads, one
+    #    line per (algo, level), color = algo, style = level; dotted grey is
+    #    linear scaling from the fastest line's first point.
+    groups = scaling_groups(all_recs)
+    level_styles = ["-o", "--s", ":^", "-.D", "--o", ":s"]
+    panels = sorted({(k[0], k[2], k[3]) for k in groups})
+    for inp, impl, mode in panels:
+        sub_groups = {k: v for k, v in groups.items() if (k[0], k[2], k[3]) == (inp, impl, mode)}
+        lvls = sorted({k[4] for k in sub_groups})
+        lstyle = {lv: level_styles[i % len(level_styles)] for i, lv in enumerate(lvls)}
+        colors = {a: c for a, c in zip(sorted({k[1] for k in sub_groups}), plt.cm.tab10.colors)}
+        fig, axes = plt.subplots(1, 2, figsize=(11, 4.5))
+        for ax, direction in zip(axes, ("compress", "decompress")):
+            peak = None
+            for k in sorted(sub_groups):
+                rs = sub_groups[k]
+                xs = [r.get("threads", 1) for r in rs]
+                ys = [r[f"{direction}_mbps_aggregate"] for r in rs]
+                ax.plot(xs, ys, lstyle[k[4]], color=colors[k[1]], markersize=4,
+                        label=f"{k[1]} L{k[4]}")
+                if peak is None or ys[0] / xs[0] > peak[1] / peak[0]:
+                    peak = (xs[0], ys[0], xs[-1])
+            if peak:
+                x0, y0, x1 = peak
+                ax.plot([x0, x1], [y0, y0 * x1 / x0], ":", color="grey", linewidth=1)
+            ax.set_xscale("log", base=2)
+            ax.set_yscale("log")
+            ticks = sorted({r.get("threads", 1) for v in sub_groups.values() for r in v})
+            ax.set_xticks(ticks)
+            ax.set_xticklabels([str(t) for t in ticks])
+            ax.set_xlabel("threads")
+            ax.set_ylabel(f"aggregate {direction} MB/s")
+            ax.grid(True, which="both", alpha=0.2)
+        axes[0].legend(fontsize=7)
+        who = "" if impl == "compress-utils" else f" ({impl})"
+        fig.suptitle(f"thread scaling — {inp}, {mode}{who}")
+        out = PLOTS_DIR / f"scaling-{inp}-{mode}{'' if not who else '-' + impl}.png"
+        fig.tight_layout()
+        fig.savefig(out, dpi=120)
+        plt.close(fig)
+        print(f"[report] wrote {out}")
+
+    make_latency_plots(plt, msg_recs)
+    make_sweep_plots(plt, sweep)
+    make_ffi_plots(plt, ffi)
+
+
+def make_latency_plots(plt, recs: list[dict]) -> None:
+    """4) Latency CDF per (input, algo, level, sizes), compress and decompress
+    side by side, one line per (impl, variant). HDR-style axes: x is the
+    percentile on a 1/(1-q) log scale so the tail gets room, y is latency."""
+    groups: dict = {}
+    for r in recs:
+        groups.setdefault(msg_key(r)[:4], []).append(r)
+    qticks = [0.5, 0.9, 0.99, 0.999, 0.9999]
+    styles = ["-", "--", ":", "-."]
+    for (inp, algo, sizes, lvl), rs in sorted(groups.items()):
+        rs.sort(key=msg_key)
+        impls = sorted({r.get("impl", "compress-utils") for r in rs})
+        colors = {i: c for i, c in zip(impls, plt.cm.tab10.colors)}
+        variants = sorted({r.get("msg_variant", "fresh") for r in rs})
+        vstyle = {v: styles[i % len(styles)] for i, v in enumerate(variants)}
+        fig, axes = plt.subplots(1, 2, figsize=(11, 4.5))
+        for ax, direction in zip(axes, ("compress", "decompress")):
+            for r in rs:
+                pts = [(q, ns) for ns, q in r.get(f"{direction}_cdf", []) if q < 1]
+                if not pts:
+                    continue
+                impl, var = r.get("impl", "compress-utils"), r.get("msg_variant", "fresh")
+                ax.plot([1 / (1 - q) for q, _ in pts], [ns / 1000 for _, ns in pts],
+                        vstyle[var], color=colors[impl], marker=".", label=f"{impl} {var}")
+            ax.set_xscale("log")
+            ax.set_yscale("log")
+            ax.set_xticks([1 / (1 - q) for q in qticks])
+            ax.set_xticklabels([f"{q * 100:g}%" for q in qticks])
+            ax.set_xlabel("percentile")
+            ax.set_ylabel(f"{direction} latency µs")
+            ax.grid(True, which="both", alpha=0.2)
+        axes[0].legend(fontsize=7)
+        fig.suptitle(f"per-message latency — {inp}, {algo} L{lvl}, {sizes} B")
+        out = PLOTS_DIR / f"latency-cdf-{inp}-{algo}-L{lvl}-{sizes}.png"
+        fig.tight_layout()
+        fig.savefig(out, dpi=120)
+        plt.close(fig)
+        print(f"[report] wrote {out}")
+
+
+def make_sweep_plots(plt, groups: dict) -> None:
+    """5) Throughput surface per (input, algo, impl, level): input chunk (x) ×
+    output buffer (y) heatmaps, compress and decompress side by side, each cell
+    annotated with MB/s and the bindings' 64K/64K cell outlined."""
+    for (inp, algo, impl, lvl), rs in sorted(groups.items()):
+        chunks = sorted({r["chunk_bytes"] for r in rs})
+        outs = sorted({r["out_chunk_bytes"] for r in rs})
+        at = {(r["chunk_bytes"], r["out_chunk_bytes"]): r for r in rs}
+        fig, axes = plt.subplots(1, 2, figsize=(5 + 1.4 * len(chunks), 1.2 + 0.6 * len(outs)))
+        for ax, direction in zip(axes, ("compress", "decompress")):
+            grid = [[at[(c, o)][f"{direction}_mbps"] if (c, o) in at else float("nan")
+                     for c in chunks] for o in outs]
+            im = ax.imshow(grid, origin="lower", aspect="auto", cmap="viridis")
+            for yi, row in enumerate(grid):
+                for xi, v in enumerate(row):
+                    if v == v:
+                        ax.text(xi, yi, f"{v:.0f}", ha="center", va="center", fontsize=7,
+                                color="white")
+            if BINDING_CHUNK in chunks and BINDING_OUT in outs:
+                ax.add_patch(plt.Rectangle((chunks.index(BINDING_CHUNK) - 0.5,
+                                            outs.index(BINDING_OUT) - 0.5), 1, 1,
+                                           fill=False, edgecolor="red", linewidth=1.5))
+            ax.set_xticks(range(len(chunks)))
+            ax.set_xticklabels([size_label(c) for c in chunks])
+            ax.set_yticks(range(len(outs)))
+            ax.set_yticklabels([size_label(o) for o in outs])
+            ax.set_xlabel("input chunk")
+            ax.set_ylabel("output buffer")
+            ax.set_title(f"{direction} MB/s")
+            fig.colorbar(im, ax=ax)
+        fig.suptitle(f"streaming sweep — {inp}, {algo} ({impl}) L{lvl}")
+        out = PLOTS_DIR / f"sweep-{inp}-{algo}-{impl}-L{lvl}.png"
+        fig.tight_layout()
+        fig.savefig(out, dpi=120)
+        plt.close(fig)
+        print(f"[report] wrote {out}")
+
+
+def make_ffi_plots(plt, groups: dict) -> None:
+    """6) Wrapper overhead per (input, level): ns/call above the raw C call,
+    one bar per binding for every (algo, payload), compress and decompress
+    stacked vertically."""
+    by_run: dict = {}
+    for (inp, lvl, algo, payload), (rs, ref) in groups.items():
+        if ref:
+            by_run.setdefault((inp, lvl), []).append(((algo, payload), rs, ref))
+    for (inp, lvl), cells in sorted(by_run.items()):
+        cells.sort(key=lambda c: c[0])
+        labels = sorted({ffi_label(r) for _, rs, ref in cells for r in rs if r is not ref})
+        if not labels:
+            continue
+        colors = {lb: c for lb, c in zip(labels, plt.cm.tab10.colors)}
+        width = 0.8 / len(labels)
+        fig, axes = plt.subplots(2, 1, figsize=(max(7, 0.9 * len(cells)), 7), sharex=True)
+        for ax, direction in zip(axes, ("compress", "decompress")):
+            for li, lb in enumerate(labels):
+                xs, ys = [], []
+                for xi, (_, rs, ref) in enumerate(cells):
+                    r = next((r for r in rs if ffi_label(r) == lb), None)
+                    if r is not None:
+                        xs.append(xi + (li - (len(labels) - 1) / 2) * width)
+                        ys.append(r[f"{direction}_ns_median"] - ref[f"{direction}_ns_median"])
+                ax.bar(xs, ys, width, color=colors[lb], label=lb)
+            ax.axhline(0, color="black", linewidth=0.5)
+            ax.set_ylabel(f"{direction} wrapper ns/call")
+            ax.grid(True, axis="y", alpha=0.3)
+        axes[1].set_xticks(range(len(cells)))
+        axes[1].set_xticklabels([f"{a}\n{p} B" for (a, p), _, _ in cells], fontsize=8)
+        axes[0].legend(fontsize=8)
+        fig.suptitle(f"binding call overhead vs the raw C call — {inp}, L{lvl}")
+        out = PLOTS_DIR / f"ffi-overhead-{inp}-L{lvl}.png"
+        fig.tight_layout()
+        fig.savefig(out, dpi=120)
+        plt.close(fig)
+        print(f"[report] wrote {out}")
+
 
 # --------------------------------------------------------------------------- #
 # Regression
@@ -180,8 +737,17 @@ def make_plots(data: dict) -> None:
 
 
 def key(r: dict) -> tuple:
-    return (r["input_id"], r["algo"], r.get("impl", "compress-utils"),
-            r.get("mode", "oneshot"), r["level"])
+    return (r["input_id"], r["algo"], r.get("lang", ""), r.get("impl", "compress-utils"),
+            mode_of(r), r["level"], r.get("threads", 1))
+
+
+def speed(r: dict, direction: str) -> float:
+    """Higher is better: MB/s, or calls/s for ffi records (whose payload may be
+    empty, so MB/s would be 0)."""
+    if is_ffi(r):
+        ns = r[f"{direction}_ns_median"]
+        return 1e9 / ns if ns else 0.0
+    return r[f"{direction}_mbps"]
 
 
 def regress(new: dict, base: dict) -> int:
@@ -197,22 +763,29 @@ def regress(new: dict, base: dict) -> int:
 
     print(f"\n  regression: {bm['git_sha']} → {nm['git_sha']}")
     print(f"  flag if ratio ↓ >{RATIO_DROP_PCT}% or speed ↓ >{SPEED_DROP_PCT}%\n")
-    hdr = f"  {'input':8} {'algo':7} {'lvl':>3} {'Δratio%':>9} {'Δc%':>8} {'Δd%':>8}  flag"
+    multi_threads = len({r.get("threads", 1) for r in new["records"]}) > 1
+    multi_mode = len({mode_of(r) for r in new["records"]}) > 1
+    multi_drv = len({ffi_label(r) for r in new["records"]}) > 1
+    thr_col = f" {'thr':>3}" if multi_threads else ""
+    mode_col = f" {'mode':20}" if multi_mode else ""
+    drv_col = f" {'driver':18}" if multi_drv else ""
+    hdr = (f"  {'input':8} {'algo':7}{drv_col}{mode_col} {'lvl':>3}{thr_col} "
+           f"{'Δratio%':>9} {'Δc%':>8} {'Δd%':>8}  flag")
     print(hdr)
     print("  " + "-" * (len(hdr) - 2))
 
     regressions = 0
     for r in sorted(new["records"], key=key):
         b = bidx.get(key(r))
-        if not b:
+        if not b or is_startup(r):
             continue
 
         def pct(new_v, old_v):
             return (new_v - old_v) / old_v * 100 if old_v else 0.0
 
         dr = pct(r["ratio"], b["ratio"])
-        dc = pct(r["compress_mbps"], b["compress_mbps"])
-        dd = pct(r["decompress_mbps"], b["decompress_mbps"])
+        dc = pct(speed(r, "compress"), speed(b, "compress"))
+        dd = pct(speed(r, "decompress"), speed(b, "decompress"))
 
         flags = []
         if dr < -RATIO_DROP_PCT:
@@ -223,8 +796,11 @@ def regress(new: dict, base: dict) -> int:
             flags.append("DSPEED")
         if flags:
             regressions += 1
+        thr_cell = f" {r.get('threads', 1):>3}" if multi_threads else ""
+        mode_cell = f" {mode_of(r):20}" if multi_mode else ""
+        drv_cell = f" {ffi_label(r):18}" if multi_drv else ""
         print(
-            f"  {r['input_id']:8} {r['algo']:7} {r['level']:>3} "
+            f"  {r['input_id']:8} {r['algo']:7}{drv_cell}{mode_cell} {r['level']:>3}{thr_cell} "
             f"{dr:>+9.2f} {dc:>+8.1f} {dd:>+8.1f}  {','.join(flags)}"
         )
 
@@ -256,6 +832,13 @@ def main() -> None:
         sys.exit(1 if regress(data, base) else 0)
 
     print_table(data)
+    print_counters(data)
+    print_memory(data)
+    print_latency(data)
+    print_sweep(data)
+    print_ffi(data)
+    print_startup(data)
+    print_scaling(data)
     if not args.no_plots:
         make_plots(data)
 
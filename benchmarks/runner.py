@@ -16,6 +16,13 @@ Usage:
     python3 benchmarks/runner.py                          # c driver, default matrix
     python3 benchmarks/runner.py --drivers c,c-baseline     # binding + C baseline
     python3 benchmarks/runner.py --algos zstd,brotli --levels 1,9 --samples 9
+    python3 benchmarks/runner.py --threads 1,2,4,8 --modes oneshot,parallel
+    python3 benchmarks/runner.py --threads 8,16,32 --modes parallel --numa node0,on,off
+    python3 benchmarks/runner.py --algos xz,zstd,brotli --levels 9,10 --huge-pages off,on
+    python3 benchmarks/runner.py --drivers c,c-baseline --modes msg --msg-sizes 256-16384,1024
+    python3 benchmarks/runner.py --modes sweep --algos zstd,lz4 --levels 3 --sweep-out 4K,64K
+    python3 benchmarks/runner.py --drivers c,python,go,wasm --modes ffi --levels 1
+    python3 benchmarks/runner.py --modes startup --corpus prod-small --levels 1,6
 """
 
 from __future__ import annotations
@@ -23,8 +30,10 @@ from __future__ import annotations
 import argparse
 import json
 import os
+import shutil
 import subprocess
 import sys
+import time
 from pathlib import Path
 
 sys.path.insert(0, str(Path(__file__).resolve().parent / "lib"))
@@ -68,39 +77,53 @@ def _baseline_paths() -> tuple[Path, Path]:
 
 
 def _compile(src: Path, out: Path, cflags: list[str], ldflags: list[str]) -> Path:
-    deps = [src, DRIVER_DIR / "bench_harness.h"]
-    if out.exists() and all(out.stat().st_mtime >= d.stat().st_mtime for d in deps):
+    deps = [src, *DRIVER_DIR.glob("bench_*.h")]
+    cmd = ["cc", "-O2", "-std=c11", "-pthread", f"-I{DRIVER_DIR}", *cflags, str(src), "-o",
+           str(out), *ldflags]
+    # The command is stamped next to the binary, so a flag change rebuilds it.
+    stamp = out.with_name(out.name + ".cmd")
+    if (out.exists() and all(out.stat().st_mtime >= d.stat().st_mtime for d in deps)
+            and stamp.exists() and stamp.read_text() == " ".join(cmd)):
         return out
-    cmd = ["cc", "-O2", "-std=c11", f"-I{DRIVER_DIR}", *cflags, str(src), "-o", str(out), *ldflags]
     print(f"[runner] compiling {out.name}: {' '.join(cmd)}")
     subprocess.run(cmd, check=True)
+    stamp.write_text(" ".join(cmd))
     return out
 
 
 # A driver builder returns the argv used to launch it (so C drivers are a
 # compiled binary, the WASM driver is `node <script>`, future drivers whatever).
+#
+# The C drivers build twice. The timing binary leaves out bench_alloc.h's
+# interposer, so timed calls run glibc's own malloc and memcpy. The `alloc`
+# binary (bench_mem, bench_baseline_mem) keeps it and only runs the memory
+# pass (see run_interleaved).
 
 
-def build_c() -> list[str]:
+def _alloc_flags(alloc: bool) -> list[str]:
+    return [] if alloc else ["-DBENCH_NO_ALLOC_TRACKING"]
+
+
+def build_c(alloc: bool = False) -> list[str]:
     lib, inc = _cu_paths()
     out = _compile(
         DRIVER_DIR / "bench.c",
-        DRIVER_DIR / "bench",
-        cflags=[f"-I{inc}"],
+        DRIVER_DIR / ("bench_mem" if alloc else "bench"),
+        cflags=[f"-I{inc}", *_alloc_flags(alloc)],
         ldflags=[f"-L{lib}", "-lcompress_utils", f"-Wl,-rpath,{lib}"],
     )
     return [str(out)]
 
 
-def build_c_baseline() -> list[str]:
+def build_c_baseline(alloc: bool = False) -> list[str]:
     lib, inc = _baseline_paths()
     # brotli enc/dec depend on common → list common last for picky linkers.
     libs = ["-lzstd", "-lbrotlienc", "-lbrotlidec", "-lbrotlicommon",
             "-lbz2_static", "-llz4", "-llzma", "-lz"]
     out = _compile(
         DRIVER_DIR / "bench_baseline.c",
-        DRIVER_DIR / "bench_baseline",
-        cflags=[f"-I{inc}"],
+        DRIVER_DIR / ("bench_baseline_mem" if alloc else "bench_baseline"),
+        cflags=[f"-I{inc}", *_alloc_flags(alloc)],
         ldflags=[f"-L{lib}", *libs],
     )
     return [str(out)]
@@ -150,6 +173,13 @@ DRIVERS = {
     "go": build_go,
 }
 
+# Drivers with a separate allocation-tracking build, called as builder(alloc=True).
+MEM_DRIVERS = {"c": build_c, "c-baseline": build_c_baseline}
+
+# Record fields that come from the memory pass rather than the timed run.
+MEM_FIELDS = ("_heap_peak_bytes", "_alloc_bytes", "_allocs", "_memcpy_bytes",
+              "_rss_hwm_bytes")
+
 
 def driver_info(argv: list[str]) -> dict:
     out = subprocess.run([*argv, "--info"], capture_output=True, text=True, check=True)
@@ -161,6 +191,41 @@ def driver_info(argv: list[str]) -> dict:
 # --------------------------------------------------------------------------- #
 
 
+MSG_VARIANTS = ["fresh", "reuse", "dict"]
+SWEEP_CHUNKS = "1K,4K,16K,64K,256K,1M,4M"
+SWEEP_OUT = "4K,16K,64K,256K,1M"
+FFI_SIZES = "0,64,1024"
+
+
+def parse_size(text: str) -> int:
+    """"4096", "4K", "1M" → bytes (binary multiples)."""
+    t = text.strip().upper()
+    mult = {"K": 1 << 10, "M": 1 << 20, "G": 1 << 30}.get(t[-1:], 1)
+    n = int(t[:-1] if mult > 1 else t)
+    if n < 1:
+        raise ValueError(text)
+    return n * mult
+
+
+def expand_modes(modes: list[str], variants: list[str], sizes: list[str],
+                 sweep_chunks: list[int] = (), sweep_out: list[int] = (),
+                 ffi_sizes: list[int] = ()) -> list[str]:
+    """Replace "msg" with one "msg:<variant>:<sizes>" job mode per combination,
+    "sweep" with one "stream:<chunk>:<out_chunk>" per input chunk × output
+    window, and "ffi" with one "ffi:<bytes>" per payload size."""
+    out = []
+    for m in modes:
+        if m == "msg":
+            out += [f"msg:{v}:{z}" for z in sizes for v in variants]
+        elif m == "sweep":
+            out += [f"stream:{c}:{o}" for c in sweep_chunks for o in sweep_out]
+        elif m == "ffi":
+            out += [f"ffi:{n}" for n in ffi_sizes]
+        else:
+            out.append(m)
+    return out
+
+
 def build_jobs(datasets: list[dict], algos: list[str], levels: list[int],
                modes: list[str]) -> list[tuple]:
     jobs = []
@@ -182,6 +247,45 @@ def build_jobs(datasets: list[dict], algos: list[str], levels: list[int],
 # (warmup+samples) iterations is legitimately slow.
 JOB_TIMEOUT_S = 1800
 
+# --numa placements. "on" leaves the library's NUMA placement to run as it
+# would in production, "off" disables it (CU_NUMA=0: one shared queue, no
+# pinning), and "node<N>" confines the whole driver to node N's CPUs (and
+# memory, when numactl is installed) — the one-socket baseline.
+NUMA_SYSFS = Path("/sys/devices/system/node")
+
+
+def parse_cpulist(text: str) -> set[int]:
+    cpus: set[int] = set()
+    for part in text.strip().split(","):
+        if not part:
+            continue
+        lo, _, hi = part.partition("-")
+        cpus.update(range(int(lo), int(hi or lo) + 1))
+    return cpus
+
+
+def numa_launch(placement: str, argv: list[str]) -> tuple[list[str], dict, object]:
+    """(argv, extra env, preexec_fn) that run a driver under `placement`."""
+    if placement == "on":
+        return argv, {}, None
+    if placement == "off":
+        return argv, {"CU_NUMA": "0"}, None
+    node = int(placement[4:])
+    if shutil.which("numactl"):
+        return ["numactl", f"--cpunodebind={node}", f"--membind={node}", *argv], {}, None
+    cpus = parse_cpulist((NUMA_SYSFS / f"node{node}" / "cpulist").read_text())
+    return argv, {}, lambda: os.sched_setaffinity(0, cpus)
+
+
+def huge_pages_env(setting: str) -> dict:
+    """CU_HUGE_PAGES for a --huge-pages setting: off, on (the library's default
+    threshold) or a threshold size such as 2M."""
+    if setting == "off":
+        return {"CU_HUGE_PAGES": "0"}
+    if setting == "on":
+        return {"CU_HUGE_PAGES": "1"}
+    return {"CU_HUGE_PAGES": str(parse_size(setting))}
+
 
 def keep_awake() -> None:
     """On macOS, prevent sleep for the lifetime of this process. A sleeping
@@ -205,30 +309,107 @@ def _read_line(proc: subprocess.Popen, timeout: float) -> str | None:
     return proc.stdout.readline()
 
 
+def _mem_pass(entry: list, line: str, key: str) -> dict:
+    """Send one job line to a memory-pass process (entry is [proc, dead]) and
+    return the memory fields of its record; {} if it skipped, failed or died."""
+    p = entry[0]
+    if entry[1] or p.poll() is not None:
+        entry[1] = True
+        return {}
+    try:
+        p.stdin.write(line)
+        p.stdin.flush()
+    except BrokenPipeError:
+        entry[1] = True
+        return {}
+    out = _read_line(p, JOB_TIMEOUT_S)
+    if out is None:
+        print(f"[runner] {key}: memory pass timed out ({line.strip()}); killing it",
+              file=sys.stderr)
+        p.kill()
+        entry[1] = True
+        return {}
+    out = out.strip()
+    if not out:
+        return {}
+    rec = json.loads(out)
+    return {k: v for k, v in rec.items() if k.endswith(MEM_FIELDS)}
+
+
 def run_interleaved(built: list[tuple], jobs: list[tuple], samples: int, warmup: int,
-                    chunk: int, checkpoint=None) -> list[dict]:
+                    chunk: int, threads: int = 1, checkpoint=None,
+                    messages: int = 2000, calls: int = 20000,
+                    numa: str | None = None, huge_pages: str | None = None,
+                    mem: dict | None = None) -> list[dict]:
     """Run every driver on each job spec back-to-back, so all impls are measured
     in the same thermal window. Drivers are persistent processes; the protocol
     is line-synchronous (one job line in → exactly one result/marker line out),
     which is why the drivers emit skip/error markers.
 
-    `built` is a list of (key, info, binary). `checkpoint(records)` is called
-    periodically so a long run is never all-or-nothing.
+    `built` is a list of (key, info, binary). `threads` is passed as
+    BENCH_THREADS; drivers whose --info lacks "threads" only get one-thread,
+    non-parallel jobs. Small-message jobs go only to drivers whose --info has
+    "messages", and only at one thread (they measure single-caller latency).
+    Sweep jobs ("stream:<chunk>:<out_chunk>") likewise need "sweep", and
+    call-overhead jobs ("ffi:<bytes>", `calls` calls per sample) need "ffi";
+    both run at one thread.
+    `numa` (a --numa placement) launches the drivers under it and tags
+    each record with it; None runs them as-is. `huge_pages` (a --huge-pages
+    setting) likewise sets CU_HUGE_PAGES for the drivers and tags records.
+    `mem` maps a driver key to the argv of its allocation-tracking build. That
+    process gets each of the driver's oneshot, stream, parallel and sweep jobs
+    again, at one sample and no warmup, and its memory fields (MEM_FIELDS) are
+    merged into the timed record. The timed run never pays for the counting.
+    `checkpoint(records)` is called periodically so a long run is never
+    all-or-nothing.
     """
     env = {**os.environ, "BENCH_SAMPLES": str(samples), "BENCH_WARMUP": str(warmup),
-           "BENCH_CHUNK": str(chunk)}
+           "BENCH_CHUNK": str(chunk), "BENCH_THREADS": str(threads),
+           "BENCH_MESSAGES": str(messages), "BENCH_CALLS": str(calls),
+           **(huge_pages_env(huge_pages) if huge_pages else {})}
     procs = []
-    for key, _info, argv in built:
+    for key, info, argv in built:
+        if threads != 1 and not info.get("threads"):
+            continue
+        argv, numa_env, preexec = numa_launch(numa, argv) if numa else (argv, {}, None)
         p = subprocess.Popen(argv, stdin=subprocess.PIPE, stdout=subprocess.PIPE,
-                             text=True, bufsize=1, env=env)
-        procs.append([key, p, False])  # [key, proc, dead]
+                             text=True, bufsize=1, env={**env, **numa_env},
+                             preexec_fn=preexec)
+        # [key, proc, dead, mt, msg, sweep, ffi]
+        procs.append([key, p, False, bool(info.get("threads")), bool(info.get("messages")),
+                      bool(info.get("sweep")), bool(info.get("ffi"))])
+    # key -> [proc, dead], one memory-pass process per timed driver that has one.
+    mem_procs: dict = {}
+    mem_env = {**env, "BENCH_SAMPLES": "1", "BENCH_WARMUP": "0"}
+    for key, *_ in procs:
+        if key not in (mem or {}):
+            continue
+        argv, numa_env, preexec = numa_launch(numa, mem[key]) if numa else (mem[key], {}, None)
+        mem_procs[key] = [subprocess.Popen(argv, stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                           text=True, bufsize=1, env={**mem_env, **numa_env},
+                                           preexec_fn=preexec), False]
 
     records: list[dict] = []
     try:
         for i, (a, lvl, mode, path, ds_id) in enumerate(jobs):
             line = f"{a} {lvl} {mode} {path}\n"
+            is_msg = mode.startswith("msg:")
+            is_sweep = mode.startswith("stream:")
+            is_ffi = mode.startswith("ffi:")
+            if mode == "startup":
+                continue  # one fresh process per sample: run_startup
+            if (is_msg or is_sweep or is_ffi) and threads != 1:
+                continue
             for entry in procs:
-                key, p, dead = entry
+                key, p, dead, mt, msg, sweep, ffi = entry
+                if mode == "parallel" and not mt:
+                    continue
+                if is_msg and not msg:
+                    continue
+                if is_sweep and not sweep:
+                    continue
+                if is_ffi and not ffi:
+                    continue
                 if dead or p.poll() is not None:
                     entry[2] = True
                     continue
@@ -252,11 +433,17 @@ def run_interleaved(built: list[tuple], jobs: list[tuple], samples: int, warmup:
                 if rec.get("skipped") or rec.get("error"):
                     continue
                 rec["input_id"] = ds_id
+                if numa:
+                    rec["numa"] = numa
+                if huge_pages:
+                    rec["huge_pages"] = huge_pages
+                if key in mem_procs and not (is_msg or is_ffi):
+                    rec.update(_mem_pass(mem_procs[key], line, key))
                 records.append(rec)
             if checkpoint and (i + 1) % 64 == 0:
                 checkpoint(records)
     finally:
-        for key, p, _dead in procs:
+        for key, p, *_ in [*procs, *([k, e[0]] for k, e in mem_procs.items())]:
             try:
                 if p.stdin and not p.stdin.closed:
                     p.stdin.close()
@@ -269,6 +456,65 @@ def run_interleaved(built: list[tuple], jobs: list[tuple], samples: int, warmup:
     return records
 
 
+STARTUP_VARIANTS = ["cold", "warm"]
+STARTUP_FIELDS = ["first_ns", "steady_ns", "warmup_ns", "process_ns"]
+
+
+def run_startup(built: list[tuple], jobs: list[tuple], samples: int,
+                numa: str | None = None, huge_pages: str | None = None) -> list[dict]:
+    """Time-to-first-compress. Unlike run_interleaved, every sample is a fresh
+    driver process (`--startup <variant> <algo> <level> <path>`) timing its
+    first compress call and a second, steady-state one; "warm" calls cu_warmup
+    first. Only drivers whose --info has "startup" take these jobs.
+
+    BENCH_SPAWN_NS is stamped just before the spawn, so process_ns (spawn to
+    end of the first call) also covers exec, dynamic loading and the read of
+    the input. One record per job × variant, with medians over the samples.
+    """
+    env = {**os.environ, **(huge_pages_env(huge_pages) if huge_pages else {})}
+    records: list[dict] = []
+    for key, info, argv in built:
+        if not info.get("startup"):
+            continue
+        argv, numa_env, preexec = numa_launch(numa, argv) if numa else (argv, {}, None)
+        for a, lvl, mode, path, ds_id in jobs:
+            if mode != "startup":
+                continue
+            for variant in STARTUP_VARIANTS:
+                runs = []
+                for _ in range(samples):
+                    spawn_env = {**env, **numa_env, "BENCH_SPAWN_NS": str(time.monotonic_ns())}
+                    try:
+                        p = subprocess.run([*argv, "--startup", variant, a, str(lvl), path],
+                                           capture_output=True, text=True, env=spawn_env,
+                                           preexec_fn=preexec, timeout=JOB_TIMEOUT_S)
+                    except subprocess.TimeoutExpired:
+                        print(f"[runner] {key}: startup job timed out ({a} L{lvl} {variant})",
+                              file=sys.stderr)
+                        break
+                    rec = json.loads(p.stdout) if p.returncode == 0 and p.stdout.strip() else None
+                    if not rec or rec.get("skipped") or rec.get("error"):
+                        break
+                    runs.append(rec)
+                if not runs:
+                    continue
+                rec = dict(runs[0])
+                for f in STARTUP_FIELDS:
+                    rec.pop(f, None)
+                    vals = sorted(r[f] for r in runs if f in r)
+                    if vals:
+                        rec[f"{f}_median"] = vals[len(vals) // 2]
+                rec["samples"] = len(runs)
+                rec["verified"] = all(r.get("verified") for r in runs)
+                rec["input_id"] = ds_id
+                if numa:
+                    rec["numa"] = numa
+                if huge_pages:
+                    rec["huge_pages"] = huge_pages
+                records.append(rec)
+    return records
+
+
 def main() -> None:
     ap = argparse.ArgumentParser(description="compress-utils benchmark runner")
     ap.add_argument("--drivers", default="c",
@@ -277,11 +523,39 @@ def main() -> None:
                     help=f"comma-separated corpus tiers ({', '.join(corpora.TIERS)}, all)")
     ap.add_argument("--algos", default=",".join(ALL_ALGOS), help="comma-separated algorithms")
     ap.add_argument("--levels", default=",".join(map(str, DEFAULT_LEVELS)),
-                    help="comma-separated levels (1..10)")
+                    help="comma-separated levels (-5..10; 0 and below are speed tiers, pass as --levels=-1,1)")
     ap.add_argument("--modes", default="oneshot",
-                    help="comma-separated modes: oneshot, stream")
+                    help="comma-separated modes: oneshot, stream, parallel, msg, sweep, ffi, "
+                         "startup")
     ap.add_argument("--chunk", type=int, default=64 * 1024,
                     help="streaming chunk size in bytes (stream mode only)")
+    ap.add_argument("--threads", default="1",
+                    help="comma-separated thread counts: concurrent callers for "
+                         "oneshot/stream, library workers for parallel")
+    ap.add_argument("--numa", default=None,
+                    help="comma-separated NUMA placements, each a full pass: on (library "
+                         "placement), off (CU_NUMA=0), node<N> (driver confined to node N). "
+                         "With --modes parallel this shows scaling across sockets")
+    ap.add_argument("--huge-pages", default=None,
+                    help="comma-separated huge-page settings, each a full pass: off, on "
+                         "(CU_HUGE_PAGES=1, default threshold) or a threshold size (2M). "
+                         "Matters for xz/zstd/brotli at their top levels")
+    ap.add_argument("--msg-variants", default=",".join(MSG_VARIANTS),
+                    help="msg mode: comma-separated variants (fresh, reuse, dict)")
+    ap.add_argument("--msg-sizes", default="256-16384",
+                    help="msg mode: comma-separated message sizes, each N bytes or a "
+                         "log-uniform LO-HI range")
+    ap.add_argument("--messages", type=int, default=2000,
+                    help="msg mode: messages per job (each sample is one pass over them)")
+    ap.add_argument("--sweep-chunks", default=SWEEP_CHUNKS,
+                    help="sweep mode: comma-separated input chunk sizes (K/M suffixes)")
+    ap.add_argument("--sweep-out", default=SWEEP_OUT,
+                    help="sweep mode: comma-separated output buffer sizes offered per "
+                         "stream call (K/M suffixes)")
+    ap.add_argument("--ffi-sizes", default=FFI_SIZES,
+                    help="ffi mode: comma-separated payload sizes in bytes (K suffix ok)")
+    ap.add_argument("--ffi-calls", type=int, default=20000,
+                    help="ffi mode: back-to-back calls per sample")
     ap.add_argument("--samples", type=int, default=5)
     ap.add_argument("--warmup", type=int, default=1)
     args = ap.parse_args()
@@ -294,23 +568,89 @@ def main() -> None:
     levels = [int(x) for x in args.levels.split(",") if x.strip()]
     modes = [m.strip() for m in args.modes.split(",") if m.strip()]
     for m in modes:
-        if m not in ("oneshot", "stream"):
-            sys.exit(f"error: unknown mode '{m}'. Known: oneshot, stream")
+        if m not in ("oneshot", "stream", "parallel", "msg", "sweep", "ffi", "startup"):
+            sys.exit(f"error: unknown mode '{m}'. "
+                     f"Known: oneshot, stream, parallel, msg, sweep, ffi, startup")
+    msg_variants = [v.strip() for v in args.msg_variants.split(",") if v.strip()]
+    for v in msg_variants:
+        if v not in MSG_VARIANTS:
+            sys.exit(f"error: unknown msg variant '{v}'. Known: {', '.join(MSG_VARIANTS)}")
+    msg_sizes = [z.strip() for z in args.msg_sizes.split(",") if z.strip()]
+    if args.messages < 1:
+        sys.exit("error: --messages takes a positive integer")
+    try:
+        sweep_chunks = [parse_size(z) for z in args.sweep_chunks.split(",") if z.strip()]
+        sweep_out = [parse_size(z) for z in args.sweep_out.split(",") if z.strip()]
+    except ValueError as e:
+        sys.exit(f"error: bad sweep size {e}")
+    try:
+        # 0 is a valid payload here (the empty-input call), unlike a buffer size.
+        ffi_sizes = [0 if z.strip() == "0" else parse_size(z)
+                     for z in args.ffi_sizes.split(",") if z.strip()]
+    except ValueError as e:
+        sys.exit(f"error: bad ffi size {e}")
+    if args.ffi_calls < 1:
+        sys.exit("error: --ffi-calls takes a positive integer")
+    modes = expand_modes(modes, msg_variants, msg_sizes, sweep_chunks, sweep_out, ffi_sizes)
+    thread_counts = [int(x) for x in args.threads.split(",") if x.strip()]
+    if not thread_counts or min(thread_counts) < 1:
+        sys.exit("error: --threads takes positive integers")
+    placements: list = [None]
+    if args.numa:
+        placements = [p.strip() for p in args.numa.split(",") if p.strip()]
+        for p in placements:
+            if p in ("on", "off"):
+                continue
+            if not (p.startswith("node") and p[4:].isdigit()):
+                sys.exit(f"error: unknown NUMA placement '{p}'. Known: on, off, node<N>")
+            if not (NUMA_SYSFS / p / "cpulist").exists():
+                sys.exit(f"error: --numa {p}: no such node on this host")
+    hp_settings: list = [None]
+    if args.huge_pages:
+        hp_settings = [h.strip() for h in args.huge_pages.split(",") if h.strip()]
+        for h in hp_settings:
+            try:
+                huge_pages_env(h)
+            except ValueError:
+                sys.exit(f"error: unknown huge-page setting '{h}'. Known: off, on, <size>")
 
     datasets = corpora.resolve(args.corpus)
     jobs = build_jobs(datasets, algos, levels, modes)
 
     # Build every driver up front so they run interleaved per spec.
     built: list[tuple] = []
+    mem: dict = {}
     driver_meta: list[dict] = []
     for key in driver_keys:
         argv = DRIVERS[key]()
         info = driver_info(argv)
         built.append((key, info, argv))
+        if key in MEM_DRIVERS:
+            mem_argv = MEM_DRIVERS[key](alloc=True)
+            if driver_info(mem_argv).get("alloc"):
+                mem[key] = mem_argv
         driver_meta.append({"key": key, "lang": info["lang"], "version": info["version"]})
+        if thread_counts != [1] and not info.get("threads"):
+            print(f"[runner] {key}: no threads support; runs at 1 thread, no parallel mode",
+                  file=sys.stderr)
+        if any(m.startswith("msg:") for m in modes) and not info.get("messages"):
+            print(f"[runner] {key}: no small-message support; msg jobs skipped",
+                  file=sys.stderr)
+        if any(m.startswith("stream:") for m in modes) and not info.get("sweep"):
+            print(f"[runner] {key}: no sweep support; sweep jobs skipped", file=sys.stderr)
+        if any(m.startswith("ffi:") for m in modes) and not info.get("ffi"):
+            print(f"[runner] {key}: no call-overhead support; ffi jobs skipped",
+                  file=sys.stderr)
+        if "startup" in modes and not info.get("startup"):
+            print(f"[runner] {key}: no startup support; startup jobs skipped",
+                  file=sys.stderr)
 
     meta = bc.RunMeta(drivers=driver_meta, corpus=args.corpus, chunk=args.chunk,
-                      samples=args.samples, warmup=args.warmup)
+                      samples=args.samples, warmup=args.warmup, threads=thread_counts,
+                      numa=placements if args.numa else [],
+                      huge_pages=hp_settings if args.huge_pages else [],
+                      messages=args.messages if any(m.startswith("msg:") for m in modes) else 0,
+                      calls=args.ffi_calls if any(m.startswith("ffi:") for m in modes) else 0)
     stamp = meta.timestamp.replace(":", "").replace("-", "")[:15]
     corpus_tag = args.corpus.replace(",", "+")
     fname = f"{stamp}-{'+'.join(driver_keys)}-{corpus_tag}-{meta.git_sha}.json"
@@ -318,12 +658,25 @@ def main() -> None:
 
     print(f"[runner] drivers={','.join(driver_keys)}  {len(jobs)} specs × {len(built)} drivers "
           f"({len(datasets)} inputs × {len(algos)} algos × {len(levels)} levels × "
-          f"{len(modes)} modes), {args.samples} samples + {args.warmup} warmup")
+          f"{len(modes)} modes), {args.samples} samples + {args.warmup} warmup"
+          + (f", threads {','.join(map(str, thread_counts))}" if thread_counts != [1] else ""))
 
     keep_awake()
-    # Checkpoint progressively so a long run is never all-or-nothing.
-    checkpoint = lambda recs: bc.save_results(meta, recs, path)  # noqa: E731
-    all_records = run_interleaved(built, jobs, args.samples, args.warmup, args.chunk, checkpoint)
+    # Checkpoint progressively so a long run is never all-or-nothing. Huge-page
+    # settings, NUMA placements and thread counts run one after another, each
+    # with fresh driver processes.
+    all_records: list[dict] = []
+    for hp in hp_settings:
+        for numa in placements:
+            for t in thread_counts:
+                done = list(all_records)
+                checkpoint = lambda recs: bc.save_results(meta, done + recs, path)  # noqa: E731
+                all_records = done + run_interleaved(built, jobs, args.samples, args.warmup,
+                                                     args.chunk, t, checkpoint, args.messages,
+                                                     args.ffi_calls, numa, hp, mem)
+            if "startup" in modes:
+                all_records += run_startup(built, jobs, args.samples, numa, hp)
+                bc.save_results(meta, all_records, path)
     path = bc.save_results(meta, all_records, path)
 
     n_bad = sum(1 for r in all_records if not r.get("verified", False))
@@ -0,0 +1,354 @@
+/*
+ * cli_io.c — see cli_io.h.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  /* O_DIRECT, copy_file_range */
+#endif
+
+#include "cli_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+#ifndef O_DIRECT
+#define O_DIRECT 0
+#endif
+
+/* read() fallback granularity when the caller asks for less. */
+#define CLI_READ_MIN ((size_t)64 << 10)
+
+static size_t round_up(size_t n, size_t a) { return (n + a - 1) / a * a; }
+
+/* ============================================================================
+ * Input
+ * ============================================================================ */
+
+int cli_input_open(cli_input_t* in, const char* path) {
+    memset(in, 0, sizeof(*in));
+    if (!path || strcmp(path, "-") == 0) {
+        in->name = "<stdin>";
+        in->fd = STDIN_FILENO;
+        in->is_stdin = 1;
+    } else {
+        in->name = path;
+        in->fd = open(path, O_RDONLY);
+        if (in->fd < 0) {
+            fprintf(stderr, "cu: %s: %s\n", path, strerror(errno));
+            return -1;
+        }
+    }
+
+    struct stat st;
+    if (fstat(in->fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0
+        && (uint64_t)st.st_size <= (uint64_t)SIZE_MAX) {
+        void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, in->fd, 0);
+        if (p != MAP_FAILED) {
+            in->map = p;
+            in->size = (size_t)st.st_size;
+#ifdef MADV_SEQUENTIAL
+            madvise(in->map, in->size, MADV_SEQUENTIAL);
+#endif
+        }
+    }
+    return 0;
+}
+
+void cli_input_close(cli_input_t* in) {
+    if (in->map) munmap(in->map, in->size);
+    if (!in->is_stdin && in->fd >= 0) close(in->fd);
+    free(in->buf);
+    memset(in, 0, sizeof(*in));
+    in->fd = -1;
+}
+
+/* Read until buf holds at least `want` unconsumed bytes or EOF. */
+static int fill(cli_input_t* in, size_t want) {
+    if (in->buf_off) {
+        memmove(in->buf, in->buf + in->buf_off, in->buf_len - in->buf_off);
+        in->buf_len -= in->buf_off;
+        in->buf_off = 0;
+    }
+    if (want < CLI_READ_MIN) want = CLI_READ_MIN;
+    if (in->buf_cap < want) {
+        uint8_t* nb = realloc(in->buf, want);
+        if (!nb) {
+            fprintf(stderr, "cu: %s: out of memory\n", in->name);
+            return -1;
+        }
+        in->buf = nb;
+        in->buf_cap = want;
+    }
+    while (!in->eof && in->buf_len < want) {
+        ssize_t r = read(in->fd, in->buf + in->buf_len, in->buf_cap - in->buf_len);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "cu: %s: %s\n", in->name, strerror(errno));
+            return -1;
+        }
+        if (r == 0) in->eof = 1;
+        in->buf_len += (size_t)r;
+    }
+    return 0;
+}
+
+int cli_input_next(cli_input_t* in, size_t want, const uint8_t** data, size_t* len) {
+    if (in->map) {
+        size_t n = in->size - in->pos < want ? in->size - in->pos : want;
+        *data = in->map + in->pos;
+        *len = n;
+        in->pos += n;
+        return 0;
+    }
+    if (in->buf_len - in->buf_off < want && !in->eof) {
+        if (fill(in, want) != 0) return -1;
+    }
+    size_t have = in->buf_len - in->buf_off;
+    size_t n = have < want ? have : want;
+    *data = in->buf + in->buf_off;
+    *len = n;
+    in->buf_off += n;
+    in->pos += n;
+    return 0;
+}
+
+void cli_input_release(cli_input_t* in) {
+#ifdef MADV_DONTNEED
+    if (!in->map) return;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t end = in->pos / page * page;
+    if (end > in->released) {
+        madvise(in->map + in->released, end - in->released, MADV_DONTNEED);
+        in->released = end;
+    }
+#else
+    (void)in;
+#endif
+}
+
+size_t cli_input_peek(cli_input_t* in, uint8_t* dst, size_t n) {
+    if (in->map) {
+        size_t have = in->size - in->pos;
+        if (n > have) n = have;
+        memcpy(dst, in->map + in->pos, n);
+        return n;
+    }
+    if (in->buf_len - in->buf_off < n && !in->eof) {
+        if (fill(in, n) != 0) return 0;
+    }
+    size_t have = in->buf_len - in->buf_off;
+    if (n > have) n = have;
+    memcpy(dst, in->buf + in->buf_off, n);
+    return n;
+}
+
+/* ============================================================================
+ * Output
+ * ============================================================================ */
+
+static void set_direct(cli_output_t* out, int on) {
+    if (out->direct == on) return;
+    int fl = fcntl(out->fd, F_GETFL);
+    if (fl >= 0) fcntl(out->fd, F_SETFL, on ? (fl | O_DIRECT) : (fl & ~O_DIRECT));
+    out->direct = on;
+}
+
+static int write_all(cli_output_t* out, const uint8_t* p, size_t n) {
+    while (n) {
+        ssize_t w = write(out->fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            /* Some filesystems accept O_DIRECT at open and reject it at
+             * write time; fall back to buffered I/O. */
+            if (errno == EINVAL && out->direct) {
+                set_direct(out, 0);
+                continue;
+            }
+            fprintf(stderr, "cu: %s: %s\n", out->name, strerror(errno));
+            return -1;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+    return 0;
+}
+
+int cli_output_open(cli_output_t* out, const char* path, int force, int direct,
+                    size_t buf_size) {
+    memset(out, 0, sizeof(*out));
+    if (!path || strcmp(path, "-") == 0) {
+        out->name = "<stdout>";
+        out->fd = STDOUT_FILENO;
+        out->is_stdout = 1;
+    } else {
+        out->name = path;
+        int flags = O_WRONLY | O_CREAT | O_TRUNC | (force ? 0 : O_EXCL);
+        if (direct && O_DIRECT) {
+            out->fd = open(path, flags | O_DIRECT, 0644);
+            if (out->fd >= 0) {
+                out->direct = 1;
+            } else if (errno != EINVAL) {
+                fprintf(stderr, "cu: %s: %s\n", path, strerror(errno));
+                return -1;
+            }
+        }
+        if (!out->direct) out->fd = open(path, flags, 0644);
+        if (out->fd < 0) {
+            fprintf(stderr, "cu: %s: %s\n", path,
+                    errno == EEXIST ? "already exists (use -f to overwrite)" : strerror(errno));
+            return -1;
+        }
+    }
+
+    out->cap = round_up(buf_size ? buf_size : CLI_IO_ALIGN, CLI_IO_ALIGN);
+    void* p = NULL;
+    if (posix_memalign(&p, CLI_IO_ALIGN, out->cap) != 0) {
+        fprintf(stderr, "cu: %s: out of memory\n", out->name);
+        if (!out->is_stdout) close(out->fd);
+        return -1;
+    }
+    out->buf = p;
+    return 0;
+}
+
+int cli_output_flush(cli_output_t* out) {
+    size_t n = out->direct ? out->used / CLI_IO_ALIGN * CLI_IO_ALIGN : out->used;
+    if (n == 0) return 0;
+    if (write_all(out, out->buf, n) != 0) return -1;
+    memmove(out->buf, out->buf + n, out->used - n);
+    out->used -= n;
+    return 0;
+}
+
+uint8_t* cli_output_reserve(cli_output_t* out, size_t n) {
+    if (out->cap - out->used >= n) return out->buf + out->used;
+    if (cli_output_flush(out) != 0) return NULL;
+    if (out->cap - out->used < n) {
+        size_t cap = round_up(out->used + n, CLI_IO_ALIGN);
+        void* p = NULL;
+        if (posix_memalign(&p, CLI_IO_ALIGN, cap) != 0) {
+            fprintf(stderr, "cu: %s: out of memory\n", out->name);
+            return NULL;
+        }
+        memcpy(p, out->buf, out->used);
+        free(out->buf);
+        out->buf = p;
+        out->cap = cap;
+    }
+    return out->buf + out->used;
+}
+
+void cli_output_commit(cli_output_t* out, size_t n) {
+    out->used += n;
+    out->total += n;
+}
+
+int cli_output_write(cli_output_t* out, const uint8_t* data, size_t len) {
+    if (!out->direct && out->used == 0 && len >= out->cap) {
+        out->total += len;
+        return write_all(out, data, len);
+    }
+    while (len) {
+        if (out->used == out->cap && cli_output_flush(out) != 0) return -1;
+        size_t n = out->cap - out->used < len ? out->cap - out->used : len;
+        memcpy(out->buf + out->used, data, n);
+        cli_output_commit(out, n);
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+int cli_output_close(cli_output_t* out) {
+    int rc = cli_output_flush(out);
+    if (rc == 0 && out->used) {
+        /* Unaligned tail: O_DIRECT would reject it. */
+        set_direct(out, 0);
+        rc = cli_output_flush(out);
+    }
+    if (!out->is_stdout && close(out->fd) != 0 && rc == 0) {
+        fprintf(stderr, "cu: %s: %s\n", out->name, strerror(errno));
+        rc = -1;
+    }
+    free(out->buf);
+    out->buf = NULL;
+    out->fd = -1;
+    return rc;
+}
+
+void cli_output_abort(cli_output_t* out, const char* path) {
+    if (!out->is_stdout) {
+        close(out->fd);
+        if (path) unlink(path);
+    }
+    free(out->buf);
+    out->buf = NULL;
+    out->fd = -1;
+}
+
+/* ============================================================================
+ * Passthrough
+ * ============================================================================ */
+
+int cli_copy_through(cli_input_t* in, cli_output_t* out) {
+    set_direct(out, 0);
+    if (cli_output_flush(out) != 0) return -1;
+
+    if (in->map) {
+        size_t off = 0;
+#if defined(__linux__)
+        /* Kernel-side copy: no pages pass through user space, and
+         * copy_file_range can reflink on filesystems that support it. */
+        loff_t lo = 0;
+        while (off < in->size) {
+            ssize_t r = copy_file_range(in->fd, &lo, out->fd, NULL, in->size - off, 0);
+            if (r <= 0) break;
+            off += (size_t)r;
+        }
+        while (off < in->size) {
+            off_t so = (off_t)off;
+            ssize_t r = sendfile(out->fd, in->fd, &so, in->size - off);
+            if (r <= 0) break;
+            off += (size_t)r;
+        }
+#endif
+        if (off < in->size && write_all(out, in->map + off, in->size - off) != 0) return -1;
+        out->total += in->size;
+        in->pos = in->size;
+        return 0;
+    }
+
+    /* Stream input: emit what was peeked, then relay the rest. */
+    if (in->buf_len > in->buf_off) {
+        size_t n = in->buf_len - in->buf_off;
+        if (write_all(out, in->buf + in->buf_off, n) != 0) return -1;
+        out->total += n;
+        in->buf_off = in->buf_len;
+    }
+#if defined(__linux__)
+    for (;;) {
+        ssize_t r = sendfile(out->fd, in->fd, NULL, (size_t)1 << 30);
+        if (r == 0) return 0;
+        if (r < 0) break;
+        out->total += (uint64_t)r;
+    }
+#endif
+    for (;;) {
+        const uint8_t* p;
+        size_t n;
+        if (cli_input_next(in, CLI_READ_MIN, &p, &n) != 0) return -1;
+        if (n == 0) return 0;
+        if (write_all(out, p, n) != 0) return -1;
+        out->total += n;
+    }
+}
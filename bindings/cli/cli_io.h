@@ -0,0 +1,115 @@
+/*
+ * cli_io.h — file plumbing for the `cu` command-line tool.
+ *
+ * Input:  regular files are mmap'd (MADV_SEQUENTIAL) and handed out as
+ *         zero-copy spans; stdin, pipes and anything mmap refuses fall back
+ *         to read() into an owned buffer.
+ * Output: one large page-aligned buffer that codecs write into directly.
+ *         Optionally opened O_DIRECT, in which case only whole aligned
+ *         blocks are written and O_DIRECT is dropped for the final tail.
+ *
+ * POSIX only.
+ */
+
+#ifndef CU_CLI_IO_H
+#define CU_CLI_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* O_DIRECT alignment for buffer address, file offset and write length. */
+#define CLI_IO_ALIGN 4096
+
+typedef struct {
+    const char*    name;      /* for messages; "<stdin>" for stdin */
+    int            fd;
+    int            is_stdin;
+    uint8_t*       map;       /* non-NULL when mmap'd */
+    size_t         size;      /* file size when mmap'd */
+    size_t         pos;       /* bytes handed out so far */
+    size_t         released;  /* mapped bytes already madvise'd away */
+    uint8_t*       buf;       /* read() fallback buffer */
+    size_t         buf_cap;
+    size_t         buf_len;   /* valid bytes in buf */
+    size_t         buf_off;   /* bytes of buf already handed out */
+    int            eof;
+} cli_input_t;
+
+/* path NULL or "-" = stdin. Returns 0, or -1 with a message printed. */
+int  cli_input_open(cli_input_t* in, const char* path);
+void cli_input_close(cli_input_t* in);
+
+/*
+ * Next span of up to `want` bytes (fewer only at end of input). Spans
+ * from a mapping point into it and stay valid until close; spans from
+ * the read() fallback are valid until the next call. Returns 0 and sets
+ * *len = 0 at end of input, -1 on a read error.
+ */
+int  cli_input_next(cli_input_t* in, size_t want, const uint8_t** data, size_t* len);
+
+/* Tell the kernel the mapped bytes before the current position are done
+ * with, so they leave our RSS. No-op for the read() fallback. */
+void cli_input_release(cli_input_t* in);
+
+/* Peek at up to `n` leading bytes without consuming them. Returns the
+ * number of bytes available (< n only for short inputs). */
+size_t cli_input_peek(cli_input_t* in, uint8_t* dst, size_t n);
+
+typedef struct {
+    const char* name;         /* for messages; "<stdout>" for stdout */
+    int         fd;
+    int         is_stdout;
+    int         direct;       /* O_DIRECT currently set on fd */
+    uint8_t*    buf;          /* CLI_IO_ALIGN-aligned */
+    size_t      cap;
+    size_t      used;
+    uint64_t    total;        /* bytes accepted so far */
+} cli_output_t;
+
+/*
+ * path NULL or "-" = stdout. Refuses to overwrite an existing file unless
+ * `force`. `direct` asks for O_DIRECT and is silently dropped when the
+ * filesystem does not support it. `buf_size` is rounded up to the
+ * alignment.
+ */
+int  cli_output_open(cli_output_t* out, const char* path, int force, int direct,
+                     size_t buf_size);
+
+/* Pointer to at least `n` free contiguous bytes in the buffer, flushing
+ * and growing as needed. NULL on error (message printed). */
+uint8_t* cli_output_reserve(cli_output_t* out, size_t n);
+
+/* Free bytes at the end of the buffer (no flush). */
+static inline size_t cli_output_avail(const cli_output_t* out) {
+    return out->cap - out->used;
+}
+static inline uint8_t* cli_output_tail(cli_output_t* out) {
+    return out->buf + out->used;
+}
+
+/* Mark `n` bytes written at cli_output_tail() as filled. */
+void cli_output_commit(cli_output_t* out, size_t n);
+
+/* Copy `len` bytes in; large writes skip the buffer when not O_DIRECT. */
+int  cli_output_write(cli_output_t* out, const uint8_t* data, size_t len);
+
+/* Write out whatever is buffered (the aligned prefix only, when O_DIRECT).
+ * Returns 0 or -1. */
+int  cli_output_flush(cli_output_t* out);
+
+/* Flush everything, drop O_DIRECT for the tail, close. Returns 0 or -1. */
+int  cli_output_close(cli_output_t* out);
+
+/* Close and unlink a partially written output after an error. */
+void cli_output_abort(cli_output_t* out, const char* path);
+
+/*
+ * Copy `in` to `out` unchanged from the start. Uses copy_file_range, then
+ * sendfile, then read/write — whichever the kernel and the pair of file
+ * types accept first. Call before any cli_input_next (peeking is fine).
+ * Any buffered output is flushed first. Returns 0 or -1.
+ */
+int  cli_copy_through(cli_input_t* in, cli_output_t* out);
+
+#endif  /* CU_CLI_IO_H */
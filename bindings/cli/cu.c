@@ -0,0 +1,759 @@
+/*
+ * cu.c — standalone compress/decompress tool on top of the C ABI.
+ *
+ * Reads and writes the same files as the reference tools: `cu -a zstd`
+ * output decodes with `zstd -d`, `cu -d` reads what `xz`, `gzip`,
+ * `bzip2` and `lz4` write (including their multi-frame/multi-member
+ * files). Codecs with a parallel mode (see cu_parallel_supported)
+ * compress through cu_compress_parallel in windows of whole chunks, so
+ * the output is the same for every --threads value; the rest stream
+ * through cu_compress_stream_t on one thread.
+ *
+ * I/O is in cli_io.c: mmap'd input, one large aligned output buffer the
+ * codec writes into directly (optionally O_DIRECT), and kernel-side
+ * copies for passthrough.
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L  /* clock_gettime */
+#endif
+
+#include "cli_io.h"
+#include "compress_utils.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Output buffer size; also the size of each streaming codec call. */
+#define CLI_OUT_BUF      ((size_t)4 << 20)
+/* Input span fed to one streaming codec call. */
+#define CLI_FEED         ((size_t)1 << 20)
+/* Minimum free output space handed to a streaming codec call. */
+#define CLI_MIN_OUT      ((size_t)64 << 10)
+/* Parallel window = chunk × threads × this; more chunks per thread
+ * smooths out uneven chunk times at each window boundary. */
+#define CLI_CHUNKS_PER_THREAD 4
+/* --bench: repeat each measurement until this much time has passed. */
+#define CLI_BENCH_MIN_SECONDS 0.5
+
+typedef enum { MODE_COMPRESS, MODE_DECOMPRESS, MODE_BENCH } cli_mode_t;
+
+typedef struct {
+    cli_mode_t  mode;
+    int         algo;        /* cu_algorithm_t, or -1 = unset */
+    int         level;
+    unsigned    threads;     /* 0 = one per online CPU */
+    size_t      chunk;       /* 0 = codec default */
+    int         to_stdout;
+    int         force;
+    int         rm_src;
+    int         direct;
+    int         auto_detect; /* --auto: pass unrecognized input through */
+    int         verbose;     /* 0 = -q, 1 = default, 2 = -v */
+    const char* out_path;
+} cli_opts_t;
+
+/* ============================================================================
+ * Algorithms, names and suffixes
+ * ============================================================================ */
+
+static const struct {
+    const char*    name;
+    cu_algorithm_t algo;
+    const char*    suffix;   /* NULL for aliases */
+} NAMES[] = {
+    { "zstd",   CU_ALGO_ZSTD,   ".zst"    },
+    { "brotli", CU_ALGO_BROTLI, ".br"     },
+    { "zlib",   CU_ALGO_ZLIB,   ".zz"     },
+    { "bz2",    CU_ALGO_BZ2,    ".bz2"    },
+    { "lz4",    CU_ALGO_LZ4,    ".lz4"    },
+    { "xz",     CU_ALGO_XZ,     ".xz"     },
+    { "snappy", CU_ALGO_SNAPPY, ".snappy" },
+    { "gzip",   CU_ALGO_GZIP,   ".gz"     },
+    /* Aliases. */
+    { "zst",    CU_ALGO_ZSTD,   NULL      },
+    { "br",     CU_ALGO_BROTLI, NULL      },
+    { "bzip2",  CU_ALGO_BZ2,    NULL      },
+    { "lzma",   CU_ALGO_XZ,     NULL      },
+    { "gz",     CU_ALGO_GZIP,   NULL      },
+};
+#define N_NAMES (sizeof(NAMES) / sizeof(NAMES[0]))
+
+static int algo_from_name(const char* s) {
+    for (size_t i = 0; i < N_NAMES; i++) {
+        if (strcmp(NAMES[i].name, s) == 0) return (int)NAMES[i].algo;
+    }
+    return -1;
+}
+
+static const char* algo_suffix(int algo) {
+    for (size_t i = 0; i < N_NAMES; i++) {
+        if ((int)NAMES[i].algo == algo && NAMES[i].suffix) return NAMES[i].suffix;
+    }
+    return NULL;
+}
+
+/* Length of a known compressed suffix on `path` (for `algo`, or any when
+ * algo < 0); 0 if none. *found receives the suffix's algorithm. */
+static size_t known_suffix(const char* path, int algo, int* found) {
+    size_t len = strlen(path);
+    for (size_t i = 0; i < N_NAMES; i++) {
+        const char* sfx = NAMES[i].suffix;
+        if (!sfx || (algo >= 0 && (int)NAMES[i].algo != algo)) continue;
+        size_t sl = strlen(sfx);
+        if (len > sl && strcmp(path + len - sl, sfx) == 0) {
+            if (found) *found = (int)NAMES[i].algo;
+            return sl;
+        }
+    }
+    return 0;
+}
+
+/* Identify a stream by its leading bytes. Brotli and snappy carry no
+ * magic and are never detected. */
+static int detect_format(const uint8_t* p, size_t n) {
+    if (n >= 4 && p[0] == 0x28 && p[1] == 0xB5 && p[2] == 0x2F && p[3] == 0xFD) return CU_ALGO_ZSTD;
+    if (n >= 4 && p[0] == 0x04 && p[1] == 0x22 && p[2] == 0x4D && p[3] == 0x18) return CU_ALGO_LZ4;
+    if (n >= 6 && memcmp(p, "\xFD" "7zXZ\0", 6) == 0)                           return CU_ALGO_XZ;
+    if (n >= 3 && p[0] == 0x1F && p[1] == 0x8B && p[2] == 0x08)                 return CU_ALGO_GZIP;
+    if (n >= 4 && p[0] == 'B' && p[1] == 'Z' && p[2] == 'h' && p[3] >= '1' && p[3] <= '9')
+        return CU_ALGO_BZ2;
+    /* RFC 1950: deflate, window ≤ 32K, header checksum. */
+    if (n >= 2 && (p[0] & 0x0F) == 8 && (p[0] >> 4) <= 7 && ((p[0] << 8) | p[1]) % 31 == 0)
+        return CU_ALGO_ZLIB;
+    return -1;
+}
+
+static unsigned online_cpus(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (unsigned)n : 1u;
+}
+
+static int codec_error(const char* name, const char* what, cu_status_t s) {
+    const char* detail = cu_last_error();
+    fprintf(stderr, "cu: %s: %s: %s%s%s\n", name, what, cu_strerror(s),
+            *detail ? ": " : "", detail);
+    return -1;
+}
+
+/* ============================================================================
+ * Compress / decompress one stream
+ * ============================================================================ */
+
+static int compress_parallel(const cli_opts_t* o, cli_input_t* in, cli_output_t* out) {
+    cu_parallel_opts_t po = { .threads = o->threads, .chunk_size = o->chunk };
+    size_t chunk = cu_parallel_chunk_size((cu_algorithm_t)o->algo, &po);
+    unsigned t = o->threads ? o->threads : online_cpus();
+    size_t window = chunk * CLI_CHUNKS_PER_THREAD;
+    window = window > SIZE_MAX / t ? SIZE_MAX / chunk * chunk : window * t;
+
+    for (int first = 1;; first = 0) {
+        const uint8_t* p;
+        size_t n;
+        if (cli_input_next(in, window, &p, &n) != 0) return -1;
+        if (n == 0 && !first) break;
+        size_t cap = cu_compress_parallel_bound(n, (cu_algorithm_t)o->algo, &po);
+        uint8_t* dst = cli_output_reserve(out, cap);
+        if (!dst) return -1;
+        cu_status_t s = cu_compress_parallel((cu_algorithm_t)o->algo, p, n, dst, &cap,
+                                             o->level, &po);
+        if (s != CU_OK) return codec_error(in->name, "compression failed", s);
+        cli_output_commit(out, cap);
+        cli_input_release(in);
+        if (n < window) break;
+    }
+    return 0;
+}
+
+/* Drive a compress or decompress stream over the whole input. The two
+ * stream types share the write/finish protocol; `write`/`finish` are
+ * adapters so one loop serves both. */
+typedef cu_status_t (*stream_write_fn)(void* s, const uint8_t* in, size_t in_len,
+                                       uint8_t* out, size_t* out_len);
+typedef cu_status_t (*stream_finish_fn)(void* s, uint8_t* out, size_t* out_len);
+
+static int pump_stream(void* st, stream_write_fn write, stream_finish_fn finish,
+                       const char* what, cli_input_t* in, cli_output_t* out) {
+    for (;;) {
+        const uint8_t* p;
+        size_t n;
+        if (cli_input_next(in, CLI_FEED, &p, &n) != 0) return -1;
+        if (n == 0) break;
+        for (;;) {
+            if (!cli_output_reserve(out, CLI_MIN_OUT)) return -1;
+            size_t avail = cli_output_avail(out);
+            cu_status_t s = write(st, p, n, cli_output_tail(out), &avail);
+            cli_output_commit(out, avail);
+            if (s == CU_OK) break;
+            if (s != CU_ERR_BUF_TOO_SMALL) return codec_error(in->name, what, s);
+            p = NULL;
+            n = 0;
+        }
+        cli_input_release(in);
+    }
+    for (;;) {
+        if (!cli_output_reserve(out, CLI_MIN_OUT)) return -1;
+        size_t avail = cli_output_avail(out);
+        cu_status_t s = finish(st, cli_output_tail(out), &avail);
+        cli_output_commit(out, avail);
+        if (s == CU_OK) return 0;
+        if (s != CU_ERR_BUF_TOO_SMALL) return codec_error(in->name, what, s);
+    }
+}
+
+static cu_status_t cs_write(void* s, const uint8_t* i, size_t il, uint8_t* o, size_t* ol) {
+    return cu_compress_stream_write((cu_compress_stream_t*)s, i, il, o, ol);
+}
+static cu_status_t cs_finish(void* s, uint8_t* o, size_t* ol) {
+    return cu_compress_stream_finish((cu_compress_stream_t*)s, o, ol);
+}
+static cu_status_t ds_write(void* s, const uint8_t* i, size_t il, uint8_t* o, size_t* ol) {
+    return cu_decompress_stream_write((cu_decompress_stream_t*)s, i, il, o, ol);
+}
+static cu_status_t ds_finish(void* s, uint8_t* o, size_t* ol) {
+    return cu_decompress_stream_finish((cu_decompress_stream_t*)s, o, ol);
+}
+
+static int compress_stream(const cli_opts_t* o, cli_input_t* in, cli_output_t* out) {
+    if (cu_parallel_supported((cu_algorithm_t)o->algo)) return compress_parallel(o, in, out);
+
+    cu_compress_stream_t* cs = NULL;
+    cu_status_t s = cu_compress_stream_create((cu_algorithm_t)o->algo, o->level, &cs);
+    if (s != CU_OK) return codec_error(in->name, "cannot start compression", s);
+    int rc = pump_stream(cs, cs_write, cs_finish, "compression failed", in, out);
+    cu_compress_stream_destroy(cs);
+    return rc;
+}
+
+static int decompress_stream(int algo, cli_input_t* in, cli_output_t* out) {
+    cu_decompress_stream_t* ds = NULL;
+    cu_status_t s = cu_decompress_stream_create((cu_algorithm_t)algo, &ds);
+    if (s != CU_OK) return codec_error(in->name, "cannot start decompression", s);
+    int rc = pump_stream(ds, ds_write, ds_finish, "decompression failed", in, out);
+    cu_decompress_stream_destroy(ds);
+    return rc;
+}
+
+/* ============================================================================
+ * Per-file driver
+ * ============================================================================ */
+
+/* Returns 0 on success, 1 on error, 2 on a skipped file (warning). */
+static int process_file(const cli_opts_t* o, const char* path) {
+    int is_stdin = !path || strcmp(path, "-") == 0;
+    const char* label = is_stdin ? "<stdin>" : path;
+    int to_stdout = o->to_stdout || (is_stdin && !o->out_path);
+
+    cli_input_t in;
+    if (cli_input_open(&in, path) != 0) return 1;
+
+    /* Pick the codec. */
+    int algo = o->algo;
+    int passthrough = 0;
+    if (o->mode == MODE_DECOMPRESS) {
+        uint8_t magic[8];
+        int detected = detect_format(magic, cli_input_peek(&in, magic, sizeof magic));
+        if (algo < 0) algo = detected;
+        if (algo < 0 && !is_stdin) known_suffix(path, -1, &algo);
+        if (o->auto_detect ? detected < 0 : algo < 0) {
+            if (o->auto_detect || o->force) {
+                passthrough = 1;
+            } else {
+                fprintf(stderr, "cu: %s: not in a recognized compressed format (use -a)\n", label);
+                cli_input_close(&in);
+                return 1;
+            }
+        }
+    }
+    if (!passthrough && !cu_algorithm_available((cu_algorithm_t)algo)) {
+        fprintf(stderr, "cu: %s: algorithm not available in this build\n", label);
+        cli_input_close(&in);
+        return 1;
+    }
+
+    /* Name the output. */
+    char* derived = NULL;
+    const char* out_path = NULL;
+    if (o->out_path) {
+        out_path = o->out_path;
+    } else if (!to_stdout) {
+        size_t len = strlen(path);
+        if (o->mode == MODE_COMPRESS) {
+            const char* sfx = algo_suffix(algo);
+            if (known_suffix(path, algo, NULL) && !o->force) {
+                if (o->verbose) fprintf(stderr, "cu: %s: already has %s suffix -- unchanged\n", path, sfx);
+                cli_input_close(&in);
+                return 2;
+            }
+            derived = malloc(len + strlen(sfx) + 1);
+            if (derived) sprintf(derived, "%s%s", path, sfx);
+        } else {
+            size_t sl = known_suffix(path, passthrough ? -1 : algo, NULL);
+            if (!sl) {
+                if (o->verbose) fprintf(stderr, "cu: %s: unknown suffix -- ignored\n", path);
+                cli_input_close(&in);
+                return 2;
+            }
+            derived = malloc(len - sl + 1);
+            if (derived) {
+                memcpy(derived, path, len - sl);
+                derived[len - sl] = '\0';
+            }
+        }
+        if (!derived) {
+            fprintf(stderr, "cu: out of memory\n");
+            cli_input_close(&in);
+            return 1;
+        }
+        out_path = derived;
+    }
+    if (!out_path && isatty(STDOUT_FILENO) && o->mode == MODE_COMPRESS && !o->force) {
+        fprintf(stderr, "cu: refusing to write compressed data to a terminal (use -f)\n");
+        cli_input_close(&in);
+        return 1;
+    }
+
+    cli_output_t out;
+    if (cli_output_open(&out, out_path, o->force, o->direct, CLI_OUT_BUF) != 0) {
+        cli_input_close(&in);
+        free(derived);
+        return 1;
+    }
+
+    int rc;
+    if (passthrough)                  rc = cli_copy_through(&in, &out);
+    else if (o->mode == MODE_COMPRESS) rc = compress_stream(o, &in, &out);
+    else                              rc = decompress_stream(algo, &in, &out);
+
+    uint64_t in_bytes = in.pos;
+    if (rc == 0) {
+        rc = cli_output_close(&out);
+        if (rc != 0 && out_path) unlink(out_path);
+    } else {
+        cli_output_abort(&out, out_path);
+    }
+    cli_input_close(&in);
+
+    if (rc == 0 && o->verbose > 1) {
+        uint64_t raw = o->mode == MODE_COMPRESS ? in_bytes : out.total;
+        uint64_t packed = o->mode == MODE_COMPRESS ? out.total : in_bytes;
+        fprintf(stderr, "%s: %llu -> %llu (%.2f%%)%s%s\n", label,
+                (unsigned long long)in_bytes, (unsigned long long)out.total,
+                raw ? 100.0 * (double)packed / (double)raw : 0.0,
+                out_path ? " -> " : "", out_path ? out_path : "");
+    }
+    if (rc == 0 && o->rm_src && !is_stdin && out_path && unlink(path) != 0) {
+        fprintf(stderr, "cu: %s: %s\n", path, strerror(errno));
+    }
+    free(derived);
+    return rc == 0 ? 0 : 1;
+}
+
+/* ============================================================================
+ * --bench
+ * ============================================================================ */
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+typedef struct {
+    int                algo;
+    int                level;
+    const uint8_t*     in;
+    size_t             in_len;
+    uint8_t*           out;
+    size_t             out_len;   /* in: capacity; out: result */
+    cu_parallel_opts_t po;
+} bench_job_t;
+
+static cu_status_t bench_compress(bench_job_t* j) {
+    size_t cap = j->out_len;
+    cu_status_t s = cu_parallel_supported((cu_algorithm_t)j->algo)
+        ? cu_compress_parallel((cu_algorithm_t)j->algo, j->in, j->in_len, j->out, &cap,
+                               j->level, &j->po)
+        : cu_compress((cu_algorithm_t)j->algo, j->in, j->in_len, j->out, &cap, j->level);
+    j->out_len = cap;
+    return s;
+}
+
+/* Best-of-N wall time for one compress; N grows until the budget is spent. */
+static double bench_time_compress(bench_job_t* j, size_t cap, cu_status_t* status) {
+    double best = 0, start = now_seconds();
+    do {
+        j->out_len = cap;
+        double t0 = now_seconds();
+        *status = bench_compress(j);
+        double dt = now_seconds() - t0;
+        if (*status != CU_OK) return 0;
+        if (best == 0 || dt < best) best = dt;
+    } while (now_seconds() - start < CLI_BENCH_MIN_SECONDS);
+    return best;
+}
+
+static double mbps(size_t bytes, double seconds) {
+    return seconds > 0 ? (double)bytes / seconds / 1e6 : 0.0;
+}
+
+static int bench_one(const cli_opts_t* o, int algo, const char* label,
+                     const uint8_t* data, size_t len) {
+    unsigned threads = o->threads ? o->threads : online_cpus();
+    int parallel = cu_parallel_supported((cu_algorithm_t)algo);
+    bench_job_t j = {
+        .algo = algo, .level = o->level, .in = data, .in_len = len,
+        .po = { .threads = 1, .chunk_size = o->chunk },
+    };
+    size_t cap = parallel ? cu_compress_parallel_bound(len, (cu_algorithm_t)algo, &j.po)
+                          : cu_compress_bound(len, (cu_algorithm_t)algo);
+    j.out = malloc(cap ? cap : 1);
+    uint8_t* back = malloc(len ? len : 1);
+    if (!j.out || !back) {
+        free(j.out);
+        free(back);
+        fprintf(stderr, "cu: out of memory\n");
+        return 1;
+    }
+
+    cu_status_t s;
+    double t1 = bench_time_compress(&j, cap, &s);
+    double tn = t1;
+    if (s == CU_OK && parallel && threads > 1) {
+        j.po.threads = threads;
+        tn = bench_time_compress(&j, cap, &s);
+    }
+    if (s != CU_OK) {
+        codec_error(label, "compression failed", s);
+        free(j.out);
+        free(back);
+        return 1;
+    }
+
+    double td = 0, start = now_seconds();
+    do {
+        size_t back_len = len;
+        double t0 = now_seconds();
+        s = cu_decompress((cu_algorithm_t)algo, j.out, j.out_len, back, &back_len);
+        double dt = now_seconds() - t0;
+        if (s != CU_OK || back_len != len || memcmp(back, data, len) != 0) {
+            if (s == CU_OK) fprintf(stderr, "cu: %s: %s round-trip mismatch\n", label,
+                                    cu_algorithm_name((cu_algorithm_t)algo));
+            else codec_error(label, "decompression failed", s);
+            free(j.out);
+            free(back);
+            return 1;
+        }
+        if (td == 0 || dt < td) td = dt;
+    } while (now_seconds() - start < CLI_BENCH_MIN_SECONDS);
+
+    printf("%-7s %2d %12zu %12zu %7.3f %10.1f", cu_algorithm_name((cu_algorithm_t)algo),
+           o->level, len, j.out_len, j.out_len ? (double)len / (double)j.out_len : 0.0,
+           mbps(len, t1));
+    if (parallel && threads > 1) {
+        printf(" %10.1f %6.2fx", mbps(len, tn), tn > 0 ? t1 / tn : 0.0);
+    } else {
+        printf(" %10s %7s", "-", "-");
+    }
+    printf(" %10.1f\n", mbps(len, td));
+    free(j.out);
+    free(back);
+    return 0;
+}
+
+static int bench_file(const cli_opts_t* o, const char* path) {
+    cli_input_t in;
+    if (cli_input_open(&in, path) != 0) return 1;
+
+    /* Benchmarks need the whole input in memory: the mapping when there
+     * is one, otherwise read it all. */
+    uint8_t* owned = NULL;
+    const uint8_t* data = in.map;
+    size_t len = in.size;
+    if (!in.map) {
+        size_t cap = 0;
+        len = 0;
+        for (;;) {
+            const uint8_t* p;
+            size_t n;
+            if (cli_input_next(&in, CLI_FEED, &p, &n) != 0) { free(owned); cli_input_close(&in); return 1; }
+            if (n == 0) break;
+            if (len + n > cap) {
+                cap = cap ? cap * 2 : CLI_FEED;
+                while (cap < len + n) cap *= 2;
+                uint8_t* nb = realloc(owned, cap);
+                if (!nb) {
+                    fprintf(stderr, "cu: out of memory\n");
+                    free(owned);
+                    cli_input_close(&in);
+                    return 1;
+                }
+                owned = nb;
+            }
+            memcpy(owned + len, p, n);
+            len += n;
+        }
+        data = owned;
+    }
+    if (data == NULL) data = (const uint8_t*)"";
+
+    unsigned threads = o->threads ? o->threads : online_cpus();
+    printf("%s: %zu bytes, %u thread%s\n", in.name, len, threads, threads == 1 ? "" : "s");
+    printf("%-7s %2s %12s %12s %7s %10s %10s %7s %10s\n", "algo", "lv", "input", "output",
+           "ratio", "c1 MB/s", "cN MB/s", "speedup", "d MB/s");
+
+    int rc = 0;
+    if (o->algo >= 0) {
+        rc = bench_one(o, o->algo, in.name, data, len);
+    } else {
+        for (size_t i = 0; i < N_NAMES && rc == 0; i++) {
+            if (!NAMES[i].suffix || !cu_algorithm_available(NAMES[i].algo)) continue;
+            rc = bench_one(o, (int)NAMES[i].algo, in.name, data, len);
+        }
+    }
+    free(owned);
+    cli_input_close(&in);
+    return rc;
+}
+
+/* ============================================================================
+ * Arguments
+ * ============================================================================ */
+
+static void usage(FILE* f) {
+    fprintf(f,
+        "usage: cu [OPTIONS] [FILE...]\n"
+        "\n"
+        "Compress or decompress FILEs in place (FILE -> FILE.zst etc.), or\n"
+        "stdin to stdout when no FILE is given or FILE is '-'.\n"
+        "\n"
+        "  -z, --compress        compress (default)\n"
+        "  -d, --decompress      decompress; the format is detected from the data,\n"
+        "                        then from the file suffix, unless -a is given\n"
+        "      --auto            like -d, but copy unrecognized input through unchanged\n"
+        "  -a, --algo=NAME       zstd (default), gzip, xz, bz2, lz4, brotli, zlib, snappy\n"
+        "  -l, --level=N, -1..-9 compression level 1..10 (default 5); 0 and -1..-5\n"
+        "                        are speed tiers below level 1\n"
+        "      --fast[=N]        speed tier N (1..5, default 1); same as --level=-N\n"
+        "  -T, --threads=N       worker threads; 0 = one per CPU (default)\n"
+        "      --chunk=SIZE      input bytes per parallel frame (K/M/G suffixes)\n"
+        "  -c, --stdout          write to stdout, keep input files\n"
+        "  -o, --output=FILE     write to FILE (single input only)\n"
+        "  -k, --keep            keep input files (default)\n"
+        "      --rm              remove input files after success\n"
+        "  -f, --force           overwrite outputs; with -d, copy through\n"
+        "                        unrecognized input\n"
+        "      --direct          write output files with O_DIRECT\n"
+        "      --bench           measure ratio and speed, 1 thread vs -T; writes nothing\n"
+        "                        (all algorithms unless -a is given)\n"
+        "  -q, --quiet           suppress warnings\n"
+        "  -v, --verbose         report sizes per file\n"
+        "  -V, --version         print the version and exit\n"
+        "  -h, --help            show this help\n");
+}
+
+static int parse_uint(const char* s, unsigned long long* out) {
+    char* end;
+    errno = 0;
+    unsigned long long v = strtoull(s, &end, 10);
+    if (errno || end == s) return -1;
+    switch (*end) {
+        case 'k': case 'K': v <<= 10; end++; break;
+        case 'm': case 'M': v <<= 20; end++; break;
+        case 'g': case 'G': v <<= 30; end++; break;
+        default: break;
+    }
+    if (*end == 'i' || *end == 'B') end++;
+    if (*end == 'B') end++;
+    if (*end) return -1;
+    *out = v;
+    return 0;
+}
+
+/* Level on the library scale, CU_LEVEL_MIN..CU_LEVEL_MAX. */
+static int parse_level(const char* s, int* out) {
+    char* end;
+    errno = 0;
+    long v = strtol(s, &end, 10);
+    if (errno || end == s || *end || v < CU_LEVEL_MIN || v > CU_LEVEL_MAX) return -1;
+    *out = (int)v;
+    return 0;
+}
+
+/* Apply one option that takes a value. Returns 0 or -1 (message printed). */
+static int apply_value(cli_opts_t* o, char opt, const char* v) {
+    unsigned long long n;
+    switch (opt) {
+        case 'a':
+            o->algo = algo_from_name(v);
+            if (o->algo < 0) {
+                fprintf(stderr, "cu: unknown algorithm '%s'\n", v);
+                return -1;
+            }
+            return 0;
+        case 'l':
+            if (parse_level(v, &o->level) != 0) {
+                fprintf(stderr, "cu: level must be -5..10\n");
+                return -1;
+            }
+            return 0;
+        case 'T':
+            if (parse_uint(v, &n) != 0 || n > 4096) {
+                fprintf(stderr, "cu: bad thread count '%s'\n", v);
+                return -1;
+            }
+            o->threads = (unsigned)n;
+            return 0;
+        case 'C':
+            if (parse_uint(v, &n) != 0 || n == 0 || n > SIZE_MAX / 2) {
+                fprintf(stderr, "cu: bad chunk size '%s'\n", v);
+                return -1;
+            }
+            o->chunk = (size_t)n;
+            return 0;
+        case 'o':
+            o->out_path = v;
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+static const struct {
+    const char* name;
+    char        opt;       /* short equivalent, or a private code */
+    int         has_value;
+} LONG_OPTS[] = {
+    { "compress",   'z', 0 }, { "decompress", 'd', 0 }, { "algo",    'a', 1 },
+    { "level",      'l', 1 }, { "threads",    'T', 1 }, { "chunk",   'C', 1 },
+    { "stdout",     'c', 0 }, { "output",     'o', 1 }, { "keep",    'k', 0 },
+    { "rm",         'R', 0 }, { "force",      'f', 0 }, { "direct",  'D', 0 },
+    { "bench",      'B', 0 }, { "auto",       'A', 0 }, { "quiet",   'q', 0 },
+    { "verbose",    'v', 0 }, { "version",    'V', 0 }, { "help",    'h', 0 },
+};
+#define N_LONG_OPTS (sizeof(LONG_OPTS) / sizeof(LONG_OPTS[0]))
+
+/* Apply a flag. Returns 0, 1 to exit successfully (help/version), -1 on error. */
+static int apply_flag(cli_opts_t* o, char opt) {
+    switch (opt) {
+        case 'z': o->mode = MODE_COMPRESS; return 0;
+        case 'd': o->mode = MODE_DECOMPRESS; return 0;
+        case 'A': o->mode = MODE_DECOMPRESS; o->auto_detect = 1; return 0;
+        case 'B': o->mode = MODE_BENCH; return 0;
+        case 'c': o->to_stdout = 1; return 0;
+        case 'k': o->rm_src = 0; return 0;
+        case 'R': o->rm_src = 1; return 0;
+        case 'f': o->force = 1; return 0;
+        case 'D': o->direct = 1; return 0;
+        case 'q': o->verbose = 0; return 0;
+        case 'v': o->verbose = 2; return 0;
+        case 'V': printf("cu %s\n", cu_version()); return 1;
+        case 'h': usage(stdout); return 1;
+        default:
+            if (opt >= '1' && opt <= '9') { o->level = opt - '0'; return 0; }
+            fprintf(stderr, "cu: unknown option '-%c'\n", opt);
+            return -1;
+    }
+}
+
+static int value_option(char c) {
+    return c == 'a' || c == 'l' || c == 'T' || c == 'o';
+}
+
+int main(int argc, char** argv) {
+    cli_opts_t o = {
+        .mode = MODE_COMPRESS, .algo = -1, .level = 5, .verbose = 1,
+    };
+    const char** files = calloc((size_t)argc, sizeof(*files));
+    size_t nfiles = 0;
+    if (!files) return 1;
+
+    int only_files = 0;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        int r = 0;
+        if (only_files || a[0] != '-' || a[1] == '\0') {
+            files[nfiles++] = a;
+        } else if (strcmp(a, "--") == 0) {
+            only_files = 1;
+        } else if (strncmp(a, "--fast", 6) == 0 && (a[6] == '\0' || a[6] == '=')) {
+            /* zstd-style --fast[=N]: the value is optional, unlike the table. */
+            int tier = 1;
+            if (a[6] == '=' &&
+                (parse_level(a + 7, &tier) != 0 || tier < 1 || tier > -CU_LEVEL_MIN)) {
+                fprintf(stderr, "cu: --fast takes 1..%d\n", -CU_LEVEL_MIN);
+                r = -1;
+            } else {
+                o.level = -tier;
+            }
+        } else if (a[1] == '-') {
+            const char* name = a + 2;
+            const char* eq = strchr(name, '=');
+            size_t nl = eq ? (size_t)(eq - name) : strlen(name);
+            size_t k = 0;
+            while (k < N_LONG_OPTS &&
+                   !(strlen(LONG_OPTS[k].name) == nl && strncmp(LONG_OPTS[k].name, name, nl) == 0)) {
+                k++;
+            }
+            if (k == N_LONG_OPTS) {
+                fprintf(stderr, "cu: unknown option '%s'\n", a);
+                r = -1;
+            } else if (LONG_OPTS[k].has_value) {
+                const char* v = eq ? eq + 1 : (i + 1 < argc ? argv[++i] : NULL);
+                if (!v) {
+                    fprintf(stderr, "cu: option '--%s' needs a value\n", LONG_OPTS[k].name);
+                    r = -1;
+                } else {
+                    r = apply_value(&o, LONG_OPTS[k].opt, v);
+                }
+            } else if (eq) {
+                fprintf(stderr, "cu: option '--%s' takes no value\n", LONG_OPTS[k].name);
+                r = -1;
+            } else {
+                r = apply_flag(&o, LONG_OPTS[k].opt);
+            }
+        } else {
+            /* Bundled short options: -dc, -kf9, -T4, -a zstd. */
+            for (const char* p = a + 1; *p && r == 0; p++) {
+                if (value_option(*p)) {
+                    const char* v = p[1] ? p + 1 : (i + 1 < argc ? argv[++i] : NULL);
+                    if (!v) {
+                        fprintf(stderr, "cu: option '-%c' needs a value\n", *p);
+                        r = -1;
+                    } else {
+                        r = apply_value(&o, *p, v);
+                    }
+                    break;
+                }
+                r = apply_flag(&o, *p);
+            }
+        }
+        if (r != 0) {
+            free(files);
+            if (r < 0) usage(stderr);
+            return r < 0 ? 2 : 0;
+        }
+    }
+
+    if (o.mode == MODE_COMPRESS && o.algo < 0) o.algo = CU_ALGO_ZSTD;
+    if (o.out_path && nfiles > 1) {
+        fprintf(stderr, "cu: -o takes a single input\n");
+        free(files);
+        return 2;
+    }
+    if (nfiles == 0) files[nfiles++] = "-";
+
+    int status = 0;
+    for (size_t i = 0; i < nfiles; i++) {
+        int r = o.mode == MODE_BENCH ? bench_file(&o, files[i]) : process_file(&o, files[i]);
+        if (r == 1) status = 1;
+        else if (r == 2 && status == 0) status = 2;
+    }
+    free(files);
+    return status;
+}
@@ -17,6 +17,10 @@
  *       for (auto& out : cs.write(chunk)) sink.push(out);
  *   }
  *   for (auto& out : cs.finish()) sink.push(out);
+ *
+ * For sockets, cs.flush() after each message returns bytes the peer can
+ * decode right away; cs.set_target_block_size(1400) (zstd) keeps blocks
+ * small enough to decode as they arrive.
  */
 
 #ifndef COMPRESS_UTILS_HPP
@@ -102,6 +106,21 @@ inline void set_max_decompressed_size(std::size_t bytes) {
     cu_set_max_decompressed_size(bytes);
 }
 
+/* Huge-page backing for codec allocations >= threshold (0 = off). */
+inline void set_huge_pages(std::size_t threshold = CU_HUGE_PAGES_DEFAULT_THRESHOLD) {
+    cu_set_huge_pages(threshold);
+}
+
+/* Pay first-call costs up front (cu_warmup). Empty algos: every algorithm
+ * in the build; empty levels: level 5. */
+inline void warmup(const std::vector<Algorithm>& algos = {},
+                   const std::vector<int>& levels = {}) {
+    std::vector<cu_algorithm_t> c_algos;
+    c_algos.reserve(algos.size());
+    for (Algorithm a : algos) c_algos.push_back(detail::c_algo(a));
+    detail::check(cu_warmup(c_algos.data(), c_algos.size(), levels.data(), levels.size()));
+}
+
 /* ============================================================================
  * One-shot
  * ============================================================================ */
@@ -125,6 +144,46 @@ inline std::vector<std::uint8_t> decompress(
     std::span<const std::uint8_t> in
 );  // forward decl; defined below the streaming class.
 
+/* What the first frame header declares (see cu_frame_info). Throws
+ * cu::Error on a truncated or malformed header. */
+using FrameInfo = cu_frame_info_t;
+inline constexpr std::uint64_t FRAME_SIZE_UNKNOWN = CU_FRAME_SIZE_UNKNOWN;
+
+inline FrameInfo frame_info(Algorithm a, std::span<const std::uint8_t> in) {
+    FrameInfo info;
+    detail::check(cu_frame_info(detail::c_algo(a), in.data(), in.size(), &info));
+    return info;
+}
+
+/* Scatter/gather one-shot (cu_compressv / cu_decompressv): input pieces
+ * and output pages are passed as segment arrays, nothing is concatenated.
+ * Return the bytes written across `out`; throw cu::Error otherwise. */
+using ConstIovec = cu_const_iovec_t;
+using Iovec = cu_iovec_t;
+
+inline std::size_t compressv(
+    Algorithm a,
+    std::span<const ConstIovec> in,
+    std::span<const Iovec> out,
+    int level = 5
+) {
+    std::size_t out_len = 0;
+    detail::check(cu_compressv(detail::c_algo(a), in.data(), in.size(),
+                               out.data(), out.size(), &out_len, level));
+    return out_len;
+}
+
+inline std::size_t decompressv(
+    Algorithm a,
+    std::span<const ConstIovec> in,
+    std::span<const Iovec> out
+) {
+    std::size_t out_len = 0;
+    detail::check(cu_decompressv(detail::c_algo(a), in.data(), in.size(),
+                                 out.data(), out.size(), &out_len));
+    return out_len;
+}
+
 /* ============================================================================
  * Streaming
  *
@@ -168,6 +227,31 @@ public:
         });
     }
 
+    /* Everything written so far, made decodable without ending the frame
+     * (cu_compress_stream_flush). Throws for bz2 and snappy. */
+    std::vector<std::uint8_t> flush() {
+        return drain_loop([&](std::uint8_t* out, std::size_t* out_len, bool) {
+            return cu_compress_stream_flush(stream_, out, out_len);
+        });
+    }
+
+    /* zstd low-latency mode; call before the first write. 0 = default. */
+    void set_target_block_size(std::size_t bytes) {
+        detail::check(cu_compress_stream_set_target_block_size(stream_, bytes));
+    }
+
+    /* Exact total input; call before the first write. zstd and lz4 record
+     * it in the frame header. Throws for zlib, gzip, bz2 and xz. */
+    void set_pledged_size(std::uint64_t bytes) {
+        detail::check(cu_compress_stream_set_pledged_size(stream_, bytes));
+    }
+
+    /* Write (true) or omit (false) the frame content checksum; call before
+     * the first write. zstd, lz4 and xz only. */
+    void set_checksum(bool enabled) {
+        detail::check(cu_compress_stream_set_checksum(stream_, enabled ? 1 : 0));
+    }
+
 private:
     cu_compress_stream_t* stream_ = nullptr;
 
@@ -227,6 +311,13 @@ public:
         });
     }
 
+    /* Trusted-input mode: don't verify content checksums. Only for data
+     * whose integrity is already guaranteed; call before the first write.
+     * Throws for bz2, brotli and snappy. */
+    void set_skip_checksum(bool skip) {
+        detail::check(cu_decompress_stream_set_skip_checksum(stream_, skip ? 1 : 0));
+    }
+
 private:
     cu_decompress_stream_t* stream_ = nullptr;
 
@@ -279,6 +370,198 @@ inline std::vector<std::uint8_t> decompress(
     return first;
 }
 
+/* ============================================================================
+ * Compile-time codecs
+ *
+ * cu::Codec<A> is the one-shot API with the algorithm fixed at compile
+ * time. It calls the codec's direct entry points (cu_lz4_compress & co.),
+ * so there is no algorithm lookup and no runtime argument check; with LTO
+ * against the static library the wrapper inlines down to the codec call.
+ *
+ * Levels are cu::Level<A>, built from a constant and checked against the
+ * codec's own range when the program is compiled:
+ *
+ *   auto z = cu::Codec<cu::Algorithm::Lz4>::compress(msg, -3);   // ok
+ *   cu::Codec<cu::Algorithm::Zlib>::compress(msg, -3);           // error: no speed tiers
+ *   cu::Codec<cu::Algorithm::Snappy>::compress(msg, 1);          // error: no levels
+ *
+ * zstd and lz4 take CU_LEVEL_MIN..CU_LEVEL_MAX. The codecs without a speed
+ * knob take 0..10 (below 0 they would silently run level 0); snappy takes
+ * no level. Levels known only at run time go through cu::compress.
+ *
+ * A codec left out of the build is a link error here, not a cu::Error.
+ * Not available against the plugin core (BUILD_CODEC_PLUGINS).
+ * ============================================================================ */
+
+namespace detail {
+
+template <Algorithm A> struct CodecTraits;
+
+template <> struct CodecTraits<Algorithm::Zstd> {
+    static constexpr bool has_levels = true;
+    static constexpr int  min_level  = CU_LEVEL_MIN;
+    static constexpr auto bound      = &cu_zstd_compress_bound;
+    static constexpr auto compress   = &cu_zstd_compress;
+    static constexpr auto decompress = &cu_zstd_decompress;
+    static constexpr auto size_hint  = &cu_zstd_decompress_size_hint;
+};
+
+template <> struct CodecTraits<Algorithm::Brotli> {
+    static constexpr bool has_levels = true;
+    static constexpr int  min_level  = 0;
+    static constexpr auto bound      = &cu_brotli_compress_bound;
+    static constexpr auto compress   = &cu_brotli_compress;
+    static constexpr auto decompress = &cu_brotli_decompress;
+    static constexpr auto size_hint  = &cu_brotli_decompress_size_hint;
+};
+
+template <> struct CodecTraits<Algorithm::Zlib> {
+    static constexpr bool has_levels = true;
+    static constexpr int  min_level  = 0;
+    static constexpr auto bound      = &cu_zlib_compress_bound;
+    static constexpr auto compress   = &cu_zlib_compress;
+    static constexpr auto decompress = &cu_zlib_decompress;
+    static constexpr auto size_hint  = &cu_zlib_decompress_size_hint;
+};
+
+template <> struct CodecTraits<Algorithm::Bz2> {
+    static constexpr bool has_levels = true;
+    static constexpr int  min_level  = 0;
+    static constexpr auto bound      = &cu_bz2_compress_bound;
+    static constexpr auto compress   = &cu_bz2_compress;
+    static constexpr auto decompress = &cu_bz2_decompress;
+    static constexpr auto size_hint  = &cu_bz2_decompress_size_hint;
+};
+
+template <> struct CodecTraits<Algorithm::Lz4> {
+    static constexpr bool has_levels = true;
+    static constexpr int  min_level  = CU_LEVEL_MIN;
+    static constexpr auto bound      = &cu_lz4_compress_bound;
+    static constexpr auto compress   = &cu_lz4_compress;
+    static constexpr auto decompress = &cu_lz4_decompress;
+    static constexpr auto size_hint  = &cu_lz4_decompress_size_hint;
+};
+
+template <> struct CodecTraits<Algorithm::Xz> {
+    static constexpr bool has_levels = true;
+    static constexpr int  min_level  = 0;
+    static constexpr auto bound      = &cu_xz_compress_bound;
+    static constexpr auto compress   = &cu_xz_compress;
+    static constexpr auto decompress = &cu_xz_decompress;
+    static constexpr auto size_hint  = &cu_xz_decompress_size_hint;
+};
+
+template <> struct CodecTraits<Algorithm::Lzma> : CodecTraits<Algorithm::Xz> {};
+
+template <> struct CodecTraits<Algorithm::Snappy> {
+    static constexpr bool has_levels = false;
+    static constexpr int  min_level  = 0;
+    static constexpr auto bound      = &cu_snappy_compress_bound;
+    static constexpr auto compress   = &cu_snappy_compress;
+    static constexpr auto decompress = &cu_snappy_decompress;
+    static constexpr auto size_hint  = &cu_snappy_decompress_size_hint;
+};
+
+template <> struct CodecTraits<Algorithm::Gzip> {
+    static constexpr bool has_levels = true;
+    static constexpr int  min_level  = 0;
+    static constexpr auto bound      = &cu_gzip_compress_bound;
+    static constexpr auto compress   = &cu_gzip_compress;
+    static constexpr auto decompress = &cu_gzip_decompress;
+    static constexpr auto size_hint  = &cu_gzip_decompress_size_hint;
+};
+
+/* Not constexpr on purpose: reaching it in a constant evaluation is what
+ * turns an out-of-range level into a compile error that names it. */
+inline void level_out_of_range_for_this_codec() {}
+
+}  // namespace detail
+
+template <Algorithm A>
+class Level {
+    static_assert(detail::CodecTraits<A>::has_levels, "this codec takes no compression level");
+public:
+    static constexpr int min = detail::CodecTraits<A>::min_level;
+    static constexpr int max = CU_LEVEL_MAX;
+
+    consteval Level(int v) : value_(v) {
+        if (v < min || v > max) detail::level_out_of_range_for_this_codec();
+    }
+    constexpr int value() const noexcept { return value_; }
+private:
+    int value_;
+};
+
+template <Algorithm A>
+struct Codec {
+    using Traits = detail::CodecTraits<A>;
+
+    static constexpr Algorithm algorithm = A;
+    static constexpr int default_level = 5;
+
+    static std::size_t compress_bound(std::size_t in_len) noexcept {
+        return Traits::bound(in_len);
+    }
+
+    /* Into a caller buffer of at least compress_bound(in.size()) bytes;
+     * returns the bytes written. */
+    static std::size_t compress(std::span<const std::uint8_t> in,
+                                std::span<std::uint8_t> out) {
+        return compress_into(in, out, default_level);
+    }
+    static std::size_t compress(std::span<const std::uint8_t> in,
+                                std::span<std::uint8_t> out, Level<A> level)
+        requires Traits::has_levels
+    {
+        return compress_into(in, out, level.value());
+    }
+
+    static std::vector<std::uint8_t> compress(std::span<const std::uint8_t> in) {
+        return compress_vec(in, default_level);
+    }
+    static std::vector<std::uint8_t> compress(std::span<const std::uint8_t> in,
+                                              Level<A> level)
+        requires Traits::has_levels
+    {
+        return compress_vec(in, level.value());
+    }
+
+    /* Into a caller buffer; returns the bytes written. */
+    static std::size_t decompress(std::span<const std::uint8_t> in,
+                                  std::span<std::uint8_t> out) {
+        std::size_t out_len = out.size();
+        detail::check(Traits::decompress(in.data(), in.size(), out.data(), &out_len));
+        return out_len;
+    }
+
+    /* Sized from the frame header where the format has one, otherwise
+     * through DecompressStream like cu::decompress. */
+    static std::vector<std::uint8_t> decompress(std::span<const std::uint8_t> in) {
+        std::size_t hint = 0;
+        cu_status_t s = Traits::size_hint(in.data(), in.size(), &hint);
+        if (s == CU_ERR_SIZE_UNKNOWN) return cu::decompress(A, in);
+        if (s != CU_OK) detail::throw_status(s);
+        std::vector<std::uint8_t> out(hint);
+        out.resize(decompress(in, out));
+        return out;
+    }
+
+private:
+    static std::size_t compress_into(std::span<const std::uint8_t> in,
+                                     std::span<std::uint8_t> out, int level) {
+        std::size_t out_len = out.size();
+        detail::check(Traits::compress(in.data(), in.size(), out.data(), &out_len, level));
+        return out_len;
+    }
+
+    static std::vector<std::uint8_t> compress_vec(std::span<const std::uint8_t> in,
+                                                  int level) {
+        std::vector<std::uint8_t> out(Traits::bound(in.size()));
+        out.resize(compress_into(in, out, level));
+        return out;
+    }
+};
+
 }  // namespace cu
 
 #endif  // COMPRESS_UTILS_HPP
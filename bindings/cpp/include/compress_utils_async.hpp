@@ -0,0 +1,536 @@
+/*
+ * compress_utils_async.hpp — C++20 coroutine layer for the compress-utils
+ * C++ binding.
+ *
+ * Offloads codec work from the calling thread (typically a network
+ * reactor) onto an executor and hands the result back through an
+ * awaitable. Header-only, built entirely on compress_utils.hpp.
+ *
+ * Example:
+ *
+ *   #include <compress_utils_async.hpp>
+ *
+ *   cu::Task<void> respond(Socket& s, std::vector<std::uint8_t> body) {
+ *       auto z = co_await cu::async_compress(cu::Algorithm::Zstd, body, 3);
+ *       co_await s.send(z);
+ *   }
+ *
+ *   cu::AsyncCompressStream cs(cu::Algorithm::Zstd, 5);
+ *   for (auto chunk : chunks) co_await s.send(co_await cs.write(chunk));
+ *   co_await s.send(co_await cs.finish());
+ *
+ * Executors: anything with `execute(F)` taking a nullary callable. The
+ * default is a process-wide cu::ThreadPool; pass your own scheduler to
+ * run codec work elsewhere. The awaiting coroutine resumes on whichever
+ * thread completed the work — hop back to your reactor with its own
+ * scheduler awaitable if you need thread affinity.
+ */
+
+#ifndef COMPRESS_UTILS_ASYNC_HPP
+#define COMPRESS_UTILS_ASYNC_HPP
+
+#include "compress_utils.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+namespace cu {
+
+/* ============================================================================
+ * Executors
+ * ============================================================================ */
+
+template <typename E>
+concept Executor = requires(E& e, std::function<void()> f) {
+    e.execute(std::move(f));
+};
+
+/* Fixed-size worker pool. Tasks run FIFO; the destructor drains the queue
+ * and joins. */
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency()) {
+        if (threads == 0) threads = 1;
+        workers_.reserve(threads);
+        for (unsigned i = 0; i < threads; i++) {
+            workers_.emplace_back([this] { run(); });
+        }
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    void execute(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            tasks_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    std::size_t size() const noexcept { return workers_.size(); }
+
+private:
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> workers_;
+    bool stop_ = false;
+
+    void run() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lk(mu_);
+                cv_.wait(lk, [this] { return stop_ || !tasks_.empty(); });
+                if (tasks_.empty()) return;
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+/* Shared pool used when no executor is passed. Created on first use. */
+inline ThreadPool& default_executor() {
+    static ThreadPool pool;
+    return pool;
+}
+
+/* Non-owning, type-erased reference to an Executor. The referenced
+ * executor must outlive every operation submitted through it. */
+class ExecutorRef {
+public:
+    template <Executor E>
+        requires(!std::same_as<std::remove_cvref_t<E>, ExecutorRef>)
+    ExecutorRef(E& e) noexcept
+        : obj_(&e),
+          fn_([](void* o, std::function<void()> f) {
+              static_cast<E*>(o)->execute(std::move(f));
+          }) {}
+
+    void execute(std::function<void()> f) const { fn_(obj_, std::move(f)); }
+
+private:
+    void* obj_;
+    void (*fn_)(void*, std::function<void()>);
+};
+
+/* ============================================================================
+ * Task<T> — minimal lazy coroutine type, plus sync_wait() for callers that
+ * are not themselves coroutines. Our awaitables work in any coroutine
+ * type; Task is provided so the binding is usable without a framework.
+ * ============================================================================ */
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+template <typename T>
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+            return h.promise().continuation;
+        }
+        void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase<T> {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+    template <typename U>
+    void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+
+    T take() {
+        if (this->error) std::rethrow_exception(this->error);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase<void> {
+    Task<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+
+    void take() {
+        if (this->error) std::rethrow_exception(this->error);
+    }
+};
+
+}  // namespace detail
+
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> h) noexcept : h_(h) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task(Task&& other) noexcept : h_(std::exchange(other.h_, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (h_) h_.destroy();
+            h_ = std::exchange(other.h_, nullptr);
+        }
+        return *this;
+    }
+    ~Task() { if (h_) h_.destroy(); }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        h_.promise().continuation = awaiting;
+        return h_;
+    }
+    T await_resume() { return h_.promise().take(); }
+
+private:
+    std::coroutine_handle<promise_type> h_;
+};
+
+namespace detail {
+
+template <typename T>
+inline Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+/* Fire-and-forget coroutine used by sync_wait to drive a Task. */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+}  // namespace detail
+
+/* Block the calling thread until `task` completes; return its value or
+ * rethrow its exception. Never call this from an executor thread the task
+ * itself depends on. */
+template <typename T>
+T sync_wait(Task<T> task) {
+    std::mutex mu;
+    std::condition_variable cv;
+    bool done = false;
+    std::exception_ptr error;
+    using Slot = std::conditional_t<std::is_void_v<T>, bool, std::optional<T>>;
+    Slot slot{};
+
+    auto drive = [&]() -> detail::Detached {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await std::move(task);
+            } else {
+                slot.emplace(co_await std::move(task));
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+        // Notify under the lock so the waiter cannot return (and destroy
+        // mu/cv) until we are done touching them.
+        std::lock_guard<std::mutex> lk(mu);
+        done = true;
+        cv.notify_one();
+    };
+    drive();
+
+    std::unique_lock<std::mutex> lk(mu);
+    cv.wait(lk, [&] { return done; });
+    if (error) std::rethrow_exception(error);
+    if constexpr (!std::is_void_v<T>) return std::move(*slot);
+}
+
+/* ============================================================================
+ * One-shot
+ *
+ * The returned awaitable is lazy: the work is submitted when it is
+ * co_awaited. Input spans must stay valid until the co_await completes
+ * (the awaiting coroutine's frame keeps them alive in the usual case).
+ * ============================================================================ */
+
+namespace detail {
+
+template <typename F>
+class [[nodiscard]] OffloadAwaitable {
+public:
+    using result_type = std::invoke_result_t<F&>;
+
+    OffloadAwaitable(ExecutorRef ex, F fn) : ex_(ex), fn_(std::move(fn)) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+        ex_.execute([this, h] {
+            try {
+                result_.emplace(fn_());
+            } catch (...) {
+                error_ = std::current_exception();
+            }
+            h.resume();  // `this` may be gone after this call
+        });
+    }
+    result_type await_resume() {
+        if (error_) std::rethrow_exception(error_);
+        return std::move(*result_);
+    }
+
+private:
+    ExecutorRef ex_;
+    F fn_;
+    std::optional<result_type> result_;
+    std::exception_ptr error_;
+};
+
+}  // namespace detail
+
+inline auto async_compress(
+    Algorithm a,
+    std::span<const std::uint8_t> in,
+    int level = 5,
+    ExecutorRef ex = default_executor()
+) {
+    return detail::OffloadAwaitable(ex, [a, in, level] { return compress(a, in, level); });
+}
+
+inline auto async_decompress(
+    Algorithm a,
+    std::span<const std::uint8_t> in,
+    ExecutorRef ex = default_executor()
+) {
+    return detail::OffloadAwaitable(ex, [a, in] { return decompress(a, in); });
+}
+
+/* ============================================================================
+ * Async streaming
+ *
+ * `co_await write(chunk)` copies the chunk into the stream's queue and
+ * returns whatever output the codec has produced since the last call. The
+ * codec runs on the executor, one chunk at a time and in order. Once more
+ * than `max_buffered` input bytes are queued but not yet consumed, write()
+ * suspends until the codec catches up — that is the backpressure. A
+ * stream must not be awaited by two coroutines at once.
+ * ============================================================================ */
+
+inline constexpr std::size_t DEFAULT_ASYNC_MAX_BUFFERED = 4 * 1024 * 1024;
+
+template <typename Stream>
+class BasicAsyncStream {
+public:
+    BasicAsyncStream(Stream stream, ExecutorRef ex,
+                     std::size_t max_buffered = DEFAULT_ASYNC_MAX_BUFFERED)
+        : st_(std::make_shared<State>(std::move(stream), ex, max_buffered)) {}
+
+    auto write(std::span<const std::uint8_t> in) { return WriteAwaitable{st_, in}; }
+    auto finish() { return FinishAwaitable{st_}; }
+
+private:
+    enum class Wait { None, Drain, Done };
+
+    struct Item {
+        std::vector<std::uint8_t> data;
+        bool finish = false;
+    };
+
+    struct State {
+        State(Stream s, ExecutorRef e, std::size_t hw)
+            : stream(std::move(s)), ex(e), max_buffered(hw) {}
+
+        Stream stream;
+        ExecutorRef ex;
+        std::size_t max_buffered;
+
+        std::mutex mu;
+        std::deque<Item> queue;
+        std::size_t queued_bytes = 0;
+        bool running = false;
+        bool done = false;
+        std::vector<std::uint8_t> out;
+        std::exception_ptr error;
+        std::coroutine_handle<> waiter;
+        Wait wait = Wait::None;
+
+        /* Claim the pump if idle. Caller holds mu; on true it must call
+         * launch() after releasing it, since an inline executor runs pump()
+         * (which takes mu) before execute() returns. */
+        bool claim() {
+            if (running) return false;
+            running = true;
+            return true;
+        }
+
+        static void launch(const std::shared_ptr<State>& self) {
+            self->ex.execute([self] { self->pump(); });
+        }
+
+        bool satisfied() const {
+            if (error) return true;
+            return wait == Wait::Done ? done : queued_bytes <= max_buffered;
+        }
+
+        void pump() {
+            for (;;) {
+                Item item;
+                {
+                    std::lock_guard<std::mutex> lk(mu);
+                    if (queue.empty() || error) {
+                        running = false;
+                        return;
+                    }
+                    item = std::move(queue.front());
+                    queue.pop_front();
+                }
+
+                std::vector<std::uint8_t> piece;
+                std::exception_ptr err;
+                try {
+                    if (item.finish) piece = stream.finish();
+                    else piece = stream.write(item.data);
+                } catch (...) {
+                    err = std::current_exception();
+                }
+
+                std::coroutine_handle<> wake;
+                {
+                    std::lock_guard<std::mutex> lk(mu);
+                    out.insert(out.end(), piece.begin(), piece.end());
+                    queued_bytes -= item.data.size();
+                    if (item.finish) done = true;
+                    if (err) {
+                        error = err;
+                        queue.clear();
+                        queued_bytes = 0;
+                    }
+                    if (waiter && satisfied()) {
+                        wake = std::exchange(waiter, nullptr);
+                        wait = Wait::None;
+                    }
+                }
+                if (wake) wake.resume();
+            }
+        }
+
+        std::vector<std::uint8_t> take() {
+            std::lock_guard<std::mutex> lk(mu);
+            if (error) std::rethrow_exception(error);
+            return std::exchange(out, {});
+        }
+    };
+
+    struct WriteAwaitable {
+        std::shared_ptr<State> st;
+        std::span<const std::uint8_t> in;
+
+        bool await_ready() {
+            bool start = false;
+            {
+                std::lock_guard<std::mutex> lk(st->mu);
+                if (st->error) return true;
+                if (st->done) {
+                    throw Error(CU_ERR_STREAM_FINISHED, "write() after finish()");
+                }
+                if (!in.empty()) {
+                    st->queue.push_back(Item{{in.begin(), in.end()}, false});
+                    st->queued_bytes += in.size();
+                    start = st->claim();
+                }
+            }
+            if (start) State::launch(st);
+            std::lock_guard<std::mutex> lk(st->mu);
+            return st->queued_bytes <= st->max_buffered;
+        }
+        bool await_suspend(std::coroutine_handle<> h) {
+            std::lock_guard<std::mutex> lk(st->mu);
+            st->wait = Wait::Drain;
+            if (st->satisfied()) {
+                st->wait = Wait::None;
+                return false;
+            }
+            st->waiter = h;
+            return true;
+        }
+        std::vector<std::uint8_t> await_resume() { return st->take(); }
+    };
+
+    struct FinishAwaitable {
+        std::shared_ptr<State> st;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h) {
+            // Once h is set as the waiter, the pump may resume it and free
+            // this awaitable; only the local copy is touched after that.
+            std::shared_ptr<State> s = st;
+            {
+                std::lock_guard<std::mutex> lk(s->mu);
+                if (s->error || s->done) return false;
+                s->queue.push_back(Item{{}, true});
+                s->wait = Wait::Done;
+                s->waiter = h;
+                if (!s->claim()) return true;
+            }
+            State::launch(s);
+            return true;
+        }
+        std::vector<std::uint8_t> await_resume() { return st->take(); }
+    };
+
+    std::shared_ptr<State> st_;
+};
+
+class AsyncCompressStream : public BasicAsyncStream<CompressStream> {
+public:
+    AsyncCompressStream(Algorithm a, int level = 5,
+                        ExecutorRef ex = default_executor(),
+                        std::size_t max_buffered = DEFAULT_ASYNC_MAX_BUFFERED)
+        : BasicAsyncStream(CompressStream(a, level), ex, max_buffered) {}
+};
+
+class AsyncDecompressStream : public BasicAsyncStream<DecompressStream> {
+public:
+    explicit AsyncDecompressStream(Algorithm a,
+                                   ExecutorRef ex = default_executor(),
+                                   std::size_t max_buffered = DEFAULT_ASYNC_MAX_BUFFERED)
+        : BasicAsyncStream(DecompressStream(a), ex, max_buffered) {}
+};
+
+}  // namespace cu
+
+#endif  // COMPRESS_UTILS_ASYNC_HPP
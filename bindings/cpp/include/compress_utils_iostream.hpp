@@ -0,0 +1,340 @@
+/*
+ * compress_utils_iostream.hpp — std::streambuf / iostream adapters for the
+ * compress-utils C++ binding.
+ *
+ * The streambufs drive the C stream ABI directly: compression reads straight
+ * out of the put area, decompression writes straight into the get area, and
+ * large xsputn/xsgetn requests bypass the internal buffer altogether. No
+ * intermediate std::vector is allocated per chunk.
+ *
+ * Codec errors are thrown as cu::Error from the streambuf virtuals; the
+ * owning iostream catches them and sets badbit (or rethrows, if badbit is
+ * in its exceptions() mask).
+ *
+ * Example:
+ *
+ *   #include <compress_utils_iostream.hpp>
+ *
+ *   std::ofstream file("log.zst", std::ios::binary);
+ *   cu::ocompressstream out(file, cu::Algorithm::Zstd, 5);
+ *   out << "hello " << 42 << '\n';
+ *   out.finish();                         // writes the frame trailer
+ *
+ *   std::ifstream src("log.zst", std::ios::binary);
+ *   cu::icompressstream in(src, cu::Algorithm::Zstd);
+ *   std::string line;
+ *   std::getline(in, line);
+ */
+
+#ifndef COMPRESS_UTILS_IOSTREAM_HPP
+#define COMPRESS_UTILS_IOSTREAM_HPP
+
+#include "compress_utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <ios>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+
+namespace cu {
+
+/* Default size of each internal buffer (put/get area and codec scratch). */
+inline constexpr std::size_t DEFAULT_STREAMBUF_SIZE = 256 * 1024;
+
+namespace detail {
+
+/* Buffers are indexed with int (pbump/gbump), so cap them well below that. */
+inline std::size_t clamp_streambuf_size(std::size_t n) {
+    constexpr std::size_t max = std::size_t{1} << 30;
+    return std::clamp<std::size_t>(n, 64, max);
+}
+
+}  // namespace detail
+
+/* ============================================================================
+ * compress_streambuf — output-only; compresses into `sink`.
+ * ============================================================================ */
+
+class compress_streambuf : public std::streambuf {
+public:
+    compress_streambuf(std::streambuf& sink, Algorithm a, int level = 5,
+                       std::size_t buffer_size = DEFAULT_STREAMBUF_SIZE)
+        : sink_(&sink),
+          size_(detail::clamp_streambuf_size(buffer_size)),
+          in_(new char[size_]),
+          out_(new char[size_]) {
+        detail::check(cu_compress_stream_create(detail::c_algo(a), level, &stream_));
+        setp(in_.get(), in_.get() + size_);
+    }
+    compress_streambuf(const compress_streambuf&) = delete;
+    compress_streambuf& operator=(const compress_streambuf&) = delete;
+
+    /* Finishes the frame if finish() was not called; errors are swallowed
+     * here, so call finish() explicitly to observe them. */
+    ~compress_streambuf() override {
+        try { finish(); } catch (...) {}
+        cu_compress_stream_destroy(stream_);
+    }
+
+    /* Compress what is buffered, write the frame trailer and flush the sink.
+     * Idempotent. Throws cu::Error on codec failure. */
+    void finish() {
+        if (finished_) return;
+        finished_ = true;
+        flush_put_area();
+        drain([&](char* out, std::size_t* out_len) {
+            return cu_compress_stream_finish(stream_, reinterpret_cast<std::uint8_t*>(out), out_len);
+        });
+        sink_->pubsync();
+    }
+
+    /* sync() plus a codec flush (cu_compress_stream_flush): everything
+     * written so far becomes decodable by the reader. Not what sync() does,
+     * since std::endl / std::flush would then cost ratio on every line.
+     * Throws cu::Error on failure (bz2 and snappy cannot flush). */
+    void sync_flush() {
+        if (finished_) return;
+        flush_put_area();
+        drain([&](char* out, std::size_t* out_len) {
+            return cu_compress_stream_flush(stream_, reinterpret_cast<std::uint8_t*>(out), out_len);
+        });
+        sink_->pubsync();
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (finished_) return traits_type::eof();
+        flush_put_area();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        if (finished_ || n <= 0) return 0;
+        std::size_t len = static_cast<std::size_t>(n);
+        std::size_t room = static_cast<std::size_t>(epptr() - pptr());
+        if (len <= room) {
+            std::memcpy(pptr(), s, len);
+            pbump(static_cast<int>(len));
+            return n;
+        }
+        flush_put_area();
+        if (len >= size_) {
+            feed(s, len);  // large write: straight to the codec
+        } else {
+            std::memcpy(pptr(), s, len);
+            pbump(static_cast<int>(len));
+        }
+        return n;
+    }
+
+    /* Pushes buffered input through the codec. Does not end the frame. */
+    int sync() override {
+        if (finished_) return 0;
+        flush_put_area();
+        return sink_->pubsync();
+    }
+
+private:
+    std::streambuf* sink_;
+    std::size_t size_;
+    std::unique_ptr<char[]> in_;
+    std::unique_ptr<char[]> out_;
+    cu_compress_stream_t* stream_ = nullptr;
+    bool finished_ = false;
+
+    void flush_put_area() {
+        std::size_t n = static_cast<std::size_t>(pptr() - pbase());
+        if (n) feed(pbase(), n);
+        setp(in_.get(), in_.get() + size_);
+    }
+
+    void feed(const char* data, std::size_t len) {
+        bool first = true;
+        drain([&](char* out, std::size_t* out_len) {
+            cu_status_t s = cu_compress_stream_write(
+                stream_,
+                first ? reinterpret_cast<const std::uint8_t*>(data) : nullptr,
+                first ? len : 0,
+                reinterpret_cast<std::uint8_t*>(out), out_len);
+            first = false;
+            return s;
+        });
+    }
+
+    template <typename Op>
+    void drain(Op&& op) {
+        for (;;) {
+            std::size_t out_len = size_;
+            cu_status_t s = op(out_.get(), &out_len);
+            if (out_len) write_sink(out_.get(), out_len);
+            if (s == CU_OK) return;
+            if (s != CU_ERR_BUF_TOO_SMALL) detail::throw_status(s);
+        }
+    }
+
+    void write_sink(const char* p, std::size_t n) {
+        if (static_cast<std::size_t>(sink_->sputn(p, static_cast<std::streamsize>(n))) != n) {
+            throw std::ios_base::failure("compress_streambuf: short write to sink");
+        }
+    }
+};
+
+/* ============================================================================
+ * decompress_streambuf — input-only; decompresses from `source`.
+ * ============================================================================ */
+
+class decompress_streambuf : public std::streambuf {
+public:
+    decompress_streambuf(std::streambuf& source, Algorithm a,
+                         std::size_t buffer_size = DEFAULT_STREAMBUF_SIZE)
+        : source_(&source),
+          size_(detail::clamp_streambuf_size(buffer_size)),
+          in_(new char[size_]),
+          out_(new char[size_]) {
+        detail::check(cu_decompress_stream_create(detail::c_algo(a), &stream_));
+        setg(out_.get(), out_.get(), out_.get());
+    }
+    decompress_streambuf(const decompress_streambuf&) = delete;
+    decompress_streambuf& operator=(const decompress_streambuf&) = delete;
+    ~decompress_streambuf() override { cu_decompress_stream_destroy(stream_); }
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+        std::size_t n = produce(out_.get(), size_);
+        if (n == 0) return traits_type::eof();
+        setg(out_.get(), out_.get(), out_.get() + n);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    std::streamsize xsgetn(char* s, std::streamsize n) override {
+        std::streamsize done = 0;
+        while (done < n) {
+            std::streamsize avail = egptr() - gptr();
+            if (avail > 0) {
+                std::streamsize take = std::min(avail, n - done);
+                std::memcpy(s + done, gptr(), static_cast<std::size_t>(take));
+                gbump(static_cast<int>(take));
+                done += take;
+                continue;
+            }
+            std::size_t want = static_cast<std::size_t>(n - done);
+            if (want >= size_) {
+                // Large read: decompress straight into the caller's buffer.
+                std::size_t got = produce(s + done, want);
+                if (got == 0) break;
+                done += static_cast<std::streamsize>(got);
+            } else if (traits_type::eq_int_type(underflow(), traits_type::eof())) {
+                break;
+            }
+        }
+        return done;
+    }
+
+private:
+    std::streambuf* source_;
+    std::size_t size_;
+    std::unique_ptr<char[]> in_;
+    std::unique_ptr<char[]> out_;
+    cu_decompress_stream_t* stream_ = nullptr;
+    bool draining_ = false;    // last call returned BUF_TOO_SMALL
+    bool source_eof_ = false;  // source exhausted; now in finish()
+    bool done_ = false;
+
+    /* Decompress into dst[0..cap). Returns bytes produced; 0 means end of
+     * stream. Throws cu::Error on corrupt or truncated input. */
+    std::size_t produce(char* dst, std::size_t cap) {
+        auto* out = reinterpret_cast<std::uint8_t*>(dst);
+        while (!done_) {
+            std::size_t out_len = cap;
+            cu_status_t s;
+            if (source_eof_) {
+                s = cu_decompress_stream_finish(stream_, out, &out_len);
+            } else if (draining_) {
+                s = cu_decompress_stream_write(stream_, nullptr, 0, out, &out_len);
+            } else {
+                std::streamsize got = source_->sgetn(in_.get(), static_cast<std::streamsize>(size_));
+                if (got <= 0) {
+                    source_eof_ = true;
+                    continue;
+                }
+                s = cu_decompress_stream_write(
+                    stream_, reinterpret_cast<const std::uint8_t*>(in_.get()),
+                    static_cast<std::size_t>(got), out, &out_len);
+            }
+            if (s == CU_ERR_BUF_TOO_SMALL) {
+                draining_ = true;
+            } else {
+                detail::check(s);
+                draining_ = false;
+                if (source_eof_) done_ = true;
+            }
+            if (out_len) return out_len;
+        }
+        return 0;
+    }
+};
+
+/* ============================================================================
+ * iostreams
+ * ============================================================================ */
+
+class ocompressstream : public std::ostream {
+public:
+    ocompressstream(std::ostream& sink, Algorithm a, int level = 5,
+                    std::size_t buffer_size = DEFAULT_STREAMBUF_SIZE)
+        : std::ostream(nullptr), buf_(*sink.rdbuf(), a, level, buffer_size) {
+        init(&buf_);
+    }
+
+    /* End the compressed frame. Throws cu::Error on failure. */
+    void finish() {
+        try {
+            buf_.finish();
+        } catch (...) {
+            setstate(std::ios::badbit);
+            throw;
+        }
+    }
+
+    /* Make everything written so far decodable; see compress_streambuf. */
+    void sync_flush() {
+        try {
+            buf_.sync_flush();
+        } catch (...) {
+            setstate(std::ios::badbit);
+            throw;
+        }
+    }
+
+    compress_streambuf* rdbuf() { return &buf_; }
+
+private:
+    compress_streambuf buf_;
+};
+
+class icompressstream : public std::istream {
+public:
+    icompressstream(std::istream& source, Algorithm a,
+                    std::size_t buffer_size = DEFAULT_STREAMBUF_SIZE)
+        : std::istream(nullptr), buf_(*source.rdbuf(), a, buffer_size) {
+        init(&buf_);
+    }
+
+    decompress_streambuf* rdbuf() { return &buf_; }
+
+private:
+    decompress_streambuf buf_;
+};
+
+}  // namespace cu
+
+#endif  // COMPRESS_UTILS_IOSTREAM_HPP
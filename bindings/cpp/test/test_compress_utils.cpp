@@ -7,10 +7,16 @@
  */
 
 #include <compress_utils.hpp>
+#include <compress_utils_async.hpp>
+#include <compress_utils_iostream.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <functional>
+#include <iterator>
+#include <sstream>
 #include <span>
 #include <string>
 #include <vector>
@@ -88,11 +94,321 @@ static int test_error_translation() {
     return 0;
 }
 
+// flush() output must decode on its own, before finish() ends the frame.
+static int test_stream_flush() {
+    auto in = sample(8 * 1024);
+    for (auto a : ALL) {
+        if (!cu::is_available(a)) continue;
+        cu::CompressStream cs(a, 5);
+        bool can_flush = a != cu::Algorithm::Bz2 && a != cu::Algorithm::Snappy;
+        auto wire = cs.write(std::span<const std::uint8_t>(in));
+        try {
+            auto f = cs.flush();
+            wire.insert(wire.end(), f.begin(), f.end());
+            CHECK(can_flush, "%s flush should be unsupported", cu::algorithm_name(a).c_str());
+        } catch (const cu::Error& e) {
+            CHECK(!can_flush && e.code() == CU_ERR_UNSUPPORTED_ALGO,
+                  "%s flush threw: %s", cu::algorithm_name(a).c_str(), e.what());
+            continue;
+        }
+        cu::DecompressStream ds(a);
+        auto got = ds.write(std::span<const std::uint8_t>(wire));
+        CHECK(got == in, "%s flushed prefix: %zu of %zu bytes",
+              cu::algorithm_name(a).c_str(), got.size(), in.size());
+        (void)cs.finish();
+    }
+    return 0;
+}
+
+// A pledged zstd stream records its size; frame_info reads it back.
+static int test_frame_info() {
+    if (!cu::is_available(cu::Algorithm::Zstd)) return 0;
+    auto in = sample(10 * 1024);
+    cu::CompressStream cs(cu::Algorithm::Zstd, 5);
+    cs.set_pledged_size(in.size());
+    auto z = cs.write(std::span<const std::uint8_t>(in));
+    auto tail = cs.finish();
+    z.insert(z.end(), tail.begin(), tail.end());
+    auto fi = cu::frame_info(cu::Algorithm::Zstd, std::span<const std::uint8_t>(z));
+    CHECK(fi.content_size == in.size(), "frame_info content_size %llu",
+          static_cast<unsigned long long>(fi.content_size));
+    try {
+        (void)cu::frame_info(cu::Algorithm::Zstd, std::span<const std::uint8_t>(z.data(), 2));
+        CHECK(false, "expected cu::Error on a truncated header");
+    } catch (const cu::Error& e) {
+        CHECK(e.code() == CU_ERR_TRUNCATED, "truncated header code=%d", static_cast<int>(e.code()));
+    }
+    return 0;
+}
+
+static int test_iovec() {
+    if (!cu::is_available(cu::Algorithm::Zstd)) return 0;
+    auto in = sample(30 * 1024);
+    const std::size_t split = 1000;
+    cu::ConstIovec pieces[2] = {{in.data(), split}, {in.data() + split, in.size() - split}};
+    std::size_t bound = cu_compress_bound(in.size(), CU_ALGO_ZSTD);
+    std::vector<std::uint8_t> pool(bound);
+    cu::Iovec pages[2] = {{pool.data(), bound / 2}, {pool.data() + bound / 2, bound - bound / 2}};
+    std::size_t n = cu::compressv(cu::Algorithm::Zstd, pieces, pages, 5);
+    pool.resize(n);
+    CHECK(cu::decompress(cu::Algorithm::Zstd, pool) == in, "compressv round-trip");
+
+    std::vector<std::uint8_t> back(in.size());
+    cu::ConstIovec frame[1] = {{pool.data(), pool.size()}};
+    cu::Iovec outs[3] = {{back.data(), 7}, {back.data() + 7, 4096},
+                         {back.data() + 4103, back.size() - 4103}};
+    n = cu::decompressv(cu::Algorithm::Zstd, frame, outs);
+    CHECK(n == in.size() && back == in, "decompressv round-trip");
+    return 0;
+}
+
+// lz4 with its content checksum omitted still round-trips; a corrupted
+// checksum is rejected unless the reader trusts its input.
+static int test_checksum() {
+    if (!cu::is_available(cu::Algorithm::Lz4)) return 0;
+    auto in = sample(20 * 1024);
+    cu::CompressStream plain(cu::Algorithm::Lz4, 5);
+    plain.set_checksum(false);
+    auto z = plain.write(std::span<const std::uint8_t>(in));
+    auto tail = plain.finish();
+    z.insert(z.end(), tail.begin(), tail.end());
+    CHECK(!cu::frame_info(cu::Algorithm::Lz4, z).has_checksum, "lz4 checksum not omitted");
+    CHECK(cu::decompress(cu::Algorithm::Lz4, z) == in, "checksum-free round-trip");
+
+    z = cu::compress(cu::Algorithm::Lz4, in, 5);
+    z.back() ^= 0x5a;
+    try {
+        (void)cu::decompress(cu::Algorithm::Lz4, z);
+        CHECK(false, "corrupt checksum accepted");
+    } catch (const cu::Error& e) {
+        CHECK(e.code() == CU_ERR_DECOMPRESSION, "corrupt checksum code=%d", static_cast<int>(e.code()));
+    }
+    cu::DecompressStream ds(cu::Algorithm::Lz4);
+    ds.set_skip_checksum(true);
+    auto got = ds.write(std::span<const std::uint8_t>(z));
+    auto rest = ds.finish();
+    got.insert(got.end(), rest.begin(), rest.end());
+    CHECK(got == in, "trusted decode");
+    return 0;
+}
+
+// Runs submitted work on the calling thread — exercises the pluggable
+// executor path without a pool.
+struct InlineExecutor {
+    int submitted = 0;
+    void execute(std::function<void()> f) { submitted++; f(); }
+};
+
+static cu::Task<std::vector<std::uint8_t>> async_roundtrip(
+    cu::Algorithm a, std::span<const std::uint8_t> in, cu::ExecutorRef ex
+) {
+    auto compressed = co_await cu::async_compress(a, in, 5, ex);
+    co_return co_await cu::async_decompress(a, compressed, ex);
+}
+
+static cu::Task<std::vector<std::uint8_t>> async_stream_roundtrip(
+    cu::Algorithm a, std::span<const std::uint8_t> in, std::size_t chunk, cu::ExecutorRef ex
+) {
+    // max_buffered smaller than one chunk: every write() has to wait for
+    // the codec, which is the backpressure path.
+    cu::AsyncCompressStream cs(a, 5, ex, chunk / 4);
+    std::vector<std::uint8_t> compressed;
+    for (std::size_t off = 0; off < in.size(); off += chunk) {
+        std::size_t n = std::min(chunk, in.size() - off);
+        auto piece = co_await cs.write(in.subspan(off, n));
+        compressed.insert(compressed.end(), piece.begin(), piece.end());
+    }
+    auto tail = co_await cs.finish();
+    compressed.insert(compressed.end(), tail.begin(), tail.end());
+
+    cu::AsyncDecompressStream ds(a, ex);
+    std::vector<std::uint8_t> out;
+    for (std::size_t off = 0; off < compressed.size(); off += chunk) {
+        std::size_t n = std::min(chunk, compressed.size() - off);
+        auto piece = co_await ds.write(std::span<const std::uint8_t>(compressed).subspan(off, n));
+        out.insert(out.end(), piece.begin(), piece.end());
+    }
+    auto rest = co_await ds.finish();
+    out.insert(out.end(), rest.begin(), rest.end());
+    co_return out;
+}
+
+static int test_async() {
+    auto in = sample(96 * 1024);
+    InlineExecutor inline_ex;
+    for (auto a : ALL) {
+        if (!cu::is_available(a)) continue;
+        auto name = cu::algorithm_name(a);
+
+        auto pooled = cu::sync_wait(async_roundtrip(a, in, cu::default_executor()));
+        CHECK(pooled == in, "%s async one-shot (pool) mismatch", name.c_str());
+
+        auto inlined = cu::sync_wait(async_roundtrip(a, in, inline_ex));
+        CHECK(inlined == in, "%s async one-shot (inline) mismatch", name.c_str());
+
+        auto streamed = cu::sync_wait(
+            async_stream_roundtrip(a, in, 8 * 1024, cu::default_executor()));
+        CHECK(streamed == in, "%s async stream (pool) mismatch", name.c_str());
+
+        // The pump runs inside write()/finish() here, so they must not hold
+        // the stream's lock while submitting it.
+        auto streamed_inline = cu::sync_wait(async_stream_roundtrip(a, in, 8 * 1024, inline_ex));
+        CHECK(streamed_inline == in, "%s async stream (inline) mismatch", name.c_str());
+    }
+    CHECK(inline_ex.submitted > 0, "inline executor never used");
+
+    // Errors raised on the executor surface at the co_await.
+    std::vector<std::uint8_t> garbage(32, 0xff);
+    auto bad_oneshot = [&]() -> cu::Task<std::vector<std::uint8_t>> {
+        co_return co_await cu::async_decompress(cu::Algorithm::Zstd, garbage);
+    };
+    try {
+        auto _ = cu::sync_wait(bad_oneshot());
+        (void)_;
+        CHECK(false, "expected cu::Error from async decompress");
+    } catch (const cu::Error& e) {
+        CHECK(e.code() != CU_OK, "async Error reported CU_OK");
+    }
+    auto bad_stream = [&]() -> cu::Task<void> {
+        cu::AsyncDecompressStream ds(cu::Algorithm::Zstd);
+        (void)co_await ds.write(garbage);
+        (void)co_await ds.finish();
+    };
+    try {
+        cu::sync_wait(bad_stream());
+        CHECK(false, "expected cu::Error from async stream");
+    } catch (const cu::Error& e) {
+        CHECK(e.code() != CU_OK, "async stream Error reported CU_OK");
+    }
+    return 0;
+}
+
+static int test_iostream() {
+    auto in = sample(200 * 1024);
+    const char* raw = reinterpret_cast<const char*>(in.data());
+    constexpr std::size_t buf = 4 * 1024;  // small, so both bypass paths fire
+    for (auto a : ALL) {
+        if (!cu::is_available(a)) continue;
+        auto name = cu::algorithm_name(a);
+
+        std::stringstream file;
+        {
+            cu::ocompressstream out(file, a, 5, buf);
+            out.write(raw, 100);                      // buffered
+            out.write(raw + 100, 64 * 1024);          // > buffer: direct to codec
+            for (std::size_t i = 100 + 64 * 1024; i < in.size(); i++) out.put(raw[i]);
+            out.flush();
+            out.finish();
+            CHECK(out.good(), "%s ocompressstream went bad", name.c_str());
+        }
+
+        std::string compressed = file.str();
+        auto oneshot = cu::decompress(a, std::span<const std::uint8_t>(
+            reinterpret_cast<const std::uint8_t*>(compressed.data()), compressed.size()));
+        CHECK(oneshot == in, "%s ocompressstream output mismatch", name.c_str());
+
+        // Large reads bypass the get area; then finish byte-by-byte.
+        file.seekg(0);
+        cu::icompressstream is(file, a, buf);
+        std::vector<std::uint8_t> back(in.size());
+        is.read(reinterpret_cast<char*>(back.data()), 150 * 1024);
+        CHECK(is.gcount() == 150 * 1024, "%s short bulk read", name.c_str());
+        std::string rest{std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+        CHECK(rest.size() == in.size() - 150 * 1024, "%s tail size %zu", name.c_str(), rest.size());
+        std::memcpy(back.data() + 150 * 1024, rest.data(), rest.size());
+        CHECK(back == in, "%s icompressstream mismatch", name.c_str());
+    }
+
+    // Corrupt input surfaces as badbit (not a silent EOF) on the istream.
+    std::stringstream junk(std::string(64, '\xff'));
+    cu::icompressstream bad(junk, cu::Algorithm::Zstd);
+    char c;
+    bad.read(&c, 1);
+    CHECK(bad.bad(), "corrupt input did not set badbit");
+    return 0;
+}
+
+template <cu::Algorithm A>
+concept takes_level = requires(std::span<const std::uint8_t> s) { cu::Codec<A>::compress(s, 1); };
+
+// cu::Codec<A> must produce what the generic calls produce, and read it back
+// through both the sized and the DecompressStream paths.
+template <cu::Algorithm A>
+static int codec_roundtrip(std::span<const std::uint8_t> in) {
+    using C = cu::Codec<A>;
+    auto name = cu::algorithm_name(A);
+    std::vector<std::uint8_t> z;
+    if constexpr (takes_level<A>) {
+        z = C::compress(in, 1);
+        CHECK(z == cu::compress(A, in, 1), "%s Codec output differs", name.c_str());
+    } else {
+        z = C::compress(in);
+        CHECK(z == cu::compress(A, in), "%s Codec output differs", name.c_str());
+    }
+    CHECK(C::decompress(z) == std::vector<std::uint8_t>(in.begin(), in.end()),
+          "%s Codec round-trip mismatch", name.c_str());
+
+    std::vector<std::uint8_t> buf(C::compress_bound(in.size()));
+    std::size_t n = C::compress(in, buf);
+    std::vector<std::uint8_t> back(in.size());
+    CHECK(C::decompress(std::span<const std::uint8_t>(buf.data(), n), back) == in.size() &&
+          std::equal(back.begin(), back.end(), in.begin()),
+          "%s Codec buffer round-trip mismatch", name.c_str());
+    return 0;
+}
+
+static int test_codec() {
+    auto in = sample(300);
+    std::span<const std::uint8_t> s(in);
+#ifdef INCLUDE_LZ4
+    if (codec_roundtrip<cu::Algorithm::Lz4>(s)) return 1;
+    auto fast = cu::Codec<cu::Algorithm::Lz4>::compress(s, CU_LEVEL_MIN);
+    CHECK(fast == cu::compress(cu::Algorithm::Lz4, s, CU_LEVEL_MIN), "lz4 speed tier differs");
+#endif
+#ifdef INCLUDE_SNAPPY
+    if (codec_roundtrip<cu::Algorithm::Snappy>(s)) return 1;
+#endif
+#ifdef INCLUDE_ZSTD
+    if (codec_roundtrip<cu::Algorithm::Zstd>(s)) return 1;
+#endif
+#ifdef INCLUDE_ZLIB
+    if (codec_roundtrip<cu::Algorithm::Zlib>(s)) return 1;  // size unknown: stream path
+#endif
+#ifdef INCLUDE_XZ
+    if (codec_roundtrip<cu::Algorithm::Lzma>(s)) return 1;
+#endif
+
+    // Levels are checked per codec; snappy takes none.
+    static_assert(cu::Level<cu::Algorithm::Zstd>::min == CU_LEVEL_MIN);
+    static_assert(cu::Level<cu::Algorithm::Zlib>::min == 0);
+    static_assert(takes_level<cu::Algorithm::Zlib> && !takes_level<cu::Algorithm::Snappy>);
+    static_assert(cu::Codec<cu::Algorithm::Lz4>::default_level == 5);
+
+#ifdef INCLUDE_LZ4
+    // Errors still surface as cu::Error with the codec's status.
+    std::vector<std::uint8_t> junk(64, 0xff);
+    try {
+        cu::Codec<cu::Algorithm::Lz4>::decompress(junk);
+        CHECK(false, "lz4 Codec accepted junk");
+    } catch (const cu::Error& e) {
+        CHECK(e.code() != CU_OK, "lz4 Codec error without a code");
+    }
+#endif
+    return 0;
+}
+
 int main() {
     std::printf("cu version: %s\n", cu::version().c_str());
     if (test_freefn_roundtrip())  return 1;
     if (test_stream_roundtrip())  return 1;
     if (test_error_translation()) return 1;
+    if (test_stream_flush())      return 1;
+    if (test_frame_info())        return 1;
+    if (test_iovec())             return 1;
+    if (test_checksum())          return 1;
+    if (test_async())             return 1;
+    if (test_iostream())          return 1;
+    if (test_codec())             return 1;
     std::printf("OK\n");
     return 0;
 }
@@ -146,6 +146,44 @@ func SetMaxDecompressedSize(bytes uint64) {
 	C.cu_set_max_decompressed_size(C.size_t(bytes))
 }
 
+// SetHugePages backs codec allocations of at least threshold bytes (the
+// match-finder tables of xz, zstd and brotli at their top levels) with 2 MiB
+// huge pages. 0 turns it off; HugePagesDefaultThreshold is a good start.
+// Linux only; a no-op elsewhere.
+func SetHugePages(threshold uint64) {
+	C.cu_set_huge_pages(C.size_t(threshold))
+}
+
+// HugePagesDefaultThreshold is the threshold CU_HUGE_PAGES=1 uses.
+const HugePagesDefaultThreshold = 4 << 20
+
+// Warmup takes the first-call costs of the given algorithms and levels
+// (code page faults, first context allocations) now rather than on the
+// first real call. Empty algos means every available algorithm; empty
+// levels means DefaultLevel.
+func Warmup(algos []Algorithm, levels []int) error {
+	runtime.LockOSThread()
+	defer runtime.UnlockOSThread()
+
+	var ca *C.cu_algorithm_t
+	var cl *C.int
+	cAlgos := make([]C.cu_algorithm_t, len(algos))
+	for i, a := range algos {
+		cAlgos[i] = C.cu_algorithm_t(a)
+	}
+	cLevels := make([]C.int, len(levels))
+	for i, l := range levels {
+		cLevels[i] = C.int(l)
+	}
+	if len(cAlgos) > 0 {
+		ca = &cAlgos[0]
+	}
+	if len(cLevels) > 0 {
+		cl = &cLevels[0]
+	}
+	return statusErr(C.cu_warmup(ca, C.size_t(len(cAlgos)), cl, C.size_t(len(cLevels))))
+}
+
 // Compress compresses data with the given algorithm at the given level
 // (1 fastest .. 10 smallest) and returns the compressed bytes.
 func Compress(algo Algorithm, data []byte, level int) ([]byte, error) {
@@ -220,3 +258,37 @@ func decompressOneShot(algo Algorithm, data []byte) (out []byte, unknownSize boo
 		return nil, false, statusErr(st)
 	}
 }
+
+// FrameSizeUnknown is FrameInfo.ContentSize when the header omits it.
+const FrameSizeUnknown = ^uint64(0)
+
+// FrameInfo is what the first frame header of a compressed buffer declares.
+type FrameInfo struct {
+	ContentSize       uint64 // decoded bytes in the frame, or FrameSizeUnknown
+	WindowSize        uint64 // history the decoder keeps; 0 if not declared
+	BlockSize         uint64 // largest decoded block; 0 if no fixed limit
+	DictID            uint32 // dictionary the frame needs; 0 if none
+	HasChecksum       bool
+	BlocksIndependent bool
+}
+
+// ParseFrameInfo reads the header at the start of data without decoding
+// anything, so callers can preallocate and pick memory budgets up front.
+func ParseFrameInfo(algo Algorithm, data []byte) (FrameInfo, error) {
+	runtime.LockOSThread()
+	defer runtime.UnlockOSThread()
+
+	var fi C.cu_frame_info_t
+	st := C.cu_frame_info(C.cu_algorithm_t(algo), bytePtr(data), C.size_t(len(data)), &fi)
+	if err := statusErr(st); err != nil {
+		return FrameInfo{}, err
+	}
+	return FrameInfo{
+		ContentSize:       uint64(fi.content_size),
+		WindowSize:        uint64(fi.window_size),
+		BlockSize:         uint64(fi.block_size),
+		DictID:            uint32(fi.dict_id),
+		HasChecksum:       fi.has_checksum != 0,
+		BlocksIndependent: fi.blocks_independent != 0,
+	}, nil
+}
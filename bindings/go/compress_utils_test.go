@@ -162,6 +162,127 @@ func TestCrossAPI(t *testing.T) {
 	}
 }
 
+// TestWriterFlush checks that Flush output decodes before Close ends the
+// frame — the property a message-per-flush socket protocol relies on.
+func TestWriterFlush(t *testing.T) {
+	data := payloads()["text_18k"]
+	for _, a := range allAlgos {
+		if !Available(a) {
+			continue
+		}
+		t.Run(a.Name(), func(t *testing.T) {
+			var buf bytes.Buffer
+			w, err := NewWriter(&buf, a, DefaultLevel)
+			if err != nil {
+				t.Fatalf("NewWriter: %v", err)
+			}
+			defer w.Close()
+			if _, err := w.Write(data); err != nil {
+				t.Fatalf("Write: %v", err)
+			}
+			err = w.Flush()
+			if a == Bz2 || a == Snappy {
+				var ce *Error
+				if !errors.As(err, &ce) || ce.Code != ErrUnsupported {
+					t.Fatalf("Flush: want ErrUnsupported, got %v", err)
+				}
+				return
+			}
+			if err != nil {
+				t.Fatalf("Flush: %v", err)
+			}
+			r, err := NewReader(bytes.NewReader(buf.Bytes()), a)
+			if err != nil {
+				t.Fatalf("NewReader: %v", err)
+			}
+			defer r.Close()
+			got := make([]byte, len(data))
+			if _, err := io.ReadFull(r, got); err != nil {
+				t.Fatalf("ReadFull of flushed prefix: %v", err)
+			}
+			if !bytes.Equal(got, data) {
+				t.Fatal("flushed prefix mismatch")
+			}
+		})
+	}
+}
+
+func TestChecksumOptions(t *testing.T) {
+	if !Available(Lz4) {
+		t.Skip("lz4 not built")
+	}
+	data := payloads()["text_18k"]
+	var buf bytes.Buffer
+	w, err := NewWriter(&buf, Lz4, DefaultLevel)
+	if err != nil {
+		t.Fatalf("NewWriter: %v", err)
+	}
+	if err := w.SetChecksum(false); err != nil {
+		t.Fatalf("SetChecksum: %v", err)
+	}
+	if _, err := w.Write(data); err != nil {
+		t.Fatalf("Write: %v", err)
+	}
+	if err := w.Close(); err != nil {
+		t.Fatalf("Close: %v", err)
+	}
+	fi, err := ParseFrameInfo(Lz4, buf.Bytes())
+	if err != nil {
+		t.Fatalf("ParseFrameInfo: %v", err)
+	}
+	if fi.HasChecksum {
+		t.Fatalf("checksum written after SetChecksum(false)")
+	}
+
+	r, err := NewReader(bytes.NewReader(buf.Bytes()), Lz4)
+	if err != nil {
+		t.Fatalf("NewReader: %v", err)
+	}
+	defer r.Close()
+	if err := r.SetSkipChecksum(true); err != nil {
+		t.Fatalf("SetSkipChecksum: %v", err)
+	}
+	got, err := io.ReadAll(r)
+	if err != nil {
+		t.Fatalf("ReadAll: %v", err)
+	}
+	if !bytes.Equal(got, data) {
+		t.Fatalf("round-trip mismatch: %d vs %d bytes", len(got), len(data))
+	}
+}
+
+func TestPledgedSizeFrameInfo(t *testing.T) {
+	for _, a := range []Algorithm{Zstd, Lz4} {
+		if !Available(a) {
+			continue
+		}
+		t.Run(a.Name(), func(t *testing.T) {
+			data := payloads()["text_18k"]
+			var buf bytes.Buffer
+			w, err := NewWriter(&buf, a, DefaultLevel)
+			if err != nil {
+				t.Fatalf("NewWriter: %v", err)
+			}
+			if err := w.SetPledgedSize(uint64(len(data))); err != nil {
+				t.Fatalf("SetPledgedSize: %v", err)
+			}
+			if _, err := w.Write(data); err != nil {
+				t.Fatalf("Write: %v", err)
+			}
+			if err := w.Close(); err != nil {
+				t.Fatalf("Close: %v", err)
+			}
+			fi, err := ParseFrameInfo(a, buf.Bytes())
+			if err != nil {
+				t.Fatalf("ParseFrameInfo: %v", err)
+			}
+			if fi.ContentSize != uint64(len(data)) {
+				t.Fatalf("ContentSize = %d, want %d", fi.ContentSize, len(data))
+			}
+		})
+	}
+}
+
 func TestDecompressGarbage(t *testing.T) {
 	for _, a := range allAlgos {
 		if !Available(a) {
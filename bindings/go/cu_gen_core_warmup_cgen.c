@@ -0,0 +1,2 @@
+/* Code generated by tools/gen-go-cgo.py from third_party/manifest.json. DO NOT EDIT. */
+#include "../../src/warmup.c"
@@ -91,6 +91,75 @@ func (w *Writer) Write(p []byte) (int, error) {
 	}
 }
 
+// Flush makes everything written so far decodable by the reader without
+// ending the frame (a codec sync point), forwarding the output to the sink.
+// Each call costs some ratio, so flush at message boundaries, not per Write.
+// bz2 and snappy cannot flush and return ErrUnsupported.
+func (w *Writer) Flush() error {
+	if w.closed {
+		return errClosed
+	}
+	runtime.LockOSThread()
+	defer runtime.UnlockOSThread()
+
+	for {
+		outLen := C.size_t(len(w.scratch))
+		st := C.cu_compress_stream_flush(w.stream, bytePtr(w.scratch), &outLen)
+		if n := int(outLen); n > 0 {
+			if _, err := w.sink.Write(w.scratch[:n]); err != nil {
+				return err
+			}
+		}
+		if st == C.CU_OK {
+			return nil
+		}
+		if Status(st) != ErrBufTooSmall {
+			return statusErr(st)
+		}
+	}
+}
+
+// SetTargetBlockSize asks the codec to emit compressed blocks of about n
+// bytes so a reader can decode them as they arrive (zstd only; 0 restores
+// the default). It must be called before the first Write or Flush.
+func (w *Writer) SetTargetBlockSize(n int) error {
+	if w.closed {
+		return errClosed
+	}
+	runtime.LockOSThread()
+	defer runtime.UnlockOSThread()
+	return statusErr(C.cu_compress_stream_set_target_block_size(w.stream, C.size_t(n)))
+}
+
+// SetPledgedSize declares the exact number of bytes that will be written,
+// before the first Write. zstd and lz4 record it in the frame header (see
+// ParseFrameInfo); writing more, or closing after fewer, is an error. zlib,
+// gzip, bz2 and xz return ErrUnsupported.
+func (w *Writer) SetPledgedSize(n uint64) error {
+	if w.closed {
+		return errClosed
+	}
+	runtime.LockOSThread()
+	defer runtime.UnlockOSThread()
+	return statusErr(C.cu_compress_stream_set_pledged_size(w.stream, C.uint64_t(n)))
+}
+
+// SetChecksum writes (true) or omits (false) the frame content checksum,
+// before the first Write. zstd, lz4 and xz only; others return
+// ErrUnsupported.
+func (w *Writer) SetChecksum(enabled bool) error {
+	if w.closed {
+		return errClosed
+	}
+	var on C.int
+	if enabled {
+		on = 1
+	}
+	runtime.LockOSThread()
+	defer runtime.UnlockOSThread()
+	return statusErr(C.cu_compress_stream_set_checksum(w.stream, on))
+}
+
 // Close flushes any buffered data, finalizes the frame, and releases the
 // underlying C stream. It is safe to call more than once.
 func (w *Writer) Close() error {
@@ -261,6 +330,22 @@ func (r *Reader) pump() error {
 	}
 }
 
+// SetSkipChecksum turns on trusted-input mode: content checksums are not
+// verified. Use it only when something else already guarantees integrity.
+// Call before the first Read; bz2, brotli and snappy return ErrUnsupported.
+func (r *Reader) SetSkipChecksum(skip bool) error {
+	if r.closed {
+		return errClosed
+	}
+	var on C.int
+	if skip {
+		on = 1
+	}
+	runtime.LockOSThread()
+	defer runtime.UnlockOSThread()
+	return statusErr(C.cu_decompress_stream_set_skip_checksum(r.stream, on))
+}
+
 // Close releases the underlying C stream. It is safe to call more than once.
 func (r *Reader) Close() error {
 	if r.closed {
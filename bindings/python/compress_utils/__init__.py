@@ -14,17 +14,24 @@
 #   version()                       → "MAJOR.MINOR.PATCH"
 #   is_available(algorithm)         → bool
 #   set_max_decompressed_size(b)    → cap one-shot decompression
+#   set_huge_pages(threshold)       → huge pages for large codec tables (0 = off)
+#   warmup(algorithms, levels)      → take first-call costs at startup
+#   frame_info(data, algorithm)     → FrameInfo parsed from the first header
 
 from .compress_utils_py import (
     Algorithm,
     CompressStream,
     DecompressStream,
     CompressError,
+    FrameInfo,
     compress,
     decompress,
+    frame_info,
     is_available,
+    set_huge_pages,
     set_max_decompressed_size,
     version,
+    warmup,
 )
 
 __all__ = [
@@ -32,9 +39,13 @@ __all__ = [
     "CompressStream",
     "DecompressStream",
     "CompressError",
+    "FrameInfo",
     "compress",
     "decompress",
+    "frame_info",
     "is_available",
+    "set_huge_pages",
     "set_max_decompressed_size",
     "version",
+    "warmup",
 ]
@@ -4,7 +4,7 @@ Python bindings for compress-utils library (C-core).
 from __future__ import annotations
 import typing
 import typing_extensions
-__all__: list[str] = ['Algorithm', 'CompressError', 'CompressStream', 'DecompressStream', 'brotli', 'bz2', 'compress', 'decompress', 'gzip', 'is_available', 'lz4', 'lzma', 'set_max_decompressed_size', 'snappy', 'version', 'xz', 'zlib', 'zstd']
+__all__: list[str] = ['Algorithm', 'CompressError', 'CompressStream', 'DecompressStream', 'FrameInfo', 'brotli', 'bz2', 'compress', 'decompress', 'frame_info', 'gzip', 'is_available', 'lz4', 'lzma', 'set_huge_pages', 'set_max_decompressed_size', 'snappy', 'version', 'warmup', 'xz', 'zlib', 'zstd']
 class Algorithm:
     """
     Members:
@@ -75,6 +75,22 @@ class CompressStream:
         ...
     def finish(self) -> bytes:
         ...
+    def flush(self) -> bytes:
+        """
+        Make everything compressed so far decodable without ending the frame.
+        """
+    def set_checksum(self, enabled: bool) -> None:
+        """
+        Write or omit the frame content checksum (zstd, lz4, xz). Call before the first compress().
+        """
+    def set_pledged_size(self, size: int) -> None:
+        """
+        Declare the exact total input before the first compress(); zstd and lz4 record it in the frame header.
+        """
+    def set_target_block_size(self, size: int) -> None:
+        """
+        zstd only: cap compressed block size (low-latency streaming). Call before the first compress().
+        """
 class DecompressStream:
     """
     Streaming decompression. Feed chunks via .decompress(b); flush with .finish().
@@ -85,6 +101,38 @@ class DecompressStream:
         ...
     def finish(self) -> bytes:
         ...
+    def set_skip_checksum(self, skip: bool) -> None:
+        """
+        Trusted input: don't verify content checksums. Call before the first decompress().
+        """
+class FrameInfo:
+    """
+    What a frame header declares; see frame_info().
+    """
+    @property
+    def block_size(self) -> int:
+        """
+        Largest decoded block; 0 if there is no fixed limit.
+        """
+    @property
+    def blocks_independent(self) -> bool:
+        ...
+    @property
+    def content_size(self) -> typing.Any:
+        """
+        Decoded bytes in the frame, or None if the header omits it.
+        """
+    @property
+    def dict_id(self) -> int:
+        ...
+    @property
+    def has_checksum(self) -> bool:
+        ...
+    @property
+    def window_size(self) -> int:
+        """
+        History the decoder keeps; 0 if not declared.
+        """
 def compress(data: typing_extensions.Buffer, algorithm: typing.Any, level: int = 5) -> bytes:
     """
     Compress bytes/buffer using the given algorithm (string or Algorithm).
@@ -93,12 +141,22 @@ def decompress(data: typing_extensions.Buffer, algorithm: typing.Any) -> bytes:
     """
     Decompress bytes/buffer using the given algorithm.
     """
+def frame_info(data: typing_extensions.Buffer, algorithm: typing.Any) -> FrameInfo:
+    """
+    Parse the first frame header: sizes, checksum flag, dictionary id.
+    """
 def is_available(algorithm: typing.Any) -> bool:
     ...
+def set_huge_pages(threshold: int = 4194304) -> None:
+    ...
 def set_max_decompressed_size(bytes: int) -> None:
     ...
 def version() -> str:
     ...
+def warmup(algorithms: typing.Any = None, levels: list[int] = []) -> None:
+    """
+    Take first-call costs (page faults, first context allocations) up front.
+    """
 brotli: Algorithm  # value = <Algorithm.brotli: 1>
 bz2: Algorithm  # value = <Algorithm.bz2: 3>
 gzip: Algorithm  # value = <Algorithm.gzip: 8>
@@ -91,6 +91,18 @@ PYBIND11_MODULE(compress_utils_py, m) {
     }, py::arg("algorithm"));
     m.def("set_max_decompressed_size", &cu::set_max_decompressed_size,
           py::arg("bytes"));
+    m.def("set_huge_pages", &cu::set_huge_pages,
+          py::arg("threshold") = CU_HUGE_PAGES_DEFAULT_THRESHOLD);
+    m.def("warmup", [](const py::object& algorithms, const std::vector<int>& levels) {
+        std::vector<cu::Algorithm> algos;
+        if (!algorithms.is_none()) {
+            for (const auto& a : algorithms) {
+                algos.push_back(parse_algorithm(py::reinterpret_borrow<py::object>(a)));
+            }
+        }
+        cu::warmup(algos, levels);
+    }, py::arg("algorithms") = py::none(), py::arg("levels") = std::vector<int>{},
+       "Take first-call costs (page faults, first context allocations) up front.");
 
     /* Functional API. */
     m.def("compress", [](py::buffer data, const py::object& algorithm, int level) {
@@ -103,6 +115,27 @@ PYBIND11_MODULE(compress_utils_py, m) {
     }, py::arg("data"), py::arg("algorithm"),
        "Decompress bytes/buffer using the given algorithm.");
 
+    py::class_<cu::FrameInfo>(m, "FrameInfo",
+        "What a frame header declares; see frame_info().")
+        .def_property_readonly("content_size", [](const cu::FrameInfo& f) -> py::object {
+            if (f.content_size == cu::FRAME_SIZE_UNKNOWN) return py::none();
+            return py::int_(f.content_size);
+        }, "Decoded bytes in the frame, or None if the header omits it.")
+        .def_readonly("window_size", &cu::FrameInfo::window_size,
+                      "History the decoder keeps; 0 if not declared.")
+        .def_readonly("block_size", &cu::FrameInfo::block_size,
+                      "Largest decoded block; 0 if there is no fixed limit.")
+        .def_readonly("dict_id", &cu::FrameInfo::dict_id)
+        .def_property_readonly("has_checksum",
+                               [](const cu::FrameInfo& f) { return f.has_checksum != 0; })
+        .def_property_readonly("blocks_independent",
+                               [](const cu::FrameInfo& f) { return f.blocks_independent != 0; });
+
+    m.def("frame_info", [](py::buffer data, const py::object& algorithm) {
+        return cu::frame_info(parse_algorithm(algorithm), as_span(data));
+    }, py::arg("data"), py::arg("algorithm"),
+       "Parse the first frame header: sizes, checksum flag, dictionary id.");
+
     /* Streaming. */
     py::class_<cu::CompressStream>(m, "CompressStream",
         "Streaming compression. Feed chunks via .compress(b); flush with .finish().")
@@ -114,7 +147,22 @@ PYBIND11_MODULE(compress_utils_py, m) {
         }, py::arg("data"))
         .def("finish", [](cu::CompressStream& self) {
             return to_bytes(self.finish());
-        });
+        })
+        .def("flush", [](cu::CompressStream& self) {
+            return to_bytes(self.flush());
+        }, "Make everything compressed so far decodable without ending the frame.")
+        .def("set_target_block_size", &cu::CompressStream::set_target_block_size,
+             py::arg("size"),
+             "zstd only: cap compressed block size (low-latency streaming). "
+             "Call before the first compress().")
+        .def("set_pledged_size", &cu::CompressStream::set_pledged_size,
+             py::arg("size"),
+             "Declare the exact total input before the first compress(); "
+             "zstd and lz4 record it in the frame header.")
+        .def("set_checksum", &cu::CompressStream::set_checksum,
+             py::arg("enabled"),
+             "Write or omit the frame content checksum (zstd, lz4, xz). "
+             "Call before the first compress().");
 
     py::class_<cu::DecompressStream>(m, "DecompressStream",
         "Streaming decompression. Feed chunks via .decompress(b); flush with .finish().")
@@ -126,7 +174,11 @@ PYBIND11_MODULE(compress_utils_py, m) {
         }, py::arg("data"))
         .def("finish", [](cu::DecompressStream& self) {
             return to_bytes(self.finish());
-        });
+        })
+        .def("set_skip_checksum", &cu::DecompressStream::set_skip_checksum,
+             py::arg("skip"),
+             "Trusted input: don't verify content checksums. "
+             "Call before the first decompress().");
 
     /* Translate cu::Error to a Python exception. */
     static py::exception<cu::Error> cu_error_exc(m, "CompressError");
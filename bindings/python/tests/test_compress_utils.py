@@ -86,6 +86,31 @@ class TestCompressUtils(unittest.TestCase):
                 ds = cu.DecompressStream(name)
                 self.assertEqual(ds.decompress(compressed_b) + ds.finish(), data)
 
+    def test_stream_flush(self):
+        for name in available_algorithms():
+            with self.subTest(algorithm=name):
+                data = b"msg-0001 " * 512
+                cs = cu.CompressStream(name, 5)
+                if name in ("bz2", "snappy"):
+                    cs.compress(data)
+                    with self.assertRaises(cu.CompressError):
+                        cs.flush()
+                    continue
+                wire = cs.compress(data) + cs.flush()
+                ds = cu.DecompressStream(name)
+                self.assertEqual(ds.decompress(wire), data)
+
+    def test_pledged_size_frame_info(self):
+        data = b"pledged " * 4096
+        cs = cu.CompressStream("zstd", 5)
+        cs.set_pledged_size(len(data))
+        frame = cs.compress(data) + cs.finish()
+        self.assertEqual(cu.frame_info(frame, "zstd").content_size, len(data))
+        cs = cu.CompressStream("zlib", 5)
+        with self.assertRaises(cu.CompressError):
+            cs.set_pledged_size(len(data))
+        self.assertIsNone(cu.frame_info(cu.compress(data, "gzip"), "gzip").content_size)
+
     def test_error_on_garbage(self):
         with self.assertRaises(cu.CompressError):
             cu.decompress(b"\xff" * 32, "zstd")
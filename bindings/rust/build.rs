@@ -16,8 +16,13 @@ use std::path::PathBuf;
 /// is not here — it reuses the zlib sources; only its vtable is added below.
 const CODECS: &[&str] = &["zstd", "brotli", "zlib", "bz2", "lz4", "xz", "snappy"];
 
-/// Our C core: the ABI dispatcher + registry.
-const CORE_SOURCES: &[&str] = &["src/compress_utils.c", "src/registry.c"];
+/// Our C core: the ABI dispatcher + registry + codec allocator hooks + warmup.
+const CORE_SOURCES: &[&str] = &[
+    "src/compress_utils.c",
+    "src/registry.c",
+    "src/alloc.c",
+    "src/warmup.c",
+];
 
 /// Per-algorithm vtables: (INCLUDE_<ALGO> define, vtable source). All are
 /// compiled and enabled, matching the CMake defaults (every INCLUDE_* ON).
@@ -46,6 +46,19 @@ pub struct cu_decompress_stream {
     _private: [u8; 0],
 }
 
+pub const CU_FRAME_SIZE_UNKNOWN: u64 = u64::MAX;
+
+#[repr(C)]
+#[derive(Default)]
+pub struct cu_frame_info {
+    pub content_size: u64,
+    pub window_size: u64,
+    pub block_size: u64,
+    pub dict_id: u32,
+    pub has_checksum: c_int,
+    pub blocks_independent: c_int,
+}
+
 extern "C" {
     pub fn cu_version() -> *const c_char;
 
@@ -84,7 +97,21 @@ extern "C" {
         out_size: *mut usize,
     ) -> c_int;
 
+    pub fn cu_frame_info(
+        algo: c_int,
+        input: *const u8,
+        in_len: usize,
+        info: *mut cu_frame_info,
+    ) -> c_int;
+
     pub fn cu_set_max_decompressed_size(bytes: usize);
+    pub fn cu_set_huge_pages(threshold: usize);
+    pub fn cu_warmup(
+        algos: *const c_int,
+        n_algos: usize,
+        levels: *const c_int,
+        n_levels: usize,
+    ) -> c_int;
 
     pub fn cu_compress_stream_create(
         algo: c_int,
@@ -103,6 +130,23 @@ extern "C" {
         out: *mut u8,
         out_len: *mut usize,
     ) -> c_int;
+    pub fn cu_compress_stream_flush(
+        stream: *mut cu_compress_stream,
+        out: *mut u8,
+        out_len: *mut usize,
+    ) -> c_int;
+    pub fn cu_compress_stream_set_target_block_size(
+        stream: *mut cu_compress_stream,
+        bytes: usize,
+    ) -> c_int;
+    pub fn cu_compress_stream_set_pledged_size(
+        stream: *mut cu_compress_stream,
+        size: u64,
+    ) -> c_int;
+    pub fn cu_compress_stream_set_checksum(
+        stream: *mut cu_compress_stream,
+        enabled: c_int,
+    ) -> c_int;
     pub fn cu_compress_stream_destroy(stream: *mut cu_compress_stream);
 
     pub fn cu_decompress_stream_create(
@@ -121,5 +165,9 @@ extern "C" {
         out: *mut u8,
         out_len: *mut usize,
     ) -> c_int;
+    pub fn cu_decompress_stream_set_skip_checksum(
+        stream: *mut cu_decompress_stream,
+        skip: c_int,
+    ) -> c_int;
     pub fn cu_decompress_stream_destroy(stream: *mut cu_decompress_stream);
 }
@@ -228,6 +228,28 @@ pub fn set_max_decompressed_size(bytes: usize) {
     );
 }
 
+/// Threshold `CU_HUGE_PAGES=1` uses for [`set_huge_pages`].
+pub const HUGE_PAGES_DEFAULT_THRESHOLD: usize = 4 << 20;
+
+/// Back codec allocations of at least `threshold` bytes (the match-finder
+/// tables of xz, zstd and brotli at their top levels) with 2 MiB huge pages.
+/// `0` turns it off. Linux only; a no-op elsewhere.
+pub fn set_huge_pages(threshold: usize) {
+    // SAFETY: plain scalar setter, thread-safe per the C ABI contract.
+    unsafe { ffi::cu_set_huge_pages(threshold) }
+}
+
+/// Take the first-call costs of `algos` × `levels` (code page faults, first
+/// context allocations) now rather than on the first real call. Empty
+/// `algos` means every available algorithm; empty `levels` means
+/// [`DEFAULT_LEVEL`].
+pub fn warmup(algos: &[Algorithm], levels: &[i32]) -> Result<(), Error> {
+    let raw: Vec<std::os::raw::c_int> = algos.iter().map(|a| a.to_raw()).collect();
+    // SAFETY: both slices are valid for their lengths for the whole call;
+    // the C side only reads them.
+    check(unsafe { ffi::cu_warmup(raw.as_ptr(), raw.len(), levels.as_ptr(), levels.len()) })
+}
+
 /// Compress `data` with `algo` at `level` (1 fastest ..= 10 smallest).
 pub fn compress(algo: Algorithm, data: &[u8], level: i32) -> Result<Vec<u8>, Error> {
     let bound = algo.compress_bound(data.len());
@@ -290,6 +312,38 @@ pub fn decompress(algo: Algorithm, data: &[u8]) -> Result<Vec<u8>, Error> {
     }
 }
 
+/// What the first frame header of a compressed buffer declares. See
+/// [`frame_info`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct FrameInfo {
+    /// Decoded bytes in the frame, if the header records it.
+    pub content_size: Option<u64>,
+    /// History the decoder keeps; 0 if not declared.
+    pub window_size: u64,
+    /// Largest decoded block; 0 if there is no fixed limit.
+    pub block_size: u64,
+    /// Dictionary the frame needs; 0 if none.
+    pub dict_id: u32,
+    pub has_checksum: bool,
+    pub blocks_independent: bool,
+}
+
+/// Parse the header at the start of `data` without decoding anything, so
+/// callers can preallocate and pick memory budgets up front.
+pub fn frame_info(algo: Algorithm, data: &[u8]) -> Result<FrameInfo, Error> {
+    let mut fi = ffi::cu_frame_info::default();
+    // SAFETY: valid slice, valid out pointer.
+    check(unsafe { ffi::cu_frame_info(algo.to_raw(), data.as_ptr(), data.len(), &mut fi) })?;
+    Ok(FrameInfo {
+        content_size: (fi.content_size != ffi::CU_FRAME_SIZE_UNKNOWN).then_some(fi.content_size),
+        window_size: fi.window_size,
+        block_size: fi.block_size,
+        dict_id: fi.dict_id,
+        has_checksum: fi.has_checksum != 0,
+        blocks_independent: fi.blocks_independent != 0,
+    })
+}
+
 /// Attempt the size-hint + one-shot path. `Ok(None)` means the caller should
 /// fall back to streaming (size not recoverable from the wire format).
 fn decompress_one_shot(algo: Algorithm, data: &[u8]) -> Result<Option<Vec<u8>>, Error> {
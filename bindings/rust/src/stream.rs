@@ -95,17 +95,72 @@ impl<W: Write> Compressor<W> {
         Ok(self.sink.take().expect("sink present"))
     }
 
+    /// Make everything written so far decodable by the reader without ending
+    /// the frame, then flush the sink. Unlike [`Write::flush`] this emits a
+    /// codec sync point and costs some ratio, so call it at message
+    /// boundaries. bz2 and snappy return [`Status::UnsupportedAlgo`].
+    pub fn sync_flush(&mut self) -> io::Result<()> {
+        if self.finished {
+            return Err(io::Error::new(
+                io::ErrorKind::Other,
+                "compress-utils: stream is finished",
+            ));
+        }
+        self.drain(ffi::cu_compress_stream_flush)?;
+        self.sink.as_mut().expect("sink present").flush()
+    }
+
+    /// Ask the codec for compressed blocks of about `bytes` so a reader can
+    /// decode them as they arrive (zstd only; 0 restores the default). Must be
+    /// called before the first write.
+    pub fn set_target_block_size(&mut self, bytes: usize) -> Result<(), Error> {
+        // SAFETY: valid handle until destroy.
+        crate::check_status(unsafe {
+            ffi::cu_compress_stream_set_target_block_size(self.stream, bytes)
+        })
+    }
+
+    /// Declare the exact number of bytes that will be written, before the
+    /// first write. zstd and lz4 record it in the frame header (see
+    /// [`crate::frame_info`]); writing more, or finishing after fewer, fails.
+    /// zlib, gzip, bz2 and xz return [`Status::UnsupportedAlgo`].
+    pub fn set_pledged_size(&mut self, bytes: u64) -> Result<(), Error> {
+        // SAFETY: valid handle until destroy.
+        crate::check_status(unsafe {
+            ffi::cu_compress_stream_set_pledged_size(self.stream, bytes)
+        })
+    }
+
+    /// Write (`true`) or omit (`false`) the frame content checksum; call
+    /// before the first write. zstd, lz4 and xz only; others return
+    /// [`Status::UnsupportedAlgo`].
+    pub fn set_checksum(&mut self, enabled: bool) -> Result<(), Error> {
+        // SAFETY: valid handle until destroy.
+        crate::check_status(unsafe {
+            ffi::cu_compress_stream_set_checksum(self.stream, enabled as std::os::raw::c_int)
+        })
+    }
+
     /// Drain the finalize phase to the sink. Idempotent.
     fn do_finish(&mut self) -> io::Result<()> {
         if self.finished {
             return Ok(());
         }
+        self.drain(ffi::cu_compress_stream_finish)?;
+        self.finished = true;
+        Ok(())
+    }
+
+    /// Run a no-input stream op (finish / flush) until it stops reporting
+    /// `BUF_TOO_SMALL`, forwarding output to the sink.
+    fn drain(
+        &mut self,
+        op: unsafe extern "C" fn(*mut ffi::cu_compress_stream, *mut u8, *mut usize) -> std::os::raw::c_int,
+    ) -> io::Result<()> {
         loop {
             let mut out_len = self.scratch.len();
             // SAFETY: valid handle + scratch buffer; out_len is in/out.
-            let st = unsafe {
-                ffi::cu_compress_stream_finish(self.stream, self.scratch.as_mut_ptr(), &mut out_len)
-            };
+            let st = unsafe { op(self.stream, self.scratch.as_mut_ptr(), &mut out_len) };
             if out_len > 0 {
                 self.sink
                     .as_mut()
@@ -113,7 +168,6 @@ impl<W: Write> Compressor<W> {
                     .write_all(&self.scratch[..out_len])?;
             }
             if st == ffi::CU_OK {
-                self.finished = true;
                 return Ok(());
             }
             if st != ffi::CU_ERR_BUF_TOO_SMALL {
@@ -183,9 +237,9 @@ impl<W: Write> Write for Compressor<W> {
     }
 
     fn flush(&mut self) -> io::Result<()> {
-        // Data is forwarded to the sink on every write; the C compress stream
-        // has no mid-stream flush that keeps the frame open, so we only flush
-        // the sink. Call finish() to finalize the frame.
+        // Data is forwarded to the sink on every write; this only flushes the
+        // sink. sync_flush() also makes the codec emit what it holds back, and
+        // finish() finalizes the frame.
         if let Some(sink) = self.sink.as_mut() {
             sink.flush()
         } else {
@@ -239,6 +293,16 @@ impl<R: Read> Decompressor<R> {
         })
     }
 
+    /// Trusted-input mode: don't verify content checksums. Only for data
+    /// whose integrity is already guaranteed; call before the first read.
+    /// bz2, brotli and snappy return [`Status::UnsupportedAlgo`].
+    pub fn set_skip_checksum(&mut self, skip: bool) -> Result<(), Error> {
+        // SAFETY: valid handle until destroy.
+        crate::check_status(unsafe {
+            ffi::cu_decompress_stream_set_skip_checksum(self.stream, skip as std::os::raw::c_int)
+        })
+    }
+
     /// Append decompressed bytes to `out` by advancing the C stream one step.
     /// Mirrors the Go reader's feed/drain/finish state machine.
     fn pump(&mut self) -> io::Result<()> {
@@ -156,6 +156,77 @@ fn streaming_large() {
     }
 }
 
+/// A sink the test can read while the Compressor still owns a handle to it.
+#[derive(Clone, Default)]
+struct SharedSink(std::rc::Rc<std::cell::RefCell<Vec<u8>>>);
+
+impl Write for SharedSink {
+    fn write(&mut self, buf: &[u8]) -> std::io::Result<usize> {
+        self.0.borrow_mut().extend_from_slice(buf);
+        Ok(buf.len())
+    }
+    fn flush(&mut self) -> std::io::Result<()> {
+        Ok(())
+    }
+}
+
+/// sync_flush() output must decode before finish() ends the frame.
+#[test]
+fn sync_flush_prefix_decodes() {
+    let data = b"{\"id\":1,\"msg\":\"hello\"}\n".repeat(200);
+    for algo in available(ALGOS) {
+        let sink = SharedSink::default();
+        let mut c = Compressor::new(sink.clone(), algo, 5).unwrap();
+        c.write_all(&data).unwrap();
+        let res = c.sync_flush();
+        if matches!(algo, Algorithm::Bz2 | Algorithm::Snappy) {
+            assert!(res.is_err(), "{algo} flush should be unsupported");
+            continue;
+        }
+        res.unwrap();
+
+        let wire = sink.0.borrow().clone();
+        let mut d = Decompressor::new(&wire[..], algo).unwrap();
+        let mut got = vec![0u8; data.len()];
+        d.read_exact(&mut got).unwrap();
+        assert!(got == data, "{algo} flushed prefix mismatch");
+        c.finish().unwrap();
+    }
+}
+
+/// A pledged zstd stream records its size, and frame_info reads it back.
+#[test]
+fn pledged_size_frame_info() {
+    if !Algorithm::Zstd.available() {
+        return;
+    }
+    let data = pseudo_random(10_000, 3);
+    let mut c = Compressor::new(Vec::new(), Algorithm::Zstd, 5).unwrap();
+    c.set_pledged_size(data.len() as u64).unwrap();
+    c.write_all(&data).unwrap();
+    let packed = c.finish().unwrap();
+    let fi = compress_utils::frame_info(Algorithm::Zstd, &packed).unwrap();
+    assert_eq!(fi.content_size, Some(data.len() as u64));
+}
+
+/// A corrupted lz4 content checksum is rejected unless the reader trusts
+/// its input.
+#[test]
+fn skip_checksum() {
+    if !Algorithm::Lz4.available() {
+        return;
+    }
+    let data = pseudo_random(10_000, 5);
+    let mut packed = compress(Algorithm::Lz4, &data, 5).unwrap();
+    *packed.last_mut().unwrap() ^= 0x5a;
+    assert!(decompress(Algorithm::Lz4, &packed).is_err());
+    let mut d = Decompressor::new(&packed[..], Algorithm::Lz4).unwrap();
+    d.set_skip_checksum(true).unwrap();
+    let mut out = Vec::new();
+    d.read_to_end(&mut out).unwrap();
+    assert_eq!(out, data);
+}
+
 /// Truncated / malformed input must error, never panic or silently succeed.
 #[test]
 fn rejects_bad_input() {
@@ -313,6 +313,67 @@ export class CompressStream extends StreamBase {
             this.dispatcher.exports.cu_compress_stream_finish(this.handle, outPtr, outLenPtr),
         );
     }
+
+    /**
+     * Everything written so far, made decodable without ending the frame —
+     * send it at a message boundary. Costs some ratio per call. bz2 and
+     * snappy throw `UnsupportedAlgo`.
+     */
+    flush(): Uint8Array {
+        this.ensureLive();
+        if (this.finished) {
+            throw new CompressError(
+                Status.StreamFinished,
+                this.dispatcher.algorithmName,
+                "flush after finish",
+            );
+        }
+        return drain(this.dispatcher, null, (_in, _len, outPtr, outLenPtr) =>
+            this.dispatcher.exports.cu_compress_stream_flush(this.handle, outPtr, outLenPtr),
+        );
+    }
+
+    /**
+     * zstd only: cap compressed blocks at about `bytes` so the peer can
+     * decode them as they arrive (0 restores the default). Call before the
+     * first `write`.
+     */
+    setTargetBlockSize(bytes: number): void {
+        this.ensureLive();
+        const status = this.dispatcher.exports.cu_compress_stream_set_target_block_size(
+            this.handle,
+            bytes,
+        );
+        checkStatus(this.dispatcher.exports, status, this.dispatcher.algorithmName);
+    }
+
+    /**
+     * Declare the exact total input before the first `write`. zstd and lz4
+     * record it in the frame header so decoders can preallocate; writing
+     * more, or finishing after fewer, throws. zlib, gzip, bz2 and xz throw
+     * `UnsupportedAlgo`.
+     */
+    setPledgedSize(bytes: number): void {
+        this.ensureLive();
+        const status = this.dispatcher.exports.cu_compress_stream_set_pledged_size(
+            this.handle,
+            BigInt(bytes),
+        );
+        checkStatus(this.dispatcher.exports, status, this.dispatcher.algorithmName);
+    }
+
+    /**
+     * Write (`true`) or omit (`false`) the frame content checksum. Call before
+     * the first `write()`. zstd, lz4 and xz only; others throw `UnsupportedAlgo`.
+     */
+    setChecksum(enabled: boolean): void {
+        this.ensureLive();
+        const status = this.dispatcher.exports.cu_compress_stream_set_checksum(
+            this.handle,
+            enabled ? 1 : 0,
+        );
+        checkStatus(this.dispatcher.exports, status, this.dispatcher.algorithmName);
+    }
 }
 
 export class DecompressStream extends StreamBase {
@@ -340,6 +401,20 @@ export class DecompressStream extends StreamBase {
             this.dispatcher.exports.cu_decompress_stream_finish(this.handle, outPtr, outLenPtr),
         );
     }
+
+    /**
+     * Trusted-input mode: don't verify content checksums. Only for data whose
+     * integrity is already guaranteed. Call before the first `write()`; bz2,
+     * brotli and snappy throw `UnsupportedAlgo`.
+     */
+    setSkipChecksum(skip: boolean): void {
+        this.ensureLive();
+        const status = this.dispatcher.exports.cu_decompress_stream_set_skip_checksum(
+            this.handle,
+            skip ? 1 : 0,
+        );
+        checkStatus(this.dispatcher.exports, status, this.dispatcher.algorithmName);
+    }
 }
 
 /**
@@ -73,6 +73,14 @@ export interface WasmExports {
         out_ptr: number,
         out_len_ptr: number,
     ) => number;
+    readonly cu_compress_stream_flush: (
+        stream: number,
+        out_ptr: number,
+        out_len_ptr: number,
+    ) => number;
+    readonly cu_compress_stream_set_target_block_size: (stream: number, bytes: number) => number;
+    readonly cu_compress_stream_set_pledged_size: (stream: number, size: bigint) => number;
+    readonly cu_compress_stream_set_checksum: (stream: number, enabled: number) => number;
     readonly cu_compress_stream_destroy: (stream: number) => void;
 
     readonly cu_decompress_stream_create: (algo: number, out_stream_pp: number) => number;
@@ -88,6 +96,7 @@ export interface WasmExports {
         out_ptr: number,
         out_len_ptr: number,
     ) => number;
+    readonly cu_decompress_stream_set_skip_checksum: (stream: number, skip: number) => number;
     readonly cu_decompress_stream_destroy: (stream: number) => void;
 
     /* Optional — only present in wasm modules that wired it through. */
@@ -53,7 +53,8 @@ export class CompressError extends Error {
 }
 
 export interface CompressOptions {
-    /** 1..10. 1 = fastest, 10 = smallest. Default 5. */
+    /** 1..10. 1 = fastest, 10 = smallest. Default 5. 0 and -1..-5 are
+     *  speed tiers below 1 (zstd negative levels, lz4 acceleration). */
     level?: number;
 }
 
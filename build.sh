@@ -36,8 +36,8 @@ Options:
   --debug                    Build in Debug instead of Release.
   --algorithms=LIST          Comma-separated list. Default: all.
                              Available: brotli, bz2 (bzip2), lz4, zstd, zlib, xz (lzma)
-  --languages=LIST           Comma-separated list. Default: c, cpp, python.
-                             Available: c, cpp (c++), python, wasm, zig, go, rust
+  --languages=LIST           Comma-separated list. Default: c, cpp, python, cli.
+                             Available: c, cpp (c++), python, cli, wasm, zig, go, rust
   --cores=N                  Parallel build cores. Default: 1.
   -h, --help                 Show this help.
 
@@ -70,7 +70,7 @@ done
 
 # Default language set if user didn't specify one.
 if [[ ${#LANGUAGES[@]} -eq 0 ]]; then
-    LANGUAGES=(c cpp python)
+    LANGUAGES=(c cpp python cli)
 fi
 
 REPO_ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
@@ -81,6 +81,7 @@ cd "$REPO_ROOT"
 WANT_C=false
 WANT_CPP=false
 WANT_PYTHON=false
+WANT_CLI=false
 WANT_WASM=false
 WANT_ZIG=false
 WANT_GO=false
@@ -91,6 +92,7 @@ for lang in "${LANGUAGES[@]}"; do
         c)              WANT_C=true ;;
         cpp|c++)        WANT_CPP=true ;;
         python|py)      WANT_PYTHON=true ;;
+        cli|cu)         WANT_CLI=true ;;
         wasm|js|ts)     WANT_WASM=true ;;
         zig)            WANT_ZIG=true ;;
         go|golang)      WANT_GO=true ;;
@@ -100,9 +102,9 @@ for lang in "${LANGUAGES[@]}"; do
 done
 
 # C ABI is always built (it's the library's core). Any other binding pulls it in
-# transitively. C++/Python/WASM are CMake-built; Zig has its own build.zig.
+# transitively. C++/Python/CLI/WASM are CMake-built; Zig has its own build.zig.
 NEEDS_CMAKE=false
-if $WANT_C || $WANT_CPP || $WANT_PYTHON || $WANT_WASM; then
+if $WANT_C || $WANT_CPP || $WANT_PYTHON || $WANT_CLI || $WANT_WASM; then
     NEEDS_CMAKE=true
 fi
 
@@ -181,6 +183,7 @@ if $NEEDS_CMAKE; then
     CMAKE_OPTS+=(
         -DBUILD_CPP_BINDINGS=$( $WANT_CPP && echo ON || echo OFF )
         -DBUILD_PYTHON_BINDINGS=$( $WANT_PYTHON && echo ON || echo OFF )
+        -DBUILD_CLI=$( $WANT_CLI && echo ON || echo OFF )
         -DBUILD_WASM_BINDINGS=$( $WANT_WASM && echo ON || echo OFF )
     )
     if $WANT_PYTHON; then
@@ -107,7 +107,7 @@ typedef enum {
 
     /* Caller-side errors */
     CU_ERR_INVALID_ARG       = 1,   /* NULL pointer, bad enum value, etc. */
-    CU_ERR_INVALID_LEVEL     = 2,   /* level outside 1..10 */
+    CU_ERR_INVALID_LEVEL     = 2,   /* level outside CU_LEVEL_MIN..CU_LEVEL_MAX */
     CU_ERR_BUF_TOO_SMALL     = 3,   /* output buffer insufficient; *out_len holds the required size */
     CU_ERR_SIZE_UNKNOWN      = 4,   /* wire format does not carry decompressed size; use cu_decompress_stream_t */
     CU_ERR_UNSUPPORTED_ALGO  = 5,   /* algorithm not compiled into this build */
@@ -124,7 +124,8 @@ typedef enum {
 
     /* System errors */
     CU_ERR_OOM               = 12,  /* internal allocation (codec context, etc.) failed */
-    CU_ERR_INTERNAL          = 13   /* unexpected internal failure; check cu_last_error() */
+    CU_ERR_INTERNAL          = 13,  /* unexpected internal failure; check cu_last_error() */
+    CU_ERR_IO                = 14   /* file open/read/write failed (file and archive APIs); see cu_last_error() */
 } cu_status_t;
 
 /*
@@ -157,7 +158,26 @@ CU_API void cu_clear_last_error(void);
  *
  * level: 1..10. 1 = fastest, 10 = smallest. Mapped per-algorithm — see
  * doc/levels.md for the per-algorithm native ranges.
+ *
+ * Speed tiers: levels 0 and -1..-5 (CU_LEVEL_MIN) trade ratio for speed
+ * below level 1. 0 is the codec's own fastest regular level (zstd 1, brotli
+ * quality 0, xz preset 0); each negative step roughly doubles the speed
+ * knob where the codec has one:
+ *
+ *   level    zstd       lz4 acceleration
+ *    0        1          1 (same as level 1)
+ *   -1       -1          2
+ *   -2       -2          4
+ *   -3       -4          8
+ *   -4       -8          16
+ *   -5       -16         32
+ *
+ * Codecs without such a knob (zlib, gzip, bz2, brotli, xz, snappy) use
+ * their fastest setting for every level <= 0. Every tier still produces
+ * the standard wire format.
  */
+#define CU_LEVEL_MIN (-5)
+#define CU_LEVEL_MAX 10
 
 /*
  * Returns the maximum possible compressed size for an input of `in_len`
@@ -237,9 +257,10 @@ CU_API cu_status_t cu_decompress(
  *   CU_ERR_TRUNCATED      — input is shorter than the minimum header
  *
  * Notes:
- *   - For ZSTD inputs containing multiple concatenated frames, this
- *     returns the decompressed size of the *first* frame only. Callers
- *     handling concatenated frames should use the streaming API.
+ *   - For ZSTD and LZ4 inputs containing multiple concatenated frames
+ *     (e.g. cu_compress_parallel output), this walks the frame headers
+ *     and returns the total over all frames; if any frame omits its
+ *     size the result is CU_ERR_SIZE_UNKNOWN.
  *   - For XZ, parses the stream footer; requires `in` to contain the
  *     complete stream (i.e. `in_len` reaches the end-of-stream marker).
  */
@@ -249,6 +270,42 @@ CU_API cu_status_t cu_decompress_size_hint(
     size_t* out_size
 );
 
+/*
+ * What the first frame header declares, for preallocating output and
+ * choosing a memory budget before decoding. Fields the format does not
+ * carry are left at their "unknown" value.
+ */
+#define CU_FRAME_SIZE_UNKNOWN UINT64_MAX
+
+typedef struct cu_frame_info {
+    uint64_t content_size;        /* decoded bytes in the frame, or CU_FRAME_SIZE_UNKNOWN */
+    uint64_t window_size;         /* history the decoder keeps; 0 = not declared */
+    uint64_t block_size;          /* largest decoded block; 0 = no fixed limit */
+    uint32_t dict_id;             /* dictionary the frame needs; 0 = none */
+    int      has_checksum;        /* frame carries a checksum of its content */
+    int      blocks_independent;  /* blocks decode without earlier history */
+} cu_frame_info_t;
+
+/*
+ * Parse the header at the start of `in` (leading skippable frames are
+ * skipped for zstd and lz4). Reads nothing past the header; for xz that
+ * is the stream header plus the first block header.
+ *
+ * Per format: zstd and lz4 report every field their header has; zlib
+ * reports its window and preset-dictionary id; gzip its 32 KiB window;
+ * brotli its WBITS window; bz2 its block size (blocks are independent);
+ * xz its check and the first block's LZMA2 dictionary; snappy its
+ * content size. For multi-frame totals use cu_decompress_size_hint.
+ *
+ * Returns CU_OK, CU_ERR_TRUNCATED if `in` ends inside the header, or
+ * CU_ERR_DECOMPRESSION if the header is malformed.
+ */
+CU_API cu_status_t cu_frame_info(
+    cu_algorithm_t algo,
+    const uint8_t* in, size_t in_len,
+    cu_frame_info_t* info
+);
+
 /*
  * Sets a global cap on the decompressed size that cu_decompress will
  * accept. Defaults to 1 GiB. Set to 0 to disable. Inputs that would
@@ -260,6 +317,139 @@ CU_API cu_status_t cu_decompress_size_hint(
  */
 CU_API void cu_set_max_decompressed_size(size_t bytes);
 
+/*
+ * Backs codec allocations of at least `threshold` bytes with 2 MiB huge
+ * pages. This targets the big match-finder tables and windows of xz at
+ * high presets, zstd at its top levels and brotli at quality 11, where
+ * TLB misses on random table probes cost a measurable share of the run.
+ * Such allocations are mapped with MAP_HUGETLB when the system has huge
+ * pages reserved, otherwise aligned and marked MADV_HUGEPAGE for
+ * transparent huge pages. Freed mappings are cached (up to 1 GiB) and
+ * reused by later contexts, which also saves their page faults.
+ *
+ * 0 turns it off and releases the cache. Off by default; CU_HUGE_PAGES=1
+ * in the environment turns it on at CU_HUGE_PAGES_DEFAULT_THRESHOLD
+ * (CU_HUGE_PAGES=<bytes> sets the threshold). Linux only; a no-op
+ * elsewhere.
+ *
+ * Thread-safe; takes effect for contexts created afterwards.
+ */
+#define CU_HUGE_PAGES_DEFAULT_THRESHOLD ((size_t)4 << 20)
+CU_API void cu_set_huge_pages(size_t threshold);
+
+/*
+ * Takes the first-call costs of the given algorithms and levels up front,
+ * for processes whose first request is latency-sensitive (serverless cold
+ * starts). It faults in the library's code and constant tables (Linux)
+ * and runs a small one-shot and streaming round trip for every
+ * algorithm × level pair, which binds the codec entry points and leaves
+ * the allocator holding memory of the size real contexts need.
+ *
+ * algos NULL / n_algos 0: every algorithm in the build. levels NULL /
+ * n_levels 0: level 5. Returns CU_ERR_UNSUPPORTED_ALGO for a listed
+ * algorithm that is not built, CU_ERR_INVALID_LEVEL for a level outside
+ * CU_LEVEL_MIN..CU_LEVEL_MAX, otherwise the first failure of the round
+ * trips (CU_OK normally). Safe to call from any thread, and more than
+ * once; a hot process gains nothing from it.
+ */
+CU_API cu_status_t cu_warmup(
+    const cu_algorithm_t* algos, size_t n_algos,
+    const int* levels, size_t n_levels
+);
+
+/* ============================================================================
+ * Direct per-codec one-shot
+ * ============================================================================
+ *
+ * The one-shot calls above, bound to one codec at link time:
+ *
+ *   size_t      cu_<algo>_compress_bound(size_t in_len);
+ *   cu_status_t cu_<algo>_compress(in, in_len, out, out_len, level);
+ *   cu_status_t cu_<algo>_decompress(in, in_len, out, out_len);
+ *   cu_status_t cu_<algo>_decompress_size_hint(in, in_len, out_size);
+ *
+ * for <algo> in zstd, brotli, zlib, bz2, lz4, xz, snappy, gzip. They skip
+ * the algorithm lookup and the argument checks: pointers must be valid as
+ * the cu_compress contract allows, and `level` must lie in
+ * CU_LEVEL_MIN..CU_LEVEL_MAX. Output, return codes and the decompression
+ * cap are otherwise those of the generic calls. Meant for callers that
+ * check their arguments once up front, such as the C++ cu::Codec<>
+ * templates, and for which the dispatch is a visible share of a call
+ * (lz4 and snappy on messages of a few hundred bytes).
+ *
+ * Defined only for the codecs compiled in (INCLUDE_<ALGO>), and not by
+ * the plugin core (BUILD_CODEC_PLUGINS), so using one that is missing
+ * fails at link time rather than returning CU_ERR_UNSUPPORTED_ALGO.
+ */
+#define CU_DIRECT_API(algo)                                                    \
+    CU_API size_t cu_##algo##_compress_bound(size_t in_len);                   \
+    CU_API cu_status_t cu_##algo##_compress(                                   \
+        const uint8_t* in, size_t in_len,                                      \
+        uint8_t* out, size_t* out_len, int level);                             \
+    CU_API cu_status_t cu_##algo##_decompress(                                 \
+        const uint8_t* in, size_t in_len,                                      \
+        uint8_t* out, size_t* out_len);                                        \
+    CU_API cu_status_t cu_##algo##_decompress_size_hint(                       \
+        const uint8_t* in, size_t in_len, size_t* out_size);
+
+CU_DIRECT_API(zstd)
+CU_DIRECT_API(brotli)
+CU_DIRECT_API(zlib)
+CU_DIRECT_API(bz2)
+CU_DIRECT_API(lz4)
+CU_DIRECT_API(xz)
+CU_DIRECT_API(snappy)
+CU_DIRECT_API(gzip)
+
+#undef CU_DIRECT_API
+
+/* ============================================================================
+ * Scatter/gather one-shot
+ * ============================================================================
+ *
+ * cu_compressv / cu_decompressv take the input and the output as arrays of
+ * segments instead of single buffers, so a message assembled from
+ * non-contiguous pieces (header, body, trailer) does not need to be copied
+ * into one buffer first, and decoded output can land directly in
+ * fixed-size pages. Output segments are filled in order; *out_len returns
+ * the total written across all of them.
+ *
+ * The result is one frame, decodable by cu_decompress like the output of
+ * cu_compress (the bytes may differ: segments are fed through the codec's
+ * streaming encoder, with the total pledged up front where the format
+ * records it). Zero-length segments are allowed and skipped.
+ *
+ * Return codes follow cu_compress / cu_decompress: cu_compressv needs a
+ * total output capacity of cu_compress_bound(total input), otherwise
+ * CU_ERR_BUF_TOO_SMALL with *out_len set to that bound. cu_decompressv
+ * returns CU_ERR_BUF_TOO_SMALL (with the declared size) or
+ * CU_ERR_SIZE_UNKNOWN when the segments run out, and honors
+ * cu_set_max_decompressed_size. On error the contents of `out` are
+ * unspecified.
+ */
+typedef struct cu_iovec {
+    uint8_t* base;
+    size_t len;
+} cu_iovec_t;
+
+typedef struct cu_const_iovec {
+    const uint8_t* base;
+    size_t len;
+} cu_const_iovec_t;
+
+CU_API cu_status_t cu_compressv(
+    cu_algorithm_t algo,
+    const cu_const_iovec_t* in, size_t in_cnt,
+    const cu_iovec_t* out, size_t out_cnt, size_t* out_len,
+    int level
+);
+
+CU_API cu_status_t cu_decompressv(
+    cu_algorithm_t algo,
+    const cu_const_iovec_t* in, size_t in_cnt,
+    const cu_iovec_t* out, size_t out_cnt, size_t* out_len
+);
+
 /* ============================================================================
  * Streaming compression
  * ============================================================================
@@ -317,6 +507,67 @@ CU_API cu_status_t cu_compress_stream_finish(
     uint8_t* out, size_t* out_len
 );
 
+/*
+ * Make everything written so far decodable without ending the frame, for
+ * sockets and log tails where bytes must not sit in codec buffers. The
+ * codec compresses its buffered input and emits a sync point (zstd
+ * ZSTD_e_flush, zlib/gzip Z_SYNC_FLUSH, brotli BROTLI_OPERATION_FLUSH,
+ * LZ4F_flush, xz LZMA_SYNC_FLUSH); writes may continue.
+ *
+ * Same drain protocol as finish: CU_ERR_BUF_TOO_SMALL means more flush
+ * output remains — call again with a fresh buffer until CU_OK. Until then
+ * write and finish return CU_ERR_STREAM_STATE.
+ *
+ * Every flush closes a block and costs some ratio, so flush at message
+ * boundaries. bz2 (BZ_FLUSH keeps the block's last bits buffered, so the
+ * output is not decodable) and snappy (one raw block per stream) return
+ * CU_ERR_UNSUPPORTED_ALGO.
+ */
+CU_API cu_status_t cu_compress_stream_flush(
+    cu_compress_stream_t* stream,
+    uint8_t* out, size_t* out_len
+);
+
+/*
+ * Low-latency mode: cut compressed blocks of about `bytes` so a receiver
+ * can decode progressively instead of waiting for a full 128 KiB block
+ * (zstd ZSTD_c_targetCBlockSize; clamped to zstd's 1340..131072 range, 0
+ * restores the default). Call before the first write/flush/finish, else
+ * CU_ERR_STREAM_STATE. Other codecs: CU_ERR_UNSUPPORTED_ALGO.
+ */
+CU_API cu_status_t cu_compress_stream_set_target_block_size(
+    cu_compress_stream_t* stream,
+    size_t bytes
+);
+
+/*
+ * Declare the total number of bytes the stream will be given. zstd sizes
+ * its tables for it (faster for small inputs) and, like lz4, records it in
+ * the frame header so decoders can preallocate (see cu_frame_info).
+ * brotli uses it as an encoder size hint; snappy reserves its input buffer.
+ *
+ * Call before the first write/flush/finish, else CU_ERR_STREAM_STATE.
+ * Writing more than `size` bytes, or finishing after fewer, returns
+ * CU_ERR_STREAM_STATE. zlib, gzip, bz2 and xz: CU_ERR_UNSUPPORTED_ALGO.
+ */
+CU_API cu_status_t cu_compress_stream_set_pledged_size(
+    cu_compress_stream_t* stream,
+    uint64_t size
+);
+
+/*
+ * Write (enabled = 1) or omit (0) the frame's content checksum. Defaults:
+ * lz4 writes xxh32 and xz writes CRC64; zstd writes none unless enabled
+ * here (XXH64). Omit it when the transport already verifies integrity.
+ * Call before the first write/flush/finish, else CU_ERR_STREAM_STATE.
+ * zlib, gzip and bz2 always carry their checksum, and brotli and snappy
+ * have none: CU_ERR_UNSUPPORTED_ALGO.
+ */
+CU_API cu_status_t cu_compress_stream_set_checksum(
+    cu_compress_stream_t* stream,
+    int enabled
+);
+
 CU_API void cu_compress_stream_destroy(cu_compress_stream_t* stream);
 
 /* ============================================================================
@@ -346,8 +597,401 @@ CU_API cu_status_t cu_decompress_stream_finish(
     uint8_t* out, size_t* out_len
 );
 
+/*
+ * Trusted-input mode: with skip = 1 the decoder does not verify content
+ * checksums (zstd XXH64, lz4 xxh32, xz CRC64/CRC32/SHA-256, zlib Adler-32,
+ * gzip CRC-32), so corruption goes undetected. Use it only for data whose
+ * integrity was already checked, e.g. by the transport. Structural errors
+ * are still reported.
+ *
+ * Off by default. Call before the first write/finish, else
+ * CU_ERR_STREAM_STATE. bz2 cannot skip its block CRCs, and brotli and
+ * snappy have no checksum: CU_ERR_UNSUPPORTED_ALGO.
+ */
+CU_API cu_status_t cu_decompress_stream_set_skip_checksum(
+    cu_decompress_stream_t* stream,
+    int skip
+);
+
 CU_API void cu_decompress_stream_destroy(cu_decompress_stream_t* stream);
 
+/* ============================================================================
+ * Parallel compression
+ * ============================================================================
+ *
+ * Splits the input into fixed-size chunks, compresses them concurrently and
+ * writes the results back to back as independent frames (zstd, lz4),
+ * members (gzip) or streams (bz2, xz). Every reference decoder — and our
+ * own one-shot and streaming decoders — reads such a concatenation as one
+ * logical stream, so the output is format-compatible with `zstd`, `lz4`,
+ * `gzip`, `bzip2` and `xz`.
+ *
+ * Output depends only on the input, level and chunk size — never on the
+ * thread count. Input no larger than one chunk yields exactly what
+ * cu_compress produces.
+ *
+ * Not available for zlib, brotli or snappy (their formats have no
+ * concatenation); check with cu_parallel_supported(). Not built into the
+ * WASM modules.
+ */
+
+typedef struct cu_parallel_opts {
+    unsigned threads;     /* worker threads; 0 = one per online CPU */
+    size_t   chunk_size;  /* bytes of input per frame; 0 = codec default */
+} cu_parallel_opts_t;
+
+/* Returns 1 if cu_compress_parallel supports the algorithm in this build. */
+CU_API int cu_parallel_supported(cu_algorithm_t algo);
+
+/* Effective chunk size: opts->chunk_size, or the codec default when opts is
+ * NULL or chunk_size is 0. Returns 0 for unsupported algorithms. Callers
+ * feeding input in windows keep the output identical to a single call by
+ * making every window but the last a multiple of this. */
+CU_API size_t cu_parallel_chunk_size(cu_algorithm_t algo, const cu_parallel_opts_t* opts);
+
+/* Upper bound on cu_compress_parallel output for `in_len` bytes of input.
+ * `opts` may be NULL for defaults. Returns 0 for unsupported algorithms. */
+CU_API size_t cu_compress_parallel_bound(
+    size_t in_len,
+    cu_algorithm_t algo,
+    const cu_parallel_opts_t* opts
+);
+
+/*
+ * Compress `in` on up to opts->threads threads (opts may be NULL). The
+ * output buffer must hold cu_compress_parallel_bound() bytes: chunks are
+ * compressed in place at their worst-case offsets and then compacted.
+ * Otherwise returns CU_ERR_BUF_TOO_SMALL with *out_len set to that bound.
+ *
+ * On multi-socket Linux hosts the workers are pinned per NUMA node and
+ * each chunk is compressed on the node holding its input; set CU_NUMA=0 in
+ * the environment to turn that off. Output is byte-identical either way.
+ *
+ * Thread-safe. Blocks until all chunks are done.
+ */
+CU_API cu_status_t cu_compress_parallel(
+    cu_algorithm_t algo,
+    const uint8_t* in, size_t in_len,
+    uint8_t* out, size_t* out_len,
+    int level,
+    const cu_parallel_opts_t* opts
+);
+
+/* ============================================================================
+ * File compression
+ * ============================================================================
+ *
+ * Compress or decompress one file into another without staging either in
+ * memory. The source is memory-mapped a window at a time (MADV_SEQUENTIAL,
+ * unmapped once consumed); the destination is pre-allocated with
+ * fallocate and written through a shared mapping, so the codec reads from
+ * and writes to the page cache directly. Resident memory stays near two
+ * 64 MiB windows plus codec state whatever the file size. Where mmap is
+ * unavailable (Windows) the same windows go through stdio instead.
+ *
+ * The destination is created or truncated, and removed again on failure.
+ * File-system errors return CU_ERR_IO with the path and system message in
+ * cu_last_error(). Not built into the WASM modules.
+ */
+
+/*
+ * opts NULL: one thread, one frame — what cu_compress_stream_t produces.
+ * opts non-NULL: algorithms with a parallel mode (cu_parallel_supported)
+ * produce the same bytes as a single cu_compress_parallel call over the
+ * whole file; the others ignore opts. On POSIX this runs as a pipeline:
+ * chunk reads, compression on opts->threads workers and in-order writes
+ * all overlap, with memory fixed at two chunk buffers per thread. Linux
+ * drives the reads and writes through io_uring with registered buffers;
+ * elsewhere, or where io_uring is unavailable or CU_IO_URING=0 is set in
+ * the environment, pread/pwrite worker threads do the same job.
+ */
+CU_API cu_status_t cu_compress_file(
+    cu_algorithm_t algo,
+    const char* src_path,
+    const char* dst_path,
+    int level,
+    const cu_parallel_opts_t* opts
+);
+
+/*
+ * Streams src_path through the decoder into dst_path. Concatenated
+ * frames/members are decoded back to back. When the first frame header
+ * declares its size the destination is preallocated up front (best
+ * effort, at most 64x the source size and the cu_set_max_decompressed_size
+ * cap). Decoding itself is, like the streaming API, not subject to that cap.
+ */
+CU_API cu_status_t cu_decompress_file(
+    cu_algorithm_t algo,
+    const char* src_path,
+    const char* dst_path
+);
+
+/* ============================================================================
+ * Tar archives
+ * ============================================================================
+ *
+ * Streaming ustar/pax writer and reader for compressed tarballs
+ * (.tar.zst, .tar.gz, .tar.xz, ...). The tar stream is never held in
+ * memory as a whole: the writer stages a bounded window of tar bytes and
+ * compresses it with the parallel chunked compressors (or one
+ * cu_compress_stream_t for codecs without a parallel mode); the reader
+ * decodes through a cu_decompress_stream_t a buffer at a time. Output
+ * reads with any tar implementation (`tar --zstd -xf`, `tar xzf`, ...).
+ *
+ * Names longer than ustar allows, long link targets and members of 8 GiB
+ * or more get a pax extended header. The reader also understands GNU
+ * long-name records and base-256 sizes.
+ *
+ * The library never touches the file system on the archive's behalf:
+ * entries are only ever written to a destination path the caller names,
+ * so hostile member names ("../x", absolute paths) are the caller's to
+ * vet. File-system errors return CU_ERR_IO; malformed tar headers return
+ * CU_ERR_DECOMPRESSION. Not built into the WASM modules.
+ */
+
+typedef struct cu_tar_writer cu_tar_writer_t;
+typedef struct cu_tar_reader cu_tar_reader_t;
+
+/*
+ * Writer flag: append a member index after the archive so single members
+ * can be extracted with cu_tar_extract_member without decoding anything
+ * before them. The index sits in a skippable frame, which every decoder
+ * ignores, so it needs an algorithm whose format has them (zstd, lz4);
+ * other algorithms return CU_ERR_INVALID_ARG.
+ */
+#define CU_TAR_INDEX 0x1u
+
+typedef struct cu_tar_entry {
+    const char* name;      /* full member path; directories end in '/' */
+    const char* linkname;  /* link target for symlinks and hard links, else "" */
+    uint64_t    size;      /* bytes of member data */
+    uint32_t    mode;      /* permission bits */
+    int64_t     mtime;     /* seconds since the epoch */
+    char        type;      /* ustar typeflag: '0' file, '5' dir, '2' symlink, '1' hard link, ... */
+} cu_tar_entry_t;
+
+/*
+ * Create (or truncate) `path` and start an archive compressed with `algo`
+ * at `level`. `opts` (may be NULL for the defaults) sets the parallel
+ * compressor's threads and chunk size; the compressed stream is the same
+ * frame sequence cu_compress_parallel produces for the whole tar. flags
+ * is 0 or CU_TAR_INDEX.
+ */
+CU_API cu_status_t cu_tar_writer_create(
+    const char* path,
+    cu_algorithm_t algo,
+    int level,
+    const cu_parallel_opts_t* opts,
+    unsigned flags,
+    cu_tar_writer_t** out_writer
+);
+
+/*
+ * Add the file, directory or symlink at `src_path` as member `name`
+ * (NULL = src_path). Regular file contents are streamed from disk.
+ * Directories are added as a single entry, not recursively.
+ */
+CU_API cu_status_t cu_tar_writer_add_file(
+    cu_tar_writer_t* writer,
+    const char* src_path,
+    const char* name
+);
+
+/* Add a regular-file member with the given contents. */
+CU_API cu_status_t cu_tar_writer_add_data(
+    cu_tar_writer_t* writer,
+    const char* name,
+    const uint8_t* data, size_t len,
+    uint32_t mode,
+    int64_t mtime
+);
+
+/*
+ * Write the end-of-archive marker and the index (if requested), flush
+ * and close the file. After any writer error the archive is unusable;
+ * destroy it.
+ */
+CU_API cu_status_t cu_tar_writer_finish(cu_tar_writer_t* writer);
+
+/* Frees the writer. An archive that was not finished is deleted. */
+CU_API void cu_tar_writer_destroy(cu_tar_writer_t* writer);
+
+/* Open `path` for sequential reading of an archive compressed with `algo`. */
+CU_API cu_status_t cu_tar_reader_open(
+    const char* path,
+    cu_algorithm_t algo,
+    cu_tar_reader_t** out_reader
+);
+
+/*
+ * Advance to the next member, skipping any unread data of the current
+ * one. *entry points into the reader and stays valid until the next call;
+ * it is set to NULL at the end of the archive.
+ */
+CU_API cu_status_t cu_tar_reader_next(
+    cu_tar_reader_t* reader,
+    const cu_tar_entry_t** entry
+);
+
+/*
+ * Read up to `cap` bytes of the current member's data. *n is 0 once the
+ * member is exhausted.
+ */
+CU_API cu_status_t cu_tar_reader_read(
+    cu_tar_reader_t* reader,
+    uint8_t* buf, size_t cap,
+    size_t* n
+);
+
+/*
+ * Write the rest of the current member's data to `dst_path` (created or
+ * truncated). Only regular-file members have data to extract; others
+ * return CU_ERR_INVALID_ARG.
+ */
+CU_API cu_status_t cu_tar_reader_extract(
+    cu_tar_reader_t* reader,
+    const char* dst_path
+);
+
+CU_API void cu_tar_reader_destroy(cu_tar_reader_t* reader);
+
+/*
+ * Extract the regular-file member `name` of `archive_path` to `dst_path`.
+ * With a CU_TAR_INDEX index only the frames holding the member are
+ * decoded; without one the archive is scanned from the start. A missing
+ * member returns CU_ERR_INVALID_ARG.
+ */
+CU_API cu_status_t cu_tar_extract_member(
+    const char* archive_path,
+    cu_algorithm_t algo,
+    const char* name,
+    const char* dst_path
+);
+
+/* ============================================================================
+ * ZIP archives
+ * ============================================================================
+ *
+ * ZIP writer and random-access reader. Entries are stored (method 0),
+ * deflated (8), or compressed with zstd (93) or xz (95) per APPNOTE 6.3.
+ * ZIP64 records are written only where a size, offset or entry count
+ * needs them, so small archives open with any unzip.
+ *
+ * The writer batches entries and compresses each batch on the parallel
+ * workers, one entry per task, then writes them in the order they were
+ * added. An entry that compresses to no smaller than its input is
+ * stored. Files too large for a batch are streamed from disk instead.
+ *
+ * The reader loads the central directory once and hashes the names, so
+ * cu_zip_reader_find is O(1). Extraction decodes straight into caller
+ * buffers and checks the CRC-32. The extract functions may be called
+ * from several threads at once on one reader, and
+ * cu_zip_reader_extract_many runs a whole list on the parallel workers.
+ * Not built into the WASM modules.
+ */
+
+typedef enum {
+    CU_ZIP_STORE   = 0,
+    CU_ZIP_DEFLATE = 8,   /* needs zlib or gzip in the build */
+    CU_ZIP_ZSTD    = 93,
+    CU_ZIP_XZ      = 95
+} cu_zip_method_t;
+
+typedef struct cu_zip_writer cu_zip_writer_t;
+typedef struct cu_zip_reader cu_zip_reader_t;
+
+typedef struct cu_zip_entry {
+    const char* name;             /* directories end in '/' */
+    uint64_t    size;             /* uncompressed bytes */
+    uint64_t    compressed_size;
+    uint32_t    crc32;
+    uint16_t    method;           /* cu_zip_method_t value, or another APPNOTE method */
+    uint32_t    mode;             /* Unix permission bits when recorded, else 0 */
+    int64_t     mtime;            /* seconds since the epoch */
+} cu_zip_entry_t;
+
+/*
+ * Create (or truncate) `path`. Every entry is compressed with `method`
+ * at `level` (ignored for CU_ZIP_STORE). `opts` (may be NULL) sets the
+ * worker threads; its chunk_size is unused.
+ */
+CU_API cu_status_t cu_zip_writer_create(
+    const char* path,
+    cu_zip_method_t method,
+    int level,
+    const cu_parallel_opts_t* opts,
+    cu_zip_writer_t** out_writer
+);
+
+/* Add an entry with the given contents. The data is copied. */
+CU_API cu_status_t cu_zip_writer_add_data(
+    cu_zip_writer_t* writer,
+    const char* name,
+    const uint8_t* data, size_t len,
+    int64_t mtime
+);
+
+/*
+ * Add the regular file or directory at `src_path` as entry `name`
+ * (NULL = src_path). Directories are added as a single entry, not
+ * recursively.
+ */
+CU_API cu_status_t cu_zip_writer_add_file(
+    cu_zip_writer_t* writer,
+    const char* src_path,
+    const char* name
+);
+
+/* Compress what is still batched, write the central directory and close. */
+CU_API cu_status_t cu_zip_writer_finish(cu_zip_writer_t* writer);
+
+/* Frees the writer. An archive that was not finished is deleted. */
+CU_API void cu_zip_writer_destroy(cu_zip_writer_t* writer);
+
+CU_API cu_status_t cu_zip_reader_open(const char* path, cu_zip_reader_t** out_reader);
+
+/* Number of entries in the central directory. */
+CU_API size_t cu_zip_reader_count(const cu_zip_reader_t* reader);
+
+/* Entry `index`, or NULL when out of range. Valid until destroy. */
+CU_API const cu_zip_entry_t* cu_zip_reader_entry(const cu_zip_reader_t* reader, size_t index);
+
+/* Index of the entry named `name`; CU_ERR_INVALID_ARG if there is none. */
+CU_API cu_status_t cu_zip_reader_find(
+    const cu_zip_reader_t* reader,
+    const char* name,
+    size_t* index
+);
+
+/*
+ * Decompress entry `index` into out[0, *out_len). On CU_OK *out_len is
+ * the entry size. If the buffer is too small, returns CU_ERR_BUF_TOO_SMALL
+ * with *out_len set to the size needed. Unknown methods and encrypted
+ * entries return CU_ERR_UNSUPPORTED_ALGO. A CRC mismatch returns
+ * CU_ERR_DECOMPRESSION.
+ */
+CU_API cu_status_t cu_zip_reader_extract(
+    cu_zip_reader_t* reader,
+    size_t index,
+    uint8_t* out, size_t* out_len
+);
+
+/*
+ * Extract n entries concurrently: entry indices[i] into outs[i], with
+ * out_lens[i] in/out as for cu_zip_reader_extract. results (may be NULL)
+ * receives every status. Returns CU_OK if all succeeded, else the first
+ * failure in list order, with its message.
+ */
+CU_API cu_status_t cu_zip_reader_extract_many(
+    cu_zip_reader_t* reader,
+    const size_t* indices, size_t n,
+    uint8_t* const* outs, size_t* out_lens,
+    cu_status_t* results,
+    const cu_parallel_opts_t* opts
+);
+
+CU_API void cu_zip_reader_destroy(cu_zip_reader_t* reader);
+
 #ifdef __cplusplus
 }  /* extern "C" */
 #endif
@@ -36,6 +36,10 @@ typedef struct cu_algorithm_vtbl {
                               uint8_t* out, size_t* out_len);
     cu_status_t (*decompress_size_hint)(const uint8_t* in, size_t in_len,
                                         size_t* out_size);
+    /* `info` arrives zeroed with content_size = CU_FRAME_SIZE_UNKNOWN;
+     * fill in what the header declares. */
+    cu_status_t (*frame_info)(const uint8_t* in, size_t in_len,
+                              cu_frame_info_t* info);
 
     /* Streaming compression. State is owned by the caller; vtable
      * functions allocate it in `create` and free it in `destroy`. */
@@ -46,6 +50,16 @@ typedef struct cu_algorithm_vtbl {
     cu_status_t (*compress_stream_finish)(void* state,
                                           uint8_t* out, size_t* out_len);
     void        (*compress_stream_destroy)(void* state);
+    /* Optional (NULL = unsupported). flush emits a sync point with the
+     * finish drain protocol; set_target_block_size runs before any input. */
+    cu_status_t (*compress_stream_flush)(void* state,
+                                         uint8_t* out, size_t* out_len);
+    cu_status_t (*compress_stream_set_target_block_size)(void* state, size_t bytes);
+    /* Optional. Runs before any input; the wrapper enforces the total. */
+    cu_status_t (*compress_stream_set_pledged_size)(void* state, uint64_t size);
+    /* Optional. Runs before any input: write (1) or omit (0) the format's
+     * content checksum. */
+    cu_status_t (*compress_stream_set_checksum)(void* state, int enabled);
 
     /* Streaming decompression. */
     cu_status_t (*decompress_stream_create)(void** out_state);
@@ -55,6 +69,8 @@ typedef struct cu_algorithm_vtbl {
     cu_status_t (*decompress_stream_finish)(void* state,
                                             uint8_t* out, size_t* out_len);
     void        (*decompress_stream_destroy)(void* state);
+    /* Optional. Runs before any input: skip (1) checksum verification. */
+    cu_status_t (*decompress_stream_set_skip_checksum)(void* state, int skip);
 } cu_algorithm_vtbl_t;
 
 /*
@@ -63,10 +79,63 @@ typedef struct cu_algorithm_vtbl {
  */
 const cu_algorithm_vtbl_t* cu_registry_lookup(cu_algorithm_t algo);
 
+#ifdef CU_CODEC_PLUGINS
+/* Raw DEFLATE for zip method 8 from the cu_plugin_deflate module, or NULL
+ * when it is not installed. (The monolithic build links
+ * cu_deflate_raw_vtbl directly.) */
+const cu_algorithm_vtbl_t* cu_registry_raw_deflate(void);
+#endif
+
+/*
+ * Defines the direct entry points (cu_<algo>_compress & co., see
+ * compress_utils.h) for one codec. Expanded at the bottom of the codec's
+ * source, after its vtable: the calls read a const object whose
+ * initializer is in view, so they compile to direct calls of the static
+ * functions. Empty in plugin modules, which link none of the core.
+ */
+#if !defined(CU_OMIT_COMPRESS) && !defined(CU_PLUGIN_VTBL)
+#  define CU_DEFINE_DIRECT_COMPRESS_(algo)                                     \
+    size_t cu_##algo##_compress_bound(size_t in_len) {                         \
+        return cu_##algo##_vtbl.compress_bound(in_len);                        \
+    }                                                                          \
+    cu_status_t cu_##algo##_compress(const uint8_t* in, size_t in_len,        \
+                                     uint8_t* out, size_t* out_len,            \
+                                     int level) {                              \
+        cu_clear_last_error();                                                 \
+        return cu_##algo##_vtbl.compress(in, in_len, out, out_len, level);     \
+    }
+#else
+#  define CU_DEFINE_DIRECT_COMPRESS_(algo)
+#endif
+
+#if !defined(CU_OMIT_DECOMPRESS) && !defined(CU_PLUGIN_VTBL)
+#  define CU_DEFINE_DIRECT_DECOMPRESS_(algo)                                   \
+    cu_status_t cu_##algo##_decompress(const uint8_t* in, size_t in_len,      \
+                                       uint8_t* out, size_t* out_len) {        \
+        cu_clear_last_error();                                                 \
+        return cu_##algo##_vtbl.decompress(in, in_len, out, out_len);          \
+    }                                                                          \
+    cu_status_t cu_##algo##_decompress_size_hint(const uint8_t* in,           \
+                                                 size_t in_len,                \
+                                                 size_t* out_size) {           \
+        cu_clear_last_error();                                                 \
+        return cu_##algo##_vtbl.decompress_size_hint(in, in_len, out_size);    \
+    }
+#else
+#  define CU_DEFINE_DIRECT_DECOMPRESS_(algo)
+#endif
+
+#define CU_DEFINE_DIRECT_API(algo) \
+    CU_DEFINE_DIRECT_COMPRESS_(algo) CU_DEFINE_DIRECT_DECOMPRESS_(algo)
+
 /* Internal error-message setter used by algorithm implementations. */
 void cu_set_last_error(const char* msg);
 void cu_set_last_errorf(const char* fmt, ...);
 
+/* CU_OK for a level in CU_LEVEL_MIN..CU_LEVEL_MAX; otherwise sets the
+ * last error and returns CU_ERR_INVALID_LEVEL. */
+cu_status_t cu_check_level(int level);
+
 /* Internal cap used by one-shot decompression. */
 size_t cu_get_max_decompressed_size(void);
 
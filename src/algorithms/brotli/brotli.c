@@ -7,10 +7,12 @@
  *     caller's buffer and returns SIZE_UNKNOWN if it doesn't fit.
  *
  * Streaming uses BrotliEncoderCompressStream / BrotliDecoderDecompressStream
- * with the standard stashed-tail protocol.
+ * with the standard stashed-tail protocol. A pledged size only becomes
+ * BROTLI_PARAM_SIZE_HINT; frame info reports the WBITS window.
  */
 
 #include "algorithm_registry.h"
+#include "alloc.h"
 #include "compress_utils.h"
 
 #include "brotli/decode.h"
@@ -22,8 +24,8 @@
 #include <string.h>
 
 static int brotli_native_level(int user_level) {
-    /* Brotli quality 0..11. User 1..10 -> 1..11. */
-    if (user_level < 1) return 1;
+    /* Brotli quality 0..11. User 1..10 -> 1..11; speed tiers -> 0. */
+    if (user_level < 1) return 0;
     if (user_level > 11) return 11;
     return user_level + (user_level == 10 ? 1 : 0);
     /* user 10 -> 11 (best), others map 1:1 to their numeric value. */
@@ -44,6 +46,35 @@ static size_t brotli_compress_bound(size_t in_len) {
     return b;
 }
 
+/* What BrotliEncoderCompress falls back to (encode.c's
+ * MakeUncompressedStream): the input as stored meta-blocks of at most
+ * 16 MiB under a minimal window header. Never longer than
+ * brotli_compress_bound. */
+static size_t brotli_stored_stream(const uint8_t* in, size_t in_len, uint8_t* out) {
+    if (in_len == 0) {
+        out[0] = 6;  /* ISLAST, ISLASTEMPTY */
+        return 1;
+    }
+    size_t n = 0;
+    out[n++] = 0x21;  /* window bits = 10, not last */
+    out[n++] = 0x03;  /* empty metadata block, padding */
+    while (in_len > 0) {
+        uint32_t chunk = in_len > (1u << 24) ? (1u << 24) : (uint32_t)in_len;
+        uint32_t nibbles = chunk > (1u << 20) ? 2 : chunk > (1u << 16) ? 1 : 0;
+        uint32_t bits = (nibbles << 1) | ((chunk - 1) << 3) | (1u << (19 + 4 * nibbles));
+        out[n++] = (uint8_t)bits;
+        out[n++] = (uint8_t)(bits >> 8);
+        out[n++] = (uint8_t)(bits >> 16);
+        if (nibbles == 2) out[n++] = (uint8_t)(bits >> 24);
+        memcpy(out + n, in, chunk);
+        n += chunk;
+        in += chunk;
+        in_len -= chunk;
+    }
+    out[n++] = 3;  /* ISLAST, ISLASTEMPTY */
+    return n;
+}
+
 static cu_status_t brotli_compress(
     const uint8_t* in, size_t in_len,
     uint8_t* out, size_t* out_len,
@@ -55,18 +86,32 @@ static cu_status_t brotli_compress(
         *out_len = needed;
         return CU_ERR_BUF_TOO_SMALL;
     }
-    size_t encoded = cap;
-    BROTLI_BOOL ok = BrotliEncoderCompress(
-        brotli_native_level(level),
-        BROTLI_DEFAULT_WINDOW,
-        BROTLI_DEFAULT_MODE,
-        in_len, in,
-        &encoded, out
-    );
-    if (!ok) {
-        cu_set_last_error("brotli: compression failed");
-        return CU_ERR_COMPRESSION;
+    /* BrotliEncoderCompress, but on an instance with our allocator so
+     * quality 11's tables can get huge pages (cu_set_huge_pages). Same
+     * parameters, so the same bytes. Where that function would fall back
+     * to stored blocks (empty input, output past the bound, a failed
+     * encoder), write them directly rather than encoding twice. */
+    size_t encoded = 0;
+    BROTLI_BOOL ok = BROTLI_FALSE;
+    BrotliEncoderState* enc = in_len > 0
+        ? BrotliEncoderCreateInstance(cu_codec_alloc, cu_codec_free, NULL)
+        : NULL;
+    if (enc) {
+        const uint8_t* next_in = in;
+        size_t avail_in = in_len;
+        uint8_t* next_out = out;
+        size_t avail_out = cap;
+        BrotliEncoderSetParameter(enc, BROTLI_PARAM_QUALITY, (uint32_t)brotli_native_level(level));
+        BrotliEncoderSetParameter(enc, BROTLI_PARAM_LGWIN, BROTLI_DEFAULT_WINDOW);
+        BrotliEncoderSetParameter(enc, BROTLI_PARAM_MODE, BROTLI_DEFAULT_MODE);
+        BrotliEncoderSetParameter(enc, BROTLI_PARAM_SIZE_HINT, (uint32_t)in_len);
+        ok = BrotliEncoderCompressStream(enc, BROTLI_OPERATION_FINISH,
+                                         &avail_in, &next_in, &avail_out, &next_out, &encoded) &&
+             BrotliEncoderIsFinished(enc) &&
+             encoded <= BrotliEncoderMaxCompressedSize(in_len);
+        BrotliEncoderDestroyInstance(enc);
     }
+    if (!ok) encoded = brotli_stored_stream(in, in_len, out);
     *out_len = encoded;
     return CU_OK;
 }
@@ -79,7 +124,7 @@ static cu_status_t brotli_decompress(
         cu_set_last_error("brotli: empty input");
         return CU_ERR_TRUNCATED;
     }
-    BrotliDecoderState* st = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+    BrotliDecoderState* st = BrotliDecoderCreateInstance(cu_codec_alloc, cu_codec_free, NULL);
     if (!st) { cu_set_last_error("brotli: oom"); return CU_ERR_OOM; }
 
     const uint8_t* next_in = in;
@@ -123,6 +168,36 @@ static cu_status_t brotli_decompress_size_hint(
     return CU_ERR_SIZE_UNKNOWN;
 }
 
+/* The stream header is just WBITS (RFC 7932 9.1, plus the large-window
+ * extension), read LSB first. */
+static cu_status_t brotli_frame_info(
+    const uint8_t* in, size_t in_len, cu_frame_info_t* info
+) {
+    if (in_len < 1) goto truncated;
+    unsigned wbits;
+    uint8_t b = in[0];
+    if (!(b & 1)) {
+        wbits = 16;
+    } else if ((b >> 1) & 7) {
+        wbits = 17 + ((b >> 1) & 7);
+    } else if (((b >> 4) & 7) == 1) {
+        if (in_len < 2) goto truncated;
+        wbits = in[1] & 0x3F;
+        if ((b & 0x80) || wbits < 10 || wbits > 30) {
+            cu_set_last_error("brotli: invalid large-window header");
+            return CU_ERR_DECOMPRESSION;
+        }
+    } else {
+        wbits = ((b >> 4) & 7) ? 8 + ((b >> 4) & 7) : 17;
+    }
+    info->window_size = ((uint64_t)1 << wbits) - 16;
+    return CU_OK;
+
+truncated:
+    cu_set_last_error("brotli: empty input");
+    return CU_ERR_TRUNCATED;
+}
+
 /* ============================================================================
  * Streaming compression
  * ============================================================================ */
@@ -156,7 +231,7 @@ static cu_status_t cstream_pending_append(brotli_cstream_state_t* st,
 static cu_status_t brotli_cstream_create(int level, void** out_state) {
     brotli_cstream_state_t* st = calloc(1, sizeof(*st));
     if (!st) { cu_set_last_error("brotli: oom"); return CU_ERR_OOM; }
-    st->enc = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+    st->enc = BrotliEncoderCreateInstance(cu_codec_alloc, cu_codec_free, NULL);
     if (!st->enc) {
         free(st);
         cu_set_last_error("brotli: BrotliEncoderCreateInstance failed");
@@ -238,6 +313,27 @@ static cu_status_t brotli_cstream_finish(
     return cstream_pump(st, BROTLI_OPERATION_FINISH, out, out_len);
 }
 
+static cu_status_t brotli_cstream_set_pledged_size(void* state, uint64_t size) {
+    brotli_cstream_state_t* st = (brotli_cstream_state_t*)state;
+    uint32_t hint = size > (1u << 30) ? (1u << 30) : (uint32_t)size;
+    BrotliEncoderSetParameter(st->enc, BROTLI_PARAM_SIZE_HINT, hint);
+    return CU_OK;
+}
+
+/* BROTLI_OPERATION_FLUSH must be repeated until the encoder has no more
+ * output; the public flush protocol (drain with flush until CU_OK) does
+ * exactly that. */
+static cu_status_t brotli_cstream_flush(
+    void* state, uint8_t* out, size_t* out_len
+) {
+    brotli_cstream_state_t* st = (brotli_cstream_state_t*)state;
+    if (st->finishing) {
+        cu_set_last_error("brotli: flush after finish");
+        return CU_ERR_STREAM_STATE;
+    }
+    return cstream_pump(st, BROTLI_OPERATION_FLUSH, out, out_len);
+}
+
 static void brotli_cstream_destroy(void* state) {
     brotli_cstream_state_t* st = (brotli_cstream_state_t*)state;
     if (!st) return;
@@ -278,7 +374,7 @@ static cu_status_t dstream_pending_append(brotli_dstream_state_t* st,
 static cu_status_t brotli_dstream_create(void** out_state) {
     brotli_dstream_state_t* st = calloc(1, sizeof(*st));
     if (!st) { cu_set_last_error("brotli: oom"); return CU_ERR_OOM; }
-    st->dec = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+    st->dec = BrotliDecoderCreateInstance(cu_codec_alloc, cu_codec_free, NULL);
     if (!st->dec) {
         free(st);
         cu_set_last_error("brotli: BrotliDecoderCreateInstance failed");
@@ -384,13 +480,18 @@ const cu_algorithm_vtbl_t cu_brotli_vtbl = {
     .compress_stream_write     = brotli_cstream_write,
     .compress_stream_finish    = brotli_cstream_finish,
     .compress_stream_destroy   = brotli_cstream_destroy,
+    .compress_stream_flush     = brotli_cstream_flush,
+    .compress_stream_set_pledged_size = brotli_cstream_set_pledged_size,
 #endif
 #ifndef CU_OMIT_DECOMPRESS
     .decompress                = brotli_decompress,
     .decompress_size_hint      = brotli_decompress_size_hint,
+    .frame_info                = brotli_frame_info,
     .decompress_stream_create  = brotli_dstream_create,
     .decompress_stream_write   = brotli_dstream_write,
     .decompress_stream_finish  = brotli_dstream_finish,
     .decompress_stream_destroy = brotli_dstream_destroy,
 #endif
 };
+
+CU_DEFINE_DIRECT_API(brotli)
@@ -3,11 +3,15 @@
  *
  * bzip2's wire format does not carry the decompressed size:
  *   - cu_decompress_size_hint returns CU_ERR_SIZE_UNKNOWN.
- *   - one-shot decompress uses BZ2_bzBuffToBuffDecompress into the
- *     caller's buffer and returns SIZE_UNKNOWN if BZ_OUTBUFF_FULL.
+ *   - one-shot decompress runs BZ2_bzDecompress into the caller's buffer
+ *     and returns SIZE_UNKNOWN if it fills up.
  *
  * Streaming uses BZ2_bzCompress / BZ2_bzDecompress with the stashed-tail
  * protocol.
+ *
+ * Both decoders accept several bzip2 streams back to back (cu_compress_parallel
+ * and pbzip2 output, `cat a.bz2 b.bz2`), restarting the decoder at each
+ * stream end exactly as `bzip2 -d` does.
  */
 
 #include "algorithm_registry.h"
@@ -90,31 +94,71 @@ static cu_status_t bz2_decompress(
         cu_set_last_error("bz2: empty input");
         return CU_ERR_TRUNCATED;
     }
-    unsigned int dest_len = (unsigned int)*out_len;
     size_t cap_limit = cu_get_max_decompressed_size();
-    int r = BZ2_bzBuffToBuffDecompress(
-        (char*)out, &dest_len,
-        (char*)(uintptr_t)in, (unsigned int)in_len,
-        0, 0
-    );
-    if (r == BZ_OK) {
-        if (cap_limit > 0 && dest_len > cap_limit) {
-            cu_set_last_errorf("bz2: decompressed size %u exceeds cap %zu", dest_len, cap_limit);
-            return CU_ERR_SIZE_LIMIT;
-        }
-        *out_len = dest_len;
-        return CU_OK;
+    bz_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    int r = BZ2_bzDecompressInit(&strm, 0, 0);
+    if (r != BZ_OK) {
+        cu_set_last_errorf("bz2: %s", bz2_errstr(r));
+        return r == BZ_MEM_ERROR ? CU_ERR_OOM : CU_ERR_DECOMPRESSION;
     }
-    if (r == BZ_OUTBUFF_FULL) {
-        cu_set_last_error("bz2: output buffer too small (size not encoded in stream)");
-        return CU_ERR_SIZE_UNKNOWN;
+    strm.next_in   = (char*)(uintptr_t)in;
+    strm.avail_in  = (unsigned int)in_len;
+    strm.next_out  = (char*)out;
+    strm.avail_out = (unsigned int)*out_len;
+
+    cu_status_t ret;
+    for (;;) {
+        unsigned int in_before = strm.avail_in;
+        unsigned int out_before = strm.avail_out;
+        r = BZ2_bzDecompress(&strm);
+        if (r == BZ_STREAM_END) {
+            if (strm.avail_in == 0) { ret = CU_OK; break; }
+            /* Another stream follows: restart the decoder in place. */
+            char* next_in = strm.next_in;
+            char* next_out = strm.next_out;
+            unsigned int avail_in = strm.avail_in;
+            unsigned int avail_out = strm.avail_out;
+            BZ2_bzDecompressEnd(&strm);
+            memset(&strm, 0, sizeof(strm));
+            r = BZ2_bzDecompressInit(&strm, 0, 0);
+            if (r != BZ_OK) {
+                cu_set_last_errorf("bz2: %s", bz2_errstr(r));
+                return r == BZ_MEM_ERROR ? CU_ERR_OOM : CU_ERR_DECOMPRESSION;
+            }
+            strm.next_in = next_in;
+            strm.avail_in = avail_in;
+            strm.next_out = next_out;
+            strm.avail_out = avail_out;
+            continue;
+        }
+        if (r != BZ_OK) {
+            cu_set_last_errorf("bz2: %s", bz2_errstr(r));
+            ret = r == BZ_MEM_ERROR ? CU_ERR_OOM : CU_ERR_DECOMPRESSION;
+            break;
+        }
+        if (strm.avail_in == in_before && strm.avail_out == out_before) {
+            /* No progress: either out of room or out of input. */
+            if (strm.avail_out == 0) {
+                cu_set_last_error("bz2: output buffer too small (size not encoded in stream)");
+                ret = CU_ERR_SIZE_UNKNOWN;
+            } else {
+                cu_set_last_error("bz2: truncated input");
+                ret = CU_ERR_TRUNCATED;
+            }
+            break;
+        }
     }
-    if (r == BZ_UNEXPECTED_EOF) {
-        cu_set_last_error("bz2: truncated input");
-        return CU_ERR_TRUNCATED;
+    BZ2_bzDecompressEnd(&strm);
+    if (ret != CU_OK) return ret;
+
+    size_t produced = (size_t)((uint8_t*)strm.next_out - out);
+    if (cap_limit > 0 && produced > cap_limit) {
+        cu_set_last_errorf("bz2: decompressed size %zu exceeds cap %zu", produced, cap_limit);
+        return CU_ERR_SIZE_LIMIT;
     }
-    cu_set_last_errorf("bz2: %s", bz2_errstr(r));
-    return CU_ERR_DECOMPRESSION;
+    *out_len = produced;
+    return CU_OK;
 }
 
 static cu_status_t bz2_decompress_size_hint(
@@ -124,6 +168,25 @@ static cu_status_t bz2_decompress_size_hint(
     return CU_ERR_SIZE_UNKNOWN;
 }
 
+/* "BZh" plus the block-size digit: each block holds up to digit * 100 000
+ * bytes of input, is CRC-checked, and decodes on its own. */
+static cu_status_t bz2_frame_info(
+    const uint8_t* in, size_t in_len, cu_frame_info_t* info
+) {
+    if (in_len < 4) {
+        cu_set_last_error("bz2: input ends inside the stream header");
+        return CU_ERR_TRUNCATED;
+    }
+    if (in[0] != 'B' || in[1] != 'Z' || in[2] != 'h' || in[3] < '1' || in[3] > '9') {
+        cu_set_last_error("bz2: invalid stream header");
+        return CU_ERR_DECOMPRESSION;
+    }
+    info->block_size = (uint64_t)(in[3] - '0') * 100000;
+    info->has_checksum = 1;
+    info->blocks_independent = 1;
+    return CU_OK;
+}
+
 /* ============================================================================
  * Streaming compression
  * ============================================================================ */
@@ -275,6 +338,21 @@ static cu_status_t bz2_dstream_create(void** out_state) {
     return CU_OK;
 }
 
+/* Reinitialize the decoder for the next concatenated stream. */
+static cu_status_t dstream_restart(bz2_dstream_state_t* st) {
+    BZ2_bzDecompressEnd(&st->strm);
+    memset(&st->strm, 0, sizeof(st->strm));
+    st->strm_inited = 0;
+    int r = BZ2_bzDecompressInit(&st->strm, 0, 0);
+    if (r != BZ_OK) {
+        cu_set_last_errorf("bz2: %s", bz2_errstr(r));
+        return r == BZ_MEM_ERROR ? CU_ERR_OOM : CU_ERR_DECOMPRESSION;
+    }
+    st->strm_inited = 1;
+    st->stream_end = 0;
+    return CU_OK;
+}
+
 static cu_status_t dstream_pump(bz2_dstream_state_t* st,
                                 uint8_t* out, size_t* out_len) {
     size_t cap = *out_len;
@@ -298,8 +376,16 @@ static cu_status_t dstream_pump(bz2_dstream_state_t* st,
                 memmove(st->pending, st->pending + consumed, st->strm.avail_in);
             }
             st->pending_len = st->strm.avail_in;
-            *out_len = written;
-            return CU_OK;
+            if (st->pending_len == 0) {
+                *out_len = written;
+                return CU_OK;
+            }
+            /* Another stream follows in the same input. */
+            cu_status_t s = dstream_restart(st);
+            if (s != CU_OK) return s;
+            st->strm.next_in  = (char*)st->pending;
+            st->strm.avail_in = (unsigned int)st->pending_len;
+            continue;
         }
         if (r == BZ_OK) {
             if (st->strm.avail_out == 0 && st->strm.avail_in > 0) {
@@ -331,8 +417,8 @@ static cu_status_t bz2_dstream_write(
 ) {
     bz2_dstream_state_t* st = (bz2_dstream_state_t*)state;
     if (st->stream_end && in_len > 0) {
-        cu_set_last_error("bz2: data after end of stream");
-        return CU_ERR_DECOMPRESSION;
+        cu_status_t s = dstream_restart(st);
+        if (s != CU_OK) return s;
     }
     cu_status_t s = pending_append(&st->pending, &st->pending_len, &st->pending_cap, in, in_len);
     if (s != CU_OK) return s;
@@ -384,9 +470,12 @@ const cu_algorithm_vtbl_t cu_bz2_vtbl = {
 #ifndef CU_OMIT_DECOMPRESS
     .decompress                = bz2_decompress,
     .decompress_size_hint      = bz2_decompress_size_hint,
+    .frame_info                = bz2_frame_info,
     .decompress_stream_create  = bz2_dstream_create,
     .decompress_stream_write   = bz2_dstream_write,
     .decompress_stream_finish  = bz2_dstream_finish,
     .decompress_stream_destroy = bz2_dstream_destroy,
 #endif
 };
+
+CU_DEFINE_DIRECT_API(bz2)
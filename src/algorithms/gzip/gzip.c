@@ -30,6 +30,10 @@ static cu_status_t gzip_decompress(const uint8_t* in, size_t in_len,
 static cu_status_t gzip_cstream_create(int level, void** out_state) {
     return dfl_cstream_create(level, CU_DFL_GZIP_WBITS, out_state);
 }
+static cu_status_t gzip_frame_info(const uint8_t* in, size_t in_len,
+                                   cu_frame_info_t* info) {
+    return dfl_frame_info(in, in_len, info, CU_DFL_GZIP_WBITS);
+}
 static cu_status_t gzip_dstream_create(void** out_state) {
     return dfl_dstream_create(CU_DFL_GZIP_WBITS, out_state);
 }
@@ -44,13 +48,18 @@ const cu_algorithm_vtbl_t cu_gzip_vtbl = {
     .compress_stream_write     = dfl_cstream_write,
     .compress_stream_finish    = dfl_cstream_finish,
     .compress_stream_destroy   = dfl_stream_destroy,
+    .compress_stream_flush     = dfl_cstream_flush,
 #endif
 #ifndef CU_OMIT_DECOMPRESS
     .decompress                = gzip_decompress,
     .decompress_size_hint      = dfl_decompress_size_hint,
+    .frame_info                = gzip_frame_info,
     .decompress_stream_create  = gzip_dstream_create,
     .decompress_stream_write   = dfl_dstream_write,
     .decompress_stream_finish  = dfl_dstream_finish,
     .decompress_stream_destroy = dfl_stream_destroy,
+    .decompress_stream_set_skip_checksum = dfl_dstream_set_skip_checksum,
 #endif
 };
+
+CU_DEFINE_DIRECT_API(gzip)
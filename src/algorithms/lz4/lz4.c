@@ -9,13 +9,18 @@
  * interoperable with the standard `lz4` CLI / .lz4 files.
  *
  * Size hint: LZ4 frames optionally carry the content size if the
- * content-size flag is set at encode time. We always set it on encode,
- * so cu_decompress_size_hint succeeds for frames produced by this
- * library.
+ * content-size flag is set at encode time. One-shot encode always sets
+ * it, so cu_decompress_size_hint succeeds for those frames; streams set
+ * it when the caller pledges a size.
+ *
+ * Concatenated frames (cu_compress_parallel output, `cat a.lz4 b.lz4`)
+ * decode as one stream, as the `lz4` CLI does. The size hint walks the
+ * block headers to find each frame's end and sums the declared sizes.
  */
 
 #include "algorithm_registry.h"
 #include "compress_utils.h"
+#include "utils/levels.h"
 
 #include <lz4.h>
 #include <lz4frame.h>
@@ -30,7 +35,11 @@ static int lz4_native_level(int user_level) {
      * User 1..10 -> mapping designed to give a meaningful spread:
      *   1..3 -> 0..2 (fast mode)
      *   4..10 -> 4..12 (HC mode 4..12).
+     * Speed tiers 0, -1..-5 -> 0, -1, -3, -7, -15, -31: LZ4F runs a negative
+     * level with acceleration 1 - level, i.e. 1, 2, 4, 8, 16, 32.
      */
+    if (user_level == 0) return 0;
+    if (user_level < 0) return 1 - 2 * cu_speed_tier_step(user_level);
     if (user_level <= 3) return user_level - 1;
     /* level 4..10 -> 4..12: (level - 4) * 8 / 6 + 4 -> approx */
     return 4 + ((user_level - 4) * 8) / 6;
@@ -84,6 +93,121 @@ static cu_status_t lz4_compress(
     return CU_OK;
 }
 
+#define LZ4_FRAME_MAGIC          0x184D2204u
+#define LZ4_SKIPPABLE_MAGIC_MASK 0xFFFFFFF0u
+#define LZ4_SKIPPABLE_MAGIC      0x184D2A50u
+
+static uint32_t lz4_read_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*
+ * Walk every frame in `in` without decoding it, summing declared content
+ * sizes (skippable frames count as zero). Returns CU_OK with *total set,
+ * CU_ERR_SIZE_UNKNOWN if some frame has no content size, CU_ERR_TRUNCATED
+ * if the input ends mid-frame, or CU_ERR_DECOMPRESSION on a bad magic.
+ */
+static cu_status_t lz4_frames_content_size(const uint8_t* in, size_t in_len,
+                                           unsigned long long* total) {
+    unsigned long long sum = 0;
+    int unknown = 0;
+    size_t pos = 0;
+    while (pos < in_len) {
+        if (in_len - pos < 8) return CU_ERR_TRUNCATED;
+        uint32_t magic = lz4_read_le32(in + pos);
+        if ((magic & LZ4_SKIPPABLE_MAGIC_MASK) == LZ4_SKIPPABLE_MAGIC) {
+            size_t skip = lz4_read_le32(in + pos + 4);
+            if (in_len - pos - 8 < skip) return CU_ERR_TRUNCATED;
+            pos += 8 + skip;
+            continue;
+        }
+        if (magic != LZ4_FRAME_MAGIC) return CU_ERR_DECOMPRESSION;
+
+        uint8_t flg = in[pos + 4];
+        int has_block_crc   = (flg >> 4) & 1;
+        int has_size        = (flg >> 3) & 1;
+        int has_content_crc = (flg >> 2) & 1;
+        int has_dict_id     = flg & 1;
+        size_t hdr = 4 + 2 + (has_size ? 8 : 0) + (has_dict_id ? 4 : 0) + 1;
+        if (in_len - pos < hdr) return CU_ERR_TRUNCATED;
+        if (has_size) {
+            unsigned long long n = (unsigned long long)lz4_read_le32(in + pos + 6) |
+                ((unsigned long long)lz4_read_le32(in + pos + 10) << 32);
+            sum += n;
+        } else {
+            unknown = 1;
+        }
+        pos += hdr;
+
+        for (;;) {
+            if (in_len - pos < 4) return CU_ERR_TRUNCATED;
+            uint32_t bsize = lz4_read_le32(in + pos) & 0x7FFFFFFFu;
+            pos += 4;
+            if (bsize == 0) break;  /* EndMark */
+            size_t body = (size_t)bsize + (has_block_crc ? 4 : 0);
+            if (in_len - pos < body) return CU_ERR_TRUNCATED;
+            pos += body;
+        }
+        if (has_content_crc) {
+            if (in_len - pos < 4) return CU_ERR_TRUNCATED;
+            pos += 4;
+        }
+    }
+    *total = sum;
+    return unknown ? CU_ERR_SIZE_UNKNOWN : CU_OK;
+}
+
+/* Frame descriptor of the first non-skippable frame (lz4 frame format 1.6.x). */
+static cu_status_t lz4_frame_info(
+    const uint8_t* in, size_t in_len, cu_frame_info_t* info
+) {
+    size_t pos = 0;
+    uint32_t magic;
+    for (;;) {
+        if (in_len - pos < 4) goto truncated;
+        magic = lz4_read_le32(in + pos);
+        if ((magic & LZ4_SKIPPABLE_MAGIC_MASK) != LZ4_SKIPPABLE_MAGIC) break;
+        if (in_len - pos < 8) goto truncated;
+        size_t skip = lz4_read_le32(in + pos + 4);
+        if (in_len - pos - 8 < skip) goto truncated;
+        pos += 8 + skip;
+    }
+    if (magic != LZ4_FRAME_MAGIC) {
+        cu_set_last_error("lz4: not an lz4 frame");
+        return CU_ERR_DECOMPRESSION;
+    }
+    if (in_len - pos < 6) goto truncated;
+
+    uint8_t flg = in[pos + 4];
+    uint8_t bd  = in[pos + 5];
+    unsigned block_id = (bd >> 4) & 7;
+    if ((flg >> 6) != 1 || (flg & 0x02) || (bd & 0x8F) || block_id < 4) {
+        cu_set_last_error("lz4: invalid frame descriptor");
+        return CU_ERR_DECOMPRESSION;
+    }
+    int has_size    = (flg >> 3) & 1;
+    int has_dict_id = flg & 1;
+    if (in_len - pos < 7 + (has_size ? 8u : 0u) + (has_dict_id ? 4u : 0u)) goto truncated;
+
+    const uint8_t* p = in + pos + 6;
+    if (has_size) {
+        info->content_size = (uint64_t)lz4_read_le32(p) |
+                             ((uint64_t)lz4_read_le32(p + 4) << 32);
+        p += 8;
+    }
+    if (has_dict_id) info->dict_id = lz4_read_le32(p);
+    info->blocks_independent = (flg >> 5) & 1;
+    info->window_size = info->blocks_independent ? 0 : 64 * 1024;
+    info->block_size = (uint64_t)1 << (8 + 2 * block_id);
+    info->has_checksum = (flg >> 2) & 1;
+    return CU_OK;
+
+truncated:
+    cu_set_last_error("lz4: input ends inside the frame header");
+    return CU_ERR_TRUNCATED;
+}
+
 static cu_status_t lz4_decompress(
     const uint8_t* in, size_t in_len,
     uint8_t* out, size_t* out_len
@@ -105,15 +229,20 @@ static cu_status_t lz4_decompress(
         return map_lz4f_err(r, CU_ERR_DECOMPRESSION);
     }
     size_t cap_limit = cu_get_max_decompressed_size();
-    if (info.contentSize > 0) {
-        if (cap_limit > 0 && info.contentSize > cap_limit) {
+    unsigned long long content_size = 0;
+    if (info.contentSize > 0 &&
+        lz4_frames_content_size(in, in_len, &content_size) != CU_OK) {
+        content_size = 0;  /* not fully known: decode and see */
+    }
+    if (content_size > 0) {
+        if (cap_limit > 0 && content_size > cap_limit) {
             cu_set_last_errorf("lz4: declared size %llu exceeds cap %zu",
-                               (unsigned long long)info.contentSize, cap_limit);
+                               content_size, cap_limit);
             LZ4F_freeDecompressionContext(dctx);
             return CU_ERR_SIZE_LIMIT;
         }
-        if (*out_len < info.contentSize) {
-            *out_len = (size_t)info.contentSize;
+        if (*out_len < content_size) {
+            *out_len = (size_t)content_size;
             LZ4F_freeDecompressionContext(dctx);
             return CU_ERR_BUF_TOO_SMALL;
         }
@@ -125,6 +254,7 @@ static cu_status_t lz4_decompress(
     size_t dst_remaining = *out_len;
     uint8_t* dst = out;
     size_t total_out = 0;
+    int frame_done = 0;
 
     while (src_remaining > 0) {
         size_t src_size = src_remaining;
@@ -139,18 +269,27 @@ static cu_status_t lz4_decompress(
         dst_remaining -= dst_size;
         src += src_size;
         src_remaining -= src_size;
-        if (r == 0) break;  /* frame complete */
-        if (dst_remaining == 0 && src_remaining > 0) {
+        frame_done = (r == 0);  /* the dctx begins the next frame by itself */
+        if (cap_limit > 0 && total_out > cap_limit) {
+            LZ4F_freeDecompressionContext(dctx);
+            cu_set_last_errorf("lz4: decompressed output exceeded cap %zu", cap_limit);
+            return CU_ERR_SIZE_LIMIT;
+        }
+        if (dst_remaining == 0 && src_remaining > 0 && src_size == 0) {
             LZ4F_freeDecompressionContext(dctx);
-            if (info.contentSize == 0) {
+            if (content_size == 0) {
                 cu_set_last_error("lz4: output buffer too small (size not in frame)");
                 return CU_ERR_SIZE_UNKNOWN;
             }
-            *out_len = (size_t)info.contentSize;
+            *out_len = (size_t)content_size;
             return CU_ERR_BUF_TOO_SMALL;
         }
     }
     LZ4F_freeDecompressionContext(dctx);
+    if (!frame_done) {
+        cu_set_last_error("lz4: truncated frame");
+        return CU_ERR_TRUNCATED;
+    }
     *out_len = total_out;
     return CU_OK;
 }
@@ -167,13 +306,19 @@ static cu_status_t lz4_decompress_size_hint(
     size_t in_probe = in_len;
     r = LZ4F_getFrameInfo(dctx, &info, in, &in_probe);
     cu_status_t ret;
+    unsigned long long total = 0;
     if (LZ4F_isError(r)) {
         ret = map_lz4f_err(r, CU_ERR_DECOMPRESSION);
-    } else if (info.contentSize > 0) {
-        *out_size = (size_t)info.contentSize;
+    } else if (info.contentSize == 0) {
+        ret = CU_ERR_SIZE_UNKNOWN;
+    } else if (lz4_frames_content_size(in, in_len, &total) == CU_OK) {
+        *out_size = (size_t)total;
         ret = CU_OK;
     } else {
-        ret = CU_ERR_SIZE_UNKNOWN;
+        /* Truncated or trailing junk: fall back to the first frame's size
+         * and let decompression report the precise error. */
+        *out_size = (size_t)info.contentSize;
+        ret = CU_OK;
     }
     LZ4F_freeDecompressionContext(dctx);
     return ret;
@@ -194,11 +339,13 @@ static cu_status_t lz4_decompress_size_hint(
  *   - out_buf: compressed bytes produced by the codec, waiting to be
  *              given to the caller's `out` in BUF_TOO_SMALL slices.
  *
- * On each write/finish call:
+ * On each write/flush/finish call:
  *   1. Drain out_buf into caller's `out`.
  *   2. If out_buf is empty, append `in` to in_buf, then feed one block
  *      from in_buf into LZ4F_compressUpdate (which fills out_buf).
  *   3. Drain again, repeat.
+ * flush then puts LZ4F_flush's partial block in out_buf, finish the
+ * frame end from LZ4F_compressEnd.
  */
 
 #define LZ4_BLOCK_SIZE (64 * 1024)
@@ -307,6 +454,30 @@ static cu_status_t cstream_feed_one_block(lz4_cstream_state_t* st) {
     return CU_OK;
 }
 
+/* Steps 1-3 above: drain out_buf, emit the header if due, then feed in_buf
+ * block by block. CU_ERR_BUF_TOO_SMALL once the caller's buffer fills. */
+static cu_status_t cstream_pump_input(lz4_cstream_state_t* st,
+                                      uint8_t* out, size_t cap, size_t* written) {
+    if (out_drain(st, out, cap, written)) return CU_ERR_BUF_TOO_SMALL;
+
+    /* Emit header if needed (also for a zero-input finish). */
+    if (!st->header_written) {
+        size_t r = LZ4F_compressBegin(st->cctx, st->out_buf, st->out_cap, &st->prefs);
+        if (LZ4F_isError(r)) return map_lz4f_err(r, CU_ERR_COMPRESSION);
+        st->out_tail = r;
+        st->header_written = 1;
+        if (out_drain(st, out, cap, written)) return CU_ERR_BUF_TOO_SMALL;
+    }
+
+    /* Consume in_buf one block at a time. */
+    while (st->in_tail > st->in_head) {
+        cu_status_t s = cstream_feed_one_block(st);
+        if (s != CU_OK) return s;
+        if (out_drain(st, out, cap, written)) return CU_ERR_BUF_TOO_SMALL;
+    }
+    return CU_OK;
+}
+
 static cu_status_t lz4_cstream_write(
     void* state, const uint8_t* in, size_t in_len,
     uint8_t* out, size_t* out_len
@@ -316,34 +487,57 @@ static cu_status_t lz4_cstream_write(
         cu_set_last_error("lz4: write after finish");
         return CU_ERR_STREAM_STATE;
     }
-    size_t cap = *out_len;
     size_t written = 0;
 
     /* Append new input first. */
     cu_status_t s = in_buf_append(st, in, in_len);
     if (s != CU_OK) return s;
 
-    /* Drain anything leftover in out_buf. */
-    if (out_drain(st, out, cap, &written)) { *out_len = written; return CU_ERR_BUF_TOO_SMALL; }
+    s = cstream_pump_input(st, out, *out_len, &written);
+    if (s == CU_OK || s == CU_ERR_BUF_TOO_SMALL) *out_len = written;
+    return s;
+}
+
+static cu_status_t lz4_cstream_set_pledged_size(void* state, uint64_t size) {
+    lz4_cstream_state_t* st = (lz4_cstream_state_t*)state;
+    /* Read by LZ4F_compressBegin, which runs on the first write. */
+    st->prefs.frameInfo.contentSize = size;
+    return CU_OK;
+}
 
-    /* Emit header if needed. */
-    if (!st->header_written) {
-        size_t r = LZ4F_compressBegin(st->cctx, st->out_buf, st->out_cap, &st->prefs);
-        if (LZ4F_isError(r)) return map_lz4f_err(r, CU_ERR_COMPRESSION);
-        st->out_tail = r;
-        st->header_written = 1;
-        if (out_drain(st, out, cap, &written)) { *out_len = written; return CU_ERR_BUF_TOO_SMALL; }
+static cu_status_t lz4_cstream_set_checksum(void* state, int enabled) {
+    lz4_cstream_state_t* st = (lz4_cstream_state_t*)state;
+    st->prefs.frameInfo.contentChecksumFlag =
+        enabled ? LZ4F_contentChecksumEnabled : LZ4F_noContentChecksum;
+    return CU_OK;
+}
+
+static cu_status_t lz4_cstream_flush(
+    void* state, uint8_t* out, size_t* out_len
+) {
+    lz4_cstream_state_t* st = (lz4_cstream_state_t*)state;
+    if (st->finishing) {
+        cu_set_last_error("lz4: flush after finish");
+        return CU_ERR_STREAM_STATE;
     }
+    size_t cap = *out_len;
+    size_t written = 0;
 
-    /* Consume in_buf one block at a time. */
-    while (st->in_tail > st->in_head) {
-        s = cstream_feed_one_block(st);
-        if (s != CU_OK) return s;
-        if (out_drain(st, out, cap, &written)) { *out_len = written; return CU_ERR_BUF_TOO_SMALL; }
+    cu_status_t s = cstream_pump_input(st, out, cap, &written);
+    if (s != CU_OK) {
+        if (s == CU_ERR_BUF_TOO_SMALL) *out_len = written;
+        return s;
     }
 
+    /* Close the partial block LZ4F is holding. A repeat call after
+     * BUF_TOO_SMALL finds nothing left to flush and just drains. */
+    size_t r = LZ4F_flush(st->cctx, st->out_buf, st->out_cap, NULL);
+    if (LZ4F_isError(r)) return map_lz4f_err(r, CU_ERR_COMPRESSION);
+    st->out_tail = r;
+
+    int more = out_drain(st, out, cap, &written);
     *out_len = written;
-    return CU_OK;
+    return more ? CU_ERR_BUF_TOO_SMALL : CU_OK;
 }
 
 static cu_status_t lz4_cstream_finish(
@@ -354,25 +548,12 @@ static cu_status_t lz4_cstream_finish(
     size_t cap = *out_len;
     size_t written = 0;
 
-    if (out_drain(st, out, cap, &written)) { *out_len = written; return CU_ERR_BUF_TOO_SMALL; }
-
-    if (st->finished) { *out_len = written; return CU_OK; }
-
-    /* Header (for zero-input finish). */
-    if (!st->header_written) {
-        size_t r = LZ4F_compressBegin(st->cctx, st->out_buf, st->out_cap, &st->prefs);
-        if (LZ4F_isError(r)) return map_lz4f_err(r, CU_ERR_COMPRESSION);
-        st->out_tail = r;
-        st->header_written = 1;
-        if (out_drain(st, out, cap, &written)) { *out_len = written; return CU_ERR_BUF_TOO_SMALL; }
-    }
-
-    /* Drain pending input. */
-    while (st->in_tail > st->in_head) {
-        cu_status_t s = cstream_feed_one_block(st);
-        if (s != CU_OK) return s;
-        if (out_drain(st, out, cap, &written)) { *out_len = written; return CU_ERR_BUF_TOO_SMALL; }
+    cu_status_t s = cstream_pump_input(st, out, cap, &written);
+    if (s != CU_OK) {
+        if (s == CU_ERR_BUF_TOO_SMALL) *out_len = written;
+        return s;
     }
+    if (st->finished) { *out_len = written; return CU_OK; }
 
     /* End frame. */
     size_t r = LZ4F_compressEnd(st->cctx, st->out_buf, st->out_cap, NULL);
@@ -400,6 +581,7 @@ static void lz4_cstream_destroy(void* state) {
 
 typedef struct {
     LZ4F_dctx* dctx;
+    LZ4F_decompressOptions_t opts;  /* skipChecksums in trusted-input mode */
     uint8_t* pending;
     size_t   pending_len;
     size_t   pending_cap;
@@ -424,7 +606,7 @@ static cu_status_t dstream_pump(lz4_dstream_state_t* st,
     size_t cap = *out_len;
     size_t written = 0;
 
-    while (st->pending_len > 0 && !st->frame_done) {
+    while (st->pending_len > 0) {
         size_t avail = cap - written;
         if (avail == 0) {
             *out_len = written;
@@ -434,7 +616,7 @@ static cu_status_t dstream_pump(lz4_dstream_state_t* st,
         size_t dst_size = avail;
         size_t r = LZ4F_decompress(st->dctx,
                                    out + written, &dst_size,
-                                   st->pending, &src_size, NULL);
+                                   st->pending, &src_size, &st->opts);
         if (LZ4F_isError(r)) return map_lz4f_err(r, CU_ERR_DECOMPRESSION);
         written += dst_size;
         /* Consume src_size bytes from pending. */
@@ -442,11 +624,10 @@ static cu_status_t dstream_pump(lz4_dstream_state_t* st,
             memmove(st->pending, st->pending + src_size, st->pending_len - src_size);
             st->pending_len -= src_size;
         }
-        if (r == 0) {
-            st->frame_done = 1;
-            break;
-        }
-        if (src_size == 0 && dst_size == 0) {
+        /* r == 0 closes a frame; any bytes left in pending start the next
+         * one (or are rejected as a bad magic by LZ4F_decompress). */
+        st->frame_done = (r == 0);
+        if (r != 0 && src_size == 0 && dst_size == 0) {
             /* Decoder needs more input — pending is empty after consume,
              * caller should provide more. */
             break;
@@ -479,10 +660,6 @@ static cu_status_t lz4_dstream_write(
     uint8_t* out, size_t* out_len
 ) {
     lz4_dstream_state_t* st = (lz4_dstream_state_t*)state;
-    if (st->frame_done && in_len > 0) {
-        cu_set_last_error("lz4: data after end of frame");
-        return CU_ERR_DECOMPRESSION;
-    }
     cu_status_t s = dstream_pending_append(st, in, in_len);
     if (s != CU_OK) return s;
     return dstream_pump(st, out, out_len);
@@ -501,6 +678,12 @@ static cu_status_t lz4_dstream_finish(
     return CU_OK;
 }
 
+static cu_status_t lz4_dstream_set_skip_checksum(void* state, int skip) {
+    lz4_dstream_state_t* st = (lz4_dstream_state_t*)state;
+    st->opts.skipChecksums = (unsigned)skip;
+    return CU_OK;
+}
+
 static void lz4_dstream_destroy(void* state) {
     lz4_dstream_state_t* st = (lz4_dstream_state_t*)state;
     if (!st) return;
@@ -523,13 +706,20 @@ const cu_algorithm_vtbl_t cu_lz4_vtbl = {
     .compress_stream_write     = lz4_cstream_write,
     .compress_stream_finish    = lz4_cstream_finish,
     .compress_stream_destroy   = lz4_cstream_destroy,
+    .compress_stream_flush     = lz4_cstream_flush,
+    .compress_stream_set_pledged_size = lz4_cstream_set_pledged_size,
+    .compress_stream_set_checksum = lz4_cstream_set_checksum,
 #endif
 #ifndef CU_OMIT_DECOMPRESS
     .decompress                = lz4_decompress,
     .decompress_size_hint      = lz4_decompress_size_hint,
+    .frame_info                = lz4_frame_info,
     .decompress_stream_create  = lz4_dstream_create,
     .decompress_stream_write   = lz4_dstream_write,
     .decompress_stream_finish  = lz4_dstream_finish,
     .decompress_stream_destroy = lz4_dstream_destroy,
+    .decompress_stream_set_skip_checksum = lz4_dstream_set_skip_checksum,
 #endif
 };
+
+CU_DEFINE_DIRECT_API(lz4)
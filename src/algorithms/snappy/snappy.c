@@ -136,6 +136,15 @@ static cu_status_t snappy_decompress_size_hint(
     return CU_OK;
 }
 
+static cu_status_t snappy_frame_info(
+    const uint8_t* in, size_t in_len, cu_frame_info_t* info
+) {
+    size_t sz = 0;
+    cu_status_t s = snappy_decompress_size_hint(in, in_len, &sz);
+    if (s == CU_OK) info->content_size = sz;
+    return s;
+}
+
 /* ============================================================================
  * Streaming — buffer-all-then-run (see file header for why)
  * ============================================================================ */
@@ -200,6 +209,19 @@ static cu_status_t snappy_cstream_create(int level, void** out_state) {
     return CU_OK;
 }
 
+/* The whole input is buffered anyway; a pledge lets it land in one
+ * allocation instead of a doubling series. */
+static cu_status_t snappy_cstream_set_pledged_size(void* state, uint64_t size) {
+    snappy_stream_state_t* st = (snappy_stream_state_t*)state;
+    if (size == 0 || size <= st->in_cap) return CU_OK;
+    if (size > SIZE_MAX) { cu_set_last_error("snappy: oom"); return CU_ERR_OOM; }
+    uint8_t* p = realloc(st->in_buf, (size_t)size);
+    if (!p) { cu_set_last_error("snappy: oom"); return CU_ERR_OOM; }
+    st->in_buf = p;
+    st->in_cap = (size_t)size;
+    return CU_OK;
+}
+
 static cu_status_t snappy_cstream_write(
     void* state, const uint8_t* in, size_t in_len,
     uint8_t* out, size_t* out_len
@@ -315,13 +337,17 @@ const cu_algorithm_vtbl_t cu_snappy_vtbl = {
     .compress_stream_write     = snappy_cstream_write,
     .compress_stream_finish    = snappy_cstream_finish,
     .compress_stream_destroy   = snappy_stream_destroy,
+    .compress_stream_set_pledged_size = snappy_cstream_set_pledged_size,
 #endif
 #ifndef CU_OMIT_DECOMPRESS
     .decompress                = snappy_decompress_oneshot,
     .decompress_size_hint      = snappy_decompress_size_hint,
+    .frame_info                = snappy_frame_info,
     .decompress_stream_create  = snappy_dstream_create,
     .decompress_stream_write   = snappy_dstream_write,
     .decompress_stream_finish  = snappy_dstream_finish,
     .decompress_stream_destroy = snappy_stream_destroy,
 #endif
 };
+
+CU_DEFINE_DIRECT_API(snappy)
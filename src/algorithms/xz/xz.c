@@ -13,6 +13,7 @@
  */
 
 #include "algorithm_registry.h"
+#include "alloc.h"
 #include "compress_utils.h"
 #include "utils/levels.h"
 
@@ -37,6 +38,16 @@ static cu_status_t map_lzma_error(lzma_ret r, cu_status_t fallback) {
     return fallback;
 }
 
+/* Every coder allocates through alloc.h so presets with big dictionaries
+ * can get huge pages (cu_set_huge_pages). liblzma zeroes lzma_alloc_zero
+ * memory itself when a custom allocator is set. */
+static void* xz_alloc(void* opaque, size_t nmemb, size_t size) {
+    if (size != 0 && nmemb > SIZE_MAX / size) return NULL;
+    return cu_codec_alloc(opaque, nmemb * size);
+}
+
+static const lzma_allocator xz_allocator = { xz_alloc, cu_codec_free, NULL };
+
 /* ============================================================================
  * One-shot
  * ============================================================================ */
@@ -60,7 +71,7 @@ static cu_status_t xz_compress(
     }
     size_t out_pos = 0;
     lzma_ret r = lzma_easy_buffer_encode(
-        xz_native_level(level), LZMA_CHECK_CRC64, NULL,
+        xz_native_level(level), LZMA_CHECK_CRC64, &xz_allocator,
         in, in_len,
         out, &out_pos, cap
     );
@@ -80,6 +91,7 @@ static cu_status_t xz_decompress(
         return CU_ERR_TRUNCATED;
     }
     lzma_stream strm = LZMA_STREAM_INIT;
+    strm.allocator = &xz_allocator;
     /* lzma_stream_decoder (NOT lzma_auto_decoder): we only ever produce .xz
      * streams, and auto_decoder additionally accepts the legacy .lzma_alone
      * format, whose header can declare an unknown/unbounded uncompressed size —
@@ -132,6 +144,45 @@ static cu_status_t xz_decompress_size_hint(
     return CU_ERR_SIZE_UNKNOWN;
 }
 
+/* Stream header (check type) plus the first block header, whose LZMA2
+ * filter carries the dictionary size. A stream with no blocks goes
+ * straight to its index and is empty. */
+static cu_status_t xz_frame_info(
+    const uint8_t* in, size_t in_len, cu_frame_info_t* info
+) {
+    if (in_len < LZMA_STREAM_HEADER_SIZE + 1) goto truncated;
+    lzma_stream_flags flags;
+    lzma_ret r = lzma_stream_header_decode(&flags, in);
+    if (r != LZMA_OK) return map_lzma_error(r, CU_ERR_DECOMPRESSION);
+    info->has_checksum = flags.check != LZMA_CHECK_NONE;
+
+    const uint8_t* bh = in + LZMA_STREAM_HEADER_SIZE;
+    if (bh[0] == 0x00) {
+        info->content_size = 0;
+        return CU_OK;
+    }
+    lzma_filter filters[LZMA_FILTERS_MAX + 1];
+    lzma_block block;
+    memset(&block, 0, sizeof(block));
+    block.check = flags.check;
+    block.filters = filters;
+    block.header_size = lzma_block_header_size_decode(bh[0]);
+    if (in_len - LZMA_STREAM_HEADER_SIZE < block.header_size) goto truncated;
+    r = lzma_block_header_decode(&block, NULL, bh);
+    if (r != LZMA_OK) return map_lzma_error(r, CU_ERR_DECOMPRESSION);
+    for (size_t i = 0; filters[i].id != LZMA_VLI_UNKNOWN; i++) {
+        if (filters[i].id == LZMA_FILTER_LZMA2 && filters[i].options) {
+            info->window_size = ((const lzma_options_lzma*)filters[i].options)->dict_size;
+        }
+    }
+    lzma_filters_free(filters, NULL);
+    return CU_OK;
+
+truncated:
+    cu_set_last_error("xz: input ends inside the stream or block header");
+    return CU_ERR_TRUNCATED;
+}
+
 /* ============================================================================
  * Streaming (shared infrastructure)
  * ============================================================================ */
@@ -139,6 +190,7 @@ static cu_status_t xz_decompress_size_hint(
 typedef struct {
     lzma_stream strm;
     int      strm_inited;
+    uint32_t preset;     /* compression: re-init on a checksum change */
     uint8_t* pending;
     size_t   pending_len;
     size_t   pending_cap;
@@ -178,7 +230,8 @@ static cu_status_t stream_pump(xz_stream_state_t* st, lzma_action action,
         written += produced;
 
         if (r == LZMA_STREAM_END) {
-            st->stream_end = 1;
+            /* For LZMA_SYNC_FLUSH this only means the flush completed. */
+            if (action != LZMA_SYNC_FLUSH) st->stream_end = 1;
             size_t consumed = st->pending_len - st->strm.avail_in;
             if (consumed > 0 && st->strm.avail_in > 0) {
                 memmove(st->pending, st->pending + consumed, st->strm.avail_in);
@@ -225,7 +278,8 @@ static cu_status_t stream_pump(xz_stream_state_t* st, lzma_action action,
             *out_len = written;
             return CU_ERR_TRUNCATED;
         }
-        return map_lzma_error(r, action == LZMA_RUN ? CU_ERR_COMPRESSION : CU_ERR_DECOMPRESSION);
+        return map_lzma_error(r, action == LZMA_RUN || action == LZMA_SYNC_FLUSH
+                                     ? CU_ERR_COMPRESSION : CU_ERR_DECOMPRESSION);
     }
 }
 
@@ -238,7 +292,9 @@ static cu_status_t xz_cstream_create(int level, void** out_state) {
     if (!st) { cu_set_last_error("xz: oom"); return CU_ERR_OOM; }
     lzma_stream init = LZMA_STREAM_INIT;
     st->strm = init;
-    lzma_ret r = lzma_easy_encoder(&st->strm, xz_native_level(level), LZMA_CHECK_CRC64);
+    st->strm.allocator = &xz_allocator;
+    st->preset = xz_native_level(level);
+    lzma_ret r = lzma_easy_encoder(&st->strm, st->preset, LZMA_CHECK_CRC64);
     if (r != LZMA_OK) {
         cu_status_t s = map_lzma_error(r, CU_ERR_COMPRESSION);
         free(st);
@@ -272,6 +328,26 @@ static cu_status_t xz_cstream_finish(
     return stream_pump(st, LZMA_FINISH, out, out_len);
 }
 
+static cu_status_t xz_cstream_flush(
+    void* state, uint8_t* out, size_t* out_len
+) {
+    xz_stream_state_t* st = (xz_stream_state_t*)state;
+    if (st->finishing) {
+        cu_set_last_error("xz: flush after finish");
+        return CU_ERR_STREAM_STATE;
+    }
+    return stream_pump(st, LZMA_SYNC_FLUSH, out, out_len);
+}
+
+/* The check type is fixed when the encoder is set up, so re-init it; no
+ * input has been given yet. */
+static cu_status_t xz_cstream_set_checksum(void* state, int enabled) {
+    xz_stream_state_t* st = (xz_stream_state_t*)state;
+    lzma_ret r = lzma_easy_encoder(&st->strm, st->preset,
+                                   enabled ? LZMA_CHECK_CRC64 : LZMA_CHECK_NONE);
+    return map_lzma_error(r, CU_ERR_COMPRESSION);
+}
+
 static void xz_cstream_destroy(void* state) {
     xz_stream_state_t* st = (xz_stream_state_t*)state;
     if (!st) return;
@@ -289,6 +365,7 @@ static cu_status_t xz_dstream_create(void** out_state) {
     if (!st) { cu_set_last_error("xz: oom"); return CU_ERR_OOM; }
     lzma_stream init = LZMA_STREAM_INIT;
     st->strm = init;
+    st->strm.allocator = &xz_allocator;
     /* lzma_stream_decoder, not auto_decoder — see xz_decompress for why (rejects
      * the legacy .lzma format that could decompress-bomb on garbage input). */
     lzma_ret r = lzma_stream_decoder(&st->strm, ((uint64_t)256 << 20)  /* 256 MiB memlimit */, LZMA_CONCATENATED);
@@ -333,6 +410,13 @@ static cu_status_t xz_dstream_finish(
     return CU_OK;
 }
 
+static cu_status_t xz_dstream_set_skip_checksum(void* state, int skip) {
+    xz_stream_state_t* st = (xz_stream_state_t*)state;
+    uint32_t flags = LZMA_CONCATENATED | (skip ? LZMA_IGNORE_CHECK : 0);
+    lzma_ret r = lzma_stream_decoder(&st->strm, ((uint64_t)256 << 20)  /* 256 MiB memlimit */, flags);
+    return map_lzma_error(r, CU_ERR_DECOMPRESSION);
+}
+
 static void xz_dstream_destroy(void* state) {
     xz_stream_state_t* st = (xz_stream_state_t*)state;
     if (!st) return;
@@ -355,13 +439,19 @@ const cu_algorithm_vtbl_t cu_xz_vtbl = {
     .compress_stream_write     = xz_cstream_write,
     .compress_stream_finish    = xz_cstream_finish,
     .compress_stream_destroy   = xz_cstream_destroy,
+    .compress_stream_flush     = xz_cstream_flush,
+    .compress_stream_set_checksum = xz_cstream_set_checksum,
 #endif
 #ifndef CU_OMIT_DECOMPRESS
     .decompress                = xz_decompress,
     .decompress_size_hint      = xz_decompress_size_hint,
+    .frame_info                = xz_frame_info,
     .decompress_stream_create  = xz_dstream_create,
     .decompress_stream_write   = xz_dstream_write,
     .decompress_stream_finish  = xz_dstream_finish,
     .decompress_stream_destroy = xz_dstream_destroy,
+    .decompress_stream_set_skip_checksum = xz_dstream_set_skip_checksum,
 #endif
 };
+
+CU_DEFINE_DIRECT_API(xz)
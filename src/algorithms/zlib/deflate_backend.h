@@ -10,7 +10,13 @@
  * mod 2^32 and needs the whole stream), so decompress_size_hint always returns
  * CU_ERR_SIZE_UNKNOWN and the bindings fall back to streaming.
  *
- * This header is internal and included by exactly two .c files.
+ * gzip input may hold several members back to back (RFC 1952 §2.2; what
+ * cu_compress_parallel, pigz --independent and `cat a.gz b.gz` produce). Both
+ * decoders continue into the next member like `gzip -d`. A zlib stream is a
+ * single unit.
+ *
+ * This header is internal. It is included by zlib.c and gzip.c, and by
+ * deflate_raw.c, which binds raw DEFLATE (windowBits -15) for ZIP method 8.
  */
 
 #ifndef CU_DEFLATE_BACKEND_H
@@ -110,14 +116,24 @@ static cu_status_t dfl_decompress(
     size_t cap_limit = cu_get_max_decompressed_size();
     cu_status_t ret;
 
-    r = inflate(&strm, Z_FINISH);
+    for (;;) {
+        r = inflate(&strm, Z_FINISH);
+        /* Another gzip member follows: reset and keep appending. */
+        if (r == Z_STREAM_END && window_bits > 15 && strm.avail_in > 0) {
+            inflateReset(&strm);
+            continue;
+        }
+        break;
+    }
+    /* total_out restarts with each member; measure from the pointer. */
+    size_t produced = (size_t)(strm.next_out - out);
     if (r == Z_STREAM_END) {
-        if (cap_limit > 0 && strm.total_out > cap_limit) {
+        if (cap_limit > 0 && produced > cap_limit) {
             cu_set_last_errorf("zlib: decompressed size %llu exceeds cap %zu",
-                               (unsigned long long)strm.total_out, cap_limit);
+                               (unsigned long long)produced, cap_limit);
             ret = CU_ERR_SIZE_LIMIT;
         } else {
-            *out_len = (size_t)strm.total_out;
+            *out_len = produced;
             ret = CU_OK;
         }
     } else if (r == Z_BUF_ERROR || (r == Z_OK && strm.avail_out == 0)) {
@@ -143,6 +159,47 @@ static cu_status_t dfl_decompress_size_hint(
     return CU_ERR_SIZE_UNKNOWN;
 }
 
+/* Both wrappers carry a checksum trailer (Adler-32 / CRC-32). zlib's CMF
+ * byte declares the window and FDICT a preset dictionary (RFC 1950 2.2);
+ * gzip always allows the full 32 KiB window (RFC 1952 2.3). Raw DEFLATE
+ * (negative wbits) has no header and no checksum: the window is all there
+ * is to report. */
+static cu_status_t dfl_frame_info(
+    const uint8_t* in, size_t in_len, cu_frame_info_t* info, int wbits
+) {
+    if (wbits < 0) {
+        info->window_size = (uint64_t)1 << -wbits;
+        return CU_OK;
+    }
+    if (wbits == CU_DFL_GZIP_WBITS) {
+        if (in_len < 10) goto truncated;
+        if (in[0] != 0x1f || in[1] != 0x8b || in[2] != 8 || (in[3] & 0xE0)) {
+            cu_set_last_error("gzip: invalid header");
+            return CU_ERR_DECOMPRESSION;
+        }
+        info->window_size = 32 * 1024;
+    } else {
+        if (in_len < 2) goto truncated;
+        if ((in[0] & 0x0F) != 8 || (in[0] >> 4) > 7 || ((in[0] << 8) | in[1]) % 31) {
+            cu_set_last_error("zlib: invalid header");
+            return CU_ERR_DECOMPRESSION;
+        }
+        info->window_size = (uint64_t)1 << ((in[0] >> 4) + 8);
+        if (in[1] & 0x20) {
+            if (in_len < 6) goto truncated;
+            info->dict_id = ((uint32_t)in[2] << 24) | ((uint32_t)in[3] << 16) |
+                            ((uint32_t)in[4] << 8) | in[5];
+        }
+    }
+    info->has_checksum = 1;
+    return CU_OK;
+
+truncated:
+    cu_set_last_error(wbits == CU_DFL_GZIP_WBITS ? "gzip: input ends inside the header"
+                                                 : "zlib: input ends inside the header");
+    return CU_ERR_TRUNCATED;
+}
+
 /* ============================================================================
  * Streaming (shared: state carries the z_stream, so pumps are wrapper-agnostic)
  * ============================================================================ */
@@ -155,6 +212,7 @@ typedef struct {
     int      finishing;
     int      stream_end;
     int      kind;  /* 0 = compress, 1 = decompress */
+    int      multi_member;  /* decompress: gzip, accept concatenated members */
 } dfl_stream_state_t;
 
 static cu_status_t dfl_pending_append(dfl_stream_state_t* st, const uint8_t* src, size_t n) {
@@ -283,6 +341,17 @@ static cu_status_t dfl_cstream_finish(
     return dfl_cstream_pump(st, Z_FINISH, out, out_len);
 }
 
+static cu_status_t dfl_cstream_flush(
+    void* state, uint8_t* out, size_t* out_len
+) {
+    dfl_stream_state_t* st = (dfl_stream_state_t*)state;
+    if (st->finishing) {
+        cu_set_last_error("zlib: flush after finish");
+        return CU_ERR_STREAM_STATE;
+    }
+    return dfl_cstream_pump(st, Z_SYNC_FLUSH, out, out_len);
+}
+
 static void dfl_stream_destroy(void* state);  /* fwd — shared by both dirs */
 
 /* ---- Streaming decompression ---- */
@@ -291,6 +360,7 @@ static cu_status_t dfl_dstream_create(int window_bits, void** out_state) {
     dfl_stream_state_t* st = calloc(1, sizeof(*st));
     if (!st) { cu_set_last_error("zlib: oom"); return CU_ERR_OOM; }
     st->kind = 1;
+    st->multi_member = window_bits > 15;
     int r = inflateInit2(&st->strm, window_bits);
     if (r != Z_OK) {
         cu_status_t s = dfl_map_error(r, CU_ERR_DECOMPRESSION);
@@ -306,7 +376,13 @@ static cu_status_t dfl_dstream_pump(dfl_stream_state_t* st,
     size_t cap = *out_len;
     size_t written = 0;
 
-    if (st->pending_len > 0) {
+    while (st->pending_len > 0) {
+        if (st->stream_end) {
+            if (!st->multi_member) break;
+            /* Bytes after a gzip member: the next member starts here. */
+            inflateReset(&st->strm);
+            st->stream_end = 0;
+        }
         st->strm.next_in  = st->pending;
         st->strm.avail_in = (uInt)st->pending_len;
         st->strm.next_out  = out + written;
@@ -321,14 +397,16 @@ static cu_status_t dfl_dstream_pump(dfl_stream_state_t* st,
             return dfl_map_error(z_ret, CU_ERR_DECOMPRESSION);
         }
         size_t consumed = st->pending_len - st->strm.avail_in;
-        if (st->strm.avail_in > 0 && !st->stream_end) {
+        if (st->strm.avail_in > 0 && (!st->stream_end || st->multi_member)) {
             memmove(st->pending, st->pending + consumed, st->strm.avail_in);
             st->pending_len = st->strm.avail_in;
+            if (st->stream_end) continue;
             *out_len = written;
             return CU_ERR_BUF_TOO_SMALL;
         }
         st->pending_len = 0;
     }
+    st->pending_len = 0;
     *out_len = written;
     return CU_OK;
 }
@@ -338,7 +416,7 @@ static cu_status_t dfl_dstream_write(
     uint8_t* out, size_t* out_len
 ) {
     dfl_stream_state_t* st = (dfl_stream_state_t*)state;
-    if (st->stream_end && in_len > 0) {
+    if (st->stream_end && in_len > 0 && !st->multi_member) {
         cu_set_last_error("zlib: data after end of stream");
         return CU_ERR_DECOMPRESSION;
     }
@@ -360,6 +438,14 @@ static cu_status_t dfl_dstream_finish(
     return CU_OK;
 }
 
+/* inflateValidate (zlib >= 1.2.9) turns off the Adler-32 / CRC-32 trailer
+ * check; inflateReset between gzip members keeps the setting. */
+static cu_status_t dfl_dstream_set_skip_checksum(void* state, int skip) {
+    dfl_stream_state_t* st = (dfl_stream_state_t*)state;
+    int r = inflateValidate(&st->strm, !skip);
+    return r == Z_OK ? CU_OK : dfl_map_error(r, CU_ERR_INTERNAL);
+}
+
 /* ---- Shared teardown (both directions) ---- */
 
 static void dfl_stream_destroy(void* state) {
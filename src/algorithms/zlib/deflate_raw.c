@@ -0,0 +1,53 @@
+/*
+ * deflate_raw.c — raw DEFLATE vtable (windowBits -15, no wrapper).
+ *
+ * Not a public algorithm: this is ZIP method 8, bound by src/zip.c. It
+ * lives beside zlib.c rather than in zip.c so the plugin build can ship it
+ * as a module of its own (cu_plugin_deflate) while the plugin core stays
+ * free of zlib. Everything but the windowBits comes from deflate_backend.h.
+ */
+
+#include "deflate_backend.h"
+
+#define CU_DFL_RAW_WBITS (-15)
+
+static size_t raw_compress_bound(size_t in_len) {
+    return dfl_compress_bound(in_len, CU_DFL_RAW_WBITS);
+}
+static cu_status_t raw_compress(const uint8_t* in, size_t in_len,
+                                uint8_t* out, size_t* out_len, int level) {
+    return dfl_compress(in, in_len, out, out_len, level, CU_DFL_RAW_WBITS);
+}
+static cu_status_t raw_decompress(const uint8_t* in, size_t in_len,
+                                  uint8_t* out, size_t* out_len) {
+    return dfl_decompress(in, in_len, out, out_len, CU_DFL_RAW_WBITS);
+}
+static cu_status_t raw_frame_info(const uint8_t* in, size_t in_len,
+                                  cu_frame_info_t* info) {
+    return dfl_frame_info(in, in_len, info, CU_DFL_RAW_WBITS);
+}
+static cu_status_t raw_cstream_create(int level, void** out_state) {
+    return dfl_cstream_create(level, CU_DFL_RAW_WBITS, out_state);
+}
+static cu_status_t raw_dstream_create(void** out_state) {
+    return dfl_dstream_create(CU_DFL_RAW_WBITS, out_state);
+}
+
+const cu_algorithm_vtbl_t cu_deflate_raw_vtbl = {
+    .name                      = "deflate",
+    .compress_bound            = raw_compress_bound,
+    .compress                  = raw_compress,
+    .decompress                = raw_decompress,
+    .decompress_size_hint      = dfl_decompress_size_hint,
+    .frame_info                = raw_frame_info,
+    .compress_stream_create    = raw_cstream_create,
+    .compress_stream_write     = dfl_cstream_write,
+    .compress_stream_finish    = dfl_cstream_finish,
+    .compress_stream_destroy   = dfl_stream_destroy,
+    .compress_stream_flush     = dfl_cstream_flush,
+    .decompress_stream_create  = raw_dstream_create,
+    .decompress_stream_write   = dfl_dstream_write,
+    .decompress_stream_finish  = dfl_dstream_finish,
+    .decompress_stream_destroy = dfl_stream_destroy,
+    .decompress_stream_set_skip_checksum = dfl_dstream_set_skip_checksum,
+};
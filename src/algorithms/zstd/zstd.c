@@ -10,24 +10,37 @@
  *     frames can be one-shot decompressed (we set pledgedSrcSize from
  *     in_len).
  *
- *   - decompress consults ZSTD_getFrameContentSize. If the frame has a
- *     known content size, fails fast if out is too small. If the size is
- *     unknown (e.g. frame from a different producer without
- *     pledgedSrcSize), falls back to ZSTD_decompressStream into the
- *     caller's buffer; returns CU_ERR_SIZE_UNKNOWN if that exhausts the
- *     buffer.
+ *   - decompress sums the content sizes of every frame in the input
+ *     (concatenated frames, as written by cu_compress_parallel or
+ *     `zstd -T`, are one logical stream). If all sizes are known, fails
+ *     fast if out is too small. If any size is unknown (e.g. frame from a
+ *     different producer without pledgedSrcSize), falls back to
+ *     ZSTD_decompressStream into the caller's buffer; returns
+ *     CU_ERR_SIZE_UNKNOWN if that exhausts the buffer.
  *
  * Streaming:
+ *   - The decoder continues into the next frame after a frame ends;
+ *     finish() only requires that input stop on a frame boundary.
  *   - Write/finish honor the public ABI's "fill buffer, return
  *     BUF_TOO_SMALL with unconsumed state preserved" protocol. State
  *     buffers the unconsumed tail of `in` between calls so the caller
  *     can drain with (in=NULL, in_len=0).
+ *   - flush is ZSTD_e_flush; the low-latency mode sets
+ *     ZSTD_c_targetCBlockSize so blocks stay small enough to decode as
+ *     they arrive.
+ *   - A pledged size goes to ZSTD_CCtx_setPledgedSrcSize: tables are
+ *     sized for it and the frame header records it.
+ *
+ * Frame info parses the frame header by hand (RFC 8878 3.1.1.1) rather
+ * than through the static-linking-only ZSTD_getFrameHeader.
  */
 
 #include "algorithm_registry.h"
+#include "alloc.h"
 #include "compress_utils.h"
 #include "utils/levels.h"
 
+#define ZSTD_STATIC_LINKING_ONLY  /* ZSTD_customMem, ZSTD_create*_advanced */
 #include <zstd.h>
 
 #include <stddef.h>
@@ -35,8 +48,12 @@
 #include <stdlib.h>
 #include <string.h>
 
-/* ZSTD: user 1..10 → ZSTD native 1..22. */
+/* ZSTD: user 1..10 → ZSTD native 1..22; speed tiers 0, -1..-5 → 1, then
+ * the negative ("--fast") levels -1, -2, -4, -8, -16. Native 0 would mean
+ * "default" (3), so tier 0 is pinned to 1. */
 static int zstd_native_level(int user_level) {
+    if (user_level < 0) return -cu_speed_tier_step(user_level);
+    if (user_level == 0) return 1;
     return cu_scale_level(user_level, 22);
 }
 
@@ -46,6 +63,10 @@ static cu_status_t map_zstd_error(size_t code, cu_status_t fallback) {
     return fallback;
 }
 
+/* Contexts allocate through alloc.h so the large levels' tables and
+ * windows can get huge pages (cu_set_huge_pages). */
+static const ZSTD_customMem zstd_mem = { cu_codec_alloc, cu_codec_free, NULL };
+
 /* ============================================================================
  * One-shot
  * ============================================================================ */
@@ -69,7 +90,7 @@ static cu_status_t zstd_compress(
     /* Use a one-shot CCtx so we can set pledgedSrcSize; this writes the
      * decompressed size into the frame header, which makes the inverse
      * (one-shot decompress, size hint probe) straightforward. */
-    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    ZSTD_CCtx* cctx = ZSTD_createCCtx_advanced(zstd_mem);
     if (!cctx) {
         cu_set_last_error("zstd: ZSTD_createCCtx failed");
         return CU_ERR_OOM;
@@ -98,6 +119,31 @@ static cu_status_t zstd_compress(
     return CU_OK;
 }
 
+/*
+ * Sum the declared content sizes of every frame in `in`. Skippable frames
+ * count as zero. Yields ZSTD_CONTENTSIZE_UNKNOWN if any frame omits its
+ * size, ZSTD_CONTENTSIZE_ERROR on a malformed or truncated frame.
+ */
+static unsigned long long zstd_total_content_size(const uint8_t* in, size_t in_len) {
+    unsigned long long total = 0;
+    int unknown = 0;
+    while (in_len > 0) {
+        unsigned long long n = ZSTD_getFrameContentSize(in, in_len);
+        if (n == ZSTD_CONTENTSIZE_ERROR) return ZSTD_CONTENTSIZE_ERROR;
+        size_t frame_len = ZSTD_findFrameCompressedSize(in, in_len);
+        if (ZSTD_isError(frame_len)) {
+            /* Lone first frame that is merely cut short: let the decoder
+             * report truncation rather than calling it garbage. */
+            return total == 0 && !unknown ? n : ZSTD_CONTENTSIZE_ERROR;
+        }
+        if (n == ZSTD_CONTENTSIZE_UNKNOWN) unknown = 1;
+        else total += n;
+        in += frame_len;
+        in_len -= frame_len;
+    }
+    return unknown ? ZSTD_CONTENTSIZE_UNKNOWN : total;
+}
+
 static cu_status_t zstd_decompress(
     const uint8_t* in, size_t in_len,
     uint8_t* out, size_t* out_len
@@ -107,12 +153,15 @@ static cu_status_t zstd_decompress(
         return CU_ERR_TRUNCATED;
     }
 
-    unsigned long long content_size = ZSTD_getFrameContentSize(in, in_len);
-
-    if (content_size == ZSTD_CONTENTSIZE_ERROR) {
+    if (ZSTD_getFrameContentSize(in, in_len) == ZSTD_CONTENTSIZE_ERROR) {
         cu_set_last_error("zstd: not a valid zstd frame");
         return CU_ERR_DECOMPRESSION;
     }
+    unsigned long long content_size = zstd_total_content_size(in, in_len);
+    if (content_size == ZSTD_CONTENTSIZE_ERROR) {
+        cu_set_last_error("zstd: invalid data after end of frame");
+        return CU_ERR_DECOMPRESSION;
+    }
 
     size_t cap = *out_len;
     size_t cap_limit = cu_get_max_decompressed_size();
@@ -138,7 +187,7 @@ static cu_status_t zstd_decompress(
     /* Unknown size: stream into the caller's buffer. If it fits, great;
      * if not, surface CU_ERR_SIZE_UNKNOWN so the caller knows to switch
      * to the streaming API (we cannot tell them how much to allocate). */
-    ZSTD_DStream* ds = ZSTD_createDStream();
+    ZSTD_DStream* ds = ZSTD_createDStream_advanced(zstd_mem);
     if (!ds) {
         cu_set_last_error("zstd: ZSTD_createDStream failed");
         return CU_ERR_OOM;
@@ -160,7 +209,8 @@ static cu_status_t zstd_decompress(
             ZSTD_freeDStream(ds);
             return s;
         }
-        if (ret == 0) { frame_done = 1; break; }
+        /* ret == 0 ends a frame; the DStream starts the next one on its own. */
+        frame_done = (ret == 0);
         if (out_buf.pos == out_buf.size && in_buf.pos < in_buf.size) {
             /* Buffer exhausted, input remains. We cannot grow. */
             ZSTD_freeDStream(ds);
@@ -191,7 +241,11 @@ static cu_status_t zstd_decompress_size_hint(
     }
     /* ZSTD_getFrameContentSize gracefully handles short/invalid input;
      * we don't need the static-only ZSTD_FRAMEHEADERSIZE_MIN macro. */
-    unsigned long long n = ZSTD_getFrameContentSize(in, in_len);
+    if (ZSTD_getFrameContentSize(in, in_len) == ZSTD_CONTENTSIZE_ERROR) {
+        cu_set_last_error("zstd: not a valid zstd frame");
+        return CU_ERR_DECOMPRESSION;
+    }
+    unsigned long long n = zstd_total_content_size(in, in_len);
     if (n == ZSTD_CONTENTSIZE_ERROR) {
         cu_set_last_error("zstd: not a valid zstd frame");
         return CU_ERR_DECOMPRESSION;
@@ -207,6 +261,66 @@ static cu_status_t zstd_decompress_size_hint(
     return CU_OK;
 }
 
+static uint64_t zstd_read_le(const uint8_t* p, size_t n) {
+    uint64_t v = 0;
+    while (n-- > 0) v = (v << 8) | p[n];
+    return v;
+}
+
+static cu_status_t zstd_frame_info(
+    const uint8_t* in, size_t in_len, cu_frame_info_t* info
+) {
+    size_t pos = 0;
+    uint32_t magic;
+    for (;;) {
+        if (in_len - pos < 4) goto truncated;
+        magic = (uint32_t)zstd_read_le(in + pos, 4);
+        if ((magic & ZSTD_MAGIC_SKIPPABLE_MASK) != ZSTD_MAGIC_SKIPPABLE_START) break;
+        if (in_len - pos < 8) goto truncated;
+        uint64_t skip = zstd_read_le(in + pos + 4, 4);
+        if (in_len - pos - 8 < skip) goto truncated;
+        pos += 8 + (size_t)skip;
+    }
+    if (magic != ZSTD_MAGICNUMBER) {
+        cu_set_last_error("zstd: not a valid zstd frame");
+        return CU_ERR_DECOMPRESSION;
+    }
+    if (in_len - pos < 5) goto truncated;
+
+    uint8_t fhd = in[pos + 4];
+    if (fhd & 0x08) {
+        cu_set_last_error("zstd: reserved frame header bit set");
+        return CU_ERR_DECOMPRESSION;
+    }
+    unsigned fcs_flag = fhd >> 6;
+    int single_segment = (fhd >> 5) & 1;
+    static const size_t did_sizes[4] = {0, 1, 2, 4};
+    size_t did_size = did_sizes[fhd & 3];
+    size_t fcs_size = fcs_flag ? (size_t)1 << fcs_flag : (size_t)single_segment;
+    if (in_len - pos - 5 < (size_t)!single_segment + did_size + fcs_size) goto truncated;
+
+    const uint8_t* p = in + pos + 5;
+    if (!single_segment) {
+        uint64_t base = 1ull << (10 + (*p >> 3));
+        info->window_size = base + (base / 8) * (*p & 7);
+        p++;
+    }
+    info->dict_id = (uint32_t)zstd_read_le(p, did_size);
+    p += did_size;
+    if (fcs_size) {
+        info->content_size = zstd_read_le(p, fcs_size) + (fcs_size == 2 ? 256 : 0);
+        if (single_segment) info->window_size = info->content_size;
+    }
+    info->block_size = info->window_size < ZSTD_BLOCKSIZE_MAX
+                     ? info->window_size : ZSTD_BLOCKSIZE_MAX;
+    info->has_checksum = (fhd >> 2) & 1;
+    return CU_OK;
+
+truncated:
+    cu_set_last_error("zstd: input ends inside the frame header");
+    return CU_ERR_TRUNCATED;
+}
+
 /* ============================================================================
  * Streaming
  *
@@ -235,7 +349,7 @@ static cu_status_t zstd_cstream_create(int level, void** out_state) {
         cu_set_last_error("zstd: out of memory");
         return CU_ERR_OOM;
     }
-    st->cs = ZSTD_createCStream();
+    st->cs = ZSTD_createCStream_advanced(zstd_mem);
     if (!st->cs) {
         free(st);
         cu_set_last_error("zstd: ZSTD_createCStream failed");
@@ -326,49 +440,97 @@ static cu_status_t zstd_cstream_write(
     return CU_OK;
 }
 
-static cu_status_t zstd_cstream_finish(
-    void* state, uint8_t* out, size_t* out_len
-) {
-    zstd_cstream_state_t* st = (zstd_cstream_state_t*)state;
-    st->finishing = 1;
-    size_t cap = *out_len;
-    ZSTD_outBuffer ob = { out, cap, 0 };
-
-    /* Drain any pending tail first. */
-    if (st->pending_len > 0) {
-        ZSTD_inBuffer ib = { st->pending, st->pending_len, 0 };
-        while (ib.pos < ib.size) {
-            size_t r = ZSTD_compressStream2(st->cs, &ob, &ib, ZSTD_e_continue);
-            if (ZSTD_isError(r)) return map_zstd_error(r, CU_ERR_COMPRESSION);
-            if (ob.pos == ob.size && ib.pos < ib.size) {
-                size_t consumed = ib.pos;
-                memmove(st->pending, st->pending + consumed, ib.size - consumed);
-                st->pending_len = ib.size - consumed;
-                *out_len = ob.pos;
-                return CU_ERR_BUF_TOO_SMALL;
-            }
+/*
+ * Feed the pending tail (finish/flush path). Returns CU_ERR_BUF_TOO_SMALL
+ * with the remainder kept if the output filled first.
+ */
+static cu_status_t cstream_drain_pending(zstd_cstream_state_t* st, ZSTD_outBuffer* ob) {
+    if (st->pending_len == 0) return CU_OK;
+    ZSTD_inBuffer ib = { st->pending, st->pending_len, 0 };
+    while (ib.pos < ib.size) {
+        size_t r = ZSTD_compressStream2(st->cs, ob, &ib, ZSTD_e_continue);
+        if (ZSTD_isError(r)) return map_zstd_error(r, CU_ERR_COMPRESSION);
+        if (ob->pos == ob->size && ib.pos < ib.size) {
+            size_t consumed = ib.pos;
+            memmove(st->pending, st->pending + consumed, ib.size - consumed);
+            st->pending_len = ib.size - consumed;
+            return CU_ERR_BUF_TOO_SMALL;
         }
-        st->pending_len = 0;
     }
+    st->pending_len = 0;
+    return CU_OK;
+}
 
-    /* End the frame, looping until ZSTD reports nothing remaining. */
+/*
+ * Run `op` (ZSTD_e_flush / ZSTD_e_end) with no new input until ZSTD
+ * reports nothing remaining.
+ */
+static cu_status_t cstream_drain_op(zstd_cstream_state_t* st, ZSTD_outBuffer* ob,
+                                    ZSTD_EndDirective op) {
     ZSTD_inBuffer ib = { NULL, 0, 0 };
     for (;;) {
-        size_t r = ZSTD_compressStream2(st->cs, &ob, &ib, ZSTD_e_end);
+        size_t r = ZSTD_compressStream2(st->cs, ob, &ib, op);
         if (ZSTD_isError(r)) return map_zstd_error(r, CU_ERR_COMPRESSION);
-        if (r == 0) {
-            *out_len = ob.pos;
-            return CU_OK;
-        }
-        if (ob.pos == ob.size) {
-            /* More to write, no room. */
-            *out_len = ob.pos;
-            return CU_ERR_BUF_TOO_SMALL;
-        }
+        if (r == 0) return CU_OK;
+        if (ob->pos == ob->size) return CU_ERR_BUF_TOO_SMALL;  /* more to write, no room */
         /* r > 0 with room remaining: loop and write more. */
     }
 }
 
+static cu_status_t zstd_cstream_flush(
+    void* state, uint8_t* out, size_t* out_len
+) {
+    zstd_cstream_state_t* st = (zstd_cstream_state_t*)state;
+    if (st->finishing) {
+        cu_set_last_error("zstd: flush after finish started");
+        return CU_ERR_STREAM_STATE;
+    }
+    ZSTD_outBuffer ob = { out, *out_len, 0 };
+    cu_status_t s = cstream_drain_pending(st, &ob);
+    if (s == CU_OK) s = cstream_drain_op(st, &ob, ZSTD_e_flush);
+    *out_len = ob.pos;
+    return s;
+}
+
+static cu_status_t zstd_cstream_set_target_block_size(void* state, size_t bytes) {
+    zstd_cstream_state_t* st = (zstd_cstream_state_t*)state;
+    int v = 0;
+    if (bytes > 0) {
+        ZSTD_bounds b = ZSTD_cParam_getBounds(ZSTD_c_targetCBlockSize);
+        if (ZSTD_isError(b.error)) return map_zstd_error(b.error, CU_ERR_INTERNAL);
+        v = bytes < (size_t)b.lowerBound ? b.lowerBound
+          : bytes > (size_t)b.upperBound ? b.upperBound : (int)bytes;
+    }
+    size_t r = ZSTD_CCtx_setParameter(st->cs, ZSTD_c_targetCBlockSize, v);
+    return map_zstd_error(r, CU_ERR_COMPRESSION);
+}
+
+static cu_status_t zstd_cstream_set_pledged_size(void* state, uint64_t size) {
+    zstd_cstream_state_t* st = (zstd_cstream_state_t*)state;
+    size_t r = ZSTD_CCtx_setPledgedSrcSize(st->cs, size);
+    return map_zstd_error(r, CU_ERR_COMPRESSION);
+}
+
+static cu_status_t zstd_cstream_set_checksum(void* state, int enabled) {
+    zstd_cstream_state_t* st = (zstd_cstream_state_t*)state;
+    size_t r = ZSTD_CCtx_setParameter(st->cs, ZSTD_c_checksumFlag, enabled);
+    return map_zstd_error(r, CU_ERR_COMPRESSION);
+}
+
+static cu_status_t zstd_cstream_finish(
+    void* state, uint8_t* out, size_t* out_len
+) {
+    zstd_cstream_state_t* st = (zstd_cstream_state_t*)state;
+    st->finishing = 1;
+    ZSTD_outBuffer ob = { out, *out_len, 0 };
+
+    /* Drain any pending tail first, then end the frame. */
+    cu_status_t s = cstream_drain_pending(st, &ob);
+    if (s == CU_OK) s = cstream_drain_op(st, &ob, ZSTD_e_end);
+    *out_len = ob.pos;
+    return s;
+}
+
 static void zstd_cstream_destroy(void* state) {
     zstd_cstream_state_t* st = (zstd_cstream_state_t*)state;
     if (!st) return;
@@ -393,7 +555,7 @@ static cu_status_t zstd_dstream_create(void** out_state) {
         cu_set_last_error("zstd: out of memory");
         return CU_ERR_OOM;
     }
-    st->ds = ZSTD_createDStream();
+    st->ds = ZSTD_createDStream_advanced(zstd_mem);
     if (!st->ds) {
         free(st);
         cu_set_last_error("zstd: ZSTD_createDStream failed");
@@ -434,10 +596,6 @@ static cu_status_t zstd_dstream_write(
     uint8_t* out, size_t* out_len
 ) {
     zstd_dstream_state_t* st = (zstd_dstream_state_t*)state;
-    if (st->frame_done) {
-        cu_set_last_error("zstd: write after frame end");
-        return CU_ERR_STREAM_FINISHED;
-    }
     size_t cap = *out_len;
     ZSTD_outBuffer ob = { out, cap, 0 };
 
@@ -447,7 +605,7 @@ static cu_status_t zstd_dstream_write(
         while (ib.pos < ib.size) {
             size_t r = ZSTD_decompressStream(st->ds, &ob, &ib);
             if (ZSTD_isError(r)) return map_zstd_error(r, CU_ERR_DECOMPRESSION);
-            if (r == 0) { st->frame_done = 1; break; }
+            st->frame_done = (r == 0);
             if (ob.pos == ob.size && ib.pos < ib.size) {
                 size_t consumed = ib.pos;
                 memmove(st->pending, st->pending + consumed, ib.size - consumed);
@@ -461,20 +619,13 @@ static cu_status_t zstd_dstream_write(
         st->pending_len = 0;
     }
 
-    if (st->frame_done) {
-        if (in_len > 0) {
-            cu_set_last_error("zstd: trailing data after end of frame");
-            return CU_ERR_DECOMPRESSION;
-        }
-        *out_len = ob.pos;
-        return CU_OK;
-    }
-
+    /* A following frame (or garbage, which the decoder rejects) may start
+     * right after a frame ends — keep feeding. */
     ZSTD_inBuffer ib = { in, in_len, 0 };
     while (ib.pos < ib.size) {
         size_t r = ZSTD_decompressStream(st->ds, &ob, &ib);
         if (ZSTD_isError(r)) return map_zstd_error(r, CU_ERR_DECOMPRESSION);
-        if (r == 0) { st->frame_done = 1; break; }
+        st->frame_done = (r == 0);
         if (ob.pos == ob.size && ib.pos < ib.size) {
             cu_status_t s = dstream_pending_append(st, in + ib.pos, in_len - ib.pos);
             if (s != CU_OK) return s;
@@ -505,6 +656,12 @@ static cu_status_t zstd_dstream_finish(
     return CU_OK;
 }
 
+static cu_status_t zstd_dstream_set_skip_checksum(void* state, int skip) {
+    zstd_dstream_state_t* st = (zstd_dstream_state_t*)state;
+    size_t r = ZSTD_DCtx_setParameter(st->ds, ZSTD_d_forceIgnoreChecksum, skip);
+    return map_zstd_error(r, CU_ERR_DECOMPRESSION);
+}
+
 static void zstd_dstream_destroy(void* state) {
     zstd_dstream_state_t* st = (zstd_dstream_state_t*)state;
     if (!st) return;
@@ -534,13 +691,21 @@ const cu_algorithm_vtbl_t cu_zstd_vtbl = {
     .compress_stream_write    = zstd_cstream_write,
     .compress_stream_finish   = zstd_cstream_finish,
     .compress_stream_destroy  = zstd_cstream_destroy,
+    .compress_stream_flush    = zstd_cstream_flush,
+    .compress_stream_set_target_block_size = zstd_cstream_set_target_block_size,
+    .compress_stream_set_pledged_size = zstd_cstream_set_pledged_size,
+    .compress_stream_set_checksum = zstd_cstream_set_checksum,
 #endif
 #ifndef CU_OMIT_DECOMPRESS
     .decompress               = zstd_decompress,
     .decompress_size_hint     = zstd_decompress_size_hint,
+    .frame_info               = zstd_frame_info,
     .decompress_stream_create = zstd_dstream_create,
     .decompress_stream_write  = zstd_dstream_write,
     .decompress_stream_finish = zstd_dstream_finish,
     .decompress_stream_destroy = zstd_dstream_destroy,
+    .decompress_stream_set_skip_checksum = zstd_dstream_set_skip_checksum,
 #endif
 };
+
+CU_DEFINE_DIRECT_API(zstd)
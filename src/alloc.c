@@ -0,0 +1,199 @@
+/*
+ * alloc.c — codec allocator hooks and the huge-page backing behind
+ * cu_set_huge_pages (see alloc.h).
+ *
+ * Every block carries a small header recording how it was obtained, so a
+ * block is freed correctly whatever the setting is by then. Blocks at or
+ * above the threshold are rounded up to whole 2 MiB pages and mapped
+ * directly: MAP_HUGETLB first (only succeeds when the administrator has
+ * reserved pages in /proc/sys/vm/nr_hugepages), otherwise an anonymous
+ * mapping trimmed to 2 MiB alignment and marked MADV_HUGEPAGE, which
+ * transparent huge pages honor in both the "always" and "madvise" modes.
+ *
+ * Freed mappings go to a small best-fit cache instead of munmap, so the
+ * next context of the same shape (the common case: one level, many calls)
+ * gets pages that are already faulted in. The cache is bounded in slots
+ * and bytes and emptied by cu_set_huge_pages(0).
+ *
+ * Linux only. Elsewhere (and in the WASM build) cu_set_huge_pages is a
+ * no-op and the hooks are plain malloc/free.
+ */
+
+#include "alloc.h"
+#include "compress_utils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#  define CU_ALLOC_HUGE 1
+#  include <pthread.h>
+#  include <sys/mman.h>
+#else
+#  define CU_ALLOC_HUGE 0
+#endif
+
+#if CU_ALLOC_HUGE
+
+/* Block header; map_len is 0 for malloc'd blocks. Padded so the pointer
+ * handed out keeps malloc's alignment. */
+typedef union {
+    size_t      map_len;
+    max_align_t align;
+} cu_block_hdr_t;
+
+#define CU_HUGE_PAGE        ((size_t)2 << 20)
+#define CU_HUGE_CACHE_SLOTS 16
+#define CU_HUGE_CACHE_MAX   ((size_t)1 << 30)
+
+static void* block_malloc(size_t size) {
+    if (size > SIZE_MAX - sizeof(cu_block_hdr_t)) return NULL;
+    cu_block_hdr_t* h = malloc(sizeof(*h) + size);
+    if (!h) return NULL;
+    h->map_len = 0;
+    return h + 1;
+}
+
+/* Word-sized like the decompression cap in compress_utils.c: a torn read
+ * only means one allocation sees the previous setting. */
+static size_t g_threshold;
+static int    g_threshold_set;
+
+static pthread_once_t  g_env_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct {
+    void*  base;
+    size_t len;
+} g_cache[CU_HUGE_CACHE_SLOTS];
+static unsigned g_cache_n;
+static size_t   g_cache_bytes;
+
+/* CU_HUGE_PAGES=1 → default threshold, CU_HUGE_PAGES=<bytes> → that
+ * threshold, 0 or unset → off. An explicit cu_set_huge_pages wins. */
+static void env_init(void) {
+    const char* env = getenv("CU_HUGE_PAGES");
+    if (!env || g_threshold_set) return;
+    unsigned long long v = strtoull(env, NULL, 10);
+    g_threshold = v == 1 ? CU_HUGE_PAGES_DEFAULT_THRESHOLD : (size_t)v;
+}
+
+static void* map_huge(size_t len) {
+#ifdef MAP_HUGETLB
+    void* p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) return p;
+#endif
+    /* Over-map by one huge page and trim both ends to get alignment. */
+    size_t span = len + CU_HUGE_PAGE;
+    uint8_t* raw = mmap(NULL, span, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    uint8_t* base = (uint8_t*)(((uintptr_t)raw + CU_HUGE_PAGE - 1) & ~(uintptr_t)(CU_HUGE_PAGE - 1));
+    if (base > raw) munmap(raw, (size_t)(base - raw));
+    if (raw + span > base + len) munmap(base + len, (size_t)(raw + span - (base + len)));
+#ifdef MADV_HUGEPAGE
+    madvise(base, len, MADV_HUGEPAGE);
+#endif
+    return base;
+}
+
+/* Smallest cached mapping that fits without wasting more than half of
+ * it, or NULL. Caller holds g_lock. */
+static void* cache_take(size_t len, size_t* got) {
+    unsigned best = g_cache_n;
+    for (unsigned i = 0; i < g_cache_n; i++) {
+        if (g_cache[i].len >= len && g_cache[i].len / 2 <= len && (best == g_cache_n || g_cache[i].len < g_cache[best].len)) best = i;
+    }
+    if (best == g_cache_n) return NULL;
+    void* base = g_cache[best].base;
+    *got = g_cache[best].len;
+    g_cache_bytes -= *got;
+    g_cache[best] = g_cache[--g_cache_n];
+    return base;
+}
+
+/* Keep a freed mapping if there is room. Caller holds g_lock. */
+static int cache_put(void* base, size_t len) {
+    if (g_threshold == 0 || g_cache_n == CU_HUGE_CACHE_SLOTS ||
+        len > CU_HUGE_CACHE_MAX - g_cache_bytes) {
+        return 0;
+    }
+    g_cache[g_cache_n].base = base;
+    g_cache[g_cache_n].len = len;
+    g_cache_n++;
+    g_cache_bytes += len;
+    return 1;
+}
+
+void cu_set_huge_pages(size_t threshold) {
+    pthread_once(&g_env_once, env_init);
+    pthread_mutex_lock(&g_lock);
+    g_threshold = threshold;
+    g_threshold_set = 1;
+    if (threshold == 0) {
+        while (g_cache_n > 0) {
+            g_cache_n--;
+            munmap(g_cache[g_cache_n].base, g_cache[g_cache_n].len);
+        }
+        g_cache_bytes = 0;
+    }
+    pthread_mutex_unlock(&g_lock);
+}
+
+void* cu_codec_alloc(void* opaque, size_t size) {
+    (void)opaque;
+    pthread_once(&g_env_once, env_init);
+    size_t threshold = g_threshold;
+    if (threshold == 0 || size < threshold ||
+        size > SIZE_MAX - sizeof(cu_block_hdr_t) - CU_HUGE_PAGE) {
+        return block_malloc(size);
+    }
+    size_t len = (size + sizeof(cu_block_hdr_t) + CU_HUGE_PAGE - 1) & ~(CU_HUGE_PAGE - 1);
+
+    size_t got = 0;
+    pthread_mutex_lock(&g_lock);
+    void* base = cache_take(len, &got);
+    pthread_mutex_unlock(&g_lock);
+    if (!base) {
+        base = map_huge(len);
+        got = len;
+        if (!base) return block_malloc(size);
+    }
+    cu_block_hdr_t* h = base;
+    h->map_len = got;
+    return h + 1;
+}
+
+void cu_codec_free(void* opaque, void* ptr) {
+    (void)opaque;
+    if (!ptr) return;
+    cu_block_hdr_t* h = (cu_block_hdr_t*)ptr - 1;
+    size_t len = h->map_len;
+    if (len == 0) {
+        free(h);
+        return;
+    }
+    pthread_mutex_lock(&g_lock);
+    int kept = cache_put(h, len);
+    pthread_mutex_unlock(&g_lock);
+    if (!kept) munmap(h, len);
+}
+
+#else  /* no huge pages: plain malloc/free */
+
+void cu_set_huge_pages(size_t threshold) {
+    (void)threshold;
+}
+
+void* cu_codec_alloc(void* opaque, size_t size) {
+    (void)opaque;
+    return malloc(size);
+}
+
+void cu_codec_free(void* opaque, void* ptr) {
+    (void)opaque;
+    free(ptr);
+}
+
+#endif
@@ -0,0 +1,32 @@
+/*
+ * alloc.h — allocator hooks the codec vtables hand to their libraries.
+ *
+ * zstd (ZSTD_customMem), xz (lzma_allocator) and brotli (instance
+ * alloc/free funcs) route their context allocations through here so that
+ * the large ones — match-finder tables, history windows, dictionaries —
+ * can be backed by huge pages (see cu_set_huge_pages). Below the
+ * threshold, and whenever huge pages are off, this is malloc/free.
+ *
+ * The signatures match zstd's and brotli's allocator callbacks; `opaque`
+ * is unused. Memory is not zeroed.
+ *
+ * This header is internal — consumers must not include it.
+ */
+
+#ifndef CU_ALLOC_H
+#define CU_ALLOC_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void* cu_codec_alloc(void* opaque, size_t size);
+void  cu_codec_free(void* opaque, void* ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* CU_ALLOC_H */
@@ -88,6 +88,13 @@ void cu_set_last_errorf(const char* fmt, ...) {
     if (n < 0) g_last_error[0] = '\0';
 }
 
+cu_status_t cu_check_level(int level) {
+    if (level >= CU_LEVEL_MIN && level <= CU_LEVEL_MAX) return CU_OK;
+    cu_set_last_errorf("compression level must be between %d and %d",
+                       CU_LEVEL_MIN, CU_LEVEL_MAX);
+    return CU_ERR_INVALID_LEVEL;
+}
+
 const char* cu_last_error(void) {
     return g_last_error;
 }
@@ -100,7 +107,7 @@ const char* cu_strerror(cu_status_t code) {
     switch (code) {
         case CU_OK:                   return "ok";
         case CU_ERR_INVALID_ARG:      return "invalid argument";
-        case CU_ERR_INVALID_LEVEL:    return "compression level out of range (1..10)";
+        case CU_ERR_INVALID_LEVEL:    return "compression level out of range";
         case CU_ERR_BUF_TOO_SMALL:    return "output buffer too small";
         case CU_ERR_SIZE_UNKNOWN:     return "decompressed size not encoded in wire format; use streaming";
         case CU_ERR_UNSUPPORTED_ALGO: return "algorithm not compiled into this build";
@@ -112,6 +119,7 @@ const char* cu_strerror(cu_status_t code) {
         case CU_ERR_STREAM_STATE:     return "operation invalid for current stream state";
         case CU_ERR_OOM:              return "out of memory";
         case CU_ERR_INTERNAL:         return "internal error";
+        case CU_ERR_IO:               return "file I/O error";
     }
     return "unknown error";
 }
@@ -164,10 +172,7 @@ cu_status_t cu_compress(
     if (!out_len)                       return CU_ERR_INVALID_ARG;
     if (in_len > 0 && !in)              return CU_ERR_INVALID_ARG;
     if (*out_len > 0 && !out)           return CU_ERR_INVALID_ARG;
-    if (level < 1 || level > 10) {
-        cu_set_last_error("compression level must be between 1 and 10");
-        return CU_ERR_INVALID_LEVEL;
-    }
+    if (cu_check_level(level) != CU_OK) return CU_ERR_INVALID_LEVEL;
 
     const cu_algorithm_vtbl_t* v;
     cu_status_t s = resolve(algo, &v);
@@ -210,6 +215,230 @@ cu_status_t cu_decompress_size_hint(
     return v->decompress_size_hint(in, in_len, out_size);
 }
 
+cu_status_t cu_frame_info(
+    cu_algorithm_t algo,
+    const uint8_t* in, size_t in_len,
+    cu_frame_info_t* info
+) {
+    if (!info)             return CU_ERR_INVALID_ARG;
+    if (in_len > 0 && !in) return CU_ERR_INVALID_ARG;
+
+    const cu_algorithm_vtbl_t* v;
+    cu_status_t s = resolve(algo, &v);
+    if (s != CU_OK) return s;
+    if (!v->frame_info) {
+        cu_set_last_errorf("%s: frame info is not supported", v->name);
+        return CU_ERR_UNSUPPORTED_ALGO;
+    }
+
+    memset(info, 0, sizeof(*info));
+    info->content_size = CU_FRAME_SIZE_UNKNOWN;
+    cu_clear_last_error();
+    return v->frame_info(in, in_len, info);
+}
+
+/* ============================================================================
+ * Scatter/gather one-shot
+ * ============================================================================
+ *
+ * Both directions run the codec's streaming vtable entries directly (no
+ * wrapper struct), pointing each call at the unfilled tail of the current
+ * output segment. When the segments run out while the codec still reports
+ * BUF_TOO_SMALL, one more call into a 1-byte spill tells a genuine
+ * overflow apart from an exact fit.
+ */
+
+typedef struct {
+    const cu_iovec_t* seg;
+    size_t cnt;
+    size_t idx;    /* current segment */
+    size_t off;    /* bytes already written into seg[idx] */
+    size_t total;  /* bytes written across all segments */
+    size_t limit;  /* cap on total; 0 = none */
+} iov_cursor_t;
+
+typedef cu_status_t (*iov_write_fn)(void* state, const uint8_t* in, size_t in_len,
+                                    uint8_t* out, size_t* out_len);
+typedef cu_status_t (*iov_finish_fn)(void* state, uint8_t* out, size_t* out_len);
+
+/* Runs `wr` on (in, in_len), or `fin` if wr is NULL, draining into the
+ * cursor. Returns CU_ERR_BUF_TOO_SMALL only when output is left over. */
+static cu_status_t iov_pump(
+    iov_cursor_t* c, void* state,
+    iov_write_fn wr, iov_finish_fn fin,
+    const uint8_t* in, size_t in_len
+) {
+    for (;;) {
+        while (c->idx < c->cnt && c->off == c->seg[c->idx].len) {
+            c->idx++;
+            c->off = 0;
+        }
+
+        uint8_t spill;
+        uint8_t* dst = &spill;
+        size_t room = 1;
+        int spare = c->idx == c->cnt || (c->limit && c->total == c->limit);
+        if (!spare) {
+            dst = c->seg[c->idx].base + c->off;
+            room = c->seg[c->idx].len - c->off;
+            if (c->limit && room > c->limit - c->total) room = c->limit - c->total;
+        }
+
+        size_t n = room;
+        cu_status_t s = wr ? wr(state, in, in_len, dst, &n) : fin(state, dst, &n);
+        in = NULL;
+        in_len = 0;
+
+        if (spare) {
+            if (n > 0 || s == CU_ERR_BUF_TOO_SMALL) return CU_ERR_BUF_TOO_SMALL;
+        } else {
+            c->off += n;
+            c->total += n;
+        }
+        if (s != CU_ERR_BUF_TOO_SMALL) return s;
+    }
+}
+
+/* Validates a segment array and sums its lengths. The two segment types
+ * differ only in constness, hence the pair. */
+static int iov_in_total(const cu_const_iovec_t* seg, size_t cnt, size_t* total) {
+    *total = 0;
+    if (cnt > 0 && !seg) return 0;
+    for (size_t i = 0; i < cnt; i++) {
+        if (seg[i].len > 0 && !seg[i].base)    return 0;
+        if (seg[i].len > SIZE_MAX - *total)    return 0;
+        *total += seg[i].len;
+    }
+    return 1;
+}
+
+static int iov_out_total(const cu_iovec_t* seg, size_t cnt, size_t* total) {
+    *total = 0;
+    if (cnt > 0 && !seg) return 0;
+    for (size_t i = 0; i < cnt; i++) {
+        if (seg[i].len > 0 && !seg[i].base)    return 0;
+        if (seg[i].len > SIZE_MAX - *total)    return 0;
+        *total += seg[i].len;
+    }
+    return 1;
+}
+
+cu_status_t cu_compressv(
+    cu_algorithm_t algo,
+    const cu_const_iovec_t* in, size_t in_cnt,
+    const cu_iovec_t* out, size_t out_cnt, size_t* out_len,
+    int level
+) {
+    if (!out_len) return CU_ERR_INVALID_ARG;
+    size_t in_total, cap;
+    if (!iov_in_total(in, in_cnt, &in_total))   return CU_ERR_INVALID_ARG;
+    if (!iov_out_total(out, out_cnt, &cap))     return CU_ERR_INVALID_ARG;
+    if (cu_check_level(level) != CU_OK) return CU_ERR_INVALID_LEVEL;
+
+    const cu_algorithm_vtbl_t* v;
+    cu_status_t s = resolve(algo, &v);
+    if (s != CU_OK) return s;
+
+    cu_clear_last_error();
+    /* Nothing to gather or scatter: plain one-shot. */
+    if (in_cnt <= 1 && out_cnt == 1) {
+        *out_len = cap;
+        return v->compress(in_cnt ? in[0].base : NULL, in_total,
+                           out[0].base, out_len, level);
+    }
+
+    size_t bound = v->compress_bound(in_total);
+    if (cap < bound) {
+        *out_len = bound;
+        return CU_ERR_BUF_TOO_SMALL;
+    }
+
+    void* state = NULL;
+    s = v->compress_stream_create(level, &state);
+    if (s != CU_OK) return s;
+    if (v->compress_stream_set_pledged_size) {
+        s = v->compress_stream_set_pledged_size(state, in_total);
+    }
+
+    iov_cursor_t c = { out, out_cnt, 0, 0, 0, 0 };
+    for (size_t i = 0; i < in_cnt && s == CU_OK; i++) {
+        if (in[i].len == 0) continue;
+        s = iov_pump(&c, state, v->compress_stream_write, NULL, in[i].base, in[i].len);
+    }
+    if (s == CU_OK) {
+        s = iov_pump(&c, state, NULL, v->compress_stream_finish, NULL, 0);
+    }
+    v->compress_stream_destroy(state);
+
+    if (s == CU_ERR_BUF_TOO_SMALL) {
+        /* cap >= bound, so the streaming encoder broke the bound. */
+        cu_set_last_errorf("%s: stream output exceeded compress bound %zu", v->name, bound);
+        return CU_ERR_COMPRESSION;
+    }
+    if (s == CU_OK) *out_len = c.total;
+    return s;
+}
+
+cu_status_t cu_decompressv(
+    cu_algorithm_t algo,
+    const cu_const_iovec_t* in, size_t in_cnt,
+    const cu_iovec_t* out, size_t out_cnt, size_t* out_len
+) {
+    if (!out_len) return CU_ERR_INVALID_ARG;
+    size_t in_total, cap;
+    if (!iov_in_total(in, in_cnt, &in_total))   return CU_ERR_INVALID_ARG;
+    if (!iov_out_total(out, out_cnt, &cap))     return CU_ERR_INVALID_ARG;
+
+    const cu_algorithm_vtbl_t* v;
+    cu_status_t s = resolve(algo, &v);
+    if (s != CU_OK) return s;
+
+    cu_clear_last_error();
+    if (in_cnt <= 1 && out_cnt == 1) {
+        *out_len = cap;
+        return v->decompress(in_cnt ? in[0].base : NULL, in_total, out[0].base, out_len);
+    }
+
+    void* state = NULL;
+    s = v->decompress_stream_create(&state);
+    if (s != CU_OK) return s;
+
+    size_t limit = cu_get_max_decompressed_size();
+    iov_cursor_t c = { out, out_cnt, 0, 0, 0, limit };
+    for (size_t i = 0; i < in_cnt && s == CU_OK; i++) {
+        if (in[i].len == 0) continue;
+        s = iov_pump(&c, state, v->decompress_stream_write, NULL, in[i].base, in[i].len);
+    }
+    if (s == CU_OK) {
+        s = iov_pump(&c, state, NULL, v->decompress_stream_finish, NULL, 0);
+    }
+    v->decompress_stream_destroy(state);
+
+    if (s == CU_ERR_BUF_TOO_SMALL) {
+        if (limit && c.total == limit) {
+            cu_set_last_errorf("%s: decompressed output exceeded cap %zu", v->name, limit);
+            return CU_ERR_SIZE_LIMIT;
+        }
+        /* The header sits in the first non-empty segment unless the caller
+         * split it; if it is not readable there, report the size unknown. */
+        size_t hint = 0;
+        for (size_t i = 0; i < in_cnt; i++) {
+            if (in[i].len == 0) continue;
+            if (v->decompress_size_hint(in[i].base, in[i].len, &hint) == CU_OK && hint > cap) {
+                cu_clear_last_error();
+                *out_len = hint;
+                return CU_ERR_BUF_TOO_SMALL;
+            }
+            break;
+        }
+        cu_set_last_errorf("%s: output segments exhausted and size unknown; use streaming",
+                           v->name);
+        return CU_ERR_SIZE_UNKNOWN;
+    }
+    if (s == CU_OK) *out_len = c.total;
+    return s;
+}
+
 /* ============================================================================
  * Streaming
  * ============================================================================
@@ -223,12 +452,18 @@ struct cu_compress_stream {
     const cu_algorithm_vtbl_t* vtbl;
     void* state;
     int finished;
+    int started;   /* any write/flush/finish call made */
+    int flushing;  /* flush returned BUF_TOO_SMALL; only flush may follow */
+    int pledged;   /* set_pledged_size called; `total` must reach pledged_size */
+    uint64_t pledged_size;
+    uint64_t total;  /* input bytes accepted by write */
 };
 
 struct cu_decompress_stream {
     const cu_algorithm_vtbl_t* vtbl;
     void* state;
     int finished;
+    int started;   /* any write/finish call made */
 };
 
 cu_status_t cu_compress_stream_create(
@@ -238,10 +473,7 @@ cu_status_t cu_compress_stream_create(
 ) {
     if (!out_stream)                return CU_ERR_INVALID_ARG;
     *out_stream = NULL;
-    if (level < 1 || level > 10) {
-        cu_set_last_error("compression level must be between 1 and 10");
-        return CU_ERR_INVALID_LEVEL;
-    }
+    if (cu_check_level(level) != CU_OK) return CU_ERR_INVALID_LEVEL;
 
     const cu_algorithm_vtbl_t* v;
     cu_status_t s = resolve(algo, &v);
@@ -277,7 +509,18 @@ cu_status_t cu_compress_stream_write(
         cu_set_last_error("write to finished compress stream");
         return CU_ERR_STREAM_FINISHED;
     }
+    if (stream->flushing) {
+        cu_set_last_error("flush in progress; drain it with cu_compress_stream_flush");
+        return CU_ERR_STREAM_STATE;
+    }
+    if (stream->pledged && in_len > stream->pledged_size - stream->total) {
+        cu_set_last_errorf("write of %zu bytes exceeds the pledged size %llu",
+                           in_len, (unsigned long long)stream->pledged_size);
+        return CU_ERR_STREAM_STATE;
+    }
 
+    stream->started = 1;
+    stream->total += in_len;
     cu_clear_last_error();
     return stream->vtbl->compress_stream_write(stream->state, in, in_len, out, out_len);
 }
@@ -288,7 +531,18 @@ cu_status_t cu_compress_stream_finish(
 ) {
     if (!stream || !out_len)            return CU_ERR_INVALID_ARG;
     if (*out_len > 0 && !out)           return CU_ERR_INVALID_ARG;
+    if (stream->flushing) {
+        cu_set_last_error("flush in progress; drain it with cu_compress_stream_flush");
+        return CU_ERR_STREAM_STATE;
+    }
+    if (stream->pledged && stream->total != stream->pledged_size) {
+        cu_set_last_errorf("finish after %llu of %llu pledged bytes",
+                           (unsigned long long)stream->total,
+                           (unsigned long long)stream->pledged_size);
+        return CU_ERR_STREAM_STATE;
+    }
 
+    stream->started = 1;
     cu_clear_last_error();
     cu_status_t s = stream->vtbl->compress_stream_finish(stream->state, out, out_len);
     if (s == CU_OK) {
@@ -297,6 +551,87 @@ cu_status_t cu_compress_stream_finish(
     return s;
 }
 
+cu_status_t cu_compress_stream_flush(
+    cu_compress_stream_t* stream,
+    uint8_t* out, size_t* out_len
+) {
+    if (!stream || !out_len)            return CU_ERR_INVALID_ARG;
+    if (*out_len > 0 && !out)           return CU_ERR_INVALID_ARG;
+    if (stream->finished) {
+        cu_set_last_error("flush of finished compress stream");
+        return CU_ERR_STREAM_FINISHED;
+    }
+    if (!stream->vtbl->compress_stream_flush) {
+        cu_set_last_errorf("%s: stream flush is not supported", stream->vtbl->name);
+        return CU_ERR_UNSUPPORTED_ALGO;
+    }
+
+    stream->started = 1;
+    cu_clear_last_error();
+    cu_status_t s = stream->vtbl->compress_stream_flush(stream->state, out, out_len);
+    stream->flushing = s == CU_ERR_BUF_TOO_SMALL;
+    return s;
+}
+
+cu_status_t cu_compress_stream_set_target_block_size(
+    cu_compress_stream_t* stream,
+    size_t bytes
+) {
+    if (!stream) return CU_ERR_INVALID_ARG;
+    if (!stream->vtbl->compress_stream_set_target_block_size) {
+        cu_set_last_errorf("%s: target block size is not supported", stream->vtbl->name);
+        return CU_ERR_UNSUPPORTED_ALGO;
+    }
+    if (stream->started) {
+        cu_set_last_error("target block size must be set before the first write");
+        return CU_ERR_STREAM_STATE;
+    }
+
+    cu_clear_last_error();
+    return stream->vtbl->compress_stream_set_target_block_size(stream->state, bytes);
+}
+
+cu_status_t cu_compress_stream_set_pledged_size(
+    cu_compress_stream_t* stream,
+    uint64_t size
+) {
+    if (!stream) return CU_ERR_INVALID_ARG;
+    if (!stream->vtbl->compress_stream_set_pledged_size) {
+        cu_set_last_errorf("%s: pledged size is not supported", stream->vtbl->name);
+        return CU_ERR_UNSUPPORTED_ALGO;
+    }
+    if (stream->started) {
+        cu_set_last_error("pledged size must be set before the first write");
+        return CU_ERR_STREAM_STATE;
+    }
+
+    cu_clear_last_error();
+    cu_status_t s = stream->vtbl->compress_stream_set_pledged_size(stream->state, size);
+    if (s == CU_OK) {
+        stream->pledged = 1;
+        stream->pledged_size = size;
+    }
+    return s;
+}
+
+cu_status_t cu_compress_stream_set_checksum(
+    cu_compress_stream_t* stream,
+    int enabled
+) {
+    if (!stream) return CU_ERR_INVALID_ARG;
+    if (!stream->vtbl->compress_stream_set_checksum) {
+        cu_set_last_errorf("%s: checksum selection is not supported", stream->vtbl->name);
+        return CU_ERR_UNSUPPORTED_ALGO;
+    }
+    if (stream->started) {
+        cu_set_last_error("checksum must be set before the first write");
+        return CU_ERR_STREAM_STATE;
+    }
+
+    cu_clear_last_error();
+    return stream->vtbl->compress_stream_set_checksum(stream->state, enabled != 0);
+}
+
 void cu_compress_stream_destroy(cu_compress_stream_t* stream) {
     if (!stream) return;
     if (stream->vtbl && stream->state) {
@@ -347,6 +682,7 @@ cu_status_t cu_decompress_stream_write(
         return CU_ERR_STREAM_FINISHED;
     }
 
+    stream->started = 1;
     cu_clear_last_error();
     return stream->vtbl->decompress_stream_write(stream->state, in, in_len, out, out_len);
 }
@@ -358,6 +694,7 @@ cu_status_t cu_decompress_stream_finish(
     if (!stream || !out_len)            return CU_ERR_INVALID_ARG;
     if (*out_len > 0 && !out)           return CU_ERR_INVALID_ARG;
 
+    stream->started = 1;
     cu_clear_last_error();
     cu_status_t s = stream->vtbl->decompress_stream_finish(stream->state, out, out_len);
     if (s == CU_OK) {
@@ -366,6 +703,25 @@ cu_status_t cu_decompress_stream_finish(
     return s;
 }
 
+cu_status_t cu_decompress_stream_set_skip_checksum(
+    cu_decompress_stream_t* stream,
+    int skip
+) {
+    if (!stream) return CU_ERR_INVALID_ARG;
+    if (!stream->vtbl->decompress_stream_set_skip_checksum) {
+        cu_set_last_errorf("%s: skipping checksum verification is not supported",
+                           stream->vtbl->name);
+        return CU_ERR_UNSUPPORTED_ALGO;
+    }
+    if (stream->started) {
+        cu_set_last_error("skip_checksum must be set before the first write");
+        return CU_ERR_STREAM_STATE;
+    }
+
+    cu_clear_last_error();
+    return stream->vtbl->decompress_stream_set_skip_checksum(stream->state, skip != 0);
+}
+
 void cu_decompress_stream_destroy(cu_decompress_stream_t* stream) {
     if (!stream) return;
     if (stream->vtbl && stream->state) {
@@ -0,0 +1,594 @@
+/*
+ * file.c — cu_compress_file / cu_decompress_file.
+ *
+ * Both directions are the same loop over two cursors:
+ *
+ *   src: hands out [off, off+len) windows of the source. POSIX maps each
+ *        window read-only with MADV_SEQUENTIAL and unmaps the previous
+ *        one, so at most one input window is ever resident.
+ *   dst: hands out writable space at the current output position. POSIX
+ *        grows the file with fallocate a window ahead (so a full disk is
+ *        an ENOSPC status, not a SIGBUS on a mapped page) and maps that
+ *        window MAP_SHARED; the final ftruncate trims the slack.
+ *
+ * The codec reads straight out of the source mapping and writes straight
+ * into the destination mapping — no user-space staging buffer on either
+ * side. Windows builds use the same cursors backed by stdio and heap
+ * buffers.
+ *
+ * Parallel compression on POSIX bypasses the cursors: the overlapped
+ * read/compress/write pipeline in pipeline.c (io_uring on Linux) works
+ * on the two descriptors directly.
+ */
+
+#if !defined(_WIN32)
+#  ifndef _FILE_OFFSET_BITS
+#    define _FILE_OFFSET_BITS 64
+#  endif
+#  ifndef _GNU_SOURCE
+#    define _GNU_SOURCE  /* posix_fallocate, MADV_* on glibc */
+#  endif
+#endif
+
+#include "compress_utils.h"
+#include "algorithm_registry.h"
+#include "parallel.h"
+#include "pipeline.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#  define CU_FILE_STDIO 1
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+/* Input window and output mapping size. Bounds RSS. */
+#define CU_FILE_WINDOW ((size_t)64 << 20)
+/* Input handed to one streaming codec call. Small enough that input the
+ * codec cannot take in one go (held in the stream's pending buffer) is a
+ * cheap copy. */
+#define CU_FILE_FEED   ((size_t)1 << 20)
+/* Decompressed-size hint: bytes of the source probed for the first frame
+ * header, and the most output it may reserve per source byte. */
+#define CU_FILE_HINT_PROBE 4096
+#define CU_FILE_HINT_RATIO 64
+
+static cu_status_t io_error(const char* path, const char* what) {
+    cu_set_last_errorf("%s: %s: %s", path, what, strerror(errno));
+    return CU_ERR_IO;
+}
+
+/* ============================================================================
+ * Source cursor
+ * ============================================================================ */
+
+typedef struct {
+    const char* path;
+    uint64_t    size;
+#if CU_FILE_STDIO
+    FILE*       f;
+    uint8_t*    buf;
+    size_t      buf_cap;
+#else
+    int         fd;
+    uint8_t*    map;      /* current window mapping (page-aligned start) */
+    size_t      map_len;
+#endif
+} src_t;
+
+#if CU_FILE_STDIO
+
+static cu_status_t src_open(src_t* s, const char* path) {
+    memset(s, 0, sizeof(*s));
+    s->path = path;
+    s->f = fopen(path, "rb");
+    if (!s->f) return io_error(path, "open");
+    if (_fseeki64(s->f, 0, SEEK_END) != 0) return io_error(path, "seek");
+    s->size = (uint64_t)_ftelli64(s->f);
+    return CU_OK;
+}
+
+static cu_status_t src_window(src_t* s, uint64_t off, size_t len, const uint8_t** p) {
+    if (len == 0) {
+        static const uint8_t empty[1];
+        *p = empty;
+        return CU_OK;
+    }
+    if (len > s->buf_cap) {
+        uint8_t* nb = realloc(s->buf, len);
+        if (!nb) {
+            cu_set_last_error("file: out of memory");
+            return CU_ERR_OOM;
+        }
+        s->buf = nb;
+        s->buf_cap = len;
+    }
+    if (_fseeki64(s->f, (long long)off, SEEK_SET) != 0) return io_error(s->path, "seek");
+    if (fread(s->buf, 1, len, s->f) != len) return io_error(s->path, "read");
+    *p = s->buf;
+    return CU_OK;
+}
+
+static void src_close(src_t* s) {
+    if (s->f) fclose(s->f);
+    free(s->buf);
+}
+
+#else  /* mmap */
+
+static size_t page_size(void) {
+    long p = sysconf(_SC_PAGESIZE);
+    return p > 0 ? (size_t)p : 4096;
+}
+
+static cu_status_t src_open(src_t* s, const char* path) {
+    memset(s, 0, sizeof(*s));
+    s->path = path;
+    s->fd = open(path, O_RDONLY);
+    if (s->fd < 0) return io_error(path, "open");
+    struct stat st;
+    if (fstat(s->fd, &st) != 0) return io_error(path, "stat");
+    s->size = (uint64_t)st.st_size;
+    return CU_OK;
+}
+
+static void src_unmap(src_t* s) {
+    if (s->map) munmap(s->map, s->map_len);
+    s->map = NULL;
+}
+
+static cu_status_t src_window(src_t* s, uint64_t off, size_t len, const uint8_t** p) {
+    src_unmap(s);
+    if (len == 0) {
+        static const uint8_t empty[1];
+        *p = empty;
+        return CU_OK;
+    }
+    size_t lead = (size_t)(off % page_size());
+    s->map_len = lead + len;
+    void* m = mmap(NULL, s->map_len, PROT_READ, MAP_PRIVATE, s->fd, (off_t)(off - lead));
+    if (m == MAP_FAILED) return io_error(s->path, "mmap");
+    s->map = m;
+#ifdef MADV_SEQUENTIAL
+    madvise(s->map, s->map_len, MADV_SEQUENTIAL);
+#endif
+    *p = s->map + lead;
+    return CU_OK;
+}
+
+static void src_close(src_t* s) {
+    src_unmap(s);
+    if (s->fd >= 0) close(s->fd);
+}
+
+#endif
+
+/* ============================================================================
+ * Destination cursor
+ * ============================================================================ */
+
+typedef struct {
+    const char* path;
+    uint64_t    pos;        /* bytes produced so far */
+#if CU_FILE_STDIO
+    FILE*       f;
+    uint8_t*    buf;        /* holds [pos - used, pos) */
+    size_t      cap;
+    size_t      used;
+#else
+    int         fd;
+    uint64_t    allocated;  /* file size reserved so far */
+    uint8_t*    map;
+    uint64_t    map_off;
+    size_t      map_len;
+#endif
+} dst_t;
+
+#if CU_FILE_STDIO
+
+static cu_status_t dst_open(dst_t* d, const char* path, uint64_t size_hint) {
+    (void)size_hint;
+    memset(d, 0, sizeof(*d));
+    d->path = path;
+    d->f = fopen(path, "wb");
+    if (!d->f) return io_error(path, "open");
+    return CU_OK;
+}
+
+static cu_status_t dst_flush(dst_t* d) {
+    if (d->used && fwrite(d->buf, 1, d->used, d->f) != d->used) return io_error(d->path, "write");
+    d->used = 0;
+    return CU_OK;
+}
+
+static cu_status_t dst_space(dst_t* d, size_t min, uint8_t** p, size_t* avail) {
+    if (d->cap - d->used < min) {
+        cu_status_t st = dst_flush(d);
+        if (st != CU_OK) return st;
+        if (d->cap < min || d->cap < CU_FILE_WINDOW) {
+            size_t cap = min > CU_FILE_WINDOW ? min : CU_FILE_WINDOW;
+            uint8_t* nb = realloc(d->buf, cap);
+            if (!nb) {
+                cu_set_last_error("file: out of memory");
+                return CU_ERR_OOM;
+            }
+            d->buf = nb;
+            d->cap = cap;
+        }
+    }
+    *p = d->buf + d->used;
+    *avail = d->cap - d->used;
+    return CU_OK;
+}
+
+static void dst_commit(dst_t* d, size_t n) {
+    d->used += n;
+    d->pos += n;
+}
+
+static cu_status_t dst_close(dst_t* d) {
+    cu_status_t st = dst_flush(d);
+    if (fclose(d->f) != 0 && st == CU_OK) st = io_error(d->path, "close");
+    d->f = NULL;
+    free(d->buf);
+    return st;
+}
+
+/* Only a file this call opened is removed: when the open itself failed,
+ * the path is still the caller's. */
+static void dst_abort(dst_t* d) {
+    if (d->f) {
+        fclose(d->f);
+        remove(d->path);
+    }
+    free(d->buf);
+}
+
+#else  /* mmap */
+
+/* Make the file at least `end` bytes long with real blocks behind it. */
+static cu_status_t dst_reserve(dst_t* d, uint64_t end) {
+    if (end <= d->allocated) return CU_OK;
+#if defined(__linux__)
+    int r = posix_fallocate(d->fd, (off_t)d->allocated, (off_t)(end - d->allocated));
+    if (r == 0) {
+        d->allocated = end;
+        return CU_OK;
+    }
+    if (r != EOPNOTSUPP && r != EINVAL) {
+        errno = r;
+        return io_error(d->path, "fallocate");
+    }
+    /* Filesystem without fallocate: fall through to a sparse extend. */
+#elif defined(__APPLE__)
+    fstore_t fs = { F_ALLOCATEALL, F_PEOFPOSMODE, 0, (off_t)(end - d->allocated), 0 };
+    (void)fcntl(d->fd, F_PREALLOCATE, &fs);  /* best effort; ftruncate sets the size */
+#endif
+    if (ftruncate(d->fd, (off_t)end) != 0) return io_error(d->path, "ftruncate");
+    d->allocated = end;
+    return CU_OK;
+}
+
+static cu_status_t dst_open(dst_t* d, const char* path, uint64_t size_hint) {
+    memset(d, 0, sizeof(*d));
+    d->path = path;
+    d->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (d->fd < 0) return io_error(path, "open");
+    /* Known final size: one allocation up front, one extent on disk. Best
+     * effort: without the space, decoding stops where it runs out. */
+    if (size_hint && dst_reserve(d, size_hint) != CU_OK) {
+        if (ftruncate(d->fd, (off_t)d->allocated) != 0) return io_error(path, "ftruncate");
+        cu_clear_last_error();
+    }
+    return CU_OK;
+}
+
+static void dst_unmap(dst_t* d) {
+    if (d->map) munmap(d->map, d->map_len);
+    d->map = NULL;
+}
+
+static cu_status_t dst_space(dst_t* d, size_t min, uint8_t** p, size_t* avail) {
+    if (!d->map || d->map_off + d->map_len - d->pos < min) {
+        dst_unmap(d);
+        size_t page = page_size();
+        d->map_off = d->pos - d->pos % page;
+        size_t lead = (size_t)(d->pos - d->map_off);
+        size_t len = lead + (min > CU_FILE_WINDOW ? min : CU_FILE_WINDOW);
+        d->map_len = (len + page - 1) / page * page;
+        cu_status_t st = dst_reserve(d, d->map_off + d->map_len);
+        if (st != CU_OK) return st;
+        void* m = mmap(NULL, d->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, d->fd,
+                       (off_t)d->map_off);
+        if (m == MAP_FAILED) return io_error(d->path, "mmap");
+        d->map = m;
+    }
+    size_t off = (size_t)(d->pos - d->map_off);
+    *p = d->map + off;
+    *avail = d->map_len - off;
+    return CU_OK;
+}
+
+static void dst_commit(dst_t* d, size_t n) {
+    d->pos += n;
+}
+
+static cu_status_t dst_close(dst_t* d) {
+    dst_unmap(d);
+    cu_status_t st = CU_OK;
+    /* Trim the window slack (or an over-large size hint). */
+    if (d->allocated != d->pos && ftruncate(d->fd, (off_t)d->pos) != 0) {
+        st = io_error(d->path, "ftruncate");
+    }
+    if (close(d->fd) != 0 && st == CU_OK) st = io_error(d->path, "close");
+    d->fd = -1;
+    return st;
+}
+
+/* Only a file this call opened is removed: when the open itself failed,
+ * the path is still the caller's. */
+static void dst_abort(dst_t* d) {
+    dst_unmap(d);
+    if (d->fd >= 0) {
+        close(d->fd);
+        unlink(d->path);
+    }
+}
+
+#endif
+
+/* ============================================================================
+ * Drivers
+ * ============================================================================ */
+
+/* Feed `in` through a stream in CU_FILE_FEED slices, honouring the
+ * BUF_TOO_SMALL drain protocol. `write` is cu_compress_stream_write or
+ * cu_decompress_stream_write behind a void* adapter. */
+typedef cu_status_t (*stream_write_fn)(void* st, const uint8_t* in, size_t in_len,
+                                       uint8_t* out, size_t* out_len);
+typedef cu_status_t (*stream_finish_fn)(void* st, uint8_t* out, size_t* out_len);
+
+static cu_status_t feed(void* st, stream_write_fn write, size_t min_out,
+                        const uint8_t* in, size_t in_len, dst_t* d) {
+    while (in_len > 0) {
+        size_t n = in_len < CU_FILE_FEED ? in_len : CU_FILE_FEED;
+        const uint8_t* p = in;
+        size_t pl = n;
+        for (;;) {
+            uint8_t* out;
+            size_t avail;
+            cu_status_t s = dst_space(d, min_out, &out, &avail);
+            if (s != CU_OK) return s;
+            s = write(st, p, pl, out, &avail);
+            dst_commit(d, avail);
+            if (s == CU_OK) break;
+            if (s != CU_ERR_BUF_TOO_SMALL) return s;
+            p = NULL;
+            pl = 0;
+        }
+        in += n;
+        in_len -= n;
+    }
+    return CU_OK;
+}
+
+static cu_status_t drain(void* st, stream_finish_fn finish, size_t min_out, dst_t* d) {
+    for (;;) {
+        uint8_t* out;
+        size_t avail;
+        cu_status_t s = dst_space(d, min_out, &out, &avail);
+        if (s != CU_OK) return s;
+        s = finish(st, out, &avail);
+        dst_commit(d, avail);
+        if (s != CU_ERR_BUF_TOO_SMALL) return s;
+    }
+}
+
+static cu_status_t cs_write(void* st, const uint8_t* i, size_t il, uint8_t* o, size_t* ol) {
+    return cu_compress_stream_write((cu_compress_stream_t*)st, i, il, o, ol);
+}
+static cu_status_t cs_finish(void* st, uint8_t* o, size_t* ol) {
+    return cu_compress_stream_finish((cu_compress_stream_t*)st, o, ol);
+}
+static cu_status_t ds_write(void* st, const uint8_t* i, size_t il, uint8_t* o, size_t* ol) {
+    return cu_decompress_stream_write((cu_decompress_stream_t*)st, i, il, o, ol);
+}
+static cu_status_t ds_finish(void* st, uint8_t* o, size_t* ol) {
+    return cu_decompress_stream_finish((cu_decompress_stream_t*)st, o, ol);
+}
+
+/* Stream the whole source through `st` in CU_FILE_WINDOW windows. */
+static cu_status_t pump(void* st, stream_write_fn write, stream_finish_fn finish,
+                        size_t min_out, src_t* s, dst_t* d) {
+    for (uint64_t off = 0; off < s->size; off += CU_FILE_WINDOW) {
+        size_t len = s->size - off < CU_FILE_WINDOW ? (size_t)(s->size - off) : CU_FILE_WINDOW;
+        const uint8_t* p;
+        cu_status_t r = src_window(s, off, len, &p);
+        if (r != CU_OK) return r;
+        r = feed(st, write, min_out, p, len, d);
+        if (r != CU_OK) return r;
+    }
+    return drain(st, finish, min_out, d);
+}
+
+#if CU_FILE_STDIO
+static cu_status_t compress_parallel_windows(cu_algorithm_t algo, int level,
+                                             const cu_parallel_opts_t* opts,
+                                             src_t* s, dst_t* d) {
+    /* Whole chunks per window keep the frame layout identical to a
+     * single cu_compress_parallel call over the whole file. */
+    size_t chunk = cu_parallel_chunk_size(algo, opts);
+    unsigned threads = cu_parallel_threads(opts);
+    size_t per = CU_FILE_WINDOW / chunk;
+    if (per < (size_t)threads * 2) per = (size_t)threads * 2;
+    size_t window = per * chunk;
+
+    uint64_t off = 0;
+    do {
+        size_t len = s->size - off < window ? (size_t)(s->size - off) : window;
+        const uint8_t* p;
+        cu_status_t r = src_window(s, off, len, &p);
+        if (r != CU_OK) return r;
+        size_t cap = cu_compress_parallel_bound(len, algo, opts);
+        uint8_t* out;
+        size_t avail;
+        r = dst_space(d, cap, &out, &avail);
+        if (r != CU_OK) return r;
+        r = cu_compress_parallel(algo, p, len, out, &avail, level, opts);
+        if (r != CU_OK) return r;
+        dst_commit(d, avail);
+        off += len;
+    } while (off < s->size);
+    return CU_OK;
+}
+#endif
+
+/* Refuse to truncate the file we are about to read. */
+static int same_file(const char* a, const char* b) {
+#if CU_FILE_STDIO
+    return strcmp(a, b) == 0;
+#else
+    struct stat sa, sb;
+    return stat(a, &sa) == 0 && stat(b, &sb) == 0
+        && sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+#endif
+}
+
+/* What the first frame header declares, for preallocating the output;
+ * 0 = unknown. The header is untrusted, so the hint is capped by the
+ * decompression limit and CU_FILE_HINT_RATIO times the source size. Later
+ * frames are not walked: past the hint the output grows as it is written. */
+static uint64_t output_size_hint(cu_algorithm_t algo, src_t* s) {
+#if CU_FILE_STDIO
+    (void)algo;
+    (void)s;
+    return 0;
+#else
+    uint8_t head[CU_FILE_HINT_PROBE];
+    ssize_t n = pread(s->fd, head, sizeof(head), 0);
+    if (n <= 0) return 0;
+    cu_frame_info_t info;
+    cu_status_t st = cu_frame_info(algo, head, (size_t)n, &info);
+    cu_clear_last_error();
+    if (st != CU_OK || info.content_size == CU_FRAME_SIZE_UNKNOWN) return 0;
+
+    uint64_t hint = info.content_size;
+    uint64_t limit = cu_get_max_decompressed_size();
+    if (limit && hint > limit) hint = limit;
+    if (s->size <= UINT64_MAX / CU_FILE_HINT_RATIO && hint > s->size * CU_FILE_HINT_RATIO) {
+        hint = s->size * CU_FILE_HINT_RATIO;
+    }
+    return hint;
+#endif
+}
+
+cu_status_t cu_compress_file(
+    cu_algorithm_t algo,
+    const char* src_path,
+    const char* dst_path,
+    int level,
+    const cu_parallel_opts_t* opts
+) {
+    if (!src_path || !dst_path) return CU_ERR_INVALID_ARG;
+    if (!cu_algorithm_available(algo)) {
+        cu_set_last_errorf("algorithm %d is not available in this build", (int)algo);
+        return CU_ERR_UNSUPPORTED_ALGO;
+    }
+    if (cu_check_level(level) != CU_OK) return CU_ERR_INVALID_LEVEL;
+    if (same_file(src_path, dst_path)) {
+        cu_set_last_errorf("%s: source and destination are the same file", src_path);
+        return CU_ERR_INVALID_ARG;
+    }
+
+    src_t s;
+    cu_status_t r = src_open(&s, src_path);
+    if (r != CU_OK) {
+        src_close(&s);
+        return r;
+    }
+    dst_t d;
+    r = dst_open(&d, dst_path, 0);
+    if (r != CU_OK) {
+        dst_abort(&d);
+        src_close(&s);
+        return r;
+    }
+
+    if (opts && cu_parallel_supported(algo)) {
+#if CU_FILE_STDIO
+        r = compress_parallel_windows(algo, level, opts, &s, &d);
+#else
+        uint64_t n = 0;
+        r = cu_pipeline_compress(algo, level, opts, s.fd, s.size, src_path,
+                                 d.fd, dst_path, &n);
+        d.pos = d.allocated = n;  /* written with pwrite, nothing mapped */
+#endif
+    } else {
+        cu_compress_stream_t* cs = NULL;
+        r = cu_compress_stream_create(algo, level, &cs);
+        if (r == CU_OK) {
+            /* Room for a whole compressed feed slice: the codec never has
+             * to park input in the stream's pending buffer. */
+            size_t min_out = cu_compress_bound(CU_FILE_FEED, algo);
+            r = pump(cs, cs_write, cs_finish, min_out, &s, &d);
+        }
+        cu_compress_stream_destroy(cs);
+    }
+
+    src_close(&s);
+    if (r == CU_OK) {
+        r = dst_close(&d);
+        if (r != CU_OK) remove(dst_path);
+    } else {
+        dst_abort(&d);
+    }
+    return r;
+}
+
+cu_status_t cu_decompress_file(
+    cu_algorithm_t algo,
+    const char* src_path,
+    const char* dst_path
+) {
+    if (!src_path || !dst_path) return CU_ERR_INVALID_ARG;
+    if (same_file(src_path, dst_path)) {
+        cu_set_last_errorf("%s: source and destination are the same file", src_path);
+        return CU_ERR_INVALID_ARG;
+    }
+
+    cu_decompress_stream_t* ds = NULL;
+    cu_status_t r = cu_decompress_stream_create(algo, &ds);
+    if (r != CU_OK) return r;
+
+    src_t s;
+    r = src_open(&s, src_path);
+    if (r != CU_OK) {
+        src_close(&s);
+        cu_decompress_stream_destroy(ds);
+        return r;
+    }
+    dst_t d;
+    r = dst_open(&d, dst_path, output_size_hint(algo, &s));
+    if (r == CU_OK) {
+        r = pump(ds, ds_write, ds_finish, CU_FILE_FEED, &s, &d);
+    }
+
+    src_close(&s);
+    cu_decompress_stream_destroy(ds);
+    if (r == CU_OK) {
+        r = dst_close(&d);
+        if (r != CU_OK) remove(dst_path);
+    } else {
+        dst_abort(&d);
+    }
+    return r;
+}
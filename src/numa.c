@@ -0,0 +1,172 @@
+/*
+ * numa.c — NUMA topology discovery and thread pinning (see numa.h).
+ *
+ * The topology is read once from /sys/devices/system/node/node<N>/cpulist
+ * and intersected with the process's affinity mask, so a container or
+ * `taskset` confined to one socket sees a single node. Pinning is
+ * sched_setaffinity on the calling thread. Page placement is queried with
+ * move_pages(2) in status-only mode (no pages move).
+ *
+ * CU_NUMA=<n> with n >= 2 on a host with fewer nodes splits the allowed
+ * CPUs into n emulated nodes (CPUs are shared if there are fewer than n).
+ * Placement by page is then unavailable, so every task takes the
+ * contiguous split. This exists for tests and for measuring the engine's
+ * own overhead on one socket.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#  define _GNU_SOURCE  /* cpu_set_t, sched_getaffinity */
+#endif
+
+#include "numa.h"
+
+#if defined(__linux__)
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+_Static_assert(sizeof(cpu_set_t) <= sizeof(((cu_numa_binding_t*)0)->mask),
+               "cu_numa_binding_t mask too small for cpu_set_t");
+
+static struct {
+    unsigned  nodes;
+    cpu_set_t cpus[CU_NUMA_MAX_NODES];
+    int       index_of[CU_NUMA_MAX_NODES];  /* kernel node id -> our index, -1 if unusable */
+} topo;
+static pthread_once_t topo_once = PTHREAD_ONCE_INIT;
+
+/* Parse a sysfs cpulist ("0-3,8,10-11\n"). */
+static int parse_cpulist(const char* s, cpu_set_t* set) {
+    CPU_ZERO(set);
+    while (*s && *s != '\n') {
+        char* end;
+        unsigned long lo = strtoul(s, &end, 10);
+        if (end == s) return -1;
+        unsigned long hi = lo;
+        s = end;
+        if (*s == '-') {
+            hi = strtoul(s + 1, &end, 10);
+            if (end == s + 1) return -1;
+            s = end;
+        }
+        for (unsigned long c = lo; c <= hi && c < CPU_SETSIZE; c++) CPU_SET(c, set);
+        if (*s == ',') s++;
+    }
+    return 0;
+}
+
+/* Split `allowed` into `n` emulated nodes of contiguous CPUs. */
+static void topo_emulate(const cpu_set_t* allowed, unsigned n) {
+    int cpu[CPU_SETSIZE];
+    int ncpu = 0;
+    for (int c = 0; c < CPU_SETSIZE; c++) {
+        if (CPU_ISSET(c, allowed)) cpu[ncpu++] = c;
+    }
+    if (ncpu == 0) return;
+    for (unsigned g = 0; g < n; g++) CPU_ZERO(&topo.cpus[g]);
+    for (int k = 0; k < ncpu; k++) CPU_SET(cpu[k], &topo.cpus[(unsigned)k * n / (unsigned)ncpu]);
+    for (unsigned g = 0; g < n; g++) {
+        if (CPU_COUNT(&topo.cpus[g]) == 0) CPU_SET(cpu[g % (unsigned)ncpu], &topo.cpus[g]);
+    }
+    for (int id = 0; id < CU_NUMA_MAX_NODES; id++) topo.index_of[id] = -1;
+    topo.nodes = n;
+}
+
+static void topo_init(void) {
+    topo.nodes = 1;
+    for (int id = 0; id < CU_NUMA_MAX_NODES; id++) topo.index_of[id] = -1;
+
+    const char* env = getenv("CU_NUMA");
+    if (env && strcmp(env, "0") == 0) return;
+    unsigned long emulate = env ? strtoul(env, NULL, 10) : 0;
+    if (emulate > CU_NUMA_MAX_NODES) emulate = CU_NUMA_MAX_NODES;
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+
+    unsigned n = 0;
+    for (int id = 0; id < CU_NUMA_MAX_NODES; id++) {
+        char path[64], buf[4096];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", id);
+        FILE* f = fopen(path, "r");
+        if (!f) continue;  /* node ids may have holes */
+        size_t len = fread(buf, 1, sizeof(buf) - 1, f);
+        fclose(f);
+        buf[len] = '\0';
+
+        cpu_set_t cpus;
+        if (parse_cpulist(buf, &cpus) != 0) continue;
+        CPU_AND(&cpus, &cpus, &allowed);
+        if (CPU_COUNT(&cpus) == 0) continue;  /* memory-only, or outside our cpuset */
+        topo.cpus[n] = cpus;
+        topo.index_of[id] = (int)n;
+        n++;
+    }
+    if (n > 1) topo.nodes = n;
+    if (emulate > topo.nodes) topo_emulate(&allowed, (unsigned)emulate);
+}
+
+unsigned cu_numa_nodes(void) {
+    pthread_once(&topo_once, topo_init);
+    return topo.nodes;
+}
+
+int cu_numa_node_of(const void* addr) {
+#if defined(SYS_move_pages)
+    if (!addr || cu_numa_nodes() < 2) return -1;
+    long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0) return -1;
+    void* p = (void*)((uintptr_t)addr & ~(uintptr_t)(page - 1));
+    int status = -1;
+    if (syscall(SYS_move_pages, 0, 1UL, &p, NULL, &status, 0) != 0) return -1;
+    return status >= 0 && status < CU_NUMA_MAX_NODES ? topo.index_of[status] : -1;
+#else
+    (void)addr;
+    return -1;
+#endif
+}
+
+void cu_numa_bind(unsigned node, cu_numa_binding_t* saved) {
+    saved->active = 0;
+    if (cu_numa_nodes() < 2) return;
+    cpu_set_t old;
+    if (sched_getaffinity(0, sizeof(old), &old) != 0) return;
+    if (sched_setaffinity(0, sizeof(cpu_set_t), &topo.cpus[node % topo.nodes]) != 0) return;
+    memcpy(saved->mask, &old, sizeof(old));
+    saved->active = 1;
+}
+
+void cu_numa_unbind(cu_numa_binding_t* saved) {
+    if (!saved->active) return;
+    cpu_set_t old;
+    memcpy(&old, saved->mask, sizeof(old));
+    sched_setaffinity(0, sizeof(old), &old);
+    saved->active = 0;
+}
+
+#else  /* not Linux: one node, no pinning */
+
+unsigned cu_numa_nodes(void) {
+    return 1;
+}
+
+int cu_numa_node_of(const void* addr) {
+    (void)addr;
+    return -1;
+}
+
+void cu_numa_bind(unsigned node, cu_numa_binding_t* saved) {
+    (void)node;
+    saved->active = 0;
+}
+
+void cu_numa_unbind(cu_numa_binding_t* saved) {
+    saved->active = 0;
+}
+
+#endif
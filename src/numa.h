@@ -0,0 +1,55 @@
+/*
+ * numa.h — NUMA topology and thread placement for the parallel engines.
+ *
+ * Nodes are numbered 0..cu_numa_nodes()-1 over the nodes that have CPUs
+ * this process may run on; kernel node ids never leak out. Memory is left
+ * to the kernel's first-touch policy: a thread pinned to a node gets its
+ * codec contexts, scratch and freshly touched output pages from that
+ * node without any explicit binding.
+ *
+ * Linux only (sysfs + sched_setaffinity + move_pages, no libnuma). Every
+ * other platform, single-node hosts and CU_NUMA=0 in the environment
+ * report one node, and binding is a no-op. CU_NUMA=<n> emulates n nodes
+ * on a smaller host (see numa.c).
+ *
+ * This header is internal — consumers must not include it.
+ */
+
+#ifndef CU_NUMA_H
+#define CU_NUMA_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CU_NUMA_MAX_NODES 64
+
+/* Room for a 1024-CPU affinity mask (glibc's CPU_SETSIZE). */
+#define CU_NUMA_MASK_WORDS (1024 / (8 * sizeof(unsigned long)))
+
+/* The calling thread's affinity before cu_numa_bind, restored by
+ * cu_numa_unbind. */
+typedef struct {
+    int           active;
+    unsigned long mask[CU_NUMA_MASK_WORDS];
+} cu_numa_binding_t;
+
+/* Usable NUMA nodes; 1 when placement is off. Computed once. */
+unsigned cu_numa_nodes(void);
+
+/* Node holding the page at addr, or -1 if unknown (not faulted in yet,
+ * memory-only node, placement off). */
+int cu_numa_node_of(const void* addr);
+
+/* Pin the calling thread to `node`'s CPUs. Always pair with
+ * cu_numa_unbind, which restores the previous affinity. */
+void cu_numa_bind(unsigned node, cu_numa_binding_t* saved);
+void cu_numa_unbind(cu_numa_binding_t* saved);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* CU_NUMA_H */
@@ -0,0 +1,333 @@
+/*
+ * parallel.c — chunked multi-threaded compression.
+ *
+ * The input is cut into fixed-size chunks; each chunk is compressed with
+ * the codec's ordinary one-shot path into its own worst-case slot of the
+ * caller's output buffer, so workers never share memory. A final serial
+ * pass slides the slots together. The result is a concatenation of
+ * independent frames, which every decoder for the supported formats
+ * treats as one stream.
+ *
+ * Threads are created per call rather than kept in a pool: a call only
+ * goes parallel when the input spans several chunks (≥1 MiB each), so
+ * thread start-up is noise next to the codec work, and there is no global
+ * state to tear down at exit.
+ *
+ * On multi-socket hosts each chunk is compressed on the node that holds
+ * its input. The worker is pinned there, so the codec's tables (allocated
+ * inside the one-shot call) and the first touch of its output slot stay
+ * on that node too.
+ */
+
+#include "parallel.h"
+#include "algorithm_registry.h"
+#include "compress_utils.h"
+#include "numa.h"
+#include "utils/threads.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Upper bound on worker threads per call; keeps the stack array small. */
+#define CU_PARALLEL_MAX_THREADS 256
+
+/* Per-codec default chunk size. Big enough that the ratio loss from
+ * restarting the dictionary is ~1% or less, small enough to keep every
+ * core busy on inputs of a few tens of MB. 0 = no parallel path. */
+static size_t default_chunk_size(cu_algorithm_t algo) {
+    switch (algo) {
+        case CU_ALGO_ZSTD: return (size_t)4 << 20;
+        case CU_ALGO_LZ4:  return (size_t)4 << 20;
+        case CU_ALGO_GZIP: return (size_t)1 << 20;
+        /* Multiple of every bzip2 block size (100k..900k). */
+        case CU_ALGO_BZ2:  return (size_t)3600000;
+        case CU_ALGO_XZ:
+        case CU_ALGO_LZMA: return (size_t)8 << 20;
+        default:           return 0;
+    }
+}
+
+/* ============================================================================
+ * parallel_for
+ * ============================================================================ */
+
+typedef struct {
+    cu_mutex_t          lock;
+    size_t              next;
+    size_t              n;
+    cu_parallel_task_fn fn;
+    void*               ctx;
+} pfor_state_t;
+
+static void pfor_worker(void* arg) {
+    pfor_state_t* st = (pfor_state_t*)arg;
+    for (;;) {
+        cu_mutex_lock(&st->lock);
+        size_t i = st->next++;
+        cu_mutex_unlock(&st->lock);
+        if (i >= st->n) return;
+        st->fn(st->ctx, i);
+    }
+}
+
+/* NUMA variant: `order` holds the task indices grouped by node, and group
+ * g hands out order[next[g] .. end[g]). */
+typedef struct {
+    cu_mutex_t          lock;
+    cu_parallel_task_fn fn;
+    void*               ctx;
+    unsigned            groups;
+    unsigned            joined;  /* workers started so far; picks the group */
+    size_t*             order;
+    size_t              next[CU_NUMA_MAX_NODES];
+    size_t              end[CU_NUMA_MAX_NODES];
+} pfor_numa_state_t;
+
+static void pfor_numa_worker(void* arg) {
+    pfor_numa_state_t* st = (pfor_numa_state_t*)arg;
+    cu_mutex_lock(&st->lock);
+    unsigned g = st->joined++ % st->groups;
+    cu_mutex_unlock(&st->lock);
+
+    cu_numa_binding_t pin;
+    cu_numa_bind(g, &pin);
+    for (;;) {
+        size_t i = SIZE_MAX;
+        cu_mutex_lock(&st->lock);
+        /* Own node first, then help the others in turn. */
+        for (unsigned k = 0; k < st->groups && i == SIZE_MAX; k++) {
+            unsigned q = (g + k) % st->groups;
+            if (st->next[q] < st->end[q]) i = st->order[st->next[q]++];
+        }
+        cu_mutex_unlock(&st->lock);
+        if (i == SIZE_MAX) break;
+        st->fn(st->ctx, i);
+    }
+    cu_numa_unbind(&pin);
+}
+
+/* Group the tasks by node and run them. Returns 0 if the bookkeeping
+ * could not be allocated (the caller then runs the plain engine). */
+static int pfor_numa(unsigned threads, unsigned groups, size_t n,
+                     cu_parallel_task_fn fn, cu_parallel_home_fn home, void* ctx) {
+    pfor_numa_state_t st = { .fn = fn, .ctx = ctx, .groups = groups };
+    unsigned char* node = malloc(n);
+    st.order = malloc(n * sizeof(*st.order));
+    if (!node || !st.order) {
+        free(node);
+        free(st.order);
+        return 0;
+    }
+
+    size_t count[CU_NUMA_MAX_NODES] = {0};
+    for (size_t i = 0; i < n; i++) {
+        int g = home ? cu_numa_node_of(home(ctx, i)) : -1;
+        if (g < 0) g = (int)(i * groups / n);
+        node[i] = (unsigned char)g;
+        count[g]++;
+    }
+    size_t at = 0;
+    for (unsigned g = 0; g < groups; g++) {
+        st.next[g] = at;
+        at += count[g];
+        st.end[g] = at;
+        count[g] = st.next[g];  /* now the fill cursor */
+    }
+    for (size_t i = 0; i < n; i++) st.order[count[node[i]]++] = i;
+    free(node);
+    cu_mutex_init(&st.lock);
+
+    cu_thread_t workers[CU_PARALLEL_MAX_THREADS];
+    unsigned started = 0;
+    for (unsigned t = 1; t < threads; t++) {
+        if (cu_thread_create(&workers[started], pfor_numa_worker, &st) != 0) break;
+        started++;
+    }
+    pfor_numa_worker(&st);
+    for (unsigned t = 0; t < started; t++) cu_thread_join(&workers[t]);
+    cu_mutex_destroy(&st.lock);
+    free(st.order);
+    return 1;
+}
+
+void cu_parallel_for(unsigned threads, size_t n, cu_parallel_task_fn fn, void* ctx) {
+    cu_parallel_for_placed(threads, n, fn, NULL, ctx);
+}
+
+void cu_parallel_for_placed(unsigned threads, size_t n, cu_parallel_task_fn fn,
+                            cu_parallel_home_fn home, void* ctx) {
+    if (threads == 0) threads = cu_cpu_count();
+    if (threads > CU_PARALLEL_MAX_THREADS) threads = CU_PARALLEL_MAX_THREADS;
+    if ((size_t)threads > n) threads = (unsigned)n;
+    if (threads <= 1) {
+        for (size_t i = 0; i < n; i++) fn(ctx, i);
+        return;
+    }
+    unsigned groups = cu_numa_nodes();
+    if (groups > 1 && pfor_numa(threads, groups, n, fn, home, ctx)) return;
+
+    pfor_state_t st = { .next = 0, .n = n, .fn = fn, .ctx = ctx };
+    cu_mutex_init(&st.lock);
+
+    cu_thread_t workers[CU_PARALLEL_MAX_THREADS];
+    unsigned started = 0;
+    for (unsigned t = 1; t < threads; t++) {
+        if (cu_thread_create(&workers[started], pfor_worker, &st) != 0) break;
+        started++;
+    }
+    pfor_worker(&st);
+    for (unsigned t = 0; t < started; t++) cu_thread_join(&workers[t]);
+    cu_mutex_destroy(&st.lock);
+}
+
+/* ============================================================================
+ * Options
+ * ============================================================================ */
+
+unsigned cu_parallel_threads(const cu_parallel_opts_t* opts) {
+    unsigned t = opts ? opts->threads : 0;
+    if (t == 0) t = cu_cpu_count();
+    return t > CU_PARALLEL_MAX_THREADS ? CU_PARALLEL_MAX_THREADS : t;
+}
+
+size_t cu_parallel_chunk_size(cu_algorithm_t algo, const cu_parallel_opts_t* opts) {
+    size_t def = default_chunk_size(algo);
+    if (def == 0 || !cu_registry_lookup(algo)) return 0;
+    return opts && opts->chunk_size ? opts->chunk_size : def;
+}
+
+int cu_parallel_supported(cu_algorithm_t algo) {
+    return cu_parallel_chunk_size(algo, NULL) != 0;
+}
+
+/* ============================================================================
+ * cu_compress_parallel
+ * ============================================================================ */
+
+typedef struct {
+    const cu_algorithm_vtbl_t* v;
+    const uint8_t* in;
+    size_t         in_len;
+    uint8_t*       out;
+    size_t         chunk;
+    size_t         slot;     /* compress_bound(chunk): stride of output slots */
+    int            level;
+    size_t*        lens;     /* per-chunk compressed size */
+    cu_status_t*   status;   /* per-chunk result */
+
+    cu_mutex_t     err_lock;
+    char           err[256]; /* first worker error message */
+} pcompress_job_t;
+
+static void pcompress_chunk(void* ctx, size_t i) {
+    pcompress_job_t* job = (pcompress_job_t*)ctx;
+    size_t off = i * job->chunk;
+    size_t n = job->in_len - off < job->chunk ? job->in_len - off : job->chunk;
+    size_t cap = job->v->compress_bound(n);
+    cu_status_t s = job->v->compress(job->in + off, n, job->out + i * job->slot,
+                                     &cap, job->level);
+    job->lens[i] = cap;
+    job->status[i] = s;
+    if (s != CU_OK) {
+        /* cu_last_error is thread-local: carry the message home. */
+        cu_mutex_lock(&job->err_lock);
+        if (!job->err[0]) {
+            strncpy(job->err, cu_last_error(), sizeof(job->err) - 1);
+        }
+        cu_mutex_unlock(&job->err_lock);
+    }
+}
+
+static const void* pcompress_home(void* ctx, size_t i) {
+    pcompress_job_t* job = (pcompress_job_t*)ctx;
+    return job->in + i * job->chunk;
+}
+
+size_t cu_compress_parallel_bound(size_t in_len, cu_algorithm_t algo,
+                                  const cu_parallel_opts_t* opts) {
+    size_t chunk = cu_parallel_chunk_size(algo, opts);
+    if (chunk == 0) return 0;
+    const cu_algorithm_vtbl_t* v = cu_registry_lookup(algo);
+    if (in_len <= chunk) return v->compress_bound(in_len);
+    size_t full = in_len / chunk;
+    size_t tail = in_len % chunk;
+    size_t bound = full * v->compress_bound(chunk);
+    if (tail) bound += v->compress_bound(tail);
+    return bound;
+}
+
+cu_status_t cu_compress_parallel(
+    cu_algorithm_t algo,
+    const uint8_t* in, size_t in_len,
+    uint8_t* out, size_t* out_len,
+    int level,
+    const cu_parallel_opts_t* opts
+) {
+    if (!out_len)                       return CU_ERR_INVALID_ARG;
+    if (in_len > 0 && !in)              return CU_ERR_INVALID_ARG;
+    if (*out_len > 0 && !out)           return CU_ERR_INVALID_ARG;
+    if (cu_check_level(level) != CU_OK) return CU_ERR_INVALID_LEVEL;
+    const cu_algorithm_vtbl_t* v = cu_registry_lookup(algo);
+    if (!v) {
+        cu_set_last_errorf("algorithm %d is not available in this build", (int)algo);
+        return CU_ERR_UNSUPPORTED_ALGO;
+    }
+    size_t chunk = cu_parallel_chunk_size(algo, opts);
+    if (chunk == 0) {
+        cu_set_last_errorf("%s: no parallel mode (format has no concatenation)", v->name);
+        return CU_ERR_UNSUPPORTED_ALGO;
+    }
+
+    cu_clear_last_error();
+    if (in_len <= chunk) {
+        return v->compress(in, in_len, out, out_len, level);
+    }
+
+    size_t bound = cu_compress_parallel_bound(in_len, algo, opts);
+    if (*out_len < bound) {
+        *out_len = bound;
+        return CU_ERR_BUF_TOO_SMALL;
+    }
+
+    size_t nchunks = (in_len + chunk - 1) / chunk;
+    pcompress_job_t job = {
+        .v = v, .in = in, .in_len = in_len, .out = out,
+        .chunk = chunk, .slot = v->compress_bound(chunk), .level = level,
+    };
+    job.lens = malloc(nchunks * sizeof(*job.lens));
+    job.status = malloc(nchunks * sizeof(*job.status));
+    if (!job.lens || !job.status) {
+        free(job.lens);
+        free(job.status);
+        cu_set_last_error("parallel: out of memory");
+        return CU_ERR_OOM;
+    }
+    cu_mutex_init(&job.err_lock);
+
+    cu_parallel_for_placed(cu_parallel_threads(opts), nchunks, pcompress_chunk,
+                           pcompress_home, &job);
+
+    cu_status_t ret = CU_OK;
+    size_t total = 0;
+    for (size_t i = 0; i < nchunks; i++) {
+        if (job.status[i] != CU_OK) {
+            ret = job.status[i];
+            cu_set_last_error(job.err);
+            break;
+        }
+        /* Slide chunk i down to follow chunk i-1. Slots only move toward
+         * the front, so memmove over the not-yet-compacted tail is safe. */
+        if (total != i * job.slot) {
+            memmove(out + total, out + i * job.slot, job.lens[i]);
+        }
+        total += job.lens[i];
+    }
+    if (ret == CU_OK) *out_len = total;
+
+    cu_mutex_destroy(&job.err_lock);
+    free(job.lens);
+    free(job.status);
+    return ret;
+}
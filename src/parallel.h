@@ -0,0 +1,51 @@
+/*
+ * parallel.h — internal helpers behind cu_compress_parallel, shared with
+ * the other multi-threaded entry points.
+ *
+ * This header is internal — consumers must not include it.
+ */
+
+#ifndef CU_PARALLEL_H
+#define CU_PARALLEL_H
+
+#include "compress_utils.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Run fn(ctx, i) for every i in [0, n) on up to `threads` threads (0 = one
+ * per online CPU). The calling thread participates; indices are handed out
+ * in increasing order. Returns once every call has returned. If threads
+ * cannot be created the remaining work runs on the caller.
+ *
+ * On a NUMA host (numa.h) the workers form one group per node, each pinned
+ * to its node's CPUs, and the indices are split into one contiguous run
+ * per node; order is increasing within a run. A group that finishes its
+ * own run helps with the others.
+ */
+typedef void (*cu_parallel_task_fn)(void* ctx, size_t index);
+void cu_parallel_for(unsigned threads, size_t n, cu_parallel_task_fn fn, void* ctx);
+
+/*
+ * cu_parallel_for, but on NUMA hosts task i is queued on the node that
+ * holds the page at home(ctx, i) — typically the task's input, or the
+ * output it fills. Tasks whose page is unknown (NULL, not faulted in yet)
+ * fall back to the contiguous split.
+ */
+typedef const void* (*cu_parallel_home_fn)(void* ctx, size_t index);
+void cu_parallel_for_placed(unsigned threads, size_t n, cu_parallel_task_fn fn,
+                            cu_parallel_home_fn home, void* ctx);
+
+/* Effective thread count for `opts` (may be NULL): opts->threads, or one
+ * per online CPU when 0. */
+unsigned cu_parallel_threads(const cu_parallel_opts_t* opts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* CU_PARALLEL_H */
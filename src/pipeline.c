@@ -0,0 +1,804 @@
+/*
+ * pipeline.c — overlapped read → compress → write for cu_compress_file.
+ *
+ * The input is cut into the same chunks cu_compress_parallel uses. A
+ * fixed ring of slots (one chunk-sized input buffer plus one worst-case
+ * output buffer each) cycles through
+ *
+ *   FREE → READING → queued → COMPRESSING → DONE → WRITING → FREE
+ *
+ * Compressed chunks are written strictly in chunk order: a chunk's output
+ * offset is the running total of every chunk before it, so a slot that
+ * finishes early waits in DONE until its turn. Memory is bounded by the
+ * ring no matter how large the file.
+ *
+ * Two engines drive the ring:
+ *
+ *   io_uring  The calling thread owns the ring and issues READ_FIXED /
+ *             WRITE_FIXED against buffers registered once up front, so
+ *             the kernel never re-pins pages per request. Codec workers
+ *             are plain threads; they hand finished slots back through
+ *             an eventfd the ring polls, so one io_uring_enter waits on
+ *             disk and CPU completions alike. Up to every slot can have
+ *             a read or write in flight at once — deep enough queues to
+ *             keep NVMe busy while every core compresses.
+ *
+ *   threads   Fallback when io_uring is unavailable (old kernel, seccomp,
+ *             RLIMIT_MEMLOCK too low for the registered buffers, or
+ *             CU_IO_URING=0). Each worker owns one slot and loops pread →
+ *             compress → wait for its turn → pwrite. Writes land at
+ *             disjoint offsets, so they proceed concurrently. On NUMA
+ *             hosts the workers are spread over the nodes and pinned, so
+ *             a worker's slot buffers and codec tables are node-local.
+ *
+ * The io_uring engine talks to the kernel through the raw syscalls and
+ * <linux/io_uring.h>; there is no liburing dependency.
+ */
+
+#if !defined(_WIN32)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  /* pread/pwrite with 64-bit off_t, eventfd */
+#endif
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include "pipeline.h"
+#include "parallel.h"
+#include "algorithm_registry.h"
+#include "numa.h"
+#include "utils/threads.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(CU_HAVE_IO_URING)
+#  include <linux/io_uring.h>
+#  include <poll.h>
+#  include <sys/eventfd.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <sys/uio.h>
+#endif
+
+/* Slots per compression worker: one compressing while the other's I/O is
+ * in flight. */
+#define CU_PIPELINE_SLOTS_PER_THREAD 2
+
+/* ============================================================================
+ * Shared job state
+ * ============================================================================ */
+
+typedef struct {
+    const cu_algorithm_vtbl_t* v;
+    int         level;
+    size_t      chunk;
+    size_t      slot_out;  /* compress_bound(chunk) */
+    uint64_t    size;
+    size_t      nchunks;
+    int         src_fd;
+    int         dst_fd;
+    const char* src_path;
+    const char* dst_path;
+    unsigned    threads;
+
+    cu_mutex_t  lock;
+    cu_status_t status;    /* first failure, CU_OK while running */
+    char        err[256];
+} pipe_t;
+
+static size_t chunk_len(const pipe_t* p, size_t i) {
+    uint64_t off = (uint64_t)i * p->chunk;
+    return p->size - off < p->chunk ? (size_t)(p->size - off) : p->chunk;
+}
+
+/* Record the first failure. Caller holds p->lock. */
+static void fail_locked(pipe_t* p, cu_status_t s, const char* msg) {
+    if (p->status != CU_OK) return;
+    p->status = s;
+    strncpy(p->err, msg, sizeof(p->err) - 1);
+}
+
+static void fail_io_locked(pipe_t* p, const char* path, const char* what, int err) {
+    char msg[256];
+    snprintf(msg, sizeof(msg), "%s: %s: %s", path, what, strerror(err));
+    fail_locked(p, CU_ERR_IO, msg);
+}
+
+static cu_status_t compress_chunk(pipe_t* p, const uint8_t* in, size_t len,
+                                  uint8_t* out, size_t* out_len) {
+    *out_len = p->slot_out;
+    cu_status_t s = p->v->compress(in, len, out, out_len, p->level);
+    if (s != CU_OK) {
+        /* cu_last_error is thread-local: carry the message home. */
+        cu_mutex_lock(&p->lock);
+        fail_locked(p, s, cu_last_error());
+        cu_mutex_unlock(&p->lock);
+    }
+    return s;
+}
+
+/* ============================================================================
+ * Thread engine: pread → compress → pwrite per worker
+ * ============================================================================ */
+
+typedef struct {
+    pipe_t*   p;
+    size_t    next;      /* next chunk to claim */
+    size_t    turn;      /* chunk whose output offset is assigned next */
+    uint64_t  out_off;   /* running output size */
+    unsigned  joined;    /* workers started so far; picks the NUMA node */
+    cu_cond_t turn_cv;
+} tpipe_t;
+
+static int pread_full(int fd, uint8_t* buf, size_t len, uint64_t off) {
+    while (len) {
+        ssize_t r = pread(fd, buf, len, (off_t)off);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        if (r == 0) return EIO;  /* file shrank under us */
+        buf += r;
+        len -= (size_t)r;
+        off += (uint64_t)r;
+    }
+    return 0;
+}
+
+static int pwrite_full(int fd, const uint8_t* buf, size_t len, uint64_t off) {
+    while (len) {
+        ssize_t r = pwrite(fd, buf, len, (off_t)off);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        buf += r;
+        len -= (size_t)r;
+        off += (uint64_t)r;
+    }
+    return 0;
+}
+
+static void tpipe_worker(void* arg) {
+    tpipe_t* t = (tpipe_t*)arg;
+    pipe_t* p = t->p;
+    cu_mutex_lock(&p->lock);
+    unsigned node = t->joined++;
+    cu_mutex_unlock(&p->lock);
+    cu_numa_binding_t pin;
+    cu_numa_bind(node, &pin);  /* before the slot buffers are first touched */
+
+    uint8_t* in = malloc(p->chunk ? p->chunk : 1);
+    uint8_t* out = malloc(p->slot_out);
+    if (!in || !out) {
+        cu_mutex_lock(&p->lock);
+        fail_locked(p, CU_ERR_OOM, "pipeline: out of memory");
+        cu_cond_broadcast(&t->turn_cv);
+        cu_mutex_unlock(&p->lock);
+        free(in);
+        free(out);
+        cu_numa_unbind(&pin);
+        return;
+    }
+
+    for (;;) {
+        cu_mutex_lock(&p->lock);
+        size_t i = t->next;
+        int stop = p->status != CU_OK || i >= p->nchunks;
+        if (!stop) t->next++;
+        cu_mutex_unlock(&p->lock);
+        if (stop) break;
+
+        size_t len = chunk_len(p, i);
+        int e = pread_full(p->src_fd, in, len, (uint64_t)i * p->chunk);
+        size_t clen = 0;
+        if (e != 0) {
+            cu_mutex_lock(&p->lock);
+            fail_io_locked(p, p->src_path, "read", e);
+            cu_cond_broadcast(&t->turn_cv);
+            cu_mutex_unlock(&p->lock);
+            break;
+        }
+        if (compress_chunk(p, in, len, out, &clen) != CU_OK) {
+            cu_mutex_lock(&p->lock);
+            cu_cond_broadcast(&t->turn_cv);
+            cu_mutex_unlock(&p->lock);
+            break;
+        }
+
+        cu_mutex_lock(&p->lock);
+        while (t->turn != i && p->status == CU_OK) cu_cond_wait(&t->turn_cv, &p->lock);
+        if (p->status != CU_OK) {
+            cu_mutex_unlock(&p->lock);
+            break;
+        }
+        uint64_t off = t->out_off;
+        t->out_off += clen;
+        t->turn++;
+        cu_cond_broadcast(&t->turn_cv);
+        cu_mutex_unlock(&p->lock);
+
+        e = pwrite_full(p->dst_fd, out, clen, off);
+        if (e != 0) {
+            cu_mutex_lock(&p->lock);
+            fail_io_locked(p, p->dst_path, "write", e);
+            cu_cond_broadcast(&t->turn_cv);
+            cu_mutex_unlock(&p->lock);
+            break;
+        }
+    }
+    free(in);
+    free(out);
+    cu_numa_unbind(&pin);
+}
+
+static void run_threads(pipe_t* p, uint64_t* out_size) {
+    tpipe_t t = { .p = p };
+    cu_cond_init(&t.turn_cv);
+
+    unsigned n = p->threads;
+    if ((size_t)n > p->nchunks) n = (unsigned)p->nchunks;
+    cu_thread_t* workers = n > 1 ? malloc((n - 1) * sizeof(*workers)) : NULL;
+    unsigned started = 0;
+    if (workers) {
+        for (unsigned i = 1; i < n; i++) {
+            if (cu_thread_create(&workers[started], tpipe_worker, &t) != 0) break;
+            started++;
+        }
+    }
+    tpipe_worker(&t);
+    for (unsigned i = 0; i < started; i++) cu_thread_join(&workers[i]);
+    free(workers);
+
+    cu_cond_destroy(&t.turn_cv);
+    *out_size = t.out_off;
+}
+
+/* ============================================================================
+ * io_uring engine
+ * ============================================================================ */
+
+#if defined(CU_HAVE_IO_URING)
+
+typedef struct {
+    int                  fd;
+    unsigned*            sq_head;
+    unsigned*            sq_tail;
+    unsigned*            sq_mask;
+    unsigned*            sq_array;
+    struct io_uring_sqe* sqes;
+    unsigned             sq_pending;  /* queued since the last enter */
+    unsigned*            cq_head;
+    unsigned*            cq_tail;
+    unsigned*            cq_mask;
+    struct io_uring_cqe* cqes;
+    void*                sq_map;
+    size_t               sq_map_len;
+    void*                cq_map;      /* == sq_map with IORING_FEAT_SINGLE_MMAP */
+    size_t               cq_map_len;
+    size_t               sqes_len;
+} ring_t;
+
+static int ring_init(ring_t* r, unsigned entries) {
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+    struct io_uring_params prm;
+    memset(&prm, 0, sizeof(prm));
+    int fd = (int)syscall(__NR_io_uring_setup, entries, &prm);
+    if (fd < 0) return -1;
+    r->fd = fd;
+
+    r->sq_map_len = prm.sq_off.array + prm.sq_entries * sizeof(unsigned);
+    r->cq_map_len = prm.cq_off.cqes + prm.cq_entries * sizeof(struct io_uring_cqe);
+    int single = (prm.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && r->cq_map_len > r->sq_map_len) r->sq_map_len = r->cq_map_len;
+
+    r->sq_map = mmap(NULL, r->sq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     fd, IORING_OFF_SQ_RING);
+    if (r->sq_map == MAP_FAILED) {
+        r->sq_map = NULL;
+        return -1;
+    }
+    if (single) {
+        r->cq_map = r->sq_map;
+    } else {
+        r->cq_map = mmap(NULL, r->cq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         fd, IORING_OFF_CQ_RING);
+        if (r->cq_map == MAP_FAILED) {
+            r->cq_map = NULL;
+            return -1;
+        }
+    }
+    r->sqes_len = prm.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        r->sqes = NULL;
+        return -1;
+    }
+
+    uint8_t* sq = r->sq_map;
+    uint8_t* cq = r->cq_map;
+    r->sq_head  = (unsigned*)(sq + prm.sq_off.head);
+    r->sq_tail  = (unsigned*)(sq + prm.sq_off.tail);
+    r->sq_mask  = (unsigned*)(sq + prm.sq_off.ring_mask);
+    r->sq_array = (unsigned*)(sq + prm.sq_off.array);
+    r->cq_head  = (unsigned*)(cq + prm.cq_off.head);
+    r->cq_tail  = (unsigned*)(cq + prm.cq_off.tail);
+    r->cq_mask  = (unsigned*)(cq + prm.cq_off.ring_mask);
+    r->cqes     = (struct io_uring_cqe*)(cq + prm.cq_off.cqes);
+    return 0;
+}
+
+static void ring_exit(ring_t* r) {
+    if (r->sqes) munmap(r->sqes, r->sqes_len);
+    if (r->cq_map && r->cq_map != r->sq_map) munmap(r->cq_map, r->cq_map_len);
+    if (r->sq_map) munmap(r->sq_map, r->sq_map_len);
+    if (r->fd >= 0) close(r->fd);
+}
+
+/* Submit what is queued and, if `wait`, block for at least one completion.
+ * Returns 0 or an errno. */
+static int ring_enter(ring_t* r, int wait) {
+    for (;;) {
+        unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+        int n = (int)syscall(__NR_io_uring_enter, r->fd, r->sq_pending, wait ? 1 : 0,
+                             flags, NULL, 0);
+        if (n >= 0) {
+            r->sq_pending -= (unsigned)n < r->sq_pending ? (unsigned)n : r->sq_pending;
+            if (r->sq_pending == 0 || wait) return 0;
+            continue;
+        }
+        if (errno == EINTR) continue;
+        /* EAGAIN/EBUSY: the CQ is full; the caller reaps and retries. */
+        if (errno == EAGAIN || errno == EBUSY) return 0;
+        return errno;
+    }
+}
+
+static struct io_uring_sqe* ring_sqe(ring_t* r) {
+    unsigned tail = *r->sq_tail;
+    unsigned head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+    if (tail - head > *r->sq_mask) return NULL;  /* never: the ring holds every slot's op */
+    unsigned idx = tail & *r->sq_mask;
+    struct io_uring_sqe* sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    r->sq_array[idx] = idx;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    r->sq_pending++;
+    return sqe;
+}
+
+enum { SLOT_FREE, SLOT_READING, SLOT_QUEUED, SLOT_DONE, SLOT_WRITING };
+enum { OP_READ = 0, OP_WRITE = 1, OP_POLL = 2, OP_CANCEL = 3 };
+
+typedef struct {
+    uint8_t* in;
+    uint8_t* out;
+    int      state;
+    size_t   index;   /* chunk held by this slot */
+    size_t   len;     /* input bytes (READING) / output bytes (DONE, WRITING) */
+    size_t   done;    /* bytes transferred so far by the current op */
+    uint64_t out_off;
+} uslot_t;
+
+typedef struct {
+    pipe_t*   p;
+    uslot_t*  slots;
+    size_t    nslots;
+
+    /* Compression queue and completion list, both under p->lock. */
+    size_t*   queue;       /* FIFO of slot indices, capacity nslots */
+    size_t    q_head, q_len;
+    size_t*   finished;    /* slots compressed since the ring last looked */
+    size_t    n_finished;
+    int       stop;
+    cu_cond_t work_cv;
+    int       efd;         /* eventfd: workers → ring thread */
+} upipe_t;
+
+static void upipe_worker(void* arg) {
+    upipe_t* u = (upipe_t*)arg;
+    pipe_t* p = u->p;
+    cu_mutex_lock(&p->lock);
+    for (;;) {
+        while (!u->stop && u->q_len == 0) cu_cond_wait(&u->work_cv, &p->lock);
+        if (u->stop) break;
+        size_t si = u->queue[u->q_head];
+        u->q_head = (u->q_head + 1) % u->nslots;
+        u->q_len--;
+        cu_mutex_unlock(&p->lock);
+
+        uslot_t* s = &u->slots[si];
+        size_t clen = 0;
+        if (compress_chunk(p, s->in, s->len, s->out, &clen) == CU_OK) s->len = clen;
+
+        cu_mutex_lock(&p->lock);
+        u->finished[u->n_finished++] = si;
+        uint64_t one = 1;
+        ssize_t w = write(u->efd, &one, sizeof(one));
+        (void)w;  /* only fails if the counter would overflow */
+    }
+    cu_mutex_unlock(&p->lock);
+}
+
+static void queue_read(ring_t* r, upipe_t* u, size_t si) {
+    uslot_t* s = &u->slots[si];
+    struct io_uring_sqe* sqe = ring_sqe(r);
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->fd = u->p->src_fd;
+    sqe->off = (uint64_t)s->index * u->p->chunk + s->done;
+    sqe->addr = (uint64_t)(uintptr_t)(s->in + s->done);
+    sqe->len = (unsigned)(s->len - s->done);
+    sqe->buf_index = (uint16_t)(2 * si);
+    sqe->user_data = (uint64_t)si << 2 | OP_READ;
+}
+
+static void queue_write(ring_t* r, upipe_t* u, size_t si) {
+    uslot_t* s = &u->slots[si];
+    struct io_uring_sqe* sqe = ring_sqe(r);
+    sqe->opcode = IORING_OP_WRITE_FIXED;
+    sqe->fd = u->p->dst_fd;
+    sqe->off = s->out_off + s->done;
+    sqe->addr = (uint64_t)(uintptr_t)(s->out + s->done);
+    sqe->len = (unsigned)(s->len - s->done);
+    sqe->buf_index = (uint16_t)(2 * si + 1);
+    sqe->user_data = (uint64_t)si << 2 | OP_WRITE;
+}
+
+static void queue_poll(ring_t* r, upipe_t* u) {
+    struct io_uring_sqe* sqe = ring_sqe(r);
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = u->efd;
+    sqe->poll_events = POLLIN;
+    sqe->user_data = OP_POLL;
+}
+
+/* After a failed io_uring_enter: cancel every read and write the kernel
+ * still owns and reap until none is left, since they target the slot
+ * buffers. Returns 0 once quiet, or an errno if the ring keeps failing. */
+static int quiesce(ring_t* r, upipe_t* u, size_t inflight) {
+    for (size_t si = 0; si < u->nslots; si++) {
+        int st = u->slots[si].state;
+        if (st != SLOT_READING && st != SLOT_WRITING) continue;
+        struct io_uring_sqe* sqe = ring_sqe(r);
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = (uint64_t)si << 2 | (st == SLOT_READING ? OP_READ : OP_WRITE);
+        sqe->user_data = OP_CANCEL;
+    }
+    while (inflight > 0) {
+        int e = ring_enter(r, 1);
+        if (e != 0) return e;
+        unsigned head = *r->cq_head;
+        unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            int op = (int)(r->cqes[head & *r->cq_mask].user_data & 3);
+            if (op == OP_READ || op == OP_WRITE) inflight--;
+        }
+        __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+    }
+    return 0;
+}
+
+/* Hand a read slot to the compressors. Caller holds p->lock. */
+static void enqueue_locked(upipe_t* u, size_t si) {
+    u->slots[si].state = SLOT_QUEUED;
+    u->queue[(u->q_head + u->q_len) % u->nslots] = si;
+    u->q_len++;
+    cu_cond_signal(&u->work_cv);
+}
+
+static void start_chunk(ring_t* r, upipe_t* u, size_t si, size_t index) {
+    uslot_t* s = &u->slots[si];
+    s->index = index;
+    s->len = chunk_len(u->p, index);
+    s->done = 0;
+    if (s->len == 0) {  /* empty input: still one (empty) frame */
+        cu_mutex_lock(&u->p->lock);
+        enqueue_locked(u, si);
+        cu_mutex_unlock(&u->p->lock);
+        return;
+    }
+    s->state = SLOT_READING;
+    queue_read(r, u, si);
+}
+
+/* Returns 1 if the engine ran (result in p->status), 0 if io_uring is not
+ * usable here and the caller should fall back. */
+static int run_uring(pipe_t* p, uint64_t* out_size) {
+    const char* env = getenv("CU_IO_URING");
+    if (env && strcmp(env, "0") == 0) return 0;
+    /* Registered buffers are limited to 1 GiB each, requests to 2 GiB. */
+    if (p->slot_out > ((size_t)1 << 30)) return 0;
+
+    upipe_t u = { .p = p, .efd = -1 };
+    u.nslots = (size_t)p->threads * CU_PIPELINE_SLOTS_PER_THREAD;
+    if (u.nslots > p->nchunks) u.nslots = p->nchunks;
+    if (u.nslots > 0x7fff) u.nslots = 0x7fff;  /* buf_index is 16-bit, two per slot */
+
+    ring_t r;
+    int ran = 0;
+    struct iovec* iov = NULL;
+    cu_thread_t* workers = NULL;
+    unsigned started = 0;
+    int quiet = 1;  /* no kernel op can still touch the slot buffers */
+
+    u.slots = calloc(u.nslots, sizeof(*u.slots));
+    u.queue = malloc(u.nslots * sizeof(*u.queue));
+    u.finished = malloc(u.nslots * sizeof(*u.finished));
+    iov = malloc(2 * u.nslots * sizeof(*iov));
+    if (!u.slots || !u.queue || !u.finished || !iov) goto out;
+    for (size_t i = 0; i < u.nslots; i++) {
+        void* a = NULL;
+        void* b = NULL;
+        if (posix_memalign(&a, 4096, p->chunk ? p->chunk : 1) != 0) goto out;
+        u.slots[i].in = a;
+        if (posix_memalign(&b, 4096, p->slot_out) != 0) goto out;
+        u.slots[i].out = b;
+        iov[2 * i].iov_base = a;
+        iov[2 * i].iov_len = p->chunk ? p->chunk : 1;
+        iov[2 * i + 1].iov_base = b;
+        iov[2 * i + 1].iov_len = p->slot_out;
+    }
+
+    /* Every slot has at most one read or write in flight, plus the
+     * eventfd poll. */
+    if (ring_init(&r, (unsigned)(2 * u.nslots + 1)) != 0) {
+        ring_exit(&r);
+        goto out;
+    }
+    if (syscall(__NR_io_uring_register, r.fd, IORING_REGISTER_BUFFERS, iov,
+                (unsigned)(2 * u.nslots)) != 0) {
+        ring_exit(&r);  /* typically RLIMIT_MEMLOCK */
+        goto out;
+    }
+    u.efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (u.efd < 0) {
+        ring_exit(&r);
+        goto out;
+    }
+
+    /* From here on the engine owns the job: failures are job failures. */
+    ran = 1;
+    cu_cond_init(&u.work_cv);
+    unsigned nworkers = p->threads;
+    if ((size_t)nworkers > p->nchunks) nworkers = (unsigned)p->nchunks;
+    workers = malloc(nworkers * sizeof(*workers));
+    if (workers) {
+        for (unsigned i = 0; i < nworkers; i++) {
+            if (cu_thread_create(&workers[started], upipe_worker, &u) != 0) break;
+            started++;
+        }
+    }
+    if (started == 0) {
+        cu_mutex_lock(&p->lock);
+        fail_locked(p, CU_ERR_INTERNAL, "pipeline: cannot start worker threads");
+        cu_mutex_unlock(&p->lock);
+    }
+
+    size_t next_read = 0;    /* next chunk to read */
+    size_t next_write = 0;   /* next chunk to be written */
+    size_t written = 0;      /* chunks fully on disk */
+    uint64_t out_off = 0;
+    size_t inflight = 0;     /* reads + writes owned by the kernel */
+    int poll_armed = 0;
+    size_t busy = 0;         /* slots queued or compressing */
+    int failed = p->status != CU_OK;
+
+    if (!failed) {
+        queue_poll(&r, &u);
+        poll_armed = 1;
+        for (size_t si = 0; si < u.nslots; si++) {
+            start_chunk(&r, &u, si, next_read++);
+            if (u.slots[si].state == SLOT_READING) inflight++;
+            else busy++;
+        }
+    }
+
+    while (!failed ? written < p->nchunks : (inflight > 0 || busy > 0)) {
+        int e = ring_enter(&r, 1);
+        if (e != 0) {
+            cu_mutex_lock(&p->lock);
+            fail_io_locked(p, "io_uring", "enter", e);
+            cu_mutex_unlock(&p->lock);
+            failed = 1;
+            break;
+        }
+
+        unsigned head = *r.cq_head;
+        unsigned tail = __atomic_load_n(r.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            struct io_uring_cqe* cqe = &r.cqes[head & *r.cq_mask];
+            uint64_t ud = cqe->user_data;
+            int res = cqe->res;
+            size_t si = (size_t)(ud >> 2);
+            uslot_t* s = &u.slots[si];
+
+            if ((ud & 3) == OP_POLL) {
+                poll_armed = 0;
+                uint64_t cnt;
+                ssize_t rd = read(u.efd, &cnt, sizeof(cnt));
+                (void)rd;
+                cu_mutex_lock(&p->lock);
+                for (size_t k = 0; k < u.n_finished; k++) {
+                    u.slots[u.finished[k]].state = SLOT_DONE;
+                    busy--;
+                }
+                u.n_finished = 0;
+                failed |= p->status != CU_OK;
+                cu_mutex_unlock(&p->lock);
+                continue;
+            }
+
+            inflight--;
+            int is_read = (ud & 3) == OP_READ;
+            if (res <= 0) {
+                cu_mutex_lock(&p->lock);
+                if (res == 0) {
+                    fail_io_locked(p, is_read ? p->src_path : p->dst_path,
+                                   is_read ? "read" : "write", EIO);
+                } else {
+                    fail_io_locked(p, is_read ? p->src_path : p->dst_path,
+                                   is_read ? "read" : "write", -res);
+                }
+                cu_mutex_unlock(&p->lock);
+                failed = 1;
+                s->state = SLOT_FREE;
+                continue;
+            }
+            s->done += (size_t)res;
+            if (s->done < s->len) {
+                /* Short transfer: issue the remainder. */
+                if (!failed) {
+                    if (is_read) queue_read(&r, &u, si);
+                    else queue_write(&r, &u, si);
+                    inflight++;
+                } else {
+                    s->state = SLOT_FREE;
+                }
+                continue;
+            }
+            if (is_read) {
+                if (failed) {
+                    s->state = SLOT_FREE;
+                    continue;
+                }
+                cu_mutex_lock(&p->lock);
+                enqueue_locked(&u, si);
+                cu_mutex_unlock(&p->lock);
+                busy++;
+            } else {
+                s->state = SLOT_FREE;
+                written++;
+                if (!failed && next_read < p->nchunks) {
+                    start_chunk(&r, &u, si, next_read++);
+                    if (s->state == SLOT_READING) inflight++;
+                    else busy++;
+                }
+            }
+        }
+        __atomic_store_n(r.cq_head, head, __ATOMIC_RELEASE);
+
+        /* Issue writes for every chunk whose turn has come. */
+        while (!failed && next_write < p->nchunks) {
+            size_t si = u.nslots;
+            for (size_t k = 0; k < u.nslots; k++) {
+                if (u.slots[k].state == SLOT_DONE && u.slots[k].index == next_write) {
+                    si = k;
+                    break;
+                }
+            }
+            if (si == u.nslots) break;
+            uslot_t* s = &u.slots[si];
+            s->state = SLOT_WRITING;
+            s->out_off = out_off;
+            s->done = 0;
+            out_off += s->len;
+            next_write++;
+            if (s->len == 0) {  /* nothing to write */
+                s->state = SLOT_FREE;
+                written++;
+                if (next_read < p->nchunks) {
+                    start_chunk(&r, &u, si, next_read++);
+                    if (s->state == SLOT_READING) inflight++;
+                    else busy++;
+                }
+                continue;
+            }
+            queue_write(&r, &u, si);
+            inflight++;
+        }
+
+        if (!poll_armed && (busy > 0 || (!failed && written < p->nchunks))) {
+            queue_poll(&r, &u);
+            poll_armed = 1;
+        }
+    }
+
+    /* Only an enter failure leaves ops in flight. Tearing the ring down
+     * doesn't wait for them, so cancel and reap them first; if even that
+     * fails, leak the buffers rather than free memory the kernel may still
+     * read or write. */
+    if (inflight > 0) quiet = quiesce(&r, &u, inflight) == 0;
+
+    cu_mutex_lock(&p->lock);
+    u.stop = 1;
+    cu_cond_broadcast(&u.work_cv);
+    cu_mutex_unlock(&p->lock);
+    for (unsigned i = 0; i < started; i++) cu_thread_join(&workers[i]);
+    free(workers);
+    cu_cond_destroy(&u.work_cv);
+    ring_exit(&r);
+    close(u.efd);
+    *out_size = out_off;
+
+out:
+    if (u.slots && quiet) {
+        for (size_t i = 0; i < u.nslots; i++) {
+            free(u.slots[i].in);
+            free(u.slots[i].out);
+        }
+    }
+    free(u.slots);
+    free(u.queue);
+    free(u.finished);
+    free(iov);
+    return ran;
+}
+
+#endif  /* CU_HAVE_IO_URING */
+
+/* ============================================================================
+ * Entry point
+ * ============================================================================ */
+
+cu_status_t cu_pipeline_compress(
+    cu_algorithm_t algo, int level, const cu_parallel_opts_t* opts,
+    int src_fd, uint64_t src_size, const char* src_path,
+    int dst_fd, const char* dst_path,
+    uint64_t* out_size
+) {
+    const cu_algorithm_vtbl_t* v = cu_registry_lookup(algo);
+    size_t chunk = cu_parallel_chunk_size(algo, opts);
+    if (!v || chunk == 0) {
+        cu_set_last_errorf("algorithm %d has no parallel mode in this build", (int)algo);
+        return CU_ERR_UNSUPPORTED_ALGO;
+    }
+
+    pipe_t p = {
+        .v = v, .level = level, .chunk = chunk, .slot_out = v->compress_bound(chunk),
+        .size = src_size, .src_fd = src_fd, .dst_fd = dst_fd,
+        .src_path = src_path, .dst_path = dst_path,
+        .threads = cu_parallel_threads(opts), .status = CU_OK,
+    };
+    /* Same layout as cu_compress_parallel: an empty input is one empty frame. */
+    p.nchunks = src_size == 0 ? 1 : (size_t)((src_size + chunk - 1) / chunk);
+    /* A chunk shorter than the input need not be buffered at full size. */
+    if ((uint64_t)p.chunk > src_size) {
+        p.chunk = (size_t)src_size;
+        p.slot_out = v->compress_bound(p.chunk);
+    }
+    cu_mutex_init(&p.lock);
+
+    *out_size = 0;
+    int done = 0;
+#if defined(CU_HAVE_IO_URING)
+    done = run_uring(&p, out_size);
+#endif
+    if (!done) run_threads(&p, out_size);
+
+    cu_mutex_destroy(&p.lock);
+    if (p.status != CU_OK) {
+        cu_set_last_error(p.err);
+        return p.status;
+    }
+    cu_clear_last_error();
+    return CU_OK;
+}
+
+#endif  /* !_WIN32 */
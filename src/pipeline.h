@@ -0,0 +1,40 @@
+/*
+ * pipeline.h — overlapped read → compress → write engine behind
+ * cu_compress_file's parallel path (POSIX only).
+ *
+ * This header is internal — consumers must not include it.
+ */
+
+#ifndef CU_PIPELINE_H
+#define CU_PIPELINE_H
+
+#include "compress_utils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Compress src_size bytes of src_fd into dst_fd (from offset 0) as the
+ * same frame sequence cu_compress_parallel would produce over the whole
+ * input. Reads, codec work and writes overlap; resident memory is a
+ * fixed ring of chunk-sized buffers. Uses io_uring where the kernel and
+ * build allow it (set CU_IO_URING=0 in the environment to opt out), and
+ * pread/pwrite worker threads otherwise. The paths are only used in
+ * error messages. On success *out_size is the number of bytes written.
+ */
+cu_status_t cu_pipeline_compress(
+    cu_algorithm_t algo, int level, const cu_parallel_opts_t* opts,
+    int src_fd, uint64_t src_size, const char* src_path,
+    int dst_fd, const char* dst_path,
+    uint64_t* out_size
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* CU_PIPELINE_H */
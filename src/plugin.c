@@ -0,0 +1,68 @@
+/*
+ * plugin.c — the glue linked into every codec module (see plugin.h).
+ *
+ * Compiled once per module with CU_PLUGIN_VTBL naming the codec's vtable
+ * (e.g. -DCU_PLUGIN_VTBL=cu_zstd_vtbl). It provides the internal core
+ * functions the vtable sources call, each forwarding to the host the core
+ * passed in, and exports the entry point. Everything else stays hidden,
+ * so two modules never see each other's symbols.
+ */
+
+#include "algorithm_registry.h"
+#include "alloc.h"
+#include "plugin.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#ifndef CU_PLUGIN_VTBL
+#  error "CU_PLUGIN_VTBL must name the codec's vtable"
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define CU_PLUGIN_EXPORT __attribute__((visibility("default")))
+#else
+#  define CU_PLUGIN_EXPORT
+#endif
+
+/* Same bound as the core's thread-local buffer. */
+#define CU_PLUGIN_ERROR_LEN 256
+
+extern const cu_algorithm_vtbl_t CU_PLUGIN_VTBL;
+
+/* Set before the vtable is handed out; nothing runs before that. */
+static const cu_plugin_host_t* g_host;
+
+void cu_set_last_error(const char* msg) {
+    g_host->set_last_error(msg);
+}
+
+void cu_set_last_errorf(const char* fmt, ...) {
+    char buf[CU_PLUGIN_ERROR_LEN];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    g_host->set_last_error(n < 0 ? "" : buf);
+}
+
+size_t cu_get_max_decompressed_size(void) {
+    return g_host->get_max_decompressed_size();
+}
+
+void* cu_codec_alloc(void* opaque, size_t size) {
+    return g_host->codec_alloc(opaque, size);
+}
+
+void cu_codec_free(void* opaque, void* ptr) {
+    g_host->codec_free(opaque, ptr);
+}
+
+CU_PLUGIN_EXPORT const cu_algorithm_vtbl_t* cu_plugin_vtbl(const cu_plugin_host_t* host) {
+    if (!host || host->abi_version != CU_PLUGIN_ABI_VERSION ||
+        host->vtbl_size != sizeof(cu_algorithm_vtbl_t)) {
+        return NULL;
+    }
+    g_host = host;
+    return &CU_PLUGIN_VTBL;
+}
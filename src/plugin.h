@@ -0,0 +1,54 @@
+/*
+ * plugin.h — the contract between the plugin core (libcompress_utils_core,
+ * built with BUILD_CODEC_PLUGINS) and its per-codec modules.
+ *
+ * A module is one codec's vtable source plus its upstream library, linked
+ * into a loadable object named CU_PLUGIN_PREFIX "<algo>" [_compress |
+ * _decompress] CU_PLUGIN_SUFFIX. The directional modules are built with
+ * CU_OMIT_DECOMPRESS / CU_OMIT_COMPRESS, exactly like the WASM direction
+ * split. registry.c loads a codec's module(s) the first time
+ * cu_registry_lookup sees it; see there for the search order.
+ *
+ * A module links none of the core. The few core services a vtable calls
+ * (error reporting, the decompression cap, the codec allocator) reach it
+ * through the cu_plugin_host_t the core hands to the module's single
+ * export, CU_PLUGIN_ENTRY, which returns the module's vtable — or NULL if
+ * it was built against a different layout.
+ *
+ * This header is internal — consumers must not include it.
+ */
+
+#ifndef CU_PLUGIN_H
+#define CU_PLUGIN_H
+
+#include "algorithm_registry.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bump whenever cu_plugin_host_t or cu_algorithm_vtbl_t changes shape. */
+#define CU_PLUGIN_ABI_VERSION 1
+
+#define CU_PLUGIN_PREFIX "cu_plugin_"
+#define CU_PLUGIN_SUFFIX ".so"
+#define CU_PLUGIN_ENTRY  "cu_plugin_vtbl"
+
+typedef struct cu_plugin_host {
+    unsigned abi_version;
+    size_t   vtbl_size;
+    void   (*set_last_error)(const char* msg);
+    size_t (*get_max_decompressed_size)(void);
+    void*  (*codec_alloc)(void* opaque, size_t size);
+    void   (*codec_free)(void* opaque, void* ptr);
+} cu_plugin_host_t;
+
+typedef const cu_algorithm_vtbl_t* (*cu_plugin_entry_fn)(const cu_plugin_host_t* host);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* CU_PLUGIN_H */
@@ -8,11 +8,21 @@
  * A switch statement (rather than an array indexed by enum value)
  * handles holes from disabled algorithms cleanly: unavailable algorithms
  * simply have no case and the default returns NULL.
+ *
+ * The plugin core (CU_CODEC_PLUGINS, built by BUILD_CODEC_PLUGINS) links
+ * no codec at all: the first lookup of an algorithm loads its module(s)
+ * with dlopen instead (see plugin.h and the second half of this file).
  */
 
+#if defined(CU_CODEC_PLUGINS) && !defined(_GNU_SOURCE)
+#  define _GNU_SOURCE  /* dladdr */
+#endif
+
 #include "algorithm_registry.h"
 #include "compress_utils.h"
 
+#ifndef CU_CODEC_PLUGINS
+
 #ifdef INCLUDE_ZSTD
 extern const cu_algorithm_vtbl_t cu_zstd_vtbl;
 #endif
@@ -68,3 +78,194 @@ const cu_algorithm_vtbl_t* cu_registry_lookup(cu_algorithm_t algo) {
         default:             return NULL;
     }
 }
+
+#else  /* CU_CODEC_PLUGINS */
+
+#include "alloc.h"
+#include "plugin.h"
+
+#include <dlfcn.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Modules are looked up in $CU_PLUGIN_DIR, else in the directory the core
+ * library itself was loaded from. For each codec the first lookup tries
+ * CU_PLUGIN_PREFIX "<algo>" (both directions) and otherwise merges
+ * whichever of "<algo>_compress" / "<algo>_decompress" exist, so a
+ * decompress-only deployment ships just the decoder modules. Entry points
+ * of a missing direction fail with CU_ERR_UNSUPPORTED_ALGO. The outcome,
+ * success or not, is cached; modules are never unloaded. One more slot
+ * past the algorithms holds zip's raw DEFLATE module.
+ */
+
+#define CU_SLOT_RAW_DEFLATE (CU_ALGO_GZIP + 1)
+#define CU_PLUGIN_SLOTS     (CU_SLOT_RAW_DEFLATE + 1)
+
+enum { SLOT_UNTRIED = 0, SLOT_LOADED, SLOT_MISSING };
+
+static const char* const g_stems[CU_PLUGIN_SLOTS] = {
+    [CU_ALGO_ZSTD] = "zstd",     [CU_ALGO_BROTLI] = "brotli",
+    [CU_ALGO_ZLIB] = "zlib",     [CU_ALGO_BZ2]    = "bz2",
+    [CU_ALGO_LZ4]  = "lz4",      [CU_ALGO_XZ]     = "xz",
+    [CU_ALGO_SNAPPY] = "snappy", [CU_ALGO_GZIP]   = "gzip",
+    [CU_SLOT_RAW_DEFLATE] = "deflate",
+};
+
+static struct {
+    int                        state;  /* SLOT_*; published with release */
+    const cu_algorithm_vtbl_t* vtbl;
+    cu_algorithm_vtbl_t        merged; /* directional modules */
+} g_slots[CU_PLUGIN_SLOTS];
+
+static pthread_mutex_t g_plugin_lock = PTHREAD_MUTEX_INITIALIZER;
+static char            g_plugin_dir[PATH_MAX];
+
+static const cu_plugin_host_t g_host = {
+    CU_PLUGIN_ABI_VERSION,
+    sizeof(cu_algorithm_vtbl_t),
+    cu_set_last_error,
+    cu_get_max_decompressed_size,
+    cu_codec_alloc,
+    cu_codec_free,
+};
+
+/* Stand-ins for the entry points of a direction with no module. */
+static cu_status_t missing(const char* direction) {
+    cu_set_last_errorf("no %s module is installed for this algorithm", direction);
+    return CU_ERR_UNSUPPORTED_ALGO;
+}
+static size_t no_compress_bound(size_t in_len) {
+    (void)in_len;
+    return 0;
+}
+static cu_status_t no_compress(const uint8_t* in, size_t in_len,
+                               uint8_t* out, size_t* out_len, int level) {
+    (void)in; (void)in_len; (void)out; (void)out_len; (void)level;
+    return missing("compress");
+}
+static cu_status_t no_compress_stream(int level, void** out_state) {
+    (void)level; (void)out_state;
+    return missing("compress");
+}
+static cu_status_t no_decompress(const uint8_t* in, size_t in_len,
+                                 uint8_t* out, size_t* out_len) {
+    (void)in; (void)in_len; (void)out; (void)out_len;
+    return missing("decompress");
+}
+static cu_status_t no_size_hint(const uint8_t* in, size_t in_len, size_t* out_size) {
+    (void)in; (void)in_len; (void)out_size;
+    return missing("decompress");
+}
+static cu_status_t no_frame_info(const uint8_t* in, size_t in_len, cu_frame_info_t* info) {
+    (void)in; (void)in_len; (void)info;
+    return missing("decompress");
+}
+static cu_status_t no_decompress_stream(void** out_state) {
+    (void)out_state;
+    return missing("decompress");
+}
+
+/* Caller holds g_plugin_lock. */
+static const char* plugin_dir(void) {
+    if (g_plugin_dir[0]) return g_plugin_dir;
+    const char* env = getenv("CU_PLUGIN_DIR");
+    Dl_info info;
+    if (env && *env) {
+        snprintf(g_plugin_dir, sizeof(g_plugin_dir), "%s", env);
+    } else if (dladdr((void*)&cu_registry_lookup, &info) && info.dli_fname) {
+        const char* slash = strrchr(info.dli_fname, '/');
+        if (slash) {
+            snprintf(g_plugin_dir, sizeof(g_plugin_dir), "%.*s",
+                     (int)(slash - info.dli_fname), info.dli_fname);
+        }
+    }
+    if (!g_plugin_dir[0]) snprintf(g_plugin_dir, sizeof(g_plugin_dir), ".");
+    return g_plugin_dir;
+}
+
+static const cu_algorithm_vtbl_t* load_module(const char* stem, const char* direction) {
+    char path[PATH_MAX];
+    int n = snprintf(path, sizeof(path), "%s/" CU_PLUGIN_PREFIX "%s%s" CU_PLUGIN_SUFFIX,
+                     plugin_dir(), stem, direction);
+    if (n < 0 || (size_t)n >= sizeof(path)) return NULL;
+    void* handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) return NULL;
+    cu_plugin_entry_fn entry;
+    *(void**)&entry = dlsym(handle, CU_PLUGIN_ENTRY);
+    const cu_algorithm_vtbl_t* v = entry ? entry(&g_host) : NULL;
+    if (!v) dlclose(handle);
+    return v;
+}
+
+/* One vtable out of a compress-only and a decompress-only module, either
+ * of which may be NULL (not both). */
+static void merge(cu_algorithm_vtbl_t* m,
+                  const cu_algorithm_vtbl_t* c, const cu_algorithm_vtbl_t* d) {
+    *m = c ? *c : *d;
+    if (!c) {
+        m->compress_bound         = no_compress_bound;
+        m->compress               = no_compress;
+        m->compress_stream_create = no_compress_stream;
+    }
+    if (!d) {
+        m->decompress               = no_decompress;
+        m->decompress_size_hint     = no_size_hint;
+        m->frame_info               = no_frame_info;
+        m->decompress_stream_create = no_decompress_stream;
+    } else if (c) {
+        m->decompress                = d->decompress;
+        m->decompress_size_hint      = d->decompress_size_hint;
+        m->frame_info                = d->frame_info;
+        m->decompress_stream_create  = d->decompress_stream_create;
+        m->decompress_stream_write   = d->decompress_stream_write;
+        m->decompress_stream_finish  = d->decompress_stream_finish;
+        m->decompress_stream_destroy = d->decompress_stream_destroy;
+        m->decompress_stream_set_skip_checksum = d->decompress_stream_set_skip_checksum;
+    }
+}
+
+static const cu_algorithm_vtbl_t* load_slot(unsigned slot) {
+    pthread_mutex_lock(&g_plugin_lock);
+    if (g_slots[slot].state == SLOT_UNTRIED) {
+        const char* stem = g_stems[slot];
+        const cu_algorithm_vtbl_t* v = load_module(stem, "");
+        if (!v) {
+            const cu_algorithm_vtbl_t* c = load_module(stem, "_compress");
+            const cu_algorithm_vtbl_t* d = load_module(stem, "_decompress");
+            if (c || d) {
+                merge(&g_slots[slot].merged, c, d);
+                v = &g_slots[slot].merged;
+            }
+        }
+        g_slots[slot].vtbl = v;
+        __atomic_store_n(&g_slots[slot].state, v ? SLOT_LOADED : SLOT_MISSING,
+                         __ATOMIC_RELEASE);
+    }
+    const cu_algorithm_vtbl_t* v = g_slots[slot].vtbl;
+    pthread_mutex_unlock(&g_plugin_lock);
+    return v;
+}
+
+static const cu_algorithm_vtbl_t* lookup_slot(unsigned slot) {
+    switch (__atomic_load_n(&g_slots[slot].state, __ATOMIC_ACQUIRE)) {
+        case SLOT_LOADED:  return g_slots[slot].vtbl;
+        case SLOT_MISSING: return NULL;
+        default:           return load_slot(slot);
+    }
+}
+
+const cu_algorithm_vtbl_t* cu_registry_lookup(cu_algorithm_t algo) {
+    if (algo == CU_ALGO_LZMA) algo = CU_ALGO_XZ;  /* alias */
+    if ((unsigned)algo >= CU_SLOT_RAW_DEFLATE || !g_stems[algo]) return NULL;
+    return lookup_slot((unsigned)algo);
+}
+
+const cu_algorithm_vtbl_t* cu_registry_raw_deflate(void) {
+    return lookup_slot(CU_SLOT_RAW_DEFLATE);
+}
+
+#endif  /* CU_CODEC_PLUGINS */
@@ -0,0 +1,1205 @@
+/*
+ * tar.c — streaming ustar/pax archives over the compression engines.
+ *
+ * Writer: tar bytes are staged in a window of whole parallel chunks
+ * (threads × 2 of them). A full window is compressed chunk-per-frame on
+ * the parallel workers and written out, so the file is exactly what
+ * cu_compress_parallel would produce for the whole tar. Codecs without a
+ * parallel mode push the window through one cu_compress_stream_t.
+ *
+ * Reader: the archive is decoded through a cu_decompress_stream_t a
+ * buffer at a time and parsed block by block.
+ *
+ * Index (CU_TAR_INDEX): since every chunk is its own frame, a member whose
+ * data starts at tar offset U lives in frame U / chunk. The index records
+ * the chunk size, every frame's compressed size and every member's
+ * offsets, so extraction seeks straight to that frame and decodes from
+ * there. It is stored after the archive as a skippable frame:
+ *
+ *   u32 0x184D2A5E, u32 payload size          skippable frame header
+ *   "CUTARIX1"                                payload: magic
+ *   u64 chunk, u64 nframes, u64 csize[nframes]
+ *   u64 nmembers, then per member:
+ *     u64 data_off, u64 size, u8 type, u16 name_len, name bytes
+ *   u32 total frame size, "CUTARIX1"          footer (last 12 bytes)
+ *
+ * All integers little-endian. The footer lets a reader find the index
+ * from the end of the file with one small read.
+ */
+
+#if !defined(_WIN32)
+#  ifndef _FILE_OFFSET_BITS
+#    define _FILE_OFFSET_BITS 64
+#  endif
+#  ifndef _POSIX_C_SOURCE
+#    define _POSIX_C_SOURCE 200809L  /* fseeko, lstat, readlink */
+#  endif
+#endif
+
+#include "compress_utils.h"
+#include "algorithm_registry.h"
+#include "parallel.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(_WIN32)
+#  define cu_fseek _fseeki64
+#  define cu_ftell _ftelli64
+#else
+#  include <unistd.h>
+#  define cu_fseek fseeko
+#  define cu_ftell ftello
+#endif
+
+#define TAR_BLOCK        512
+#define TAR_OCTAL_MAX    077777777777ULL  /* largest size a 12-byte field holds */
+#define TAR_READ_BUF     ((size_t)1 << 20)
+#define TAR_STREAM_WIN   ((size_t)1 << 20)  /* window for non-parallel codecs */
+
+#define IDX_SKIPPABLE    0x184D2A5Eu
+#define IDX_MAGIC        "CUTARIX1"
+#define IDX_FOOTER       12
+
+static cu_status_t io_error(const char* path, const char* what) {
+    cu_set_last_errorf("%s: %s: %s", path, what, strerror(errno));
+    return CU_ERR_IO;
+}
+
+static cu_status_t oom(void) {
+    cu_set_last_error("tar: out of memory");
+    return CU_ERR_OOM;
+}
+
+static char* dup_str(const char* s) {
+    size_t n = strlen(s) + 1;
+    char* d = malloc(n);
+    if (d) memcpy(d, s, n);
+    return d;
+}
+
+static void put_le32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+static void put_le64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+static uint32_t get_le32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = v << 8 | p[i];
+    return v;
+}
+static uint64_t get_le64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = v << 8 | p[i];
+    return v;
+}
+
+/* ============================================================================
+ * Writer
+ * ============================================================================ */
+
+typedef struct {
+    uint64_t data_off;
+    uint64_t size;
+    char     type;
+    char*    name;
+} idx_member_t;
+
+struct cu_tar_writer {
+    FILE*                      f;
+    char*                      path;
+    const cu_algorithm_vtbl_t* v;
+    int                        level;
+    unsigned                   flags;
+    unsigned                   threads;
+    size_t                     chunk;     /* 0: no parallel mode, use cs */
+    cu_compress_stream_t*      cs;
+
+    uint8_t*                   win;       /* staged tar bytes */
+    size_t                     win_cap;
+    size_t                     win_len;
+    uint8_t*                   out;       /* compressed window */
+    size_t                     out_cap;
+    size_t*                    lens;      /* per-chunk compressed size */
+    cu_status_t*               status;    /* per-chunk result */
+
+    uint64_t                   tar_pos;   /* tar bytes produced so far */
+
+    uint64_t*                  frames;    /* index: compressed frame sizes */
+    size_t                     n_frames;
+    size_t                     frames_cap;
+    idx_member_t*              members;
+    size_t                     n_members;
+    size_t                     members_cap;
+
+    int                        finished;
+    int                        failed;
+};
+
+typedef struct {
+    cu_tar_writer_t* w;
+    size_t           n_in;     /* bytes of window being compressed */
+    size_t           slot;     /* compress_bound(chunk) */
+} tar_job_t;
+
+static void tar_compress_chunk(void* ctx, size_t i) {
+    tar_job_t* job = (tar_job_t*)ctx;
+    cu_tar_writer_t* w = job->w;
+    size_t off = i * w->chunk;
+    size_t n = job->n_in - off < w->chunk ? job->n_in - off : w->chunk;
+    size_t cap = job->slot;
+    w->status[i] = w->v->compress(w->win + off, n, w->out + i * job->slot, &cap, w->level);
+    w->lens[i] = cap;
+}
+
+static cu_status_t writer_fail(cu_tar_writer_t* w, cu_status_t s) {
+    w->failed = 1;
+    return s;
+}
+
+static cu_status_t write_out(cu_tar_writer_t* w, const uint8_t* p, size_t n) {
+    if (n && fwrite(p, 1, n, w->f) != n) return writer_fail(w, io_error(w->path, "write"));
+    return CU_OK;
+}
+
+static cu_status_t push_frame(cu_tar_writer_t* w, uint64_t csize) {
+    if (!(w->flags & CU_TAR_INDEX)) return CU_OK;
+    if (w->n_frames == w->frames_cap) {
+        size_t cap = w->frames_cap ? w->frames_cap * 2 : 64;
+        uint64_t* nf = realloc(w->frames, cap * sizeof(*nf));
+        if (!nf) return writer_fail(w, oom());
+        w->frames = nf;
+        w->frames_cap = cap;
+    }
+    w->frames[w->n_frames++] = csize;
+    return CU_OK;
+}
+
+/* Compress and write the staged window. Except at the end the window
+ * holds whole chunks only. */
+static cu_status_t flush_window(cu_tar_writer_t* w, int final) {
+    if (w->chunk == 0) {
+        const uint8_t* in = w->win;
+        size_t in_len = w->win_len;
+        for (;;) {
+            size_t n = w->out_cap;
+            cu_status_t s = cu_compress_stream_write(w->cs, in, in_len, w->out, &n);
+            if (s != CU_OK && s != CU_ERR_BUF_TOO_SMALL) return writer_fail(w, s);
+            cu_status_t ws = write_out(w, w->out, n);
+            if (ws != CU_OK) return ws;
+            if (s == CU_OK) break;
+            in = NULL;
+            in_len = 0;
+        }
+        w->win_len = 0;
+        if (!final) return CU_OK;
+        for (;;) {
+            size_t n = w->out_cap;
+            cu_status_t s = cu_compress_stream_finish(w->cs, w->out, &n);
+            if (s != CU_OK && s != CU_ERR_BUF_TOO_SMALL) return writer_fail(w, s);
+            cu_status_t ws = write_out(w, w->out, n);
+            if (ws != CU_OK) return ws;
+            if (s == CU_OK) return CU_OK;
+        }
+    }
+
+    if (w->win_len == 0) return CU_OK;
+    tar_job_t job = { .w = w, .n_in = w->win_len, .slot = w->v->compress_bound(w->chunk) };
+    size_t nchunks = (w->win_len + w->chunk - 1) / w->chunk;
+    cu_parallel_for(w->threads, nchunks, tar_compress_chunk, &job);
+    for (size_t i = 0; i < nchunks; i++) {
+        if (w->status[i] != CU_OK) {
+            /* The codec's own message stayed on the worker's thread. */
+            cu_set_last_errorf("tar: %s failed on chunk at tar offset %llu",
+                               w->v->name, (unsigned long long)(w->tar_pos - w->win_len + i * w->chunk));
+            return writer_fail(w, w->status[i]);
+        }
+        cu_status_t s = write_out(w, w->out + i * job.slot, w->lens[i]);
+        if (s != CU_OK) return s;
+        s = push_frame(w, w->lens[i]);
+        if (s != CU_OK) return s;
+    }
+    w->win_len = 0;
+    return CU_OK;
+}
+
+/* Space in the window, flushing it first when full. */
+static cu_status_t win_space(cu_tar_writer_t* w, uint8_t** p, size_t* avail) {
+    if (w->win_len == w->win_cap) {
+        cu_status_t s = flush_window(w, 0);
+        if (s != CU_OK) return s;
+    }
+    *p = w->win + w->win_len;
+    *avail = w->win_cap - w->win_len;
+    return CU_OK;
+}
+
+static void win_commit(cu_tar_writer_t* w, size_t n) {
+    w->win_len += n;
+    w->tar_pos += n;
+}
+
+static cu_status_t emit(cu_tar_writer_t* w, const uint8_t* data, size_t len) {
+    while (len) {
+        uint8_t* p;
+        size_t avail;
+        cu_status_t s = win_space(w, &p, &avail);
+        if (s != CU_OK) return s;
+        size_t n = len < avail ? len : avail;
+        if (data) {
+            memcpy(p, data, n);
+            data += n;
+        } else {
+            memset(p, 0, n);
+        }
+        win_commit(w, n);
+        len -= n;
+    }
+    return CU_OK;
+}
+
+static cu_status_t emit_padding(cu_tar_writer_t* w) {
+    size_t rem = (size_t)(w->tar_pos % TAR_BLOCK);
+    return rem ? emit(w, NULL, TAR_BLOCK - rem) : CU_OK;
+}
+
+/* Octal field with trailing NUL; 0 if it does not fit. */
+static int put_octal(char* field, size_t width, uint64_t v) {
+    char tmp[32];
+    int n = snprintf(tmp, sizeof(tmp), "%0*llo", (int)(width - 1), (unsigned long long)v);
+    if (n < 0 || (size_t)n > width - 1) return 0;
+    memcpy(field, tmp, (size_t)n + 1);
+    return 1;
+}
+
+/* Append one "len key=value\n" pax record. The length counts itself. */
+static int pax_record(char* buf, size_t cap, size_t* used, const char* key, const char* val) {
+    size_t body = 1 + strlen(key) + 1 + strlen(val) + 1;  /* " key=val\n" */
+    size_t len = body + 1;
+    while (1) {
+        char digits[24];
+        size_t d = (size_t)snprintf(digits, sizeof(digits), "%zu", len);
+        if (d + body == len) break;
+        len = d + body;
+    }
+    if (*used + len > cap) return 0;
+    snprintf(buf + *used, len + 1, "%zu %s=%s\n", len, key, val);
+    *used += len;
+    return 1;
+}
+
+static void header_checksum(uint8_t* h) {
+    memset(h + 148, ' ', 8);
+    unsigned sum = 0;
+    for (int i = 0; i < TAR_BLOCK; i++) sum += h[i];
+    snprintf((char*)h + 148, 8, "%06o", sum);
+    h[155] = ' ';
+}
+
+static void fill_header(uint8_t* h, const char* name, const char* prefix, uint32_t mode,
+                        uint64_t size, int64_t mtime, char type, const char* linkname) {
+    memset(h, 0, TAR_BLOCK);
+    memcpy(h, name, strlen(name) < 100 ? strlen(name) : 100);
+    put_octal((char*)h + 100, 8, mode & 07777);
+    put_octal((char*)h + 108, 8, 0);
+    put_octal((char*)h + 116, 8, 0);
+    put_octal((char*)h + 124, 12, size);
+    put_octal((char*)h + 136, 12, mtime > 0 ? (uint64_t)mtime : 0);
+    h[156] = (uint8_t)type;
+    if (linkname) memcpy(h + 157, linkname, strlen(linkname) < 100 ? strlen(linkname) : 100);
+    memcpy(h + 257, "ustar", 6);
+    memcpy(h + 263, "00", 2);
+    if (prefix) memcpy(h + 345, prefix, strlen(prefix) < 155 ? strlen(prefix) : 155);
+    header_checksum(h);
+}
+
+static cu_status_t record_member(cu_tar_writer_t* w, const char* name, uint64_t size, char type) {
+    if (!(w->flags & CU_TAR_INDEX)) return CU_OK;
+    if (w->n_members == w->members_cap) {
+        size_t cap = w->members_cap ? w->members_cap * 2 : 64;
+        idx_member_t* nm = realloc(w->members, cap * sizeof(*nm));
+        if (!nm) return writer_fail(w, oom());
+        w->members = nm;
+        w->members_cap = cap;
+    }
+    idx_member_t* m = &w->members[w->n_members];
+    m->name = dup_str(name);
+    if (!m->name || strlen(name) > 0xffff) {
+        free(m->name);
+        return writer_fail(w, m->name ? CU_ERR_INVALID_ARG : oom());
+    }
+    m->data_off = w->tar_pos;
+    m->size = size;
+    m->type = type;
+    w->n_members++;
+    return CU_OK;
+}
+
+/* Emit the header(s) for one member: a pax 'x' header first when the
+ * name, link target or size does not fit ustar. */
+static cu_status_t write_header(cu_tar_writer_t* w, const char* name, uint32_t mode,
+                                uint64_t size, int64_t mtime, char type, const char* linkname) {
+    size_t name_len = strlen(name);
+    if (name_len == 0) {
+        cu_set_last_error("tar: empty member name");
+        return CU_ERR_INVALID_ARG;
+    }
+
+    /* ustar: up to 100 bytes of name, or a prefix of up to 155 split off
+     * at a '/'. */
+    char prefix[156] = "";
+    const char* base = name;
+    int need_pax_path = 0;
+    if (name_len > 100) {
+        need_pax_path = 1;
+        for (size_t i = name_len - 1; i > 0; i--) {
+            if (name[i] != '/' || i > 155 || name_len - i - 1 > 100 || i + 1 == name_len) continue;
+            memcpy(prefix, name, i);
+            prefix[i] = '\0';
+            base = name + i + 1;
+            need_pax_path = 0;
+            break;
+        }
+    }
+    int need_pax_link = linkname && strlen(linkname) > 100;
+    int need_pax_size = size > TAR_OCTAL_MAX;
+
+    if (need_pax_path || need_pax_link || need_pax_size) {
+        size_t cap = 64 + 2 * (name_len + (linkname ? strlen(linkname) : 0)) + 64;
+        char* pax = malloc(cap);
+        if (!pax) return writer_fail(w, oom());
+        size_t used = 0;
+        char num[24];
+        if (need_pax_path) pax_record(pax, cap, &used, "path", name);
+        if (need_pax_link) pax_record(pax, cap, &used, "linkpath", linkname);
+        if (need_pax_size) {
+            snprintf(num, sizeof(num), "%llu", (unsigned long long)size);
+            pax_record(pax, cap, &used, "size", num);
+        }
+        /* The pax header's own name is informational; keep it short. */
+        char xname[100];
+        const char* slash = strrchr(name, '/');
+        const char* tail = slash && slash[1] ? slash + 1 : name;
+        snprintf(xname, sizeof(xname), "PaxHeaders/%.80s", tail);
+        uint8_t h[TAR_BLOCK];
+        fill_header(h, xname, NULL, 0644, used, mtime, 'x', NULL);
+        cu_status_t s = emit(w, h, TAR_BLOCK);
+        if (s == CU_OK) s = emit(w, (const uint8_t*)pax, used);
+        free(pax);
+        if (s == CU_OK) s = emit_padding(w);
+        if (s != CU_OK) return s;
+    }
+
+    uint8_t h[TAR_BLOCK];
+    fill_header(h, need_pax_path ? name : base, need_pax_path ? NULL : (prefix[0] ? prefix : NULL),
+                mode, need_pax_size ? 0 : size, mtime, type, linkname);
+    cu_status_t s = emit(w, h, TAR_BLOCK);
+    if (s != CU_OK) return s;
+    return record_member(w, name, size, type);
+}
+
+cu_status_t cu_tar_writer_create(
+    const char* path,
+    cu_algorithm_t algo,
+    int level,
+    const cu_parallel_opts_t* opts,
+    unsigned flags,
+    cu_tar_writer_t** out_writer
+) {
+    if (!path || !out_writer) return CU_ERR_INVALID_ARG;
+    *out_writer = NULL;
+    const cu_algorithm_vtbl_t* v = cu_registry_lookup(algo);
+    if (!v) {
+        cu_set_last_errorf("algorithm %d is not available in this build", (int)algo);
+        return CU_ERR_UNSUPPORTED_ALGO;
+    }
+    if (cu_check_level(level) != CU_OK) return CU_ERR_INVALID_LEVEL;
+    if ((flags & CU_TAR_INDEX) && algo != CU_ALGO_ZSTD && algo != CU_ALGO_LZ4) {
+        cu_set_last_errorf("tar: %s has no skippable frames to carry an index", v->name);
+        return CU_ERR_INVALID_ARG;
+    }
+
+    cu_tar_writer_t* w = calloc(1, sizeof(*w));
+    if (!w) return oom();
+    w->v = v;
+    w->level = level;
+    w->flags = flags;
+    w->chunk = cu_parallel_chunk_size(algo, opts);
+    w->threads = cu_parallel_threads(opts);
+
+    cu_status_t s = CU_OK;
+    if (w->chunk) {
+        size_t per = (size_t)w->threads * 2;
+        w->win_cap = per * w->chunk;
+        w->out_cap = per * v->compress_bound(w->chunk);
+        w->lens = malloc(per * sizeof(*w->lens));
+        w->status = malloc(per * sizeof(*w->status));
+        if (!w->lens || !w->status) s = oom();
+    } else {
+        w->win_cap = TAR_STREAM_WIN;
+        w->out_cap = v->compress_bound(TAR_STREAM_WIN);
+        s = cu_compress_stream_create(algo, level, &w->cs);
+    }
+    if (s == CU_OK) {
+        w->win = malloc(w->win_cap);
+        w->out = malloc(w->out_cap);
+        w->path = dup_str(path);
+        if (!w->win || !w->out || !w->path) s = oom();
+    }
+    if (s == CU_OK) {
+        w->f = fopen(path, "wb");
+        if (!w->f) s = io_error(path, "open");
+    }
+    if (s != CU_OK) {
+        w->finished = 1;  /* nothing of ours on disk to remove */
+        cu_tar_writer_destroy(w);
+        return s;
+    }
+    cu_clear_last_error();
+    *out_writer = w;
+    return CU_OK;
+}
+
+static cu_status_t writer_check(cu_tar_writer_t* w) {
+    if (!w) return CU_ERR_INVALID_ARG;
+    if (w->finished) {
+        cu_set_last_error("tar: archive already finished");
+        return CU_ERR_STREAM_FINISHED;
+    }
+    if (w->failed) {
+        cu_set_last_error("tar: archive is unusable after an earlier error");
+        return CU_ERR_STREAM_STATE;
+    }
+    return CU_OK;
+}
+
+cu_status_t cu_tar_writer_add_data(
+    cu_tar_writer_t* writer,
+    const char* name,
+    const uint8_t* data, size_t len,
+    uint32_t mode,
+    int64_t mtime
+) {
+    cu_status_t s = writer_check(writer);
+    if (s != CU_OK) return s;
+    if (!name || (len > 0 && !data)) return CU_ERR_INVALID_ARG;
+    s = write_header(writer, name, mode, len, mtime, '0', NULL);
+    if (s == CU_OK) s = emit(writer, data, len);
+    if (s == CU_OK) s = emit_padding(writer);
+    return s;
+}
+
+/* Stream `size` bytes of `f` straight into the window. */
+static cu_status_t emit_file(cu_tar_writer_t* w, FILE* f, const char* path, uint64_t size) {
+    while (size) {
+        uint8_t* p;
+        size_t avail;
+        cu_status_t s = win_space(w, &p, &avail);
+        if (s != CU_OK) return s;
+        size_t want = size < avail ? (size_t)size : avail;
+        size_t got = fread(p, 1, want, f);
+        if (got != want) {
+            if (ferror(f)) return writer_fail(w, io_error(path, "read"));
+            cu_set_last_errorf("%s: file shrank while being archived", path);
+            return writer_fail(w, CU_ERR_IO);
+        }
+        win_commit(w, got);
+        size -= got;
+    }
+    return CU_OK;
+}
+
+cu_status_t cu_tar_writer_add_file(
+    cu_tar_writer_t* writer,
+    const char* src_path,
+    const char* name
+) {
+    cu_status_t s = writer_check(writer);
+    if (s != CU_OK) return s;
+    if (!src_path) return CU_ERR_INVALID_ARG;
+    if (!name) name = src_path;
+
+    struct stat st;
+#if defined(_WIN32)
+    if (stat(src_path, &st) != 0) return io_error(src_path, "stat");
+#else
+    if (lstat(src_path, &st) != 0) return io_error(src_path, "stat");
+#endif
+    uint32_t mode = (uint32_t)(st.st_mode & 07777);
+    int64_t mtime = (int64_t)st.st_mtime;
+
+    if (S_ISDIR(st.st_mode)) {
+        size_t n = strlen(name);
+        char* dname = malloc(n + 2);
+        if (!dname) return writer_fail(writer, oom());
+        memcpy(dname, name, n);
+        if (n == 0 || name[n - 1] != '/') dname[n++] = '/';
+        dname[n] = '\0';
+        s = write_header(writer, dname, mode, 0, mtime, '5', NULL);
+        free(dname);
+        return s;
+    }
+#if !defined(_WIN32)
+    if (S_ISLNK(st.st_mode)) {
+        size_t cap = (size_t)st.st_size + 1 > 256 ? (size_t)st.st_size + 1 : 256;
+        char* target = malloc(cap);
+        if (!target) return writer_fail(writer, oom());
+        ssize_t n = readlink(src_path, target, cap - 1);
+        if (n < 0) {
+            free(target);
+            return io_error(src_path, "readlink");
+        }
+        target[n] = '\0';
+        s = write_header(writer, name, mode, 0, mtime, '2', target);
+        free(target);
+        return s;
+    }
+#endif
+    if (!S_ISREG(st.st_mode)) {
+        cu_set_last_errorf("%s: not a regular file, directory or symlink", src_path);
+        return CU_ERR_INVALID_ARG;
+    }
+
+    FILE* f = fopen(src_path, "rb");
+    if (!f) return io_error(src_path, "open");
+    uint64_t size = (uint64_t)st.st_size;
+    s = write_header(writer, name, mode, size, mtime, '0', NULL);
+    if (s == CU_OK) s = emit_file(writer, f, src_path, size);
+    fclose(f);
+    if (s == CU_OK) s = emit_padding(writer);
+    return s;
+}
+
+static cu_status_t write_index(cu_tar_writer_t* w) {
+    size_t body = 8 + 8 + 8 + 8 * w->n_frames + 8;
+    for (size_t i = 0; i < w->n_members; i++) body += 8 + 8 + 1 + 2 + strlen(w->members[i].name);
+    size_t payload = body + IDX_FOOTER;
+    if (payload > 0xffffffffu - 8) {
+        cu_set_last_error("tar: index does not fit in a skippable frame");
+        return writer_fail(w, CU_ERR_INTERNAL);
+    }
+    uint8_t* buf = malloc(8 + payload);
+    if (!buf) return writer_fail(w, oom());
+
+    uint8_t* p = buf;
+    put_le32(p, IDX_SKIPPABLE);
+    put_le32(p + 4, (uint32_t)payload);
+    p += 8;
+    memcpy(p, IDX_MAGIC, 8);
+    p += 8;
+    put_le64(p, w->chunk);
+    put_le64(p + 8, w->n_frames);
+    p += 16;
+    for (size_t i = 0; i < w->n_frames; i++, p += 8) put_le64(p, w->frames[i]);
+    put_le64(p, w->n_members);
+    p += 8;
+    for (size_t i = 0; i < w->n_members; i++) {
+        const idx_member_t* m = &w->members[i];
+        size_t n = strlen(m->name);
+        put_le64(p, m->data_off);
+        put_le64(p + 8, m->size);
+        p[16] = (uint8_t)m->type;
+        p[17] = (uint8_t)n;
+        p[18] = (uint8_t)(n >> 8);
+        memcpy(p + 19, m->name, n);
+        p += 19 + n;
+    }
+    put_le32(p, (uint32_t)(8 + payload));
+    memcpy(p + 4, IDX_MAGIC, 8);
+
+    cu_status_t s = write_out(w, buf, 8 + payload);
+    free(buf);
+    return s;
+}
+
+cu_status_t cu_tar_writer_finish(cu_tar_writer_t* writer) {
+    cu_status_t s = writer_check(writer);
+    if (s != CU_OK) return s;
+    /* End of archive: two zero blocks. */
+    s = emit(writer, NULL, 2 * TAR_BLOCK);
+    if (s == CU_OK) s = flush_window(writer, 1);
+    if (s == CU_OK && (writer->flags & CU_TAR_INDEX)) s = write_index(writer);
+    if (s != CU_OK) return s;
+    int rc = fclose(writer->f);
+    writer->f = NULL;
+    if (rc != 0) return writer_fail(writer, io_error(writer->path, "close"));
+    writer->finished = 1;
+    cu_clear_last_error();
+    return CU_OK;
+}
+
+void cu_tar_writer_destroy(cu_tar_writer_t* writer) {
+    if (!writer) return;
+    if (writer->f) fclose(writer->f);
+    if (!writer->finished && writer->path) remove(writer->path);
+    cu_compress_stream_destroy(writer->cs);
+    for (size_t i = 0; i < writer->n_members; i++) free(writer->members[i].name);
+    free(writer->members);
+    free(writer->frames);
+    free(writer->win);
+    free(writer->out);
+    free(writer->lens);
+    free(writer->status);
+    free(writer->path);
+    free(writer);
+}
+
+/* ============================================================================
+ * Reader
+ * ============================================================================ */
+
+struct cu_tar_reader {
+    FILE*                   f;
+    char*                   path;
+    cu_decompress_stream_t* ds;
+    int                     ds_pending;   /* stream holds input it could not emit */
+    int                     ds_done;      /* finish returned CU_OK */
+
+    uint8_t*                in;
+    size_t                  in_len;
+    size_t                  in_pos;
+    int                     in_eof;
+
+    uint8_t*                out;
+    size_t                  out_len;
+    size_t                  out_pos;
+
+    cu_tar_entry_t          entry;
+    char*                   name;
+    char*                   link;
+    int                     has_entry;
+    uint64_t                remaining;    /* unread data of the current member */
+    uint64_t                pad;          /* block padding after it */
+    int                     eoa;
+};
+
+/* Refill r->out. Leaves out_len == 0 only at the end of the stream. */
+static cu_status_t pull(cu_tar_reader_t* r) {
+    r->out_pos = r->out_len = 0;
+    for (;;) {
+        size_t n = TAR_READ_BUF;
+        cu_status_t s;
+        if (r->ds_pending) {
+            s = cu_decompress_stream_write(r->ds, NULL, 0, r->out, &n);
+        } else {
+            if (r->in_pos == r->in_len && !r->in_eof) {
+                r->in_len = fread(r->in, 1, TAR_READ_BUF, r->f);
+                r->in_pos = 0;
+                if (r->in_len == 0) {
+                    if (ferror(r->f)) return io_error(r->path, "read");
+                    r->in_eof = 1;
+                }
+            }
+            if (r->in_pos < r->in_len) {
+                s = cu_decompress_stream_write(r->ds, r->in + r->in_pos, r->in_len - r->in_pos,
+                                               r->out, &n);
+                r->in_pos = r->in_len;
+            } else if (!r->ds_done) {
+                s = cu_decompress_stream_finish(r->ds, r->out, &n);
+                if (s == CU_OK) r->ds_done = 1;
+                if (s == CU_ERR_BUF_TOO_SMALL) s = CU_OK;
+            } else {
+                return CU_OK;
+            }
+        }
+        if (s != CU_OK && s != CU_ERR_BUF_TOO_SMALL) return s;
+        if (!r->ds_done) r->ds_pending = s == CU_ERR_BUF_TOO_SMALL;
+        r->out_len = n;
+        if (n > 0 || r->ds_done) return CU_OK;
+    }
+}
+
+/* Copy up to `cap` decoded bytes (NULL dst = discard). */
+static cu_status_t take(cu_tar_reader_t* r, uint8_t* dst, size_t cap, size_t* got) {
+    *got = 0;
+    if (r->out_pos == r->out_len) {
+        cu_status_t s = pull(r);
+        if (s != CU_OK) return s;
+    }
+    size_t n = r->out_len - r->out_pos < cap ? r->out_len - r->out_pos : cap;
+    if (dst) memcpy(dst, r->out + r->out_pos, n);
+    r->out_pos += n;
+    *got = n;
+    return CU_OK;
+}
+
+/* Exactly n bytes or CU_ERR_TRUNCATED; *eof_at_start set if the stream
+ * ended before the first byte. */
+static cu_status_t take_exact(cu_tar_reader_t* r, uint8_t* dst, uint64_t n, int* eof_at_start) {
+    uint64_t done = 0;
+    if (eof_at_start) *eof_at_start = 0;
+    while (done < n) {
+        size_t got;
+        size_t want = n - done < (uint64_t)SIZE_MAX ? (size_t)(n - done) : SIZE_MAX;
+        cu_status_t s = take(r, dst ? dst + done : NULL, want, &got);
+        if (s != CU_OK) return s;
+        if (got == 0) {
+            if (done == 0 && eof_at_start) {
+                *eof_at_start = 1;
+                return CU_OK;
+            }
+            cu_set_last_errorf("%s: archive ends in the middle of a member", r->path);
+            return CU_ERR_TRUNCATED;
+        }
+        done += got;
+    }
+    return CU_OK;
+}
+
+static cu_status_t reader_new(const char* path, cu_algorithm_t algo, cu_tar_reader_t** out) {
+    cu_tar_reader_t* r = calloc(1, sizeof(*r));
+    if (!r) return oom();
+    cu_status_t s = cu_decompress_stream_create(algo, &r->ds);
+    if (s == CU_OK) {
+        r->in = malloc(TAR_READ_BUF);
+        r->out = malloc(TAR_READ_BUF);
+        r->path = dup_str(path);
+        if (!r->in || !r->out || !r->path) s = oom();
+    }
+    if (s == CU_OK) {
+        r->f = fopen(path, "rb");
+        if (!r->f) s = io_error(path, "open");
+    }
+    if (s != CU_OK) {
+        cu_tar_reader_destroy(r);
+        return s;
+    }
+    *out = r;
+    return CU_OK;
+}
+
+cu_status_t cu_tar_reader_open(const char* path, cu_algorithm_t algo, cu_tar_reader_t** out_reader) {
+    if (!path || !out_reader) return CU_ERR_INVALID_ARG;
+    *out_reader = NULL;
+    cu_status_t s = reader_new(path, algo, out_reader);
+    if (s == CU_OK) cu_clear_last_error();
+    return s;
+}
+
+void cu_tar_reader_destroy(cu_tar_reader_t* reader) {
+    if (!reader) return;
+    if (reader->f) fclose(reader->f);
+    cu_decompress_stream_destroy(reader->ds);
+    free(reader->in);
+    free(reader->out);
+    free(reader->name);
+    free(reader->link);
+    free(reader->path);
+    free(reader);
+}
+
+static cu_status_t bad_header(cu_tar_reader_t* r, const char* why) {
+    cu_set_last_errorf("%s: invalid tar header: %s", r->path, why);
+    return CU_ERR_DECOMPRESSION;
+}
+
+/* Numeric field: octal (NUL/space terminated) or GNU base-256. */
+static int parse_number(const uint8_t* f, size_t width, uint64_t* v) {
+    *v = 0;
+    if (f[0] & 0x80) {
+        if (f[0] != 0x80) return 0;  /* negative */
+        for (size_t i = 1; i < width; i++) {
+            if (*v >> 56) return 0;
+            *v = *v << 8 | f[i];
+        }
+        return 1;
+    }
+    size_t i = 0;
+    while (i < width && f[i] == ' ') i++;
+    for (; i < width && f[i] >= '0' && f[i] <= '7'; i++) {
+        if (*v >> 61) return 0;
+        *v = *v << 3 | (uint64_t)(f[i] - '0');
+    }
+    return i == width || f[i] == '\0' || f[i] == ' ';
+}
+
+static int checksum_ok(const uint8_t* h) {
+    uint64_t want;
+    if (!parse_number(h + 148, 8, &want)) return 0;
+    unsigned u = 0;
+    int sg = 0;
+    for (int i = 0; i < TAR_BLOCK; i++) {
+        uint8_t c = (i >= 148 && i < 156) ? ' ' : h[i];
+        u += c;
+        sg += (signed char)c;
+    }
+    return want == u || (int64_t)want == sg;
+}
+
+static int all_zero(const uint8_t* h) {
+    for (int i = 0; i < TAR_BLOCK; i++) if (h[i]) return 0;
+    return 1;
+}
+
+static char* field_str(const uint8_t* f, size_t width) {
+    size_t n = 0;
+    while (n < width && f[n]) n++;
+    char* s = malloc(n + 1);
+    if (s) {
+        memcpy(s, f, n);
+        s[n] = '\0';
+    }
+    return s;
+}
+
+/* Read a pax/GNU extension body of `size` bytes plus padding. */
+static cu_status_t read_ext(cu_tar_reader_t* r, uint64_t size, char** out) {
+    if (size > ((uint64_t)1 << 24)) return bad_header(r, "extended header too large");
+    char* buf = malloc((size_t)size + 1);
+    if (!buf) return oom();
+    cu_status_t s = take_exact(r, (uint8_t*)buf, size, NULL);
+    if (s == CU_OK && size % TAR_BLOCK) s = take_exact(r, NULL, TAR_BLOCK - size % TAR_BLOCK, NULL);
+    if (s != CU_OK) {
+        free(buf);
+        return s;
+    }
+    buf[size] = '\0';
+    *out = buf;
+    return CU_OK;
+}
+
+typedef struct {
+    char*    path;
+    char*    linkpath;
+    uint64_t size;
+    int      has_size;
+    int64_t  mtime;
+    int      has_mtime;
+} pax_t;
+
+static void pax_free(pax_t* x) {
+    free(x->path);
+    free(x->linkpath);
+    memset(x, 0, sizeof(*x));
+}
+
+static cu_status_t parse_pax(cu_tar_reader_t* r, char* body, uint64_t size, pax_t* x) {
+    char* p = body;
+    char* end = body + size;
+    while (p < end && *p) {
+        char* sp = memchr(p, ' ', (size_t)(end - p));
+        if (!sp) return bad_header(r, "malformed pax record");
+        unsigned long long len = strtoull(p, NULL, 10);
+        if (len < 5 || len > (unsigned long long)(end - p) || p[len - 1] != '\n') {
+            return bad_header(r, "malformed pax record");
+        }
+        char* key = sp + 1;
+        char* eq = memchr(key, '=', (size_t)(p + len - key));
+        if (!eq) return bad_header(r, "malformed pax record");
+        *eq = '\0';
+        char* val = eq + 1;
+        p[len - 1] = '\0';
+        if (strcmp(key, "path") == 0) {
+            free(x->path);
+            x->path = dup_str(val);
+            if (!x->path) return oom();
+        } else if (strcmp(key, "linkpath") == 0) {
+            free(x->linkpath);
+            x->linkpath = dup_str(val);
+            if (!x->linkpath) return oom();
+        } else if (strcmp(key, "size") == 0) {
+            x->size = strtoull(val, NULL, 10);
+            x->has_size = 1;
+        } else if (strcmp(key, "mtime") == 0) {
+            x->mtime = strtoll(val, NULL, 10);
+            x->has_mtime = 1;
+        }
+        p += len;
+    }
+    return CU_OK;
+}
+
+/* Skip the rest of the current member. */
+static cu_status_t skip_member(cu_tar_reader_t* r) {
+    cu_status_t s = take_exact(r, NULL, r->remaining + r->pad, NULL);
+    r->remaining = r->pad = 0;
+    return s;
+}
+
+cu_status_t cu_tar_reader_next(cu_tar_reader_t* reader, const cu_tar_entry_t** entry) {
+    if (!reader || !entry) return CU_ERR_INVALID_ARG;
+    cu_tar_reader_t* r = reader;
+    *entry = NULL;
+    if (r->eoa) return CU_OK;
+    cu_status_t s = skip_member(r);
+    if (s != CU_OK) return s;
+    r->has_entry = 0;
+
+    pax_t x = { 0 };
+    for (;;) {
+        uint8_t h[TAR_BLOCK];
+        int eof;
+        s = take_exact(r, h, TAR_BLOCK, &eof);
+        if (s != CU_OK) break;
+        if (eof || all_zero(h)) {
+            /* End of archive: a zero block (normally two), or plain EOF. */
+            r->eoa = 1;
+            break;
+        }
+        if (!checksum_ok(h)) {
+            s = bad_header(r, "checksum mismatch");
+            break;
+        }
+        uint64_t size;
+        if (!parse_number(h + 124, 12, &size)) {
+            s = bad_header(r, "bad size field");
+            break;
+        }
+        char type = h[156] ? (char)h[156] : '0';
+
+        if (type == 'x' || type == 'g' || type == 'L' || type == 'K') {
+            char* body;
+            s = read_ext(r, size, &body);
+            if (s != CU_OK) break;
+            if (type == 'x') {
+                s = parse_pax(r, body, size, &x);
+            } else if (type == 'L' || type == 'K') {
+                /* GNU long name/link: the body is the NUL-terminated string. */
+                char** dst = type == 'L' ? &x.path : &x.linkpath;
+                free(*dst);
+                *dst = dup_str(body);
+                if (!*dst) s = oom();
+            }
+            free(body);
+            if (s != CU_OK) break;
+            continue;
+        }
+
+        free(r->name);
+        free(r->link);
+        r->name = r->link = NULL;
+        if (x.path) {
+            r->name = x.path;
+            x.path = NULL;
+        } else {
+            char* base = field_str(h, 100);
+            char* prefix = memcmp(h + 257, "ustar", 5) == 0 ? field_str(h + 345, 155) : dup_str("");
+            if (base && prefix) {
+                r->name = malloc(strlen(prefix) + 1 + strlen(base) + 1);
+                if (r->name) {
+                    sprintf(r->name, "%s%s%s", prefix, prefix[0] ? "/" : "", base);
+                }
+            }
+            free(base);
+            free(prefix);
+        }
+        if (x.linkpath) {
+            r->link = x.linkpath;
+            x.linkpath = NULL;
+        } else {
+            r->link = field_str(h + 157, 100);
+        }
+        if (!r->name || !r->link) {
+            s = oom();
+            break;
+        }
+        if (x.has_size) size = x.size;
+        uint64_t mode = 0, mtime = 0;
+        parse_number(h + 100, 8, &mode);
+        parse_number(h + 136, 12, &mtime);
+
+        r->entry.name = r->name;
+        r->entry.linkname = r->link;
+        r->entry.mode = (uint32_t)(mode & 07777);
+        r->entry.mtime = x.has_mtime ? x.mtime : (int64_t)mtime;
+        r->entry.type = type;
+        /* Links, directories and devices carry no data whatever size says. */
+        int has_data = type == '0' || type == '7' || (type >= 'A' && type <= 'Z');
+        r->entry.size = has_data ? size : 0;
+        r->remaining = r->entry.size;
+        r->pad = r->remaining % TAR_BLOCK ? TAR_BLOCK - r->remaining % TAR_BLOCK : 0;
+        r->has_entry = 1;
+        *entry = &r->entry;
+        break;
+    }
+    pax_free(&x);
+    if (s == CU_OK) cu_clear_last_error();
+    return s;
+}
+
+cu_status_t cu_tar_reader_read(cu_tar_reader_t* reader, uint8_t* buf, size_t cap, size_t* n) {
+    if (!reader || !n || (cap > 0 && !buf)) return CU_ERR_INVALID_ARG;
+    *n = 0;
+    if (!reader->has_entry || reader->remaining == 0) return CU_OK;
+    size_t want = reader->remaining < cap ? (size_t)reader->remaining : cap;
+    size_t got;
+    cu_status_t s = take(reader, buf, want, &got);
+    if (s != CU_OK) return s;
+    if (got == 0 && want > 0) {
+        cu_set_last_errorf("%s: archive ends in the middle of a member", reader->path);
+        return CU_ERR_TRUNCATED;
+    }
+    reader->remaining -= got;
+    *n = got;
+    return CU_OK;
+}
+
+cu_status_t cu_tar_reader_extract(cu_tar_reader_t* reader, const char* dst_path) {
+    if (!reader || !dst_path) return CU_ERR_INVALID_ARG;
+    if (!reader->has_entry || reader->entry.type != '0') {
+        cu_set_last_error("tar: current entry is not a regular file");
+        return CU_ERR_INVALID_ARG;
+    }
+    FILE* f = fopen(dst_path, "wb");
+    if (!f) return io_error(dst_path, "open");
+    cu_status_t s = CU_OK;
+    while (reader->remaining) {
+        if (reader->out_pos == reader->out_len) {
+            s = pull(reader);
+            if (s != CU_OK) break;
+            if (reader->out_len == 0) {
+                cu_set_last_errorf("%s: archive ends in the middle of a member", reader->path);
+                s = CU_ERR_TRUNCATED;
+                break;
+            }
+        }
+        /* Write straight from the decode buffer. */
+        size_t avail = reader->out_len - reader->out_pos;
+        size_t n = reader->remaining < avail ? (size_t)reader->remaining : avail;
+        if (fwrite(reader->out + reader->out_pos, 1, n, f) != n) {
+            s = io_error(dst_path, "write");
+            break;
+        }
+        reader->out_pos += n;
+        reader->remaining -= n;
+    }
+    if (fclose(f) != 0 && s == CU_OK) s = io_error(dst_path, "close");
+    if (s != CU_OK) remove(dst_path);
+    else cu_clear_last_error();
+    return s;
+}
+
+/* ============================================================================
+ * Indexed extraction
+ * ============================================================================ */
+
+/* Load the trailing index. Returns CU_OK with *idx NULL when the archive
+ * has none. */
+static cu_status_t load_index(cu_tar_reader_t* r, uint8_t** idx, size_t* idx_len) {
+    *idx = NULL;
+    if (cu_fseek(r->f, 0, SEEK_END) != 0) return io_error(r->path, "seek");
+    long long end = (long long)cu_ftell(r->f);
+    if (end < 8 + IDX_FOOTER) return CU_OK;
+    uint8_t foot[IDX_FOOTER];
+    if (cu_fseek(r->f, end - IDX_FOOTER, SEEK_SET) != 0) return io_error(r->path, "seek");
+    if (fread(foot, 1, IDX_FOOTER, r->f) != IDX_FOOTER) return io_error(r->path, "read");
+    if (memcmp(foot + 4, IDX_MAGIC, 8) != 0) return CU_OK;
+    uint32_t total = get_le32(foot);
+    if (total < 8 + 8 + IDX_FOOTER || (long long)total > end) return CU_OK;
+    uint8_t* buf = malloc(total);
+    if (!buf) return oom();
+    if (cu_fseek(r->f, end - total, SEEK_SET) != 0 || fread(buf, 1, total, r->f) != total) {
+        free(buf);
+        return io_error(r->path, "read");
+    }
+    if (get_le32(buf) != IDX_SKIPPABLE || get_le32(buf + 4) != total - 8
+        || memcmp(buf + 8, IDX_MAGIC, 8) != 0) {
+        free(buf);
+        return CU_OK;
+    }
+    *idx = buf;
+    *idx_len = total - IDX_FOOTER;
+    return CU_OK;
+}
+
+/* Find `name` in the index; on success the compressed offset of the frame
+ * holding its first byte and the bytes to skip inside that frame. */
+static cu_status_t index_lookup(cu_tar_reader_t* r, const uint8_t* idx, size_t len,
+                                const char* name, uint64_t* comp_off, uint64_t* skip,
+                                cu_tar_entry_t* e, int* found) {
+    *found = 0;
+    const uint8_t* p = idx + 16;
+    const uint8_t* end = idx + len;
+    if (end - p < 16) return bad_header(r, "truncated index");
+    uint64_t chunk = get_le64(p);
+    uint64_t nframes = get_le64(p + 8);
+    p += 16;
+    if (chunk == 0 || nframes > (uint64_t)(end - p) / 8) return bad_header(r, "corrupt index");
+    const uint8_t* frames = p;
+    p += 8 * nframes;
+    if (end - p < 8) return bad_header(r, "truncated index");
+    uint64_t nmembers = get_le64(p);
+    p += 8;
+    size_t name_len = strlen(name);
+    for (uint64_t i = 0; i < nmembers; i++) {
+        if (end - p < 19) return bad_header(r, "truncated index");
+        uint64_t data_off = get_le64(p);
+        uint64_t size = get_le64(p + 8);
+        char type = (char)p[16];
+        size_t n = (size_t)p[17] | (size_t)p[18] << 8;
+        if ((size_t)(end - p) - 19 < n) return bad_header(r, "truncated index");
+        if (n == name_len && memcmp(p + 19, name, n) == 0) {
+            uint64_t frame = data_off / chunk;
+            if (frame > nframes) return bad_header(r, "corrupt index");
+            uint64_t off = 0;
+            for (uint64_t k = 0; k < frame; k++) off += get_le64(frames + 8 * k);
+            *comp_off = off;
+            *skip = data_off - frame * chunk;
+            e->size = size;
+            e->type = type;
+            *found = 1;
+            return CU_OK;
+        }
+        p += 19 + n;
+    }
+    return CU_OK;
+}
+
+cu_status_t cu_tar_extract_member(
+    const char* archive_path,
+    cu_algorithm_t algo,
+    const char* name,
+    const char* dst_path
+) {
+    if (!archive_path || !name || !dst_path) return CU_ERR_INVALID_ARG;
+    cu_tar_reader_t* r;
+    cu_status_t s = reader_new(archive_path, algo, &r);
+    if (s != CU_OK) return s;
+
+    uint8_t* idx = NULL;
+    size_t idx_len = 0;
+    int found = 0;
+    if (algo == CU_ALGO_ZSTD || algo == CU_ALGO_LZ4) s = load_index(r, &idx, &idx_len);
+    if (s == CU_OK && idx) {
+        uint64_t comp_off = 0, skip = 0;
+        s = index_lookup(r, idx, idx_len, name, &comp_off, &skip, &r->entry, &found);
+        if (s == CU_OK && found) {
+            if (cu_fseek(r->f, (long long)comp_off, SEEK_SET) != 0) {
+                s = io_error(archive_path, "seek");
+            } else {
+                s = take_exact(r, NULL, skip, NULL);
+            }
+            if (s == CU_OK) {
+                r->entry.name = name;
+                r->entry.linkname = "";
+                r->remaining = r->entry.size;
+                r->has_entry = 1;
+            }
+        }
+    } else if (s == CU_OK) {
+        if (cu_fseek(r->f, 0, SEEK_SET) != 0) s = io_error(archive_path, "seek");
+        while (s == CU_OK) {
+            const cu_tar_entry_t* e;
+            s = cu_tar_reader_next(r, &e);
+            if (s != CU_OK || !e) break;
+            if (strcmp(e->name, name) == 0) {
+                found = 1;
+                break;
+            }
+        }
+    }
+    free(idx);
+
+    if (s == CU_OK && !found) {
+        cu_set_last_errorf("%s: no member named '%s'", archive_path, name);
+        s = CU_ERR_INVALID_ARG;
+    }
+    if (s == CU_OK) s = cu_tar_reader_extract(r, dst_path);
+    cu_tar_reader_destroy(r);
+    return s;
+}
@@ -12,6 +12,10 @@
  * Algorithms with non-uniform mappings (brotli has a special case for
  * user=10, lz4 splits fast vs HC modes) handle their own conversion.
  *
+ * Levels CU_LEVEL_MIN..0 are speed tiers (see compress_utils.h). The clamp
+ * pattern sends them to native_min; codecs with a speed knob map them
+ * through cu_speed_tier_step.
+ *
  * Internal header — not part of the public ABI.
  */
 
@@ -32,4 +36,11 @@ static inline int cu_scale_level(int user, int native_max) {
     return n;
 }
 
+/* Speed tier user 0..CU_LEVEL_MIN -> 0, 1, 2, 4, 8, 16: the doubling step
+ * applied to a codec's speed knob. */
+static inline int cu_speed_tier_step(int user) {
+    if (user >= 0) return 0;
+    return 1 << (-user - 1);
+}
+
 #endif  /* CU_LEVELS_H */
@@ -0,0 +1,123 @@
+/*
+ * threads.h — minimal portable threading shim (pthreads / Win32).
+ *
+ * Only what the parallel engine needs: threads, a mutex, a condition
+ * variable and an online-CPU count. Everything is static inline so the
+ * header can be shared by several translation units without a .c file.
+ *
+ * Not compiled into the Go/Rust/WASM builds — they only take
+ * compress_utils.c + registry.c, which must stay free of threads.
+ *
+ * Internal header — not part of the public ABI.
+ */
+
+#ifndef CU_THREADS_H
+#define CU_THREADS_H
+
+#if defined(_WIN32)
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <windows.h>
+#  include <process.h>
+#else
+#  include <pthread.h>
+#  include <unistd.h>
+#endif
+
+typedef void (*cu_thread_fn)(void* arg);
+
+#if defined(_WIN32)
+
+typedef struct {
+    HANDLE       handle;
+    cu_thread_fn fn;
+    void*        arg;
+} cu_thread_t;
+typedef CRITICAL_SECTION   cu_mutex_t;
+typedef CONDITION_VARIABLE cu_cond_t;
+
+static inline unsigned __stdcall cu_thread_tramp_(void* p) {
+    cu_thread_t* t = (cu_thread_t*)p;
+    t->fn(t->arg);
+    return 0;
+}
+
+/* `t` must stay at a fixed address until cu_thread_join. Returns 0 on
+ * success. */
+static inline int cu_thread_create(cu_thread_t* t, cu_thread_fn fn, void* arg) {
+    t->fn = fn;
+    t->arg = arg;
+    t->handle = (HANDLE)_beginthreadex(NULL, 0, cu_thread_tramp_, t, 0, NULL);
+    return t->handle ? 0 : -1;
+}
+static inline void cu_thread_join(cu_thread_t* t) {
+    WaitForSingleObject(t->handle, INFINITE);
+    CloseHandle(t->handle);
+}
+
+static inline void cu_mutex_init(cu_mutex_t* m)    { InitializeCriticalSection(m); }
+static inline void cu_mutex_destroy(cu_mutex_t* m) { DeleteCriticalSection(m); }
+static inline void cu_mutex_lock(cu_mutex_t* m)    { EnterCriticalSection(m); }
+static inline void cu_mutex_unlock(cu_mutex_t* m)  { LeaveCriticalSection(m); }
+
+static inline void cu_cond_init(cu_cond_t* c)      { InitializeConditionVariable(c); }
+static inline void cu_cond_destroy(cu_cond_t* c)   { (void)c; }
+static inline void cu_cond_wait(cu_cond_t* c, cu_mutex_t* m) {
+    SleepConditionVariableCS(c, m, INFINITE);
+}
+static inline void cu_cond_signal(cu_cond_t* c)    { WakeConditionVariable(c); }
+static inline void cu_cond_broadcast(cu_cond_t* c) { WakeAllConditionVariable(c); }
+
+static inline unsigned cu_cpu_count(void) {
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors ? (unsigned)si.dwNumberOfProcessors : 1u;
+}
+
+#else  /* POSIX */
+
+typedef struct {
+    pthread_t    handle;
+    cu_thread_fn fn;
+    void*        arg;
+} cu_thread_t;
+typedef pthread_mutex_t cu_mutex_t;
+typedef pthread_cond_t  cu_cond_t;
+
+static inline void* cu_thread_tramp_(void* p) {
+    cu_thread_t* t = (cu_thread_t*)p;
+    t->fn(t->arg);
+    return NULL;
+}
+
+/* `t` must stay at a fixed address until cu_thread_join. Returns 0 on
+ * success. */
+static inline int cu_thread_create(cu_thread_t* t, cu_thread_fn fn, void* arg) {
+    t->fn = fn;
+    t->arg = arg;
+    return pthread_create(&t->handle, NULL, cu_thread_tramp_, t) == 0 ? 0 : -1;
+}
+static inline void cu_thread_join(cu_thread_t* t) {
+    pthread_join(t->handle, NULL);
+}
+
+static inline void cu_mutex_init(cu_mutex_t* m)    { pthread_mutex_init(m, NULL); }
+static inline void cu_mutex_destroy(cu_mutex_t* m) { pthread_mutex_destroy(m); }
+static inline void cu_mutex_lock(cu_mutex_t* m)    { pthread_mutex_lock(m); }
+static inline void cu_mutex_unlock(cu_mutex_t* m)  { pthread_mutex_unlock(m); }
+
+static inline void cu_cond_init(cu_cond_t* c)      { pthread_cond_init(c, NULL); }
+static inline void cu_cond_destroy(cu_cond_t* c)   { pthread_cond_destroy(c); }
+static inline void cu_cond_wait(cu_cond_t* c, cu_mutex_t* m) { pthread_cond_wait(c, m); }
+static inline void cu_cond_signal(cu_cond_t* c)    { pthread_cond_signal(c); }
+static inline void cu_cond_broadcast(cu_cond_t* c) { pthread_cond_broadcast(c); }
+
+static inline unsigned cu_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (unsigned)n : 1u;
+}
+
+#endif
+
+#endif  /* CU_THREADS_H */
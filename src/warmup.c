@@ -0,0 +1,204 @@
+/*
+ * warmup.c — cu_warmup: pay a process's first-call costs before the first
+ * real call.
+ *
+ * The first compression in a fresh process runs well behind the steady
+ * state: every page of codec code and constant tables it touches faults in
+ * (brotli's 120 KiB dictionary, zstd's and lz4's entropy tables), lazy
+ * binding resolves the library's entry points, and the first context of a
+ * given size goes to the kernel for fresh zeroed pages. cu_warmup takes
+ * those hits up front:
+ *
+ *   - On Linux the library's loaded segments (the executable's, when it is
+ *     linked in statically) are populated in one pass: MADV_POPULATE_READ
+ *     where the kernel has it, otherwise a read of every page.
+ *   - Each requested algorithm and level then runs one round trip of a
+ *     small synthetic sample through the one-shot and the streaming paths.
+ *     The streaming encoder is not told the input size, so it sizes its
+ *     tables for the level rather than for the sample: the same contexts a
+ *     real call allocates. Freed, they stay with the allocator (glibc raises
+ *     its mmap threshold after such a free, and cu_set_huge_pages keeps its
+ *     own cache), so the next call of that shape reuses warm memory.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#  define _GNU_SOURCE  /* dl_iterate_phdr */
+#endif
+
+#include "compress_utils.h"
+#include "algorithm_registry.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#  include <link.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#  define CU_WARMUP_PREFAULT 1
+#endif
+
+#define CU_WARMUP_SAMPLE (64 * 1024)
+#define CU_WARMUP_DEFAULT_LEVEL 5
+
+#ifdef CU_WARMUP_PREFAULT
+
+static int prefault_object(struct dl_phdr_info* info, size_t size, void* arg) {
+    (void)size;
+    uintptr_t self = (uintptr_t)arg;
+    int found = 0;
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr)* ph = &info->dlpi_phdr[i];
+        uintptr_t lo = info->dlpi_addr + ph->p_vaddr;
+        if (ph->p_type == PT_LOAD && self >= lo && self < lo + ph->p_memsz) found = 1;
+    }
+    if (!found) return 0;
+
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr)* ph = &info->dlpi_phdr[i];
+        if (ph->p_type != PT_LOAD || !(ph->p_flags & PF_R)) continue;
+        uintptr_t lo = (info->dlpi_addr + ph->p_vaddr) & ~(page - 1);
+        uintptr_t hi = info->dlpi_addr + ph->p_vaddr + ph->p_memsz;
+#ifdef MADV_POPULATE_READ
+        if (madvise((void*)lo, hi - lo, MADV_POPULATE_READ) == 0) continue;
+#endif
+        for (uintptr_t p = lo; p < hi; p += page) (void)*(volatile const uint8_t*)p;
+    }
+    return 1;
+}
+
+/* Once per process. Concurrent first calls may both run it, which is
+ * harmless, so the flag is atomic rather than locked. */
+static void prefault_library(void) {
+    static int done;
+    if (__atomic_load_n(&done, __ATOMIC_ACQUIRE)) return;
+    dl_iterate_phdr(prefault_object, (void*)(uintptr_t)&cu_warmup);
+    __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+}
+
+#else
+
+static void prefault_library(void) {
+}
+
+#endif
+
+/* Text-like and compressible, so the match finders and entropy coders all
+ * do real work. */
+static void fill_sample(uint8_t* buf, size_t len) {
+    static const char* const words[] = {
+        "compress", "stream", "window", "frame", "block", "level", "table", "match",
+    };
+    uint32_t x = 0x9e3779b9u;
+    size_t i = 0;
+    while (i < len) {
+        x = x * 1664525u + 1013904223u;
+        const char* w = words[(x >> 24) & 7];
+        while (*w && i < len) buf[i++] = (uint8_t)*w++;
+        if (i < len) buf[i++] = (x >> 16) & 1 ? ' ' : (uint8_t)('0' + ((x >> 8) % 10));
+    }
+}
+
+static cu_status_t warm_stream(cu_algorithm_t algo, int level,
+                               const uint8_t* sample, uint8_t* z, size_t z_cap,
+                               uint8_t* back) {
+    cu_compress_stream_t* cs = NULL;
+    cu_status_t s = cu_compress_stream_create(algo, level, &cs);
+    if (s != CU_OK) return s;
+    size_t n = z_cap, m = 0;
+    s = cu_compress_stream_write(cs, sample, CU_WARMUP_SAMPLE, z, &n);
+    if (s == CU_OK) {
+        m = z_cap - n;
+        s = cu_compress_stream_finish(cs, z + n, &m);
+    }
+    cu_compress_stream_destroy(cs);
+    if (s != CU_OK) return s;
+
+    cu_decompress_stream_t* ds = NULL;
+    s = cu_decompress_stream_create(algo, &ds);
+    if (s != CU_OK) return s;
+    size_t out = CU_WARMUP_SAMPLE, tail = 0;
+    s = cu_decompress_stream_write(ds, z, n + m, back, &out);
+    if (s == CU_OK) {
+        tail = CU_WARMUP_SAMPLE - out;
+        s = cu_decompress_stream_finish(ds, back + out, &tail);
+    }
+    cu_decompress_stream_destroy(ds);
+    return s;
+}
+
+static cu_status_t warm_one(cu_algorithm_t algo, int level,
+                            const uint8_t* sample, uint8_t* z, size_t z_cap,
+                            uint8_t* back) {
+    size_t z_len = z_cap;
+    cu_status_t s = cu_compress(algo, sample, CU_WARMUP_SAMPLE, z, &z_len, level);
+    if (s != CU_OK) return s;
+    size_t back_len = CU_WARMUP_SAMPLE;
+    s = cu_decompress(algo, z, z_len, back, &back_len);
+    if (s != CU_OK) return s;
+    return warm_stream(algo, level, sample, z, z_cap, back);
+}
+
+cu_status_t cu_warmup(
+    const cu_algorithm_t* algos, size_t n_algos,
+    const int* levels, size_t n_levels
+) {
+    if ((n_algos > 0 && !algos) || (n_levels > 0 && !levels)) return CU_ERR_INVALID_ARG;
+    for (size_t i = 0; i < n_levels; i++) {
+        if (cu_check_level(levels[i]) != CU_OK) return CU_ERR_INVALID_LEVEL;
+    }
+    for (size_t i = 0; i < n_algos; i++) {
+        if (!cu_algorithm_available(algos[i])) {
+            cu_set_last_errorf("algorithm %d is not available in this build", (int)algos[i]);
+            return CU_ERR_UNSUPPORTED_ALGO;
+        }
+    }
+
+    prefault_library();
+
+    static const cu_algorithm_t all[] = {
+        CU_ALGO_ZSTD, CU_ALGO_BROTLI, CU_ALGO_ZLIB, CU_ALGO_BZ2,
+        CU_ALGO_LZ4, CU_ALGO_XZ, CU_ALGO_SNAPPY, CU_ALGO_GZIP,
+    };
+    static const int default_level = CU_WARMUP_DEFAULT_LEVEL;
+    if (n_algos == 0) {
+        algos = all;
+        n_algos = sizeof(all) / sizeof(all[0]);
+    }
+    if (n_levels == 0) {
+        levels = &default_level;
+        n_levels = 1;
+    }
+
+    size_t z_cap = 0;
+    for (size_t i = 0; i < n_algos; i++) {
+        size_t b = cu_compress_bound(CU_WARMUP_SAMPLE, algos[i]);
+        if (b > z_cap) z_cap = b;
+    }
+    uint8_t* sample = malloc(CU_WARMUP_SAMPLE);
+    uint8_t* back = malloc(CU_WARMUP_SAMPLE);
+    uint8_t* z = malloc(z_cap ? z_cap : 1);
+    if (!sample || !back || !z) {
+        free(sample);
+        free(back);
+        free(z);
+        cu_set_last_error("warmup: out of memory");
+        return CU_ERR_OOM;
+    }
+    fill_sample(sample, CU_WARMUP_SAMPLE);
+
+    cu_status_t s = CU_OK;
+    for (size_t i = 0; i < n_algos && s == CU_OK; i++) {
+        if (!cu_algorithm_available(algos[i])) continue;  /* only when warming all */
+        for (size_t j = 0; j < n_levels && s == CU_OK; j++) {
+            s = warm_one(algos[i], levels[j], sample, z, z_cap, back);
+        }
+    }
+    free(z);
+    free(back);
+    free(sample);
+    return s;
+}
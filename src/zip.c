@@ -0,0 +1,1273 @@
+/*
+ * zip.c — ZIP archive writer and random-access reader (APPNOTE 6.3.x).
+ *
+ * Writer: entries are queued into a batch of roughly threads × 8 MiB of
+ * input. A full batch is compressed on the parallel workers, one entry
+ * per task (CRC-32 included), and then written sequentially in the order
+ * the entries were added, each as local header + data. Entries too large
+ * for a batch are streamed through the codec's stream vtable with a
+ * placeholder local header that is patched once CRC and compressed size
+ * are known. The central directory is written by finish.
+ *
+ * ZIP64: a zip64 extended-information extra field is added only to
+ * entries whose sizes or offset do not fit in 32 bits, and the zip64
+ * end-of-central-directory record + locator only when the entry count,
+ * the directory size or its offset overflow.
+ *
+ * Reader: the end-of-central-directory record is found by scanning the
+ * tail of the file, the directory is parsed once into an entry array and
+ * an FNV-1a open-addressing table over the names. Entry data is read
+ * with positional reads, so extraction needs no reader-wide lock on
+ * POSIX and runs concurrently in cu_zip_reader_extract_many.
+ *
+ * Method 8 is raw DEFLATE (windowBits −15) from the shared zlib backend
+ * (deflate_raw.c, or its module in the plugin build); methods 93 and 95
+ * reuse the zstd and xz vtables, whose frame formats are exactly what
+ * APPNOTE specifies for them.
+ */
+
+#if !defined(_WIN32)
+#  ifndef _FILE_OFFSET_BITS
+#    define _FILE_OFFSET_BITS 64
+#  endif
+#  ifndef _POSIX_C_SOURCE
+#    define _POSIX_C_SOURCE 200809L  /* fseeko, pread, localtime_r */
+#  endif
+#endif
+
+#include "compress_utils.h"
+#include "algorithm_registry.h"
+#include "parallel.h"
+#include "utils/threads.h"
+
+#if defined(INCLUDE_ZLIB) || defined(INCLUDE_GZIP)
+#  define CU_ZIP_HAVE_DEFLATE 1
+#  include <zlib.h>  /* crc32 */
+/* src/algorithms/zlib/deflate_raw.c */
+extern const cu_algorithm_vtbl_t cu_deflate_raw_vtbl;
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#  define cu_fseek _fseeki64
+#  define cu_ftell _ftelli64
+#else
+#  include <fcntl.h>
+#  include <unistd.h>
+#  define cu_fseek fseeko
+#  define cu_ftell ftello
+#endif
+
+#define ZIP_LOCAL_SIG     0x04034b50u
+#define ZIP_CENTRAL_SIG   0x02014b50u
+#define ZIP_EOCD_SIG      0x06054b50u
+#define ZIP64_EOCD_SIG    0x06064b50u
+#define ZIP64_LOC_SIG     0x07064b50u
+
+#define ZIP_LOCAL_LEN     30
+#define ZIP_CENTRAL_LEN   46
+#define ZIP_EOCD_LEN      22
+#define ZIP64_EOCD_LEN    56
+#define ZIP64_LOC_LEN     20
+#define ZIP_EOCD_SCAN     (ZIP_EOCD_LEN + 0xffff)  /* record + longest comment */
+
+#define ZIP_EXTRA_ZIP64   0x0001
+#define ZIP_EXTRA_UT      0x5455  /* extended timestamp */
+#define ZIP_FLAG_ENCRYPT  0x0001
+#define ZIP_FLAG_UTF8     0x0800
+#define ZIP_MADE_BY       ((3u << 8) | 63)  /* Unix, APPNOTE 6.3 */
+
+#define ZIP_U16_MAX       0xffffu
+#define ZIP_U32_MAX       0xffffffffu
+#define ZIP_BATCH_PER_THREAD ((size_t)8 << 20)
+#define ZIP_IO_BUF        ((size_t)1 << 20)
+
+static cu_status_t io_error(const char* path, const char* what) {
+    cu_set_last_errorf("%s: %s: %s", path, what, strerror(errno));
+    return CU_ERR_IO;
+}
+
+static cu_status_t oom(void) {
+    cu_set_last_error("zip: out of memory");
+    return CU_ERR_OOM;
+}
+
+static char* dup_str(const char* s) {
+    size_t n = strlen(s) + 1;
+    char* d = malloc(n);
+    if (d) memcpy(d, s, n);
+    return d;
+}
+
+static void put_le16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+static void put_le32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+static void put_le64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+static uint16_t get_le16(const uint8_t* p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+static uint32_t get_le32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = v << 8 | p[i];
+    return v;
+}
+static uint64_t get_le64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = v << 8 | p[i];
+    return v;
+}
+
+/* ============================================================================
+ * Methods and CRC-32
+ * ============================================================================ */
+
+#ifdef CU_ZIP_HAVE_DEFLATE
+static uint32_t zip_crc32(uint32_t crc, const uint8_t* p, size_t n) {
+    while (n) {
+        uInt k = n > ((size_t)1 << 30) ? (uInt)1 << 30 : (uInt)n;
+        crc = (uint32_t)crc32(crc, p, k);
+        p += k;
+        n -= k;
+    }
+    return crc;
+}
+#else
+static uint32_t crc_table[256];
+
+static void crc_table_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        crc_table[i] = c;
+    }
+}
+
+static uint32_t zip_crc32(uint32_t crc, const uint8_t* p, size_t n) {
+    /* Idempotent, so a racing first use from two workers is harmless. */
+    if (!crc_table[1]) crc_table_init();
+    crc = ~crc;
+    while (n--) crc = crc_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+#endif
+
+/* Codec for a method: *v = NULL for store, error if not in this build. */
+static cu_status_t method_vtbl(uint16_t method, const cu_algorithm_vtbl_t** v) {
+    *v = NULL;
+    switch (method) {
+    case CU_ZIP_STORE:
+        return CU_OK;
+    case CU_ZIP_DEFLATE:
+#ifdef CU_ZIP_HAVE_DEFLATE
+        *v = &cu_deflate_raw_vtbl;
+#elif defined(CU_CODEC_PLUGINS)
+        *v = cu_registry_raw_deflate();
+#endif
+        break;
+    case CU_ZIP_ZSTD:
+        *v = cu_registry_lookup(CU_ALGO_ZSTD);
+        break;
+    case CU_ZIP_XZ:
+        *v = cu_registry_lookup(CU_ALGO_XZ);
+        break;
+    default:
+        break;
+    }
+    if (!*v) {
+        cu_set_last_errorf("zip: compression method %u is not available in this build",
+                           (unsigned)method);
+        return CU_ERR_UNSUPPORTED_ALGO;
+    }
+    return CU_OK;
+}
+
+static uint16_t version_needed(uint16_t method, int zip64) {
+    if (method == CU_ZIP_ZSTD || method == CU_ZIP_XZ) return 63;
+    if (zip64) return 45;
+    return method == CU_ZIP_DEFLATE ? 20 : 10;
+}
+
+static void dos_datetime(int64_t t, uint16_t* dtime, uint16_t* ddate) {
+    time_t tt = (time_t)t;
+    struct tm tm;
+#if defined(_WIN32)
+    int ok = localtime_s(&tm, &tt) == 0;
+#else
+    int ok = localtime_r(&tt, &tm) != NULL;
+#endif
+    if (!ok || tm.tm_year < 80 || tm.tm_year > 207) {
+        *dtime = 0;
+        *ddate = (1 << 5) | 1;  /* 1980-01-01, the DOS epoch */
+        return;
+    }
+    *dtime = (uint16_t)(tm.tm_hour << 11 | tm.tm_min << 5 | tm.tm_sec / 2);
+    *ddate = (uint16_t)((tm.tm_year - 80) << 9 | (tm.tm_mon + 1) << 5 | tm.tm_mday);
+}
+
+static int64_t dos_to_epoch(uint16_t dtime, uint16_t ddate) {
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_year = (ddate >> 9) + 80;
+    tm.tm_mon = ((ddate >> 5) & 15) - 1;
+    tm.tm_mday = ddate & 31;
+    tm.tm_hour = dtime >> 11;
+    tm.tm_min = (dtime >> 5) & 63;
+    tm.tm_sec = (dtime & 31) * 2;
+    tm.tm_isdst = -1;
+    time_t t = mktime(&tm);
+    return t == (time_t)-1 ? 0 : (int64_t)t;
+}
+
+/* UT extra carries a signed 32-bit time. */
+static uint32_t ut_time(int64_t t) {
+    if (t < INT32_MIN) t = INT32_MIN;
+    if (t > INT32_MAX) t = INT32_MAX;
+    return (uint32_t)(int32_t)t;
+}
+
+/* ============================================================================
+ * Writer
+ * ============================================================================ */
+
+typedef struct {
+    char*    name;
+    uint64_t size;
+    uint64_t csize;
+    uint64_t offset;   /* of the local header */
+    uint32_t crc;
+    uint16_t method;
+    uint32_t mode;     /* st_mode-style: type and permission bits */
+    int64_t  mtime;
+} zip_cd_entry_t;
+
+typedef struct {
+    char*          name;
+    const uint8_t* data;
+    uint8_t*       owned;   /* copy of data for add_data */
+    size_t         len;
+    uint32_t       mode;
+    int64_t        mtime;
+
+    uint8_t*       comp;    /* compressed form, NULL when stored */
+    size_t         clen;
+    uint16_t       method;
+    uint32_t       crc;
+    cu_status_t    status;
+} zip_pending_t;
+
+struct cu_zip_writer {
+    FILE*                      f;
+    char*                      path;
+    uint16_t                   method;
+    const cu_algorithm_vtbl_t* v;       /* NULL for store */
+    int                        level;
+    unsigned                   threads;
+    uint64_t                   pos;     /* bytes written so far */
+
+    zip_pending_t*             batch;
+    size_t                     n_batch;
+    size_t                     batch_cap;
+    size_t                     batch_bytes;
+    size_t                     batch_limit;
+
+    zip_cd_entry_t*            cd;
+    size_t                     n_cd;
+    size_t                     cd_cap;
+
+    cu_mutex_t                 err_lock;
+    char                       err[256]; /* first worker error message */
+
+    int                        finished;
+    int                        failed;
+};
+
+static cu_status_t writer_fail(cu_zip_writer_t* w, cu_status_t s) {
+    w->failed = 1;
+    return s;
+}
+
+static cu_status_t write_out(cu_zip_writer_t* w, const void* p, size_t n) {
+    if (n && fwrite(p, 1, n, w->f) != n) return writer_fail(w, io_error(w->path, "write"));
+    w->pos += n;
+    return CU_OK;
+}
+
+static void pending_free(zip_pending_t* e) {
+    free(e->name);
+    free(e->owned);
+    free(e->comp);
+    memset(e, 0, sizeof(*e));
+}
+
+static int needs_zip64(uint64_t size, uint64_t csize) {
+    return size >= ZIP_U32_MAX || csize >= ZIP_U32_MAX;
+}
+
+/*
+ * Local header for `e`. The zip64 extra (both sizes) is present when
+ * `zip64` is set; the 32-bit fields then hold 0xFFFFFFFF. Returns the
+ * header length, which is at most ZIP_LOCAL_LEN + name + 29.
+ */
+static size_t build_local(uint8_t* h, const zip_cd_entry_t* e, int zip64) {
+    size_t nlen = strlen(e->name);
+    uint16_t dtime, ddate;
+    dos_datetime(e->mtime, &dtime, &ddate);
+    size_t xlen = (zip64 ? 20 : 0) + 9;
+
+    put_le32(h, ZIP_LOCAL_SIG);
+    put_le16(h + 4, version_needed(e->method, zip64));
+    put_le16(h + 6, ZIP_FLAG_UTF8);
+    put_le16(h + 8, e->method);
+    put_le16(h + 10, dtime);
+    put_le16(h + 12, ddate);
+    put_le32(h + 14, e->crc);
+    put_le32(h + 18, zip64 ? ZIP_U32_MAX : (uint32_t)e->csize);
+    put_le32(h + 22, zip64 ? ZIP_U32_MAX : (uint32_t)e->size);
+    put_le16(h + 26, (uint16_t)nlen);
+    put_le16(h + 28, (uint16_t)xlen);
+    uint8_t* p = h + ZIP_LOCAL_LEN;
+    memcpy(p, e->name, nlen);
+    p += nlen;
+    if (zip64) {
+        put_le16(p, ZIP_EXTRA_ZIP64);
+        put_le16(p + 2, 16);
+        put_le64(p + 4, e->size);
+        put_le64(p + 12, e->csize);
+        p += 20;
+    }
+    put_le16(p, ZIP_EXTRA_UT);
+    put_le16(p + 2, 5);
+    p[4] = 1;  /* mtime present */
+    put_le32(p + 5, ut_time(e->mtime));
+    return ZIP_LOCAL_LEN + nlen + xlen;
+}
+
+static cu_status_t record_entry(cu_zip_writer_t* w, zip_cd_entry_t* e) {
+    if (w->n_cd == w->cd_cap) {
+        size_t cap = w->cd_cap ? w->cd_cap * 2 : 64;
+        zip_cd_entry_t* n = realloc(w->cd, cap * sizeof(*n));
+        if (!n) return writer_fail(w, oom());
+        w->cd = n;
+        w->cd_cap = cap;
+    }
+    w->cd[w->n_cd++] = *e;
+    return CU_OK;
+}
+
+static void zip_compress_entry(void* ctx, size_t i) {
+    cu_zip_writer_t* w = (cu_zip_writer_t*)ctx;
+    zip_pending_t* e = &w->batch[i];
+    e->crc = zip_crc32(0, e->data, e->len);
+    e->method = CU_ZIP_STORE;
+    e->clen = e->len;
+    e->status = CU_OK;
+    if (!w->v || e->len == 0) return;
+
+    size_t cap = w->v->compress_bound(e->len);
+    e->comp = malloc(cap);
+    cu_status_t s = e->comp ? w->v->compress(e->data, e->len, e->comp, &cap, w->level)
+                            : oom();
+    if (s != CU_OK) {
+        e->status = s;
+        /* cu_last_error is thread-local: carry the message home. */
+        cu_mutex_lock(&w->err_lock);
+        if (!w->err[0]) strncpy(w->err, cu_last_error(), sizeof(w->err) - 1);
+        cu_mutex_unlock(&w->err_lock);
+        return;
+    }
+    if (cap < e->len) {
+        e->method = w->method;
+        e->clen = cap;
+    } else {
+        free(e->comp);
+        e->comp = NULL;
+    }
+}
+
+/* Write one compressed pending entry and move it into the directory. */
+static cu_status_t write_pending(cu_zip_writer_t* w, zip_pending_t* e) {
+    zip_cd_entry_t c = {
+        .name = e->name, .size = e->len, .csize = e->clen, .offset = w->pos,
+        .crc = e->crc, .method = e->method, .mode = e->mode, .mtime = e->mtime,
+    };
+    uint8_t h[ZIP_LOCAL_LEN + ZIP_U16_MAX + 29];
+    size_t hlen = build_local(h, &c, needs_zip64(c.size, c.csize));
+    cu_status_t s = write_out(w, h, hlen);
+    if (s == CU_OK) s = write_out(w, e->comp ? e->comp : e->data, e->clen);
+    if (s == CU_OK) s = record_entry(w, &c);
+    if (s == CU_OK) e->name = NULL;  /* now owned by the directory */
+    return s;
+}
+
+static const void* zip_entry_home(void* ctx, size_t i) {
+    return ((cu_zip_writer_t*)ctx)->batch[i].data;
+}
+
+static cu_status_t flush_batch(cu_zip_writer_t* w) {
+    if (w->n_batch == 0) return CU_OK;
+    w->err[0] = '\0';
+    cu_parallel_for_placed(w->threads, w->n_batch, zip_compress_entry, zip_entry_home, w);
+
+    cu_status_t s = CU_OK;
+    for (size_t i = 0; i < w->n_batch; i++) {
+        if (s == CU_OK) {
+            s = w->batch[i].status;
+            if (s != CU_OK) {
+                cu_set_last_errorf("zip: %s: %s", w->batch[i].name, w->err);
+                writer_fail(w, s);
+            } else {
+                s = write_pending(w, &w->batch[i]);
+            }
+        }
+        pending_free(&w->batch[i]);
+    }
+    w->n_batch = 0;
+    w->batch_bytes = 0;
+    return s;
+}
+
+static cu_status_t check_name(const char* name) {
+    size_t n = strlen(name);
+    if (n == 0 || n > ZIP_U16_MAX) {
+        cu_set_last_error("zip: entry name must be 1 to 65535 bytes");
+        return CU_ERR_INVALID_ARG;
+    }
+    return CU_OK;
+}
+
+/* Queue an entry; `data` must stay valid until the batch is flushed. */
+static cu_status_t queue_entry(cu_zip_writer_t* w, const char* name, const uint8_t* data,
+                               uint8_t* owned, size_t len, uint32_t mode, int64_t mtime) {
+    if (w->n_batch && w->batch_bytes + len > w->batch_limit) {
+        cu_status_t s = flush_batch(w);
+        if (s != CU_OK) {
+            free(owned);
+            return s;
+        }
+    }
+    if (w->n_batch == w->batch_cap) {
+        size_t cap = w->batch_cap ? w->batch_cap * 2 : 64;
+        zip_pending_t* n = realloc(w->batch, cap * sizeof(*n));
+        if (!n) {
+            free(owned);
+            return writer_fail(w, oom());
+        }
+        w->batch = n;
+        w->batch_cap = cap;
+    }
+    zip_pending_t* e = &w->batch[w->n_batch];
+    memset(e, 0, sizeof(*e));
+    e->name = dup_str(name);
+    if (!e->name) {
+        free(owned);
+        return writer_fail(w, oom());
+    }
+    e->data = data;
+    e->owned = owned;
+    e->len = len;
+    e->mode = mode;
+    e->mtime = mtime;
+    w->n_batch++;
+    w->batch_bytes += len;
+    return CU_OK;
+}
+
+/*
+ * Stream an entry too large for a batch from `f` (or from `mem` when f is
+ * NULL), then patch CRC and compressed size into its local header.
+ */
+static cu_status_t stream_entry(cu_zip_writer_t* w, const char* name, FILE* f,
+                                const char* src_path, const uint8_t* mem, uint64_t size,
+                                uint32_t mode, int64_t mtime) {
+    cu_status_t s = flush_batch(w);
+    if (s != CU_OK) return s;
+
+    const cu_algorithm_vtbl_t* v = w->v;
+    zip_cd_entry_t c = {
+        .name = dup_str(name), .size = size, .offset = w->pos,
+        .method = v ? w->method : CU_ZIP_STORE, .mode = mode, .mtime = mtime,
+    };
+    if (!c.name) return writer_fail(w, oom());
+    /* Whether zip64 is needed must be decided before the data is known. */
+    uint64_t worst = v && size < SIZE_MAX ? v->compress_bound((size_t)size) : size;
+    int zip64 = needs_zip64(size, worst) || (v && size >= SIZE_MAX);
+
+    uint8_t h[ZIP_LOCAL_LEN + ZIP_U16_MAX + 29];
+    size_t hlen = build_local(h, &c, zip64);
+    size_t out_cap = v ? v->compress_bound(ZIP_IO_BUF) : 0;
+    uint8_t* in = f ? malloc(ZIP_IO_BUF) : NULL;
+    uint8_t* out = out_cap ? malloc(out_cap) : NULL;
+    void* st = NULL;
+
+    s = write_out(w, h, hlen);
+    if (s == CU_OK && ((f && !in) || (out_cap && !out))) s = writer_fail(w, oom());
+    if (s == CU_OK && v) {
+        s = v->compress_stream_create(w->level, &st);
+        if (s != CU_OK) writer_fail(w, s);
+    }
+
+    uint64_t left = size;
+    uint64_t csize = 0;
+    while (s == CU_OK && left) {
+        size_t n = left < ZIP_IO_BUF ? (size_t)left : ZIP_IO_BUF;
+        const uint8_t* p = mem ? mem + (size - left) : in;
+        if (f && fread(in, 1, n, f) != n) {
+            if (ferror(f)) s = writer_fail(w, io_error(src_path, "read"));
+            else {
+                cu_set_last_errorf("%s: file shrank while being archived", src_path);
+                s = writer_fail(w, CU_ERR_IO);
+            }
+            break;
+        }
+        c.crc = zip_crc32(c.crc, p, n);
+        left -= n;
+        if (!v) {
+            s = write_out(w, p, n);
+            csize += n;
+            continue;
+        }
+        for (;;) {
+            size_t o = out_cap;
+            cu_status_t r = v->compress_stream_write(st, p, n, out, &o);
+            p = NULL;
+            n = 0;
+            if (r != CU_OK && r != CU_ERR_BUF_TOO_SMALL) {
+                s = writer_fail(w, r);
+                break;
+            }
+            s = write_out(w, out, o);
+            csize += o;
+            if (s != CU_OK || r == CU_OK) break;
+        }
+    }
+    while (s == CU_OK && v) {
+        size_t o = out_cap;
+        cu_status_t r = v->compress_stream_finish(st, out, &o);
+        if (r != CU_OK && r != CU_ERR_BUF_TOO_SMALL) {
+            s = writer_fail(w, r);
+            break;
+        }
+        s = write_out(w, out, o);
+        csize += o;
+        if (r == CU_OK) break;
+    }
+    if (v && st) v->compress_stream_destroy(st);
+    free(in);
+    free(out);
+
+    if (s == CU_OK) {
+        c.csize = csize;
+        hlen = build_local(h, &c, zip64);
+        if (cu_fseek(w->f, (int64_t)c.offset, SEEK_SET) != 0 ||
+            fwrite(h, 1, hlen, w->f) != hlen ||
+            cu_fseek(w->f, (int64_t)w->pos, SEEK_SET) != 0) {
+            s = writer_fail(w, io_error(w->path, "write"));
+        }
+    }
+    if (s == CU_OK) s = record_entry(w, &c);
+    if (s != CU_OK) free(c.name);
+    return s;
+}
+
+cu_status_t cu_zip_writer_create(
+    const char* path,
+    cu_zip_method_t method,
+    int level,
+    const cu_parallel_opts_t* opts,
+    cu_zip_writer_t** out_writer
+) {
+    if (!path || !out_writer) return CU_ERR_INVALID_ARG;
+    *out_writer = NULL;
+    const cu_algorithm_vtbl_t* v;
+    cu_status_t s = method_vtbl((uint16_t)method, &v);
+    if (s != CU_OK) return s;
+    if (v && cu_check_level(level) != CU_OK) return CU_ERR_INVALID_LEVEL;
+
+    cu_zip_writer_t* w = calloc(1, sizeof(*w));
+    if (!w) return oom();
+    w->method = (uint16_t)method;
+    w->v = v;
+    w->level = level;
+    w->threads = cu_parallel_threads(opts);
+    w->batch_limit = (size_t)w->threads * ZIP_BATCH_PER_THREAD;
+    cu_mutex_init(&w->err_lock);
+    w->path = dup_str(path);
+    if (!w->path) s = oom();
+    if (s == CU_OK) {
+        w->f = fopen(path, "wb");
+        if (!w->f) s = io_error(path, "open");
+    }
+    if (s != CU_OK) {
+        w->finished = 1;  /* nothing of ours on disk to remove */
+        cu_zip_writer_destroy(w);
+        return s;
+    }
+    cu_clear_last_error();
+    *out_writer = w;
+    return CU_OK;
+}
+
+static cu_status_t writer_check(cu_zip_writer_t* w) {
+    if (!w) return CU_ERR_INVALID_ARG;
+    if (w->finished) {
+        cu_set_last_error("zip: archive already finished");
+        return CU_ERR_STREAM_FINISHED;
+    }
+    if (w->failed) {
+        cu_set_last_error("zip: archive is unusable after an earlier error");
+        return CU_ERR_STREAM_STATE;
+    }
+    return CU_OK;
+}
+
+cu_status_t cu_zip_writer_add_data(
+    cu_zip_writer_t* writer,
+    const char* name,
+    const uint8_t* data, size_t len,
+    int64_t mtime
+) {
+    cu_status_t s = writer_check(writer);
+    if (s != CU_OK) return s;
+    if (!name || (len > 0 && !data)) return CU_ERR_INVALID_ARG;
+    if ((s = check_name(name)) != CU_OK) return s;
+    /* Larger than a batch: no copy, compress straight from the caller. */
+    if (len > writer->batch_limit) {
+        return stream_entry(writer, name, NULL, NULL, data, len, 0100644, mtime);
+    }
+    uint8_t* copy = NULL;
+    if (len) {
+        copy = malloc(len);
+        if (!copy) return writer_fail(writer, oom());
+        memcpy(copy, data, len);
+    }
+    return queue_entry(writer, name, copy, copy, len, 0100644, mtime);
+}
+
+cu_status_t cu_zip_writer_add_file(
+    cu_zip_writer_t* writer,
+    const char* src_path,
+    const char* name
+) {
+    cu_status_t s = writer_check(writer);
+    if (s != CU_OK) return s;
+    if (!src_path) return CU_ERR_INVALID_ARG;
+    if (!name) name = src_path;
+
+    struct stat st;
+    if (stat(src_path, &st) != 0) return io_error(src_path, "stat");
+    uint32_t mode = (uint32_t)st.st_mode;
+    int64_t mtime = (int64_t)st.st_mtime;
+
+    if (S_ISDIR(st.st_mode)) {
+        size_t n = strlen(name);
+        char* dname = malloc(n + 2);
+        if (!dname) return writer_fail(writer, oom());
+        memcpy(dname, name, n);
+        if (n == 0 || name[n - 1] != '/') dname[n++] = '/';
+        dname[n] = '\0';
+        s = check_name(dname);
+        if (s == CU_OK) s = queue_entry(writer, dname, NULL, NULL, 0, mode, mtime);
+        free(dname);
+        return s;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        cu_set_last_errorf("%s: not a regular file or directory", src_path);
+        return CU_ERR_INVALID_ARG;
+    }
+    if ((s = check_name(name)) != CU_OK) return s;
+
+    FILE* f = fopen(src_path, "rb");
+    if (!f) return io_error(src_path, "open");
+    uint64_t size = (uint64_t)st.st_size;
+    if (size > writer->batch_limit) {
+        s = stream_entry(writer, name, f, src_path, NULL, size, mode, mtime);
+        fclose(f);
+        return s;
+    }
+    uint8_t* buf = size ? malloc((size_t)size) : NULL;
+    if (size && !buf) s = writer_fail(writer, oom());
+    else if (size && fread(buf, 1, (size_t)size, f) != size) {
+        if (ferror(f)) s = io_error(src_path, "read");
+        else {
+            cu_set_last_errorf("%s: file shrank while being archived", src_path);
+            s = CU_ERR_IO;
+        }
+    }
+    fclose(f);
+    if (s != CU_OK) {
+        free(buf);
+        return s;
+    }
+    return queue_entry(writer, name, buf, buf, (size_t)size, mode, mtime);
+}
+
+static cu_status_t write_central(cu_zip_writer_t* w) {
+    uint64_t cd_start = w->pos;
+    uint8_t h[ZIP_CENTRAL_LEN + ZIP_U16_MAX + 28 + 9];
+    for (size_t i = 0; i < w->n_cd; i++) {
+        const zip_cd_entry_t* e = &w->cd[i];
+        size_t nlen = strlen(e->name);
+        int big_size = e->size >= ZIP_U32_MAX;
+        int big_csize = e->csize >= ZIP_U32_MAX;
+        int big_off = e->offset >= ZIP_U32_MAX;
+        size_t z64 = 8 * (size_t)(big_size + big_csize + big_off);
+        size_t xlen = (z64 ? 4 + z64 : 0) + 9;
+        uint16_t dtime, ddate;
+        dos_datetime(e->mtime, &dtime, &ddate);
+        uint32_t attr = e->mode << 16;
+        if (e->name[nlen - 1] == '/') attr |= 0x10;  /* MS-DOS directory bit */
+
+        put_le32(h, ZIP_CENTRAL_SIG);
+        put_le16(h + 4, (uint16_t)ZIP_MADE_BY);
+        put_le16(h + 6, version_needed(e->method, z64 != 0));
+        put_le16(h + 8, ZIP_FLAG_UTF8);
+        put_le16(h + 10, e->method);
+        put_le16(h + 12, dtime);
+        put_le16(h + 14, ddate);
+        put_le32(h + 16, e->crc);
+        put_le32(h + 20, big_csize ? ZIP_U32_MAX : (uint32_t)e->csize);
+        put_le32(h + 24, big_size ? ZIP_U32_MAX : (uint32_t)e->size);
+        put_le16(h + 28, (uint16_t)nlen);
+        put_le16(h + 30, (uint16_t)xlen);
+        put_le16(h + 32, 0);   /* comment */
+        put_le16(h + 34, 0);   /* disk */
+        put_le16(h + 36, 0);   /* internal attributes */
+        put_le32(h + 38, attr);
+        put_le32(h + 42, big_off ? ZIP_U32_MAX : (uint32_t)e->offset);
+        uint8_t* p = h + ZIP_CENTRAL_LEN;
+        memcpy(p, e->name, nlen);
+        p += nlen;
+        if (z64) {
+            /* Only the overflowing fields, in APPNOTE order. */
+            put_le16(p, ZIP_EXTRA_ZIP64);
+            put_le16(p + 2, (uint16_t)z64);
+            p += 4;
+            if (big_size)  { put_le64(p, e->size);   p += 8; }
+            if (big_csize) { put_le64(p, e->csize);  p += 8; }
+            if (big_off)   { put_le64(p, e->offset); p += 8; }
+        }
+        put_le16(p, ZIP_EXTRA_UT);
+        put_le16(p + 2, 5);
+        p[4] = 1;
+        put_le32(p + 5, ut_time(e->mtime));
+        cu_status_t s = write_out(w, h, ZIP_CENTRAL_LEN + nlen + xlen);
+        if (s != CU_OK) return s;
+    }
+    uint64_t cd_size = w->pos - cd_start;
+    uint64_t count = w->n_cd;
+    int zip64 = count >= ZIP_U16_MAX || cd_size >= ZIP_U32_MAX || cd_start >= ZIP_U32_MAX;
+
+    uint8_t t[ZIP64_EOCD_LEN + ZIP64_LOC_LEN + ZIP_EOCD_LEN];
+    uint8_t* p = t;
+    if (zip64) {
+        uint64_t rec = w->pos;
+        put_le32(p, ZIP64_EOCD_SIG);
+        put_le64(p + 4, ZIP64_EOCD_LEN - 12);
+        put_le16(p + 12, (uint16_t)ZIP_MADE_BY);
+        put_le16(p + 14, 45);
+        put_le32(p + 16, 0);
+        put_le32(p + 20, 0);
+        put_le64(p + 24, count);
+        put_le64(p + 32, count);
+        put_le64(p + 40, cd_size);
+        put_le64(p + 48, cd_start);
+        p += ZIP64_EOCD_LEN;
+        put_le32(p, ZIP64_LOC_SIG);
+        put_le32(p + 4, 0);
+        put_le64(p + 8, rec);
+        put_le32(p + 16, 1);
+        p += ZIP64_LOC_LEN;
+    }
+    uint16_t n16 = count >= ZIP_U16_MAX ? ZIP_U16_MAX : (uint16_t)count;
+    put_le32(p, ZIP_EOCD_SIG);
+    put_le16(p + 4, 0);
+    put_le16(p + 6, 0);
+    put_le16(p + 8, n16);
+    put_le16(p + 10, n16);
+    put_le32(p + 12, cd_size >= ZIP_U32_MAX ? ZIP_U32_MAX : (uint32_t)cd_size);
+    put_le32(p + 16, cd_start >= ZIP_U32_MAX ? ZIP_U32_MAX : (uint32_t)cd_start);
+    put_le16(p + 20, 0);
+    p += ZIP_EOCD_LEN;
+    return write_out(w, t, (size_t)(p - t));
+}
+
+cu_status_t cu_zip_writer_finish(cu_zip_writer_t* writer) {
+    cu_status_t s = writer_check(writer);
+    if (s != CU_OK) return s;
+    s = flush_batch(writer);
+    if (s == CU_OK) s = write_central(writer);
+    if (s != CU_OK) return s;
+    int rc = fclose(writer->f);
+    writer->f = NULL;
+    if (rc != 0) return writer_fail(writer, io_error(writer->path, "close"));
+    writer->finished = 1;
+    cu_clear_last_error();
+    return CU_OK;
+}
+
+void cu_zip_writer_destroy(cu_zip_writer_t* writer) {
+    if (!writer) return;
+    if (writer->f) fclose(writer->f);
+    if (!writer->finished && writer->path) remove(writer->path);
+    for (size_t i = 0; i < writer->n_batch; i++) pending_free(&writer->batch[i]);
+    free(writer->batch);
+    for (size_t i = 0; i < writer->n_cd; i++) free(writer->cd[i].name);
+    free(writer->cd);
+    cu_mutex_destroy(&writer->err_lock);
+    free(writer->path);
+    free(writer);
+}
+
+/* ============================================================================
+ * Reader
+ * ============================================================================ */
+
+typedef struct {
+    cu_zip_entry_t pub;
+    uint64_t       local_off;
+    uint16_t       flags;
+} zip_rec_t;
+
+struct cu_zip_reader {
+#if defined(_WIN32)
+    FILE*      f;
+    cu_mutex_t lock;      /* serialises seek + read */
+#else
+    int        fd;
+#endif
+    char*      path;
+    uint64_t   file_size;
+    zip_rec_t* recs;
+    size_t     n;
+    char*      names;     /* arena behind every pub.name */
+    size_t*    slots;     /* name hash table: index + 1, 0 = empty */
+    size_t     mask;
+};
+
+static cu_status_t bad_archive(const cu_zip_reader_t* r, const char* why) {
+    cu_set_last_errorf("%s: not a valid zip archive (%s)", r->path, why);
+    return CU_ERR_DECOMPRESSION;
+}
+
+static cu_status_t read_at(cu_zip_reader_t* r, uint64_t off, void* buf, size_t n) {
+    if (off > r->file_size || n > r->file_size - off) {
+        cu_set_last_errorf("%s: unexpected end of archive", r->path);
+        return CU_ERR_TRUNCATED;
+    }
+#if defined(_WIN32)
+    cu_mutex_lock(&r->lock);
+    int ok = cu_fseek(r->f, (int64_t)off, SEEK_SET) == 0 && fread(buf, 1, n, r->f) == n;
+    cu_mutex_unlock(&r->lock);
+    if (!ok) return io_error(r->path, "read");
+#else
+    uint8_t* p = (uint8_t*)buf;
+    while (n) {
+        ssize_t got = pread(r->fd, p, n, (off_t)off);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return io_error(r->path, "read");
+        }
+        if (got == 0) {
+            cu_set_last_errorf("%s: unexpected end of archive", r->path);
+            return CU_ERR_TRUNCATED;
+        }
+        p += got;
+        off += (uint64_t)got;
+        n -= (size_t)got;
+    }
+#endif
+    return CU_OK;
+}
+
+static size_t name_hash(const char* s, size_t n) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < n; i++) h = (h ^ (uint8_t)s[i]) * 1099511628211ull;
+    return (size_t)h;
+}
+
+static void hash_insert(cu_zip_reader_t* r, size_t idx) {
+    const char* name = r->recs[idx].pub.name;
+    size_t n = strlen(name);
+    size_t i = name_hash(name, n) & r->mask;
+    while (r->slots[i]) {
+        /* A repeated name resolves to the later entry, like most unzips. */
+        if (strcmp(r->recs[r->slots[i] - 1].pub.name, name) == 0) break;
+        i = (i + 1) & r->mask;
+    }
+    r->slots[i] = idx + 1;
+}
+
+/* Locate the central directory: offset, size and entry count. */
+static cu_status_t find_central(cu_zip_reader_t* r, uint64_t* cd_off, uint64_t* cd_size,
+                                uint64_t* count) {
+    if (r->file_size < ZIP_EOCD_LEN) return bad_archive(r, "too short");
+    size_t scan = r->file_size < ZIP_EOCD_SCAN ? (size_t)r->file_size : ZIP_EOCD_SCAN;
+    uint64_t base = r->file_size - scan;
+    uint8_t* buf = malloc(scan);
+    if (!buf) return oom();
+    cu_status_t s = read_at(r, base, buf, scan);
+    if (s != CU_OK) {
+        free(buf);
+        return s;
+    }
+    size_t at = scan - ZIP_EOCD_LEN + 1;
+    const uint8_t* e = NULL;
+    while (at-- > 0) {
+        if (get_le32(buf + at) == ZIP_EOCD_SIG &&
+            at + ZIP_EOCD_LEN + get_le16(buf + at + 20) <= scan) {
+            e = buf + at;
+            break;
+        }
+    }
+    if (!e) {
+        free(buf);
+        return bad_archive(r, "no end of central directory record");
+    }
+    uint64_t eocd = base + at;
+    *count = get_le16(e + 10);
+    *cd_size = get_le32(e + 12);
+    *cd_off = get_le32(e + 16);
+    free(buf);
+
+    if (eocd >= ZIP64_LOC_LEN) {
+        uint8_t loc[ZIP64_LOC_LEN];
+        s = read_at(r, eocd - ZIP64_LOC_LEN, loc, sizeof(loc));
+        if (s != CU_OK) return s;
+        if (get_le32(loc) == ZIP64_LOC_SIG) {
+            uint8_t rec[ZIP64_EOCD_LEN];
+            s = read_at(r, get_le64(loc + 8), rec, sizeof(rec));
+            if (s != CU_OK) return s;
+            if (get_le32(rec) != ZIP64_EOCD_SIG) return bad_archive(r, "bad zip64 record");
+            *count = get_le64(rec + 32);
+            *cd_size = get_le64(rec + 40);
+            *cd_off = get_le64(rec + 48);
+        }
+    }
+    if (*cd_off > r->file_size || *cd_size > r->file_size - *cd_off) {
+        return bad_archive(r, "central directory out of range");
+    }
+    /* Every central header is at least 46 bytes. */
+    if (*count > *cd_size / ZIP_CENTRAL_LEN) return bad_archive(r, "entry count");
+    return CU_OK;
+}
+
+static void parse_extra(zip_rec_t* rec, const uint8_t* x, size_t xlen,
+                        int big_size, int big_csize, int big_off) {
+    while (xlen >= 4) {
+        uint16_t id = get_le16(x);
+        size_t len = get_le16(x + 2);
+        if (len > xlen - 4) break;
+        const uint8_t* d = x + 4;
+        if (id == ZIP_EXTRA_ZIP64) {
+            size_t k = 0;
+            if (big_size && k + 8 <= len)  { rec->pub.size = get_le64(d + k);            k += 8; }
+            if (big_csize && k + 8 <= len) { rec->pub.compressed_size = get_le64(d + k); k += 8; }
+            if (big_off && k + 8 <= len)   { rec->local_off = get_le64(d + k); }
+        } else if (id == ZIP_EXTRA_UT && len >= 5 && (d[0] & 1)) {
+            rec->pub.mtime = (int32_t)get_le32(d + 1);
+        }
+        x += 4 + len;
+        xlen -= 4 + len;
+    }
+}
+
+static cu_status_t parse_central(cu_zip_reader_t* r, const uint8_t* cd, size_t cd_size) {
+    const uint8_t* p = cd;
+    const uint8_t* end = cd + cd_size;
+    char* arena = r->names;
+    for (size_t i = 0; i < r->n; i++) {
+        if ((size_t)(end - p) < ZIP_CENTRAL_LEN || get_le32(p) != ZIP_CENTRAL_SIG) {
+            return bad_archive(r, "bad central directory header");
+        }
+        size_t nlen = get_le16(p + 28);
+        size_t xlen = get_le16(p + 30);
+        size_t clen = get_le16(p + 32);
+        if ((size_t)(end - p) < ZIP_CENTRAL_LEN + nlen + xlen + clen) {
+            return bad_archive(r, "central directory truncated");
+        }
+        zip_rec_t* rec = &r->recs[i];
+        uint32_t csize32 = get_le32(p + 20);
+        uint32_t size32 = get_le32(p + 24);
+        uint32_t off32 = get_le32(p + 42);
+        rec->flags = get_le16(p + 8);
+        rec->pub.method = get_le16(p + 10);
+        rec->pub.crc32 = get_le32(p + 16);
+        rec->pub.compressed_size = csize32;
+        rec->pub.size = size32;
+        rec->local_off = off32;
+        rec->pub.mtime = dos_to_epoch(get_le16(p + 12), get_le16(p + 14));
+        /* Unix mode lives in the high half of the external attributes. */
+        if ((get_le16(p + 4) >> 8) == 3) rec->pub.mode = get_le32(p + 38) >> 16;
+
+        memcpy(arena, p + ZIP_CENTRAL_LEN, nlen);
+        arena[nlen] = '\0';
+        rec->pub.name = arena;
+        arena += nlen + 1;
+        parse_extra(rec, p + ZIP_CENTRAL_LEN + nlen, xlen,
+                    size32 == ZIP_U32_MAX, csize32 == ZIP_U32_MAX, off32 == ZIP_U32_MAX);
+        p += ZIP_CENTRAL_LEN + nlen + xlen + clen;
+    }
+    return CU_OK;
+}
+
+cu_status_t cu_zip_reader_open(const char* path, cu_zip_reader_t** out_reader) {
+    if (!path || !out_reader) return CU_ERR_INVALID_ARG;
+    *out_reader = NULL;
+    cu_zip_reader_t* r = calloc(1, sizeof(*r));
+    if (!r) return oom();
+    cu_status_t s = CU_OK;
+#if defined(_WIN32)
+    cu_mutex_init(&r->lock);
+    r->f = fopen(path, "rb");
+    if (!r->f) s = io_error(path, "open");
+    if (s == CU_OK && (cu_fseek(r->f, 0, SEEK_END) != 0 || cu_ftell(r->f) < 0)) {
+        s = io_error(path, "seek");
+    }
+    if (s == CU_OK) r->file_size = (uint64_t)cu_ftell(r->f);
+#else
+    r->fd = open(path, O_RDONLY);
+    if (r->fd < 0) s = io_error(path, "open");
+    struct stat st;
+    if (s == CU_OK && fstat(r->fd, &st) != 0) s = io_error(path, "stat");
+    if (s == CU_OK) r->file_size = (uint64_t)st.st_size;
+#endif
+    if (s == CU_OK) {
+        r->path = dup_str(path);
+        if (!r->path) s = oom();
+    }
+
+    uint64_t cd_off = 0, cd_size = 0, count = 0;
+    if (s == CU_OK) s = find_central(r, &cd_off, &cd_size, &count);
+    uint8_t* cd = NULL;
+    if (s == CU_OK && cd_size > SIZE_MAX / 2) s = oom();
+    if (s == CU_OK) {
+        r->n = (size_t)count;
+        size_t cap = 2;
+        while (cap < r->n * 2) cap <<= 1;
+        r->mask = cap - 1;
+        cd = malloc(cd_size ? (size_t)cd_size : 1);
+        r->recs = calloc(r->n ? r->n : 1, sizeof(*r->recs));
+        r->names = malloc((size_t)cd_size + 1);
+        r->slots = calloc(cap, sizeof(*r->slots));
+        if (!cd || !r->recs || !r->names || !r->slots) s = oom();
+    }
+    if (s == CU_OK) s = read_at(r, cd_off, cd, (size_t)cd_size);
+    if (s == CU_OK) s = parse_central(r, cd, (size_t)cd_size);
+    free(cd);
+    if (s != CU_OK) {
+        cu_zip_reader_destroy(r);
+        return s;
+    }
+    for (size_t i = 0; i < r->n; i++) hash_insert(r, i);
+    cu_clear_last_error();
+    *out_reader = r;
+    return CU_OK;
+}
+
+size_t cu_zip_reader_count(const cu_zip_reader_t* reader) {
+    return reader ? reader->n : 0;
+}
+
+const cu_zip_entry_t* cu_zip_reader_entry(const cu_zip_reader_t* reader, size_t index) {
+    if (!reader || index >= reader->n) return NULL;
+    return &reader->recs[index].pub;
+}
+
+cu_status_t cu_zip_reader_find(
+    const cu_zip_reader_t* reader,
+    const char* name,
+    size_t* index
+) {
+    if (!reader || !name || !index) return CU_ERR_INVALID_ARG;
+    size_t i = name_hash(name, strlen(name)) & reader->mask;
+    while (reader->slots[i]) {
+        size_t idx = reader->slots[i] - 1;
+        if (strcmp(reader->recs[idx].pub.name, name) == 0) {
+            *index = idx;
+            return CU_OK;
+        }
+        i = (i + 1) & reader->mask;
+    }
+    cu_set_last_errorf("%s: no entry named %s", reader->path, name);
+    return CU_ERR_INVALID_ARG;
+}
+
+/* Decode `csize` bytes at `off` through the stream vtable into out[0, size). */
+static cu_status_t inflate_entry(cu_zip_reader_t* r, const cu_algorithm_vtbl_t* v,
+                                 uint64_t off, uint64_t csize, uint8_t* out, size_t size) {
+    size_t in_cap = csize < ZIP_IO_BUF ? (size_t)csize : ZIP_IO_BUF;
+    uint8_t* in = malloc(in_cap ? in_cap : 1);
+    if (!in) return oom();
+    void* st = NULL;
+    cu_status_t s = v->decompress_stream_create(&st);
+    size_t produced = 0;
+    uint64_t left = csize;
+    int finishing = 0;
+    while (s == CU_OK) {
+        const uint8_t* p = NULL;
+        size_t n = 0;
+        if (left) {
+            n = left < in_cap ? (size_t)left : in_cap;
+            s = read_at(r, off + (csize - left), in, n);
+            if (s != CU_OK) break;
+            p = in;
+            left -= n;
+        } else {
+            finishing = 1;
+        }
+        cu_status_t d;
+        do {
+            size_t o = size - produced;
+            d = finishing ? v->decompress_stream_finish(st, out + produced, &o)
+                          : v->decompress_stream_write(st, p, n, out + produced, &o);
+            produced += o;
+            p = NULL;
+            n = 0;
+            if (d == CU_ERR_BUF_TOO_SMALL && produced == size) {
+                cu_set_last_errorf("%s: entry is larger than its recorded size", r->path);
+                d = CU_ERR_DECOMPRESSION;
+            }
+        } while (d == CU_ERR_BUF_TOO_SMALL);
+        s = d;
+        if (finishing) break;
+    }
+    if (st) v->decompress_stream_destroy(st);
+    free(in);
+    if (s == CU_OK && produced != size) {
+        cu_set_last_errorf("%s: entry is shorter than its recorded size", r->path);
+        s = CU_ERR_DECOMPRESSION;
+    }
+    return s;
+}
+
+cu_status_t cu_zip_reader_extract(
+    cu_zip_reader_t* reader,
+    size_t index,
+    uint8_t* out, size_t* out_len
+) {
+    if (!reader || !out_len || index >= reader->n) return CU_ERR_INVALID_ARG;
+    const zip_rec_t* rec = &reader->recs[index];
+    const cu_zip_entry_t* e = &rec->pub;
+    if (e->size > SIZE_MAX || *out_len < e->size) {
+        *out_len = e->size > SIZE_MAX ? SIZE_MAX : (size_t)e->size;
+        return CU_ERR_BUF_TOO_SMALL;
+    }
+    if (e->size > 0 && !out) return CU_ERR_INVALID_ARG;
+    if (rec->flags & ZIP_FLAG_ENCRYPT) {
+        cu_set_last_errorf("%s: %s is encrypted", reader->path, e->name);
+        return CU_ERR_UNSUPPORTED_ALGO;
+    }
+    const cu_algorithm_vtbl_t* v;
+    cu_status_t s = method_vtbl(e->method, &v);
+    if (s != CU_OK) return s;
+
+    uint8_t h[ZIP_LOCAL_LEN];
+    s = read_at(reader, rec->local_off, h, sizeof(h));
+    if (s != CU_OK) return s;
+    if (get_le32(h) != ZIP_LOCAL_SIG) return bad_archive(reader, "bad local header");
+    uint64_t data = rec->local_off + ZIP_LOCAL_LEN + get_le16(h + 26) + get_le16(h + 28);
+    size_t size = (size_t)e->size;
+
+    if (!v) {
+        if (e->compressed_size != e->size) return bad_archive(reader, "stored size mismatch");
+        s = read_at(reader, data, out, size);
+    } else if (size > 0) {
+        s = inflate_entry(reader, v, data, e->compressed_size, out, size);
+    }
+    if (s != CU_OK) return s;
+    if (zip_crc32(0, out, size) != e->crc32) {
+        cu_set_last_errorf("%s: %s: CRC-32 mismatch", reader->path, e->name);
+        return CU_ERR_DECOMPRESSION;
+    }
+    *out_len = size;
+    cu_clear_last_error();
+    return CU_OK;
+}
+
+typedef struct {
+    cu_zip_reader_t* r;
+    const size_t*    indices;
+    uint8_t* const*  outs;
+    size_t*          out_lens;
+    cu_status_t*     status;
+
+    cu_mutex_t       err_lock;
+    size_t           err_at;    /* list position of err, SIZE_MAX if none */
+    char             err[256];  /* message of the first failure in list order */
+} zip_extract_job_t;
+
+static void zip_extract_one(void* ctx, size_t i) {
+    zip_extract_job_t* job = (zip_extract_job_t*)ctx;
+    cu_status_t s = cu_zip_reader_extract(job->r, job->indices[i], job->outs[i],
+                                          &job->out_lens[i]);
+    job->status[i] = s;
+    if (s != CU_OK) {
+        /* cu_last_error is thread-local: carry the message home. */
+        cu_mutex_lock(&job->err_lock);
+        if (i < job->err_at) {
+            job->err_at = i;
+            strncpy(job->err, cu_last_error(), sizeof(job->err) - 1);
+            job->err[sizeof(job->err) - 1] = '\0';
+        }
+        cu_mutex_unlock(&job->err_lock);
+    }
+}
+
+/* Decode where the caller wants the bytes. */
+static const void* zip_extract_home(void* ctx, size_t i) {
+    return ((zip_extract_job_t*)ctx)->outs[i];
+}
+
+cu_status_t cu_zip_reader_extract_many(
+    cu_zip_reader_t* reader,
+    const size_t* indices, size_t n,
+    uint8_t* const* outs, size_t* out_lens,
+    cu_status_t* results,
+    const cu_parallel_opts_t* opts
+) {
+    if (!reader || (n > 0 && (!indices || !outs || !out_lens))) return CU_ERR_INVALID_ARG;
+    cu_status_t* status = results ? results : malloc((n ? n : 1) * sizeof(*status));
+    if (!status) return oom();
+
+    zip_extract_job_t job = {
+        .r = reader, .indices = indices, .outs = outs, .out_lens = out_lens,
+        .status = status, .err_at = SIZE_MAX,
+    };
+    cu_mutex_init(&job.err_lock);
+    cu_parallel_for_placed(cu_parallel_threads(opts), n, zip_extract_one, zip_extract_home, &job);
+    cu_mutex_destroy(&job.err_lock);
+
+    cu_status_t s = job.err_at == SIZE_MAX ? CU_OK : status[job.err_at];
+    if (!results) free(status);
+    if (s != CU_OK) cu_set_last_error(job.err);
+    else cu_clear_last_error();
+    return s;
+}
+
+void cu_zip_reader_destroy(cu_zip_reader_t* reader) {
+    if (!reader) return;
+#if defined(_WIN32)
+    if (reader->f) fclose(reader->f);
+    cu_mutex_destroy(&reader->lock);
+#else
+    if (reader->fd >= 0) close(reader->fd);
+#endif
+    free(reader->recs);
+    free(reader->names);
+    free(reader->slots);
+    free(reader->path);
+    free(reader);
+}
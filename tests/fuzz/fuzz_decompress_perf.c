@@ -0,0 +1,314 @@
+/*
+ * fuzz_decompress_perf.c — libFuzzer harness hunting for slow or
+ * memory-hungry decompression inputs (algorithmic-complexity DoS).
+ *
+ * Same input layout as fuzz_decompress.c: the first byte selects the
+ * algorithm (index into ALGOS), the rest is the payload. Every input runs
+ * through the one-shot and the streaming decoder; each run is timed in
+ * cycles (TSC on x86; elsewhere nanoseconds stand in) and its peak heap is
+ * tracked through an interposed allocator.
+ *
+ * Guidance: the cycles per input byte, cycles per output byte and peak heap
+ * of every run land in libFuzzer's extra counters as log2 buckets, one
+ * counter per (algorithm, decoder, metric, bucket). Reaching a slower or
+ * hungrier bucket than any corpus input so far counts as new coverage, so
+ * libFuzzer keeps the input and mutates it further — the search climbs
+ * toward pathological inputs the way a coverage fuzzer climbs toward new
+ * branches.
+ *
+ * Findings: a run whose cycles per processed byte (input + output) exceed
+ * the floor, or whose peak heap exceeds the ceiling, is written to
+ * CU_PERF_FUZZ_DIR (default "perf-findings") as slow-<algo>-<decoder>-<hash>
+ * or mem-<algo>-<decoder>-<hash>, with a line on stderr. Fuzzing continues.
+ * Knobs (environment):
+ *   CU_PERF_FUZZ_MAX_CPB       cycles per processed byte floor (default 2000)
+ *   CU_PERF_FUZZ_MIN_CYCLES    runs shorter than this aren't judged, so fixed
+ *                              per-call setup on tiny inputs isn't flagged
+ *                              (default 10000000)
+ *   CU_PERF_FUZZ_MAX_HEAP_MB   peak heap ceiling per run (default 128)
+ *   CU_PERF_FUZZ_DIR           where findings go
+ *
+ * Build without ASan/UBSan (-fsanitize=fuzzer only): sanitizers distort
+ * timing and own the allocator. The CMake option ENABLE_FUZZ wires this up;
+ * see tests/fuzz/CMakeLists.txt. Run with a per-input timeout so a true hang
+ * is still caught:
+ *   ./fuzz_decompress_perf -timeout=10 -rss_limit_mb=4096 corpus/
+ *
+ * The allocator tracking needs glibc; elsewhere the memory metric is 0.
+ */
+
+#include "compress_utils.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static const cu_algorithm_t ALGOS[] = {
+    CU_ALGO_ZSTD, CU_ALGO_BROTLI, CU_ALGO_ZLIB,   CU_ALGO_BZ2,
+    CU_ALGO_LZ4,  CU_ALGO_XZ,     CU_ALGO_SNAPPY, CU_ALGO_GZIP,
+};
+#define N_ALGOS (sizeof(ALGOS) / sizeof(ALGOS[0]))
+
+#define MAX_OUT (4 * 1024 * 1024)
+
+/* ---- cycles -------------------------------------------------------------- */
+
+static uint64_t perf_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* ---- heap ---------------------------------------------------------------- */
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+
+/* Interpose the allocator: forward to glibc's entry points, counting usable
+ * bytes so a run's peak heap is known without a sanitizer. */
+extern void* __libc_malloc(size_t n);
+extern void* __libc_calloc(size_t n, size_t size);
+extern void* __libc_realloc(void* p, size_t n);
+extern void* __libc_memalign(size_t align, size_t n);
+extern void __libc_free(void* p);
+
+static size_t heap_live, heap_peak;
+
+static void heap_add(void* p) {
+    if (!p) return;
+    heap_live += malloc_usable_size(p);
+    if (heap_live > heap_peak) heap_peak = heap_live;
+}
+
+static void heap_sub(void* p) {
+    if (p) heap_live -= malloc_usable_size(p);
+}
+
+void* malloc(size_t n) {
+    void* p = __libc_malloc(n);
+    heap_add(p);
+    return p;
+}
+
+void* calloc(size_t n, size_t size) {
+    void* p = __libc_calloc(n, size);
+    heap_add(p);
+    return p;
+}
+
+void* realloc(void* p, size_t n) {
+    size_t old = p ? malloc_usable_size(p) : 0;
+    void* q = __libc_realloc(p, n);
+    if (q || n == 0) {
+        heap_live -= old;
+        heap_add(q);
+    }
+    return q;
+}
+
+void free(void* p) {
+    heap_sub(p);
+    __libc_free(p);
+}
+
+void* memalign(size_t align, size_t n) {
+    void* p = __libc_memalign(align, n);
+    heap_add(p);
+    return p;
+}
+
+void* aligned_alloc(size_t align, size_t n) { return memalign(align, n); }
+
+int posix_memalign(void** out, size_t align, size_t n) {
+    if (align < sizeof(void*) || (align & (align - 1))) return EINVAL;
+    void* p = memalign(align, n);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+static size_t heap_begin(void) {
+    heap_peak = heap_live;
+    return heap_live;
+}
+
+static size_t heap_end(size_t base) { return heap_peak - base; }
+#else
+static size_t heap_begin(void) { return 0; }
+static size_t heap_end(size_t base) { (void)base; return 0; }
+#endif
+
+/* ---- guidance ------------------------------------------------------------ */
+
+enum { DEC_ONESHOT, DEC_STREAM, N_DECODERS };
+enum { MET_CPB_IN, MET_CPB_OUT, MET_HEAP, N_METRICS };
+#define N_BUCKETS 48
+
+static const char* const DECODER_NAMES[N_DECODERS] = { "oneshot", "stream" };
+
+/* libFuzzer clears these before each input and treats every counter that
+ * ends up non-zero as a feature. */
+#if defined(__linux__)
+__attribute__((used, section("__libfuzzer_extra_counters")))
+#endif
+static uint8_t perf_counters[N_ALGOS * N_DECODERS * N_METRICS * N_BUCKETS];
+
+static unsigned log2_bucket(uint64_t v) {
+    unsigned b = 0;
+    while (v > 1 && b < N_BUCKETS - 1) { v >>= 1; b++; }
+    return b;
+}
+
+static void perf_feature(size_t algo_idx, int dec, int metric, uint64_t v) {
+    size_t i = ((algo_idx * N_DECODERS + (size_t)dec) * N_METRICS + (size_t)metric) * N_BUCKETS +
+               log2_bucket(v);
+    perf_counters[i] = 1;
+}
+
+/* ---- findings ------------------------------------------------------------ */
+
+static uint64_t env_u64(const char* name, uint64_t fallback) {
+    const char* v = getenv(name);
+    if (!v || !*v) return fallback;
+    char* end;
+    unsigned long long n = strtoull(v, &end, 10);
+    return *end == '\0' ? (uint64_t)n : fallback;
+}
+
+static uint64_t max_cpb, min_cycles, max_heap;
+static const char* finding_dir;
+
+int LLVMFuzzerInitialize(int* argc, char*** argv) {
+    (void)argc; (void)argv;
+    max_cpb = env_u64("CU_PERF_FUZZ_MAX_CPB", 2000);
+    min_cycles = env_u64("CU_PERF_FUZZ_MIN_CYCLES", 10000000);
+    max_heap = env_u64("CU_PERF_FUZZ_MAX_HEAP_MB", 128) << 20;
+    finding_dir = getenv("CU_PERF_FUZZ_DIR");
+    if (!finding_dir || !*finding_dir) finding_dir = "perf-findings";
+    (void)mkdir(finding_dir, 0777); /* EEXIST is fine */
+    cu_set_max_decompressed_size(MAX_OUT);
+    return 0;
+}
+
+static void save_finding(const char* kind, cu_algorithm_t algo, int dec, const uint8_t* data,
+                         size_t size, uint64_t cycles, size_t in_len, size_t out_len,
+                         size_t heap) {
+    uint64_t h = 1469598103934665603ull; /* FNV-1a */
+    for (size_t i = 0; i < size; i++) h = (h ^ data[i]) * 1099511628211ull;
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s-%s-%s-%016llx", finding_dir, kind,
+             cu_algorithm_name(algo), DECODER_NAMES[dec], (unsigned long long)h);
+    FILE* f = fopen(path, "wb");
+    if (f) {
+        fwrite(data, 1, size, f);
+        fclose(f);
+    }
+    fprintf(stderr,
+            "perf-fuzz: %s %s/%s: %llu cycles, in %zu B (%.0f cyc/B), out %zu B (%.0f cyc/B), "
+            "peak heap %zu B -> %s%s\n",
+            kind, cu_algorithm_name(algo), DECODER_NAMES[dec], (unsigned long long)cycles,
+            in_len, in_len ? (double)cycles / (double)in_len : 0.0, out_len,
+            out_len ? (double)cycles / (double)out_len : 0.0, heap, path,
+            f ? "" : " (not written)");
+}
+
+static void judge(size_t algo_idx, int dec, const uint8_t* data, size_t size, uint64_t cycles,
+                  size_t in_len, size_t out_len, size_t heap) {
+    perf_feature(algo_idx, dec, MET_CPB_IN, cycles / (in_len ? in_len : 1));
+    perf_feature(algo_idx, dec, MET_CPB_OUT, cycles / (out_len ? out_len : 1));
+    perf_feature(algo_idx, dec, MET_HEAP, heap);
+
+    cu_algorithm_t algo = ALGOS[algo_idx];
+    if (cycles >= min_cycles && cycles / (in_len + out_len + 1) > max_cpb) {
+        save_finding("slow", algo, dec, data, size, cycles, in_len, out_len, heap);
+    }
+    if (heap > max_heap) {
+        save_finding("mem", algo, dec, data, size, cycles, in_len, out_len, heap);
+    }
+}
+
+/* ---- decoders ------------------------------------------------------------ */
+
+/* Stream through a small scratch with bounded drains; returns bytes out. */
+static size_t stream_decode(cu_algorithm_t algo, const uint8_t* in, size_t in_len) {
+    cu_decompress_stream_t* ds = NULL;
+    if (cu_decompress_stream_create(algo, &ds) != CU_OK || !ds) return 0;
+    uint8_t scratch[4096];
+    size_t total = 0, pos = 0;
+    cu_status_t s = CU_OK;
+    while (pos < in_len && s == CU_OK && total < MAX_OUT) {
+        size_t chunk = in_len - pos < 1024 ? in_len - pos : 1024;
+        size_t n = sizeof(scratch);
+        s = cu_decompress_stream_write(ds, in + pos, chunk, scratch, &n);
+        total += n;
+        pos += chunk;
+        while (s == CU_ERR_BUF_TOO_SMALL && total < MAX_OUT) {
+            n = sizeof(scratch);
+            s = cu_decompress_stream_write(ds, NULL, 0, scratch, &n);
+            total += n;
+        }
+    }
+    for (int guard = 0; s == CU_OK && guard < MAX_OUT / 4096 && total < MAX_OUT; guard++) {
+        size_t n = sizeof(scratch);
+        s = cu_decompress_stream_finish(ds, scratch, &n);
+        total += n;
+        if (s != CU_ERR_BUF_TOO_SMALL) break;
+        s = CU_OK;
+    }
+    cu_decompress_stream_destroy(ds);
+    return total;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < 1) return 0;
+    size_t algo_idx = data[0] % N_ALGOS;
+    cu_algorithm_t algo = ALGOS[algo_idx];
+    const uint8_t* payload = data + 1;
+    size_t payload_len = size - 1;
+
+    if (!cu_algorithm_available(algo)) return 0;
+
+    /* One-shot: size the buffer from the hint, as a caller would. The
+     * buffer is allocated before tracking starts, so only the codec's own
+     * allocations count toward the heap metric. */
+    size_t hint = 0;
+    (void)cu_decompress_size_hint(algo, payload, payload_len, &hint);
+    size_t out_cap = hint > 0 && hint <= MAX_OUT ? hint : 64 * 1024;
+    uint8_t* out = malloc(out_cap);
+    if (!out) return 0;
+    size_t out_len = out_cap;
+    size_t base = heap_begin();
+    uint64_t t0 = perf_cycles();
+    cu_status_t st = cu_decompress(algo, payload, payload_len, out, &out_len);
+    uint64_t cycles = perf_cycles() - t0;
+    /* Stopping at the buffer or the size cap still decoded ~out_cap bytes;
+     * counting them keeps a legitimately high-ratio input from reading as
+     * slow. Other failures produced nothing useful. */
+    if (st == CU_ERR_BUF_TOO_SMALL || st == CU_ERR_SIZE_UNKNOWN || st == CU_ERR_SIZE_LIMIT)
+        out_len = out_cap;
+    else if (st != CU_OK) out_len = 0;
+    size_t heap = heap_end(base);
+    free(out);
+    judge(algo_idx, DEC_ONESHOT, data, size, cycles, payload_len, out_len, heap);
+
+    base = heap_begin();
+    t0 = perf_cycles();
+    out_len = stream_decode(algo, payload, payload_len);
+    cycles = perf_cycles() - t0;
+    heap = heap_end(base);
+    judge(algo_idx, DEC_STREAM, data, size, cycles, payload_len, out_len, heap);
+    return 0;
+}
@@ -12,15 +12,26 @@ the actual reference *binaries* everyone uses — `zstd`, `xz`, `lz4`,
 the legacy LZ4 wire-format bug: the `lz4` CLI is *the* canonical LZ4-frame
 consumer.
 
-It drives "our side" through the installed `compress_utils` Python binding
-(the project ships no standalone CLI yet — see TODO.md). Set PYTHONPATH to
-the binding dir if running from a source tree, e.g.:
+"Our side" is one of:
 
-    PYTHONPATH=bindings/python python3 tests/interop/cli_crosscheck.py
+  * the `compress_utils` Python binding (default). Set PYTHONPATH to the
+    binding dir if running from a source tree, e.g.:
+
+        PYTHONPATH=bindings/python python3 tests/interop/cli_crosscheck.py
+
+  * the standalone `cu` tool (bindings/cli), with `--cu PATH` or the
+    CU_BIN environment variable:
+
+        python3 tests/interop/cli_crosscheck.py --cu build/bindings/cli/cu
+
+    This channel additionally compresses in parallel mode with a small
+    --chunk, so every payload above the chunk size goes out as several
+    concatenated frames/members/streams, and decodes the reference
+    output with format auto-detection (no -a).
 
 For each algorithm with its CLI available, both directions are checked:
-    outbound: cu.compress(x) | <tool> -d        == x
-    inbound:  x | <tool> -c   -> cu.decompress() == x
+    outbound: compress(x) | <tool> -d        == x
+    inbound:  x | <tool> -c   -> decompress() == x
 
 Tools that aren't installed are SKIPPED (not failed), so this is safe to
 run anywhere; it only fails on a genuine round-trip mismatch. Exit code:
@@ -37,18 +48,12 @@ friends use the Snappy *framing* format, a different container). It's
 covered against the independent `python-snappy` library in test_interop.py.
 """
 
+import argparse
+import os
 import shutil
 import subprocess
 import sys
 
-try:
-    import compress_utils as cu
-except ImportError as e:  # pragma: no cover - environment guard
-    print(f"SKIP: compress_utils binding not importable ({e}).")
-    print("      Set PYTHONPATH to the built binding dir (e.g. bindings/python).")
-    # Not a failure of the library under test — nothing to cross-check.
-    sys.exit(0)
-
 
 # algorithm -> (decompress-to-stdout argv, compress-stdin-to-stdout argv)
 # All tools read stdin / write stdout with these flags.
@@ -70,6 +75,14 @@ PAYLOADS = {
     "single_byte":    b"Q",
 }
 
+# `cu` argv fragments per algorithm name used above.
+CU_NAMES = {"zstd": "zstd", "xz": "xz", "lz4": "lz4", "bz2": "bz2",
+            "brotli": "brotli", "gzip": "gzip"}
+
+# Parallel-mode chunk for the `cu` channel: small enough that the 64k
+# payload splits into several frames.
+CU_MULTI_FRAME_CHUNK = "16K"
+
 
 def _run(argv, data):
     """Pipe `data` through `argv`, returning stdout. Raises on nonzero exit."""
@@ -89,10 +102,54 @@ def _run(argv, data):
     return proc.stdout
 
 
-def check_algorithm(algo, decompress_argv, compress_argv):
+class PythonSide:
+    """Our side via the compress_utils Python binding."""
+
+    def __init__(self, cu):
+        self.cu = cu
+        self.label = f"compress_utils {cu.version()} (Python binding)"
+
+    def available(self, algo):
+        return self.cu.is_available(algo)
+
+    def encoders(self, algo):
+        yield "", lambda data: self.cu.compress(data, algo, level=5)
+
+    def decoders(self, algo):
+        yield "", lambda data: self.cu.decompress(data, algo)
+
+
+class CuCliSide:
+    """Our side via the standalone `cu` executable."""
+
+    def __init__(self, path):
+        self.path = path
+        self.label = _run([path, "--version"], b"").decode().strip()
+
+    def available(self, algo):
+        try:
+            _run([self.path, "-a", CU_NAMES[algo], "-c"], b"")
+            return True
+        except RuntimeError:
+            return False
+
+    def encoders(self, algo):
+        name = CU_NAMES[algo]
+        yield "", lambda data: _run([self.path, "-a", name, "-l", "5", "-T", "1", "-c"], data)
+        if algo != "brotli":  # brotli has no parallel mode
+            argv = [self.path, "-a", name, "-T", "4", "--chunk", CU_MULTI_FRAME_CHUNK, "-c"]
+            yield "/parallel", lambda data: _run(argv, data)
+
+    def decoders(self, algo):
+        yield "", lambda data: _run([self.path, "-d", "-a", CU_NAMES[algo], "-c"], data)
+        if algo != "brotli":  # no magic bytes to detect
+            yield "/auto", lambda data: _run([self.path, "-d", "-c"], data)
+
+
+def check_algorithm(side, algo, decompress_argv, compress_argv):
     """Return (ran, failures) for one algorithm across all payloads."""
     tool = decompress_argv[0]
-    if not cu.is_available(algo):
+    if not side.available(algo):
         print(f"  {algo:7} SKIP — not compiled into this build")
         return (False, 0)
     if shutil.which(tool) is None:
@@ -102,38 +159,68 @@ def check_algorithm(algo, decompress_argv, compress_argv):
     failures = 0
     for case, data in PAYLOADS.items():
         # outbound: our compressor -> canonical CLI decompressor
-        try:
-            recovered = _run(decompress_argv, cu.compress(data, algo, level=5))
-            if recovered != data:
-                print(f"  {algo:7} FAIL outbound[{case}]: "
-                      f"`{tool} -d` did not recover our output")
+        for variant, compress in side.encoders(algo):
+            try:
+                recovered = _run(decompress_argv, compress(data))
+                if recovered != data:
+                    print(f"  {algo:7} FAIL outbound{variant}[{case}]: "
+                          f"`{tool} -d` did not recover our output")
+                    failures += 1
+            except Exception as e:
+                print(f"  {algo:7} FAIL outbound{variant}[{case}]: {e}")
                 failures += 1
-        except Exception as e:
-            print(f"  {algo:7} FAIL outbound[{case}]: {e}")
-            failures += 1
 
         # inbound: canonical CLI compressor -> our decompressor
         try:
-            recovered = cu.decompress(_run(compress_argv, data), algo)
-            if recovered != data:
-                print(f"  {algo:7} FAIL inbound[{case}]: "
-                      f"we did not recover `{tool} -c` output")
-                failures += 1
+            reference = _run(compress_argv, data)
         except Exception as e:
             print(f"  {algo:7} FAIL inbound[{case}]: {e}")
             failures += 1
+            continue
+        for variant, decompress in side.decoders(algo):
+            try:
+                recovered = decompress(reference)
+                if recovered != data:
+                    print(f"  {algo:7} FAIL inbound{variant}[{case}]: "
+                          f"we did not recover `{tool} -c` output")
+                    failures += 1
+            except Exception as e:
+                print(f"  {algo:7} FAIL inbound{variant}[{case}]: {e}")
+                failures += 1
 
     if failures == 0:
         print(f"  {algo:7} OK   — both directions, {len(PAYLOADS)} payloads vs `{tool}`")
     return (True, failures)
 
 
-def main():
-    print(f"CLI cross-check (compress_utils {cu.version()})")
+def make_side(argv):
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--cu", default=os.environ.get("CU_BIN"),
+                        help="path to the `cu` executable (default: $CU_BIN; "
+                             "otherwise use the Python binding)")
+    args = parser.parse_args(argv)
+    if args.cu:
+        return CuCliSide(args.cu)
+    try:
+        import compress_utils as cu
+    except ImportError as e:  # pragma: no cover - environment guard
+        print(f"SKIP: compress_utils binding not importable ({e}).")
+        print("      Set PYTHONPATH to the built binding dir (e.g. bindings/python),")
+        print("      or pass --cu PATH to check the standalone tool instead.")
+        # Not a failure of the library under test — nothing to cross-check.
+        return None
+    return PythonSide(cu)
+
+
+def main(argv=None):
+    side = make_side(argv)
+    if side is None:
+        return 0
+    print(f"CLI cross-check ({side.label})")
     ran_any = False
     total_failures = 0
     for algo, (dargv, cargv) in TOOLS.items():
-        ran, failures = check_algorithm(algo, dargv, cargv)
+        ran, failures = check_algorithm(side, algo, dargv, cargv)
         ran_any = ran_any or ran
         total_failures += failures
 
@@ -6,8 +6,16 @@
  *   - one-shot compress/decompress round-trip
  *   - size-hint probe
  *   - BUF_TOO_SMALL behavior
+ *   - speed tiers (levels 0..CU_LEVEL_MIN) and the level range check
  *   - streaming round-trip with a chunked input and an undersized
  *     output buffer (proves the unconsumed-input drain protocol)
+ *   - stream flush: flushed output decodes before finish
+ *   - pledged stream size and cu_frame_info header introspection
+ *   - cu_compressv / cu_decompressv over segmented input and output
+ *   - checksum omission on encode and trusted-input (skip checksum) decode
+ *   - cu_compress_parallel multi-frame output through every decoder
+ *   - cu_compress_file / cu_decompress_file round-trips and I/O errors
+ *   - tar writer/reader round-trips, pax long names, indexed extraction
  *
  * Exits with 0 on success, nonzero with a message on failure. Built and
  * run via ctest.
@@ -18,6 +26,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#  include <io.h>
+#  include <process.h>
+#  define chmod _chmod
+#  define getpid _getpid
+#else
+#  include <unistd.h>
+#endif
 
 #define CHECK(cond, ...) do {                                       \
     if (!(cond)) {                                                  \
@@ -131,6 +149,64 @@ static int test_buf_too_small(void) {
     return 0;
 }
 
+/* Every speed tier round-trips, one-shot and streamed; zstd and lz4 get
+ * larger (faster) as the tier drops, and levels outside the range fail. */
+static int test_speed_tiers(void) {
+    const size_t in_len = 64 * 1024;
+    uint8_t* in = malloc(in_len);
+    CHECK(in, "oom\n");
+    uint32_t x = 7;
+    for (size_t i = 0; i < in_len; i++) {
+        x = x * 1103515245u + 12345u;
+        in[i] = (uint8_t)("abcdefgh"[(x >> 16) % 8] + (i / 8192));
+    }
+    size_t cap = cu_compress_bound(in_len, CU_ALGO_XZ) + 1024;
+    for (size_t a = 0; a < N_ALGOS; a++) {
+        size_t b = cu_compress_bound(in_len, ALL_ALGOS[a]);
+        if (b > cap) cap = b;
+    }
+    uint8_t* out = malloc(cap);
+    uint8_t* back = malloc(in_len);
+    CHECK(out && back, "oom\n");
+
+    for (size_t a = 0; a < N_ALGOS; a++) {
+        cu_algorithm_t algo = ALL_ALGOS[a];
+        if (!cu_algorithm_available(algo)) continue;
+        const char* name = cu_algorithm_name(algo);
+        size_t prev = 0;
+        for (int level = 1; level >= CU_LEVEL_MIN; level--) {
+            size_t n = cap;
+            CHECK_OK(cu_compress(algo, in, in_len, out, &n, level));
+            size_t back_len = in_len;
+            CHECK_OK(cu_decompress(algo, out, n, back, &back_len));
+            CHECK(back_len == in_len && memcmp(back, in, in_len) == 0,
+                  "%s level %d round-trip\n", name, level);
+            if ((algo == CU_ALGO_ZSTD || algo == CU_ALGO_LZ4) && level < 0) {
+                CHECK(n >= prev, "%s level %d: %zu bytes, tier above gave %zu\n",
+                      name, level, n, prev);
+            }
+            prev = n;
+
+            cu_compress_stream_t* cs = NULL;
+            CHECK_OK(cu_compress_stream_create(algo, level, &cs));
+            cu_compress_stream_destroy(cs);
+        }
+        size_t n = cap;
+        cu_status_t s = cu_compress(algo, in, in_len, out, &n, CU_LEVEL_MIN - 1);
+        CHECK(s == CU_ERR_INVALID_LEVEL, "%s level %d -> %s\n", name, CU_LEVEL_MIN - 1,
+              cu_strerror(s));
+        n = cap;
+        s = cu_compress(algo, in, in_len, out, &n, CU_LEVEL_MAX + 1);
+        CHECK(s == CU_ERR_INVALID_LEVEL, "%s level %d -> %s\n", name, CU_LEVEL_MAX + 1,
+              cu_strerror(s));
+    }
+
+    free(back);
+    free(out);
+    free(in);
+    return 0;
+}
+
 /*
  * Stream compress in 3 small chunks into a tight output buffer, draining
  * with BUF_TOO_SMALL loops. Then stream-decompress the result through a
@@ -260,6 +336,412 @@ static int test_streaming_with_tight_buffer(void) {
     return 0;
 }
 
+/*
+ * cu_compress_stream_flush: after each flushed message, the bytes emitted
+ * so far must decode to every message written so far — before finish.
+ * Flushes drain through a 16-byte buffer, and a write between two flush
+ * drains must be refused.
+ */
+static int test_stream_flush_one(cu_algorithm_t algo) {
+    const char* name = cu_algorithm_name(algo);
+    cu_compress_stream_t* cs = NULL;
+    cu_decompress_stream_t* ds = NULL;
+    CHECK_OK(cu_compress_stream_create(algo, 5, &cs));
+    CHECK_OK(cu_decompress_stream_create(algo, &ds));
+
+    cu_status_t s = cu_compress_stream_set_target_block_size(cs, 2048);
+    if (algo == CU_ALGO_ZSTD) {
+        CHECK(s == CU_OK, "%s set_target_block_size -> %s\n", name, cu_strerror(s));
+    } else {
+        CHECK(s == CU_ERR_UNSUPPORTED_ALGO, "%s set_target_block_size -> %s\n",
+              name, cu_strerror(s));
+    }
+
+    uint8_t scratch[16];
+    uint8_t chunk[1024];
+    size_t chunk_len = 0;
+    char sent[4096];
+    size_t sent_len = 0;
+    uint8_t recovered[4096];
+    size_t recovered_len = 0;
+
+    for (int msg = 0; msg < 3; msg++) {
+        char line[512];
+        int n = snprintf(line, sizeof(line),
+                         "{\"seq\":%d,\"msg\":\"message %d of the flush test\"}\n", msg, msg);
+        memcpy(sent + sent_len, line, (size_t)n);
+        sent_len += (size_t)n;
+
+        chunk_len = sizeof(chunk);
+        s = cu_compress_stream_write(cs, (const uint8_t*)line, (size_t)n, chunk, &chunk_len);
+        CHECK(s == CU_OK, "%s write -> %s\n", name, cu_strerror(s));
+
+        int drains = 0;
+        for (;;) {
+            size_t scratch_len = sizeof(scratch);
+            s = cu_compress_stream_flush(cs, scratch, &scratch_len);
+            if (algo == CU_ALGO_BZ2 || algo == CU_ALGO_SNAPPY) {
+                CHECK(s == CU_ERR_UNSUPPORTED_ALGO, "%s flush -> %s\n", name, cu_strerror(s));
+                cu_compress_stream_destroy(cs);
+                cu_decompress_stream_destroy(ds);
+                return 0;
+            }
+            CHECK(chunk_len + scratch_len <= sizeof(chunk), "%s flush overflow\n", name);
+            memcpy(chunk + chunk_len, scratch, scratch_len);
+            chunk_len += scratch_len;
+            if (s == CU_OK) break;
+            CHECK(s == CU_ERR_BUF_TOO_SMALL, "%s flush -> %s\n", name, cu_strerror(s));
+            if (drains++ == 0) {
+                size_t none = 0;
+                cu_status_t ws = cu_compress_stream_write(cs, NULL, 0, NULL, &none);
+                CHECK(ws == CU_ERR_STREAM_STATE, "%s write mid-flush -> %s\n",
+                      name, cu_strerror(ws));
+            }
+        }
+
+        const uint8_t* p = chunk;
+        size_t p_len = chunk_len;
+        for (;;) {
+            size_t out_len = sizeof(recovered) - recovered_len;
+            s = cu_decompress_stream_write(ds, p, p_len, recovered + recovered_len, &out_len);
+            recovered_len += out_len;
+            if (s == CU_OK) break;
+            CHECK(s == CU_ERR_BUF_TOO_SMALL && out_len > 0, "%s decode -> %s\n",
+                  name, cu_strerror(s));
+            p = NULL;
+            p_len = 0;
+        }
+        CHECK(recovered_len == sent_len && memcmp(recovered, sent, sent_len) == 0,
+              "%s: after flush %d decoded %zu of %zu bytes\n", name, msg,
+              recovered_len, sent_len);
+    }
+
+    s = cu_compress_stream_set_target_block_size(cs, 0);
+    CHECK(s == CU_ERR_STREAM_STATE || s == CU_ERR_UNSUPPORTED_ALGO,
+          "%s set_target_block_size after write -> %s\n", name, cu_strerror(s));
+
+    chunk_len = sizeof(chunk);
+    CHECK_OK(cu_compress_stream_finish(cs, chunk, &chunk_len));
+    size_t out_len = sizeof(recovered) - recovered_len;
+    CHECK_OK(cu_decompress_stream_write(ds, chunk, chunk_len, recovered + recovered_len, &out_len));
+    recovered_len += out_len;
+    out_len = sizeof(recovered) - recovered_len;
+    CHECK_OK(cu_decompress_stream_finish(ds, recovered + recovered_len, &out_len));
+    recovered_len += out_len;
+    CHECK(recovered_len == sent_len, "%s: %zu != %zu after finish\n", name, recovered_len, sent_len);
+
+    size_t none = 0;
+    s = cu_compress_stream_flush(cs, NULL, &none);
+    CHECK(s == CU_ERR_STREAM_FINISHED, "%s flush after finish -> %s\n", name, cu_strerror(s));
+    cu_compress_stream_destroy(cs);
+    cu_decompress_stream_destroy(ds);
+    printf("  %s flush: ok\n", name);
+    return 0;
+}
+
+static int test_stream_flush(void) {
+    for (size_t i = 0; i < N_ALGOS; i++) {
+        if (!cu_algorithm_available(ALL_ALGOS[i])) continue;
+        if (test_stream_flush_one(ALL_ALGOS[i])) return 1;
+    }
+    return 0;
+}
+
+/*
+ * Pledged size: the stream must see exactly the pledged byte count, and
+ * zstd/lz4 must record it in the frame header. cu_frame_info then reports
+ * what each header declares.
+ */
+static int test_pledged_size_one(cu_algorithm_t algo) {
+    const char* name = cu_algorithm_name(algo);
+    const size_t in_len = 40000;
+    uint8_t* in = malloc(in_len);
+    CHECK(in, "oom\n");
+    for (size_t i = 0; i < in_len; i++) in[i] = (uint8_t)("pledged "[i % 8] + (i / 4096));
+
+    int expect_pledge = algo == CU_ALGO_ZSTD || algo == CU_ALGO_LZ4 ||
+                        algo == CU_ALGO_BROTLI || algo == CU_ALGO_SNAPPY;
+    int expect_size = algo == CU_ALGO_ZSTD || algo == CU_ALGO_LZ4 || algo == CU_ALGO_SNAPPY;
+
+    cu_compress_stream_t* cs = NULL;
+    CHECK_OK(cu_compress_stream_create(algo, 5, &cs));
+    cu_status_t s = cu_compress_stream_set_pledged_size(cs, in_len);
+    CHECK(s == (expect_pledge ? CU_OK : CU_ERR_UNSUPPORTED_ALGO),
+          "%s: set_pledged_size -> %s\n", name, cu_strerror(s));
+
+    size_t cap = cu_compress_bound(in_len, algo) + 1024;
+    uint8_t* out = malloc(cap);
+    CHECK(out, "oom\n");
+    size_t total = 0, n;
+    uint8_t scratch[1];
+    if (expect_pledge) {
+        n = cap;
+        CHECK_OK(cu_compress_stream_write(cs, in, in_len / 2, out, &n));
+        total += n;
+        n = 0;
+        s = cu_compress_stream_finish(cs, scratch, &n);
+        CHECK(s == CU_ERR_STREAM_STATE, "%s: finish short of the pledge -> %s\n",
+              name, cu_strerror(s));
+        n = cap - total;
+        s = cu_compress_stream_write(cs, in, in_len, out + total, &n);
+        CHECK(s == CU_ERR_STREAM_STATE, "%s: write past the pledge -> %s\n",
+              name, cu_strerror(s));
+        n = cap - total;
+        CHECK_OK(cu_compress_stream_write(cs, in + in_len / 2, in_len - in_len / 2,
+                                          out + total, &n));
+        total += n;
+        s = cu_compress_stream_set_pledged_size(cs, in_len);
+        CHECK(s == CU_ERR_STREAM_STATE, "%s: late pledge -> %s\n", name, cu_strerror(s));
+    } else {
+        n = cap;
+        CHECK_OK(cu_compress_stream_write(cs, in, in_len, out, &n));
+        total += n;
+    }
+    n = cap - total;
+    CHECK_OK(cu_compress_stream_finish(cs, out + total, &n));
+    total += n;
+    cu_compress_stream_destroy(cs);
+
+    uint8_t* back = malloc(in_len);
+    CHECK(back, "oom\n");
+    size_t back_len = in_len;
+    CHECK_OK(cu_decompress(algo, out, total, back, &back_len));
+    CHECK(back_len == in_len && memcmp(back, in, in_len) == 0, "%s: pledged round-trip\n", name);
+
+    cu_frame_info_t fi;
+    CHECK_OK(cu_frame_info(algo, out, total, &fi));
+    if (expect_size) {
+        CHECK(fi.content_size == in_len, "%s: frame content_size %llu\n",
+              name, (unsigned long long)fi.content_size);
+    } else {
+        CHECK(fi.content_size == CU_FRAME_SIZE_UNKNOWN, "%s: unexpected content_size\n", name);
+    }
+    /* zstd frames carry no content checksum unless one is requested. */
+    int expect_checksum = algo != CU_ALGO_ZSTD && algo != CU_ALGO_BROTLI &&
+                          algo != CU_ALGO_SNAPPY;
+    CHECK(fi.has_checksum == expect_checksum, "%s: has_checksum %d\n", name, fi.has_checksum);
+    if (algo != CU_ALGO_BZ2 && algo != CU_ALGO_SNAPPY) {
+        CHECK(fi.window_size > 0, "%s: no window size\n", name);
+    }
+    CHECK(fi.dict_id == 0, "%s: dict_id %u\n", name, (unsigned)fi.dict_id);
+    CHECK(fi.blocks_independent == (algo == CU_ALGO_BZ2), "%s: blocks_independent\n", name);
+
+    s = cu_frame_info(algo, out, 0, &fi);
+    CHECK(s == CU_ERR_TRUNCATED, "%s: empty frame_info -> %s\n", name, cu_strerror(s));
+    if (algo != CU_ALGO_BROTLI && algo != CU_ALGO_SNAPPY) {
+        static const uint8_t junk[16] = {0x5a, 0x5a, 0x5a, 0x5a, 0x5a, 0x5a, 0x5a, 0x5a,
+                                         0x5a, 0x5a, 0x5a, 0x5a, 0x5a, 0x5a, 0x5a, 0x5a};
+        s = cu_frame_info(algo, junk, sizeof(junk), &fi);
+        CHECK(s == CU_ERR_DECOMPRESSION, "%s: junk frame_info -> %s\n", name, cu_strerror(s));
+    }
+
+    free(back);
+    free(out);
+    free(in);
+    return 0;
+}
+
+static int test_pledged_size(void) {
+    for (size_t i = 0; i < N_ALGOS; i++) {
+        if (!cu_algorithm_available(ALL_ALGOS[i])) continue;
+        if (test_pledged_size_one(ALL_ALGOS[i])) return 1;
+    }
+    return 0;
+}
+
+/* Gather a three-piece message (plus an empty piece) into paged output,
+ * check it decodes one-shot, then scatter it back out in odd page sizes. */
+static int test_iovec_one(cu_algorithm_t algo) {
+    const char* name = cu_algorithm_name(algo);
+    static const uint8_t header[13] = "MSG-HEADER-01";
+    static const uint8_t trailer[7] = "TRAILER";
+    const size_t body_len = 50000;
+    uint8_t* body = malloc(body_len);
+    CHECK(body, "oom\n");
+    uint32_t x = 12345;
+    for (size_t i = 0; i < body_len; i++) {
+        /* first 20 KB incompressible, so the stream path is held to the bound */
+        x = x * 1103515245u + 12345u;
+        body[i] = i < 20000 ? (uint8_t)(x >> 24) : (uint8_t)("scatter "[i % 8]);
+    }
+    const size_t msg_len = sizeof(header) + body_len + sizeof(trailer);
+    uint8_t* msg = malloc(msg_len);
+    CHECK(msg, "oom\n");
+    memcpy(msg, header, sizeof(header));
+    memcpy(msg + sizeof(header), body, body_len);
+    memcpy(msg + sizeof(header) + body_len, trailer, sizeof(trailer));
+
+    cu_const_iovec_t in[4] = {
+        { header, sizeof(header) }, { NULL, 0 }, { body, body_len }, { trailer, sizeof(trailer) },
+    };
+    size_t bound = cu_compress_bound(msg_len, algo);
+    const size_t page = 4096;
+    size_t npages = (bound + page - 1) / page;
+    uint8_t* pool = malloc(npages * page);
+    CHECK(pool, "oom\n");
+    cu_iovec_t pages[64];
+    CHECK(npages <= 64, "%s: bound %zu needs too many pages\n", name, bound);
+    for (size_t i = 0; i < npages; i++) pages[i] = (cu_iovec_t){ pool + i * page, page };
+
+    size_t n = 0;
+    cu_status_t s = cu_compressv(algo, in, 4, pages, 1, &n, 5);
+    CHECK(s == CU_ERR_BUF_TOO_SMALL && n == bound, "%s: short compressv -> %s, %zu\n",
+          name, cu_strerror(s), n);
+    CHECK_OK(cu_compressv(algo, in, 4, pages, npages, &n, 5));
+    size_t comp_len = n;
+
+    /* Pages are contiguous in the pool, so the frame is pool[0..comp_len). */
+    uint8_t* back = malloc(msg_len);
+    CHECK(back, "oom\n");
+    size_t back_len = msg_len;
+    CHECK_OK(cu_decompress(algo, pool, comp_len, back, &back_len));
+    CHECK(back_len == msg_len && memcmp(back, msg, msg_len) == 0, "%s: gathered frame\n", name);
+
+    cu_const_iovec_t cin[3] = {
+        { pool, comp_len / 3 }, { pool + comp_len / 3, 0 },
+        { pool + comp_len / 3, comp_len - comp_len / 3 },
+    };
+    cu_iovec_t outs[80];
+    const size_t opage = 1000;
+    size_t nout = (msg_len + opage - 1) / opage;
+    CHECK(nout <= 80, "too many output pages\n");
+    for (size_t i = 0; i < nout; i++) {
+        size_t len = i + 1 < nout ? opage : msg_len - i * opage;
+        outs[i] = (cu_iovec_t){ back + i * opage, len };
+    }
+    memset(back, 0, msg_len);
+    CHECK_OK(cu_decompressv(algo, cin, 3, outs, nout, &n));
+    CHECK(n == msg_len && memcmp(back, msg, msg_len) == 0, "%s: scattered output\n", name);
+
+    outs[nout - 1].len -= 1;
+    s = cu_decompressv(algo, cin, 3, outs, nout, &n);
+    if (s == CU_ERR_BUF_TOO_SMALL) {
+        CHECK(n == msg_len, "%s: short decompressv reported %zu\n", name, n);
+    } else {
+        CHECK(s == CU_ERR_SIZE_UNKNOWN, "%s: short decompressv -> %s\n", name, cu_strerror(s));
+    }
+
+    free(back);
+    free(pool);
+    free(msg);
+    free(body);
+    return 0;
+}
+
+static int test_iovec(void) {
+    for (size_t i = 0; i < N_ALGOS; i++) {
+        if (!cu_algorithm_available(ALL_ALGOS[i])) continue;
+        if (test_iovec_one(ALL_ALGOS[i])) return 1;
+    }
+    return 0;
+}
+
+/* Stream-compress `in` in one go; `checksum` < 0 keeps the codec default. */
+static cu_status_t checksum_encode(cu_algorithm_t algo, int checksum,
+                                   const uint8_t* in, size_t in_len,
+                                   uint8_t* out, size_t cap, size_t* out_len) {
+    cu_compress_stream_t* cs = NULL;
+    cu_status_t s = cu_compress_stream_create(algo, 3, &cs);
+    if (s != CU_OK) return s;
+    if (checksum >= 0) s = cu_compress_stream_set_checksum(cs, checksum);
+    size_t n = cap, m = 0;
+    if (s == CU_OK) s = cu_compress_stream_write(cs, in, in_len, out, &n);
+    if (s == CU_OK) {
+        m = cap - n;
+        s = cu_compress_stream_finish(cs, out + n, &m);
+    }
+    cu_compress_stream_destroy(cs);
+    *out_len = n + m;
+    return s;
+}
+
+static cu_status_t checksum_decode(cu_algorithm_t algo, int skip,
+                                   const uint8_t* in, size_t in_len,
+                                   uint8_t* out, size_t cap, size_t* out_len) {
+    cu_decompress_stream_t* ds = NULL;
+    cu_status_t s = cu_decompress_stream_create(algo, &ds);
+    if (s != CU_OK) return s;
+    if (skip) s = cu_decompress_stream_set_skip_checksum(ds, 1);
+    size_t n = cap, m = 0;
+    if (s == CU_OK) s = cu_decompress_stream_write(ds, in, in_len, out, &n);
+    if (s == CU_OK) {
+        m = cap - n;
+        s = cu_decompress_stream_finish(ds, out + n, &m);
+    }
+    cu_decompress_stream_destroy(ds);
+    *out_len = n + m;
+    return s;
+}
+
+/* Encode without checksums where the format allows it; decode with a
+ * corrupted checksum, which only trusted-input mode accepts. */
+static int test_checksum_options_one(cu_algorithm_t algo) {
+    const char* name = cu_algorithm_name(algo);
+    const size_t in_len = 30000;
+    uint8_t* in = malloc(in_len);
+    CHECK(in, "oom\n");
+    for (size_t i = 0; i < in_len; i++) in[i] = (uint8_t)("checksum"[i % 8] ^ (i / 1000));
+    size_t cap = cu_compress_bound(in_len, algo) + 1024;
+    uint8_t* z = malloc(cap);
+    uint8_t* back = malloc(in_len);
+    CHECK(z && back, "oom\n");
+
+    int can_omit = algo == CU_ALGO_ZSTD || algo == CU_ALGO_LZ4 || algo == CU_ALGO_XZ;
+    int can_skip = can_omit || algo == CU_ALGO_ZLIB || algo == CU_ALGO_GZIP;
+    size_t z_len = 0, back_len = 0;
+
+    cu_status_t s = checksum_encode(algo, 0, in, in_len, z, cap, &z_len);
+    CHECK(s == (can_omit ? CU_OK : CU_ERR_UNSUPPORTED_ALGO), "%s: set_checksum(0) -> %s\n",
+          name, cu_strerror(s));
+    if (can_omit) {
+        cu_frame_info_t fi;
+        CHECK_OK(cu_frame_info(algo, z, z_len, &fi));
+        CHECK(fi.has_checksum == 0, "%s: checksum written after set_checksum(0)\n", name);
+        CHECK_OK(checksum_decode(algo, 0, z, z_len, back, in_len, &back_len));
+        CHECK(back_len == in_len && memcmp(back, in, in_len) == 0, "%s: no-checksum round-trip\n",
+              name);
+    }
+
+    cu_decompress_stream_t* ds = NULL;
+    CHECK_OK(cu_decompress_stream_create(algo, &ds));
+    s = cu_decompress_stream_set_skip_checksum(ds, 1);
+    CHECK(s == (can_skip ? CU_OK : CU_ERR_UNSUPPORTED_ALGO), "%s: set_skip_checksum -> %s\n",
+          name, cu_strerror(s));
+    if (can_skip) {
+        size_t n = in_len;
+        CHECK_OK(cu_decompress_stream_write(ds, z, 1, back, &n));
+        s = cu_decompress_stream_set_skip_checksum(ds, 1);
+        CHECK(s == CU_ERR_STREAM_STATE, "%s: late set_skip_checksum -> %s\n", name, cu_strerror(s));
+    }
+    cu_decompress_stream_destroy(ds);
+
+    /* The checksum is the trailer's last four bytes, except gzip (CRC-32
+     * then ISIZE). xz keeps its check inside the stream; covered above. */
+    if (can_skip && algo != CU_ALGO_XZ) {
+        CHECK_OK(checksum_encode(algo, algo == CU_ALGO_ZSTD ? 1 : -1, in, in_len, z, cap, &z_len));
+        z[z_len - (algo == CU_ALGO_GZIP ? 8 : 1)] ^= 0x5a;
+        s = checksum_decode(algo, 0, z, z_len, back, in_len, &back_len);
+        CHECK(s == CU_ERR_DECOMPRESSION, "%s: corrupt checksum accepted -> %s\n",
+              name, cu_strerror(s));
+        memset(back, 0, in_len);
+        CHECK_OK(checksum_decode(algo, 1, z, z_len, back, in_len, &back_len));
+        CHECK(back_len == in_len && memcmp(back, in, in_len) == 0, "%s: trusted decode\n", name);
+    }
+
+    free(back);
+    free(z);
+    free(in);
+    return 0;
+}
+
+static int test_checksum_options(void) {
+    for (size_t i = 0; i < N_ALGOS; i++) {
+        if (!cu_algorithm_available(ALL_ALGOS[i])) continue;
+        if (test_checksum_options_one(ALL_ALGOS[i])) return 1;
+    }
+    return 0;
+}
+
 /*
  * Cross-API round-trips: stream-compress then one-shot decompress, and
  * one-shot compress then stream-decompress. These are the tests that
@@ -435,6 +917,75 @@ static int test_cross_api(void) {
     return 0;
 }
 
+/* Huge-page backing must not change a single output byte. A 64 KiB
+ * threshold sends most context allocations through the mapping path; the
+ * second round takes them from the cache. */
+static int test_huge_pages_one(cu_algorithm_t algo) {
+    const char* name = cu_algorithm_name(algo);
+    const size_t in_len = 100000;
+    uint8_t* in = malloc(in_len);
+    CHECK(in, "oom\n");
+    for (size_t i = 0; i < in_len; i++) in[i] = (uint8_t)("huge page "[i % 10] + (i / 777) % 5);
+    size_t cap = cu_compress_bound(in_len, algo);
+    uint8_t* ref = malloc(cap);
+    uint8_t* z = malloc(cap);
+    uint8_t* back = malloc(in_len);
+    CHECK(ref && z && back, "oom\n");
+
+    size_t ref_len = cap;
+    CHECK_OK(cu_compress(algo, in, in_len, ref, &ref_len, 8));
+    cu_set_huge_pages(64 * 1024);
+    for (int round = 0; round < 2; round++) {
+        size_t z_len = cap, back_len = in_len;
+        CHECK_OK(cu_compress(algo, in, in_len, z, &z_len, 8));
+        CHECK(z_len == ref_len && memcmp(z, ref, ref_len) == 0, "%s: output changed with huge pages\n", name);
+        CHECK_OK(cu_decompress(algo, z, z_len, back, &back_len));
+        CHECK(back_len == in_len && memcmp(back, in, in_len) == 0, "%s: huge-page round-trip\n", name);
+
+        uint8_t* sz = NULL;
+        uint8_t* sb = NULL;
+        size_t sz_len = 0, sb_len = 0;
+        CHECK_OK(collect_stream_compress(algo, 8, in, in_len, &sz, &sz_len));
+        CHECK_OK(collect_stream_decompress(algo, sz, sz_len, &sb, &sb_len));
+        CHECK(sb_len == in_len && memcmp(sb, in, in_len) == 0, "%s: huge-page stream round-trip\n", name);
+        free(sz);
+        free(sb);
+    }
+    cu_set_huge_pages(0);
+
+    free(back);
+    free(z);
+    free(ref);
+    free(in);
+    return 0;
+}
+
+static int test_huge_pages(void) {
+    for (size_t i = 0; i < N_ALGOS; i++) {
+        if (!cu_algorithm_available(ALL_ALGOS[i])) continue;
+        if (test_huge_pages_one(ALL_ALGOS[i])) return 1;
+    }
+    return 0;
+}
+
+static int test_warmup(void) {
+    CHECK_OK(cu_warmup(NULL, 0, NULL, 0));
+    cu_algorithm_t algos[N_ALGOS];
+    size_t n = 0;
+    for (size_t i = 0; i < N_ALGOS; i++) {
+        if (cu_algorithm_available(ALL_ALGOS[i])) algos[n++] = ALL_ALGOS[i];
+    }
+    const int levels[] = { -1, 1, 6 };
+    CHECK_OK(cu_warmup(algos, n, levels, 3));
+
+    const int bad_level = 11;
+    cu_status_t s = cu_warmup(algos, n, &bad_level, 1);
+    CHECK(s == CU_ERR_INVALID_LEVEL, "warmup level 11 -> %s\n", cu_strerror(s));
+    s = cu_warmup(NULL, 1, NULL, 0);
+    CHECK(s == CU_ERR_INVALID_ARG, "warmup NULL algos -> %s\n", cu_strerror(s));
+    return 0;
+}
+
 /* Regression: malformed/garbage input must be REJECTED promptly and must never
  * send the caller into an unbounded drain loop. Guards the xz decompression-bomb
  * class (a truncated/garbage stream whose finish() kept returning
@@ -484,13 +1035,456 @@ static int test_reject_garbage(void) {
     return 0;
 }
 
+/* cu_compress_parallel: a small chunk_size forces several frames so the
+ * concatenated-frame decode paths (one-shot, size hint, streaming) all run.
+ * Output must not depend on the thread count. */
+static int test_parallel_one(cu_algorithm_t algo) {
+    const char* name = cu_algorithm_name(algo);
+    size_t in_len = 300 * 1024 + 123;
+    uint8_t* in = malloc(in_len);
+    for (size_t i = 0; i < in_len; i++) in[i] = (uint8_t)((i * 31 + (i >> 9)) & 0xff);
+
+    cu_parallel_opts_t opts = { .threads = 4, .chunk_size = 64 * 1024 };
+    size_t bound = cu_compress_parallel_bound(in_len, algo, &opts);
+    CHECK(bound > 0, "%s: parallel bound is 0\n", name);
+
+    size_t small_len = 16;
+    uint8_t small[16];
+    cu_status_t s = cu_compress_parallel(algo, in, in_len, small, &small_len, 5, &opts);
+    CHECK(s == CU_ERR_BUF_TOO_SMALL && small_len == bound,
+          "%s: undersized parallel buffer -> %s, out_len %zu (bound %zu)\n",
+          name, cu_strerror(s), small_len, bound);
+
+    uint8_t* c4 = malloc(bound);
+    uint8_t* c1 = malloc(bound);
+    size_t c4_len = bound, c1_len = bound;
+    CHECK_OK(cu_compress_parallel(algo, in, in_len, c4, &c4_len, 5, &opts));
+    opts.threads = 1;
+    CHECK_OK(cu_compress_parallel(algo, in, in_len, c1, &c1_len, 5, &opts));
+    CHECK(c1_len == c4_len && memcmp(c1, c4, c1_len) == 0,
+          "%s: parallel output depends on thread count\n", name);
+
+    size_t hint = 0;
+    if (cu_decompress_size_hint(algo, c4, c4_len, &hint) == CU_OK) {
+        CHECK(hint == in_len, "%s: multi-frame size_hint=%zu != %zu\n", name, hint, in_len);
+    }
+
+    uint8_t* out = malloc(in_len);
+    size_t out_len = in_len;
+    CHECK_OK(cu_decompress(algo, c4, c4_len, out, &out_len));
+    CHECK(out_len == in_len && memcmp(in, out, in_len) == 0,
+          "%s: parallel one-shot round-trip mismatch\n", name);
+    free(out);
+
+    out = NULL;
+    CHECK_OK(collect_stream_decompress(algo, c4, c4_len, &out, &out_len));
+    CHECK(out_len == in_len && memcmp(in, out, in_len) == 0,
+          "%s: parallel streaming round-trip mismatch\n", name);
+    free(out);
+
+    /* Single chunk: identical to cu_compress. */
+    opts.chunk_size = 0;
+    size_t p_len = bound, o_len = bound;
+    CHECK_OK(cu_compress_parallel(algo, in, 4096, c1, &p_len, 5, &opts));
+    CHECK_OK(cu_compress(algo, in, 4096, c4, &o_len, 5));
+    CHECK(p_len == o_len && memcmp(c1, c4, p_len) == 0,
+          "%s: single-chunk parallel output differs from cu_compress\n", name);
+
+    free(c1);
+    free(c4);
+    free(in);
+    printf("  %s parallel: ok\n", name);
+    return 0;
+}
+
+static int test_parallel(void) {
+    for (size_t i = 0; i < N_ALGOS; i++) {
+        cu_algorithm_t a = ALL_ALGOS[i];
+        if (!cu_algorithm_available(a)) continue;
+        if (!cu_parallel_supported(a)) {
+            size_t len = 0;
+            CHECK(cu_compress_parallel(a, NULL, 0, NULL, &len, 5, NULL) == CU_ERR_UNSUPPORTED_ALGO,
+                  "%s: parallel should be unsupported\n", cu_algorithm_name(a));
+            continue;
+        }
+        if (test_parallel_one(a)) return 1;
+    }
+    return 0;
+}
+
+static int write_file(const char* path, const uint8_t* data, size_t len) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return -1;
+    size_t w = len ? fwrite(data, 1, len, f) : 0;
+    return fclose(f) == 0 && w == len ? 0 : -1;
+}
+
+static uint8_t* read_file(const char* path, size_t* len) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* buf = malloc(n > 0 ? (size_t)n : 1);
+    *len = fread(buf, 1, (size_t)n, f);
+    fclose(f);
+    return buf;
+}
+
+/* Temp files go in the working directory (ctest runs in the build tree),
+ * prefixed with the pid: ctest -j runs several copies of this suite at
+ * once, and one must not truncate a file another has mapped. */
+#define TMP_PATH_LEN 64
+
+static void tmp_path(char* buf, const char* name) {
+    snprintf(buf, TMP_PATH_LEN, "cu_test_%ld_%s", (long)getpid(), name);
+}
+
+/* File round-trips. The parallel variant must match cu_compress_parallel
+ * in memory. */
+static int test_file_one(cu_algorithm_t algo, size_t in_len, const cu_parallel_opts_t* opts) {
+    const char* name = cu_algorithm_name(algo);
+    char src[TMP_PATH_LEN], cmp[TMP_PATH_LEN], dst[TMP_PATH_LEN];
+    tmp_path(src, "file.in");
+    tmp_path(cmp, "file.cmp");
+    tmp_path(dst, "file.out");
+    uint8_t* in = malloc(in_len ? in_len : 1);
+    for (size_t i = 0; i < in_len; i++) in[i] = (uint8_t)((i * 7 + (i >> 11)) & 0x3f);
+    CHECK(write_file(src, in, in_len) == 0, "%s: cannot write %s\n", name, src);
+
+    CHECK_OK(cu_compress_file(algo, src, cmp, 5, opts));
+    CHECK_OK(cu_decompress_file(algo, cmp, dst));
+    size_t out_len = 0;
+    uint8_t* out = read_file(dst, &out_len);
+    CHECK(out && out_len == in_len && memcmp(in, out, in_len) == 0,
+          "%s: file round-trip mismatch (%zu bytes, opts %s)\n",
+          name, in_len, opts ? "parallel" : "NULL");
+    free(out);
+
+    if (opts && cu_parallel_supported(algo)) {
+        size_t c_len = 0;
+        uint8_t* c = read_file(cmp, &c_len);
+        size_t m_len = cu_compress_parallel_bound(in_len, algo, opts);
+        uint8_t* m = malloc(m_len);
+        CHECK_OK(cu_compress_parallel(algo, in, in_len, m, &m_len, 5, opts));
+        CHECK(c && c_len == m_len && memcmp(c, m, m_len) == 0,
+              "%s: cu_compress_file differs from cu_compress_parallel\n", name);
+        free(c);
+        free(m);
+    }
+
+    remove(src);
+    remove(cmp);
+    remove(dst);
+    free(in);
+    return 0;
+}
+
+static int test_file(void) {
+    cu_parallel_opts_t opts = { .threads = 2, .chunk_size = 64 * 1024 };
+    for (size_t i = 0; i < N_ALGOS; i++) {
+        cu_algorithm_t a = ALL_ALGOS[i];
+        if (!cu_algorithm_available(a)) continue;
+        if (test_file_one(a, 0, NULL)) return 1;
+        if (test_file_one(a, 3 * 1024 * 1024 + 17, NULL)) return 1;
+        if (test_file_one(a, 500 * 1024 + 3, &opts)) return 1;
+        printf("  %s file: ok\n", cu_algorithm_name(a));
+    }
+
+    cu_algorithm_t a = ALL_ALGOS[0];
+    for (size_t i = 0; i < N_ALGOS && !cu_algorithm_available(a); i++) a = ALL_ALGOS[i];
+    char missing[TMP_PATH_LEN], in[TMP_PATH_LEN], out[TMP_PATH_LEN];
+    tmp_path(missing, "file.missing");
+    tmp_path(in, "file.in");
+    tmp_path(out, "file.out");
+    cu_status_t s = cu_compress_file(a, missing, out, 5, NULL);
+    CHECK(s == CU_ERR_IO, "missing source -> %s\n", cu_strerror(s));
+    CHECK(strstr(cu_last_error(), missing) != NULL,
+          "I/O error does not name the path: %s\n", cu_last_error());
+    CHECK(fopen(out, "rb") == NULL, "failed compress left its output behind\n");
+
+    CHECK(write_file(in, (const uint8_t*)"abc", 3) == 0, "cannot write input\n");
+    s = cu_compress_file(a, in, in, 5, NULL);
+    CHECK(s == CU_ERR_INVALID_ARG, "in-place compress -> %s\n", cu_strerror(s));
+    s = cu_decompress_file(a, in, out);
+    CHECK(s != CU_OK, "garbage file decompressed\n");
+    CHECK(fopen(out, "rb") == NULL, "failed decompress left its output behind\n");
+
+    /* A destination that can't be opened is the caller's file: a failed
+     * call must leave it alone. Skipped when privileges override 0444. */
+    char ro[TMP_PATH_LEN];
+    tmp_path(ro, "file.ro");
+    CHECK(write_file(ro, (const uint8_t*)"keep", 4) == 0, "cannot write %s\n", ro);
+    chmod(ro, 0444);
+    FILE* probe = fopen(ro, "r+b");
+    if (probe) {
+        fclose(probe);
+    } else {
+        s = cu_compress_file(a, in, ro, 5, NULL);
+        CHECK(s == CU_ERR_IO, "read-only destination -> %s\n", cu_strerror(s));
+        s = cu_decompress_file(a, in, ro);
+        CHECK(s == CU_ERR_IO, "read-only destination -> %s\n", cu_strerror(s));
+        size_t kept_len = 0;
+        uint8_t* kept = read_file(ro, &kept_len);
+        CHECK(kept && kept_len == 4 && memcmp(kept, "keep", 4) == 0,
+              "failed call removed or changed a read-only destination\n");
+        free(kept);
+    }
+    chmod(ro, 0644);
+    remove(ro);
+    remove(in);
+    return 0;
+}
+
+/* Tar: in-memory and on-disk members, a name that needs a pax header, an
+ * empty member, and a member spanning several parallel chunks. Read back
+ * sequentially, then extract single members (through the index where the
+ * codec has one). */
+static int test_tar_one(cu_algorithm_t algo) {
+    const char* name = cu_algorithm_name(algo);
+    char arc[TMP_PATH_LEN], src[TMP_PATH_LEN], dst[TMP_PATH_LEN];
+    tmp_path(arc, "tar.arc");
+    tmp_path(src, "tar.src");
+    tmp_path(dst, "tar.out");
+    size_t big_len = 300 * 1024 + 5;
+    uint8_t* big = malloc(big_len);
+    for (size_t i = 0; i < big_len; i++) big[i] = (uint8_t)((i * 13 + (i >> 10)) & 0x7f);
+    CHECK(write_file(src, big, big_len) == 0, "cannot write %s\n", src);
+
+    char long_name[300];
+    memset(long_name, 'n', sizeof(long_name) - 1);
+    long_name[sizeof(long_name) - 1] = '\0';
+    const char* small = "hello, tar\n";
+
+    int indexed = algo == CU_ALGO_ZSTD || algo == CU_ALGO_LZ4;
+    cu_parallel_opts_t opts = { .threads = 2, .chunk_size = 64 * 1024 };
+    cu_tar_writer_t* w = NULL;
+    CHECK_OK(cu_tar_writer_create(arc, algo, 3, &opts, indexed ? CU_TAR_INDEX : 0, &w));
+    CHECK_OK(cu_tar_writer_add_data(w, "dir/small.txt", (const uint8_t*)small, strlen(small),
+                                    0644, 1700000000));
+    CHECK_OK(cu_tar_writer_add_data(w, "empty", NULL, 0, 0600, 0));
+    CHECK_OK(cu_tar_writer_add_file(w, src, "data/big.bin"));
+    CHECK_OK(cu_tar_writer_add_data(w, long_name, (const uint8_t*)"x", 1, 0644, 0));
+    CHECK_OK(cu_tar_writer_finish(w));
+    CHECK(cu_tar_writer_add_data(w, "late", NULL, 0, 0644, 0) == CU_ERR_STREAM_FINISHED,
+          "%s: write after finish accepted\n", name);
+    cu_tar_writer_destroy(w);
+
+    /* The archive is an ordinary compressed stream. */
+    CHECK_OK(cu_decompress_file(algo, arc, dst));
+
+    cu_tar_reader_t* r = NULL;
+    CHECK_OK(cu_tar_reader_open(arc, algo, &r));
+    const cu_tar_entry_t* e;
+    const char* want[] = { "dir/small.txt", "empty", "data/big.bin", long_name };
+    for (size_t k = 0; k < 4; k++) {
+        CHECK_OK(cu_tar_reader_next(r, &e));
+        CHECK(e && strcmp(e->name, want[k]) == 0, "%s: entry %zu is '%s'\n",
+              name, k, e ? e->name : "(end)");
+        CHECK(e->type == '0', "%s: entry %zu has type %c\n", name, k, e->type);
+    }
+    CHECK_OK(cu_tar_reader_next(r, &e));
+    CHECK(e == NULL, "%s: extra entry '%s'\n", name, e->name);
+    cu_tar_reader_destroy(r);
+
+    /* Stream one member's data out through cu_tar_reader_read. */
+    CHECK_OK(cu_tar_reader_open(arc, algo, &r));
+    CHECK_OK(cu_tar_reader_next(r, &e));
+    CHECK(e->size == strlen(small) && e->mtime == 1700000000 && e->mode == 0644,
+          "%s: small.txt metadata\n", name);
+    uint8_t buf[64];
+    size_t n = 0, total = 0, got;
+    do {
+        CHECK_OK(cu_tar_reader_read(r, buf + total, 5, &got));
+        total += got;
+    } while (got);
+    n = total;
+    CHECK(n == strlen(small) && memcmp(buf, small, n) == 0, "%s: small.txt contents\n", name);
+    cu_tar_reader_destroy(r);
+
+    const char* pick[] = { "data/big.bin", long_name, "dir/small.txt" };
+    for (size_t k = 0; k < 3; k++) {
+        CHECK_OK(cu_tar_extract_member(arc, algo, pick[k], dst));
+        size_t out_len = 0;
+        uint8_t* out = read_file(dst, &out_len);
+        int ok = k == 0 ? out_len == big_len && memcmp(out, big, big_len) == 0
+               : k == 1 ? out_len == 1 && out[0] == 'x'
+               : out_len == strlen(small) && memcmp(out, small, out_len) == 0;
+        CHECK(ok, "%s: extracted '%.20s' differs\n", name, pick[k]);
+        free(out);
+    }
+    cu_status_t s = cu_tar_extract_member(arc, algo, "missing", dst);
+    CHECK(s == CU_ERR_INVALID_ARG, "%s: missing member -> %s\n", name, cu_strerror(s));
+
+    remove(arc);
+    remove(src);
+    remove(dst);
+    free(big);
+    printf("  %s tar%s: ok\n", name, indexed ? " (indexed)" : "");
+    return 0;
+}
+
+static int test_tar(void) {
+    for (size_t i = 0; i < N_ALGOS; i++) {
+        if (!cu_algorithm_available(ALL_ALGOS[i])) continue;
+        if (test_tar_one(ALL_ALGOS[i])) return 1;
+    }
+    if (cu_algorithm_available(CU_ALGO_GZIP)) {
+        char arc[TMP_PATH_LEN];
+        tmp_path(arc, "tar.arc");
+        cu_tar_writer_t* w = NULL;
+        cu_status_t s = cu_tar_writer_create(arc, CU_ALGO_GZIP, 3, NULL,
+                                             CU_TAR_INDEX, &w);
+        CHECK(s == CU_ERR_INVALID_ARG && !w, "gzip index -> %s\n", cu_strerror(s));
+    }
+    return 0;
+}
+
+/* Zip: a directory, an empty entry, a batch of small entries, one
+ * incompressible entry (falls back to store) and one larger than a
+ * batch (streamed). Read back by name, singly and in parallel. */
+static int test_zip_one(cu_zip_method_t method) {
+    char arc[TMP_PATH_LEN];
+    tmp_path(arc, "zip.zip");
+    const char* dir = ".";
+    size_t big_len = ((size_t)8 << 20) + 7;  /* one worker's batch + 7 */
+    uint8_t* big = malloc(big_len);
+    for (size_t i = 0; i < big_len; i++) big[i] = (uint8_t)((i * 7 + (i >> 12)) & 0x3f);
+    uint8_t noise[4096];
+    uint32_t x = 0x9e3779b9u;
+    for (size_t i = 0; i < sizeof(noise); i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        noise[i] = (uint8_t)x;
+    }
+
+    cu_parallel_opts_t opts = { .threads = 1, .chunk_size = 0 };
+    cu_zip_writer_t* w = NULL;
+    CHECK_OK(cu_zip_writer_create(arc, method, 3, &opts, &w));
+    CHECK_OK(cu_zip_writer_add_file(w, dir, "sub"));
+    CHECK_OK(cu_zip_writer_add_data(w, "empty", NULL, 0, 0));
+    char ename[32];
+    char body[64];
+    for (int k = 0; k < 40; k++) {
+        snprintf(ename, sizeof(ename), "sub/e%02d.txt", k);
+        int n = snprintf(body, sizeof(body), "entry %d entry %d entry %d\n", k, k, k);
+        CHECK_OK(cu_zip_writer_add_data(w, ename, (const uint8_t*)body, (size_t)n,
+                                        1700000000));
+    }
+    CHECK_OK(cu_zip_writer_add_data(w, "noise.bin", noise, sizeof(noise), 0));
+    CHECK_OK(cu_zip_writer_add_data(w, "big.bin", big, big_len, 0));
+    CHECK_OK(cu_zip_writer_finish(w));
+    CHECK(cu_zip_writer_add_data(w, "late", NULL, 0, 0) == CU_ERR_STREAM_FINISHED,
+          "zip %d: write after finish accepted\n", (int)method);
+    cu_zip_writer_destroy(w);
+
+    cu_zip_reader_t* r = NULL;
+    CHECK_OK(cu_zip_reader_open(arc, &r));
+    CHECK(cu_zip_reader_count(r) == 44, "zip %d: %zu entries\n", (int)method,
+          cu_zip_reader_count(r));
+    CHECK(strcmp(cu_zip_reader_entry(r, 0)->name, "sub/") == 0, "zip %d: dir entry '%s'\n",
+          (int)method, cu_zip_reader_entry(r, 0)->name);
+    CHECK(cu_zip_reader_entry(r, 44) == NULL, "zip %d: entry past the end\n", (int)method);
+
+    size_t idx;
+    CHECK_OK(cu_zip_reader_find(r, "noise.bin", &idx));
+    const cu_zip_entry_t* e = cu_zip_reader_entry(r, idx);
+    CHECK(e->method == CU_ZIP_STORE && e->size == sizeof(noise),
+          "zip %d: noise.bin method %u\n", (int)method, e->method);
+    uint8_t out[sizeof(noise)];
+    size_t out_len = 10;
+    cu_status_t s = cu_zip_reader_extract(r, idx, out, &out_len);
+    CHECK(s == CU_ERR_BUF_TOO_SMALL && out_len == sizeof(noise),
+          "zip %d: small buffer -> %s, %zu\n", (int)method, cu_strerror(s), out_len);
+    CHECK_OK(cu_zip_reader_extract(r, idx, out, &out_len));
+    CHECK(out_len == sizeof(noise) && memcmp(out, noise, out_len) == 0,
+          "zip %d: noise.bin differs\n", (int)method);
+
+    CHECK_OK(cu_zip_reader_find(r, "empty", &idx));
+    out_len = 0;
+    CHECK_OK(cu_zip_reader_extract(r, idx, NULL, &out_len));
+
+    CHECK_OK(cu_zip_reader_find(r, "big.bin", &idx));
+    e = cu_zip_reader_entry(r, idx);
+    CHECK(e->size == big_len && e->method == (uint16_t)method &&
+          (method == CU_ZIP_STORE || e->compressed_size < big_len),
+          "zip %d: big.bin method %u, %llu bytes\n", (int)method, e->method,
+          (unsigned long long)e->compressed_size);
+    uint8_t* big_out = malloc(big_len);
+    out_len = big_len;
+    CHECK_OK(cu_zip_reader_extract(r, idx, big_out, &out_len));
+    CHECK(out_len == big_len && memcmp(big_out, big, big_len) == 0,
+          "zip %d: big.bin differs\n", (int)method);
+    free(big_out);
+
+    size_t picks[40];
+    uint8_t bufs[40][64];
+    uint8_t* outs[40];
+    size_t lens[40];
+    cu_status_t results[40];
+    for (int k = 0; k < 40; k++) {
+        snprintf(ename, sizeof(ename), "sub/e%02d.txt", 39 - k);
+        CHECK_OK(cu_zip_reader_find(r, ename, &picks[k]));
+        outs[k] = bufs[k];
+        lens[k] = sizeof(bufs[k]);
+    }
+    cu_parallel_opts_t xopts = { .threads = 4, .chunk_size = 0 };
+    CHECK_OK(cu_zip_reader_extract_many(r, picks, 40, outs, lens, results, &xopts));
+    for (int k = 0; k < 40; k++) {
+        int n = snprintf(body, sizeof(body), "entry %d entry %d entry %d\n",
+                         39 - k, 39 - k, 39 - k);
+        CHECK(results[k] == CU_OK && lens[k] == (size_t)n && memcmp(bufs[k], body, lens[k]) == 0,
+              "zip %d: parallel extract of entry %d\n", (int)method, 39 - k);
+    }
+    CHECK(cu_zip_reader_entry(r, picks[0])->mtime == 1700000000, "zip %d: mtime\n",
+          (int)method);
+    s = cu_zip_reader_find(r, "missing", &idx);
+    CHECK(s == CU_ERR_INVALID_ARG, "zip %d: missing entry -> %s\n", (int)method, cu_strerror(s));
+    cu_zip_reader_destroy(r);
+
+    remove(arc);
+    free(big);
+    printf("  zip method %d: ok\n", (int)method);
+    return 0;
+}
+
+static int test_zip(void) {
+    const cu_zip_method_t methods[] = { CU_ZIP_STORE, CU_ZIP_DEFLATE, CU_ZIP_ZSTD, CU_ZIP_XZ };
+    const int available[] = {
+        1,
+        cu_algorithm_available(CU_ALGO_ZLIB) || cu_algorithm_available(CU_ALGO_GZIP),
+        cu_algorithm_available(CU_ALGO_ZSTD),
+        cu_algorithm_available(CU_ALGO_XZ),
+    };
+    for (size_t i = 0; i < sizeof(methods) / sizeof(methods[0]); i++) {
+        if (!available[i]) continue;
+        if (test_zip_one(methods[i])) return 1;
+    }
+    char missing[TMP_PATH_LEN];
+    tmp_path(missing, "zip.missing");
+    cu_zip_reader_t* r = NULL;
+    cu_status_t s = cu_zip_reader_open(missing, &r);
+    CHECK(s == CU_ERR_IO && !r, "missing zip -> %s\n", cu_strerror(s));
+    return 0;
+}
+
 int main(void) {
     if (test_version_and_introspection())   return 1;
     if (test_oneshot_roundtrip())           return 1;
     if (test_buf_too_small())               return 1;
+    if (test_speed_tiers())                 return 1;
     if (test_streaming_with_tight_buffer()) return 1;
+    if (test_stream_flush())                return 1;
+    if (test_pledged_size())                return 1;
+    if (test_iovec())                       return 1;
+    if (test_checksum_options())            return 1;
     if (test_cross_api())                   return 1;
+    if (test_huge_pages())                  return 1;
+    if (test_warmup())                      return 1;
     if (test_reject_garbage())              return 1;
+    if (test_parallel())                    return 1;
+    if (test_file())                        return 1;
+    if (test_tar())                         return 1;
+    if (test_zip())                         return 1;
     printf("OK\n");
     return 0;
 }
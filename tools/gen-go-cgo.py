@@ -50,9 +50,9 @@ GEN_GO = "cgo_generated.go"
 ALGOS = ["zstd", "brotli", "zlib", "gzip", "bz2", "lz4", "xz", "snappy"]
 
 # Our own translation units (not upstream): the ABI dispatcher, the registry,
-# and one vtable per algorithm. Compiled with the global INCLUDE_* defines; no
+# the codec allocator hooks, cu_warmup, and one vtable per algorithm. Compiled with the global INCLUDE_* defines; no
 # per-codec private macros needed.
-CORE_SOURCES = ["compress_utils.c", "registry.c"]
+CORE_SOURCES = ["compress_utils.c", "registry.c", "alloc.c", "warmup.c"]
 
 # Per-codec unity toggle. Default False: emit one shim per source (1:1), which
 # mirrors how CMake compiles each source as its own translation unit and is